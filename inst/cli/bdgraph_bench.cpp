@@ -0,0 +1,246 @@
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+//     Copyright (C) 2012 - 2022  Reza Mohammadi                                                   |
+//                                                                                                 |
+//     This file is part of BDgraph package.                                                       |
+//                                                                                                 |
+//     BDgraph is free software: you can redistribute it and/or modify it under                    |
+//     the terms of the GNU General Public License as published by the Free                        |
+//     Software Foundation; see <https://cran.r-project.org/web/licenses/GPL-3>.                   |
+//                                                                                                 |
+//     Maintainer: Reza Mohammadi <a.mohammadi@uva.nl>                                             |
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+//     Benchmark of the computational kernels without R: the rates of BDMCMC, G-Wishart,       |
+//     selecting an edge, the marginal pseudo-likelihood of Gaussian and of discrete data,     |
+//     and the copula, on random graphs with p nodes and a density of links. It writes one    |
+//     CSV line for each kernel and p, with the throughput of the kernel ( per second ).      |
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+
+#include "rgwish.h"
+#include "ggm_mpl_bd.h"
+#include "mpl_count.h"
+#include "copula.h"
+#include <chrono>
+#include <iostream>
+#include <cstdlib>
+
+extern "C" {
+	void log_mpl_dis( int *node, int mb_node[], int *size_node, double *log_mpl_node,
+	                  int data[], int freq_data[], int *length_freq_data,
+	                  int max_range_nodes[], double *alpha_ijl, int *n,
+	                  mpl_lgamma_table &lgamma_table, mpl_count_buffer &buffer );
+
+	void omp_set_num_cores( int *cores, int *verbose_core );
+}
+
+struct bench_options
+{
+	vector<int> size_p;
+	int n, reps, cores;
+	double density;
+	unsigned long long int seed;
+
+	bench_options() : n( 100 ), reps( 100 ), cores( 0 ), density( 0.1 ), seed( 5489ULL ) {}
+};
+
+static void usage()
+{
+	cerr << "Usage: bdgraph_bench [options]\n"
+	     << "  --p p1,p2,...        numbers of nodes ( default 50,200 )\n"
+	     << "  --density x          probability of a link of the random graphs ( default 0.1 )\n"
+	     << "  --n N                number of observations ( default 100 )\n"
+	     << "  --reps N             calls of each kernel ( default 100 )\n"
+	     << "  --seed N             seed of the random number generator\n"
+	     << "  --cores N            number of threads\n";
+}
+
+static bool parse_options( int argc, char *argv[], bench_options *opt )
+{
+	for( int i = 1; i < argc; i++ )
+	{
+		string arg = argv[ i ];
+		if( i + 1 == argc ) return false;
+
+		if( arg == "--p" )
+		{
+			string list = argv[ ++i ];
+			replace( list.begin(), list.end(), ',', ' ' );
+			istringstream values( list );
+			int p;
+			while( values >> p ) opt->size_p.push_back( p );
+		}
+		else if( arg == "--density" ) opt->density = atof( argv[ ++i ] );
+		else if( arg == "--n"       ) opt->n       = atoi( argv[ ++i ] );
+		else if( arg == "--reps"    ) opt->reps    = atoi( argv[ ++i ] );
+		else if( arg == "--seed"    ) opt->seed    = strtoull( argv[ ++i ], NULL, 10 );
+		else if( arg == "--cores"   ) opt->cores   = atoi( argv[ ++i ] );
+		else
+			return false;
+	}
+
+	if( opt->size_p.empty() )
+	{
+		opt->size_p.push_back( 50 );
+		opt->size_p.push_back( 200 );
+	}
+
+	return true;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// wall-clock time of 'reps' calls of a kernel, and one CSV line with its throughput: 'size' units
+// of the kernel in each call
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+template< class Kernel >
+static void bench_kernel( const char *kernel, const char *unit, double size, const bench_options &opt, int p, Kernel call )
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for( int r = 0; r < opt.reps; r++ ) call();
+	double time = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+	size *= opt.reps;
+	printf( "%s,%d,%g,%d,%s,%.0f,%.6f,%.6g\n", kernel, p, opt.density, opt.n, unit, size, time, ( time > 0.0 ) ? size / time : 0.0 );
+	fflush( stdout );
+}
+
+static void bench_p( int p, const bench_options &opt )
+{
+	int n = opt.n, pxp = p * p, qp = p * ( p - 1 ) / 2, b = 3, b_star = b + n;
+	double threshold = 1e-8;
+
+	// random graph with the given density
+	vector<int> G( pxp, 0 ), size_node( p, 0 );
+	for( int j = 1; j < p; j++ )
+		for( int i = 0; i < j; i++ )
+			if( unif_rand() < opt.density )
+			{
+				G[ j * p + i ] = G[ i * p + j ] = 1;
+				++size_node[ i ];
+				++size_node[ j ];
+			}
+
+	// Gaussian data, n x p by column, and their discrete version with 3 states
+	vector<double> data( static_cast<size_t>( n ) * p );
+	for( size_t k = 0; k < data.size(); k++ ) data[ k ] = norm_rand();
+
+	vector<int> data_dis( data.size() ), ranks( data.size() );
+	for( size_t k = 0; k < data.size(); k++ )
+	{
+		data_dis[ k ] = ( data[ k ] < -0.5 ) ? 0 : ( ( data[ k ] < 0.5 ) ? 1 : 2 );
+		ranks[ k ]    = data_dis[ k ] + 1;
+	}
+
+	// S = t( data ) %*% data, Ds = I + S, Ts = chol( solve( Ds ) ), and K from G-Wishart
+	vector<double> S( pxp ), K( pxp ), sigma( pxp ), inv_Ds( pxp ), Ts( pxp );
+	double alpha = 1.0, beta = 0.0;
+	char transT = 'T', transN = 'N';
+	F77_NAME(dgemm)( &transT, &transN, &p, &p, &n, &alpha, &data[0], &n, &data[0], &n, &beta, &S[0], &p FCONE FCONE );
+
+	vector<double> Ds( S );
+	for( int i = 0; i < p; i++ ) Ds[ i * p + i ] += 1.0;
+	vector<double> copy_Ds( Ds );
+	inverse( &copy_Ds[0], &inv_Ds[0], &p );
+	cholesky( &inv_Ds[0], &Ts[0], &p );
+
+	rgwish_c( &G[0], &Ts[0], &K[0], &b_star, &p, &threshold );
+	vector<double> copy_K( K );
+	inverse( &copy_K[0], &sigma[0], &p );
+
+	// rates_bdmcmc_parallel, for all the links
+	vector<int> index_row( qp ), index_col( qp );
+	vector<double> log_ratio_g_prior( pxp, log( 0.2 / 0.8 ) ), Dsijj( pxp ), rates( qp );
+	int sub_qp = 0;
+	for( int j = 1; j < p; j++ )
+		for( int i = 0; i < j; i++ )
+		{
+			index_row[ sub_qp ]   = i;
+			index_col[ sub_qp++ ] = j;
+			Dsijj[ j * p + i ]    = Ds[ j * p + i ] * Ds[ j * p + i ] / Ds[ j * p + j ];
+		}
+
+	bench_kernel( "rates_bdmcmc_parallel", "rates", qp, opt, p, [&]()
+	{
+		rates_bdmcmc_parallel( &rates[0], &log_ratio_g_prior[0], &G[0], &index_row[0], &index_col[0], &sub_qp, &Ds[0], &Dsijj[0], &sigma[0], &K[0], &b, &p );
+	} );
+
+	int index_selected_edge;
+	double sum_rates;
+	bench_kernel( "select_edge", "edges", 1, opt, p, [&]()
+	{
+		select_edge( &rates[0], &index_selected_edge, &sum_rates, &sub_qp );
+	} );
+
+	// rgwish_sigma: one sample of K and sigma
+	vector<double> sigma_start( pxp ), inv_C( pxp ), beta_star( p ), sigma_i( p ), sigma_start_N_i( p ), sigma_N_i( pxp );
+	vector<int> N_i( p );
+	bench_kernel( "rgwish_sigma", "samples", 1, opt, p, [&]()
+	{
+		rgwish_sigma( &G[0], &size_node[0], &Ts[0], &K[0], &sigma[0], &b_star, &p, &threshold,
+		              &sigma_start[0], &inv_C[0], &beta_star[0], &sigma_i[0], sigma_start_N_i, sigma_N_i, N_i );
+	} );
+
+	// log_mpl and log_mpl_dis: the scores of all the nodes for the graph G
+	vector<int> mb_nodes( pxp );
+	for( int i = 0; i < p; i++ )
+	{
+		int size_mb = 0;
+		for( int t = 0; t < p; t++ )
+			if( G[ i * p + t ] ) mb_nodes[ i * p + size_mb++ ] = t;
+	}
+
+	vector<double> S_mb_node( pxp ), log_mpl_node( p );
+	bench_kernel( "log_mpl", "scores", p, opt, p, [&]()
+	{
+		for( int i = 0; i < p; i++ )
+			log_mpl( &i, &mb_nodes[ i * p ], &size_node[ i ], &log_mpl_node[ i ], &S[0], &S_mb_node[0], &n, &p );
+	} );
+
+	vector<int> freq_data( n, 1 ), max_range_nodes( p, 2 ), size_range_nodes( p, 3 );
+	double alpha_ijl = 0.5;
+	mpl_lgamma_table lgamma_table;
+	mpl_count_buffer count_buffer;
+	get_mpl_lgamma_table( &n, &alpha_ijl, &size_range_nodes[0], &p, lgamma_table );
+	bench_kernel( "log_mpl_dis", "scores", p, opt, p, [&]()
+	{
+		for( int i = 0; i < p; i++ )
+			log_mpl_dis( &i, &mb_nodes[ i * p ], &size_node[ i ], &log_mpl_node[ i ], &data_dis[0], &freq_data[0], &n,
+			             &max_range_nodes[0], &alpha_ijl, &n, lgamma_table, count_buffer );
+	} );
+
+	// copula: one update of the latent data of all the variables
+	vector<double> Z( data );
+	vector<int> not_continuous( p, 1 );
+	bench_kernel( "copula", "values", static_cast<double>( n ) * p, opt, p, [&]()
+	{
+		copula( &Z[0], &K[0], &ranks[0], &not_continuous[0], &n, &p );
+	} );
+}
+
+int main( int argc, char *argv[] )
+{
+	bench_options opt;
+	if( !parse_options( argc, argv, &opt ) )
+	{
+		usage();
+		return 2;
+	}
+
+	try{
+		for( size_t k = 0; k < opt.size_p.size(); k++ )
+			if( opt.size_p[ k ] < 3 ) Rf_error( "Number of nodes ('p') must be more than 2" );
+		if( ( opt.density < 0.0 ) or ( opt.density > 1.0 ) ) Rf_error( "'density' must be between 0 and 1" );
+		if( ( opt.n < 1 ) or ( opt.reps < 1 ) ) Rf_error( "'n' and 'reps' must be positive" );
+
+		int cores = opt.cores, verbose_core = 0;
+		if( cores > 0 ) omp_set_num_cores( &cores, &verbose_core );
+		set_seed_standalone( opt.seed );
+
+		printf( "kernel,p,density,n,unit,size,time,per_second\n" );
+		for( size_t k = 0; k < opt.size_p.size(); k++ )
+			bench_p( opt.size_p[ k ], opt );
+	}catch( const exception &e ){
+		cerr << "Error: " << e.what() << "\n";
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,274 @@
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+//     Copyright (C) 2012 - 2022  Reza Mohammadi                                                   |
+//                                                                                                 |
+//     This file is part of BDgraph package.                                                       |
+//                                                                                                 |
+//     BDgraph is free software: you can redistribute it and/or modify it under                    |
+//     the terms of the GNU General Public License as published by the Free                        |
+//     Software Foundation; see <https://cran.r-project.org/web/licenses/GPL-3>.                   |
+//                                                                                                 |
+//     Maintainer: Reza Mohammadi <a.mohammadi@uva.nl>                                             |
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+//     Command line front end of the core samplers, without R: BDMCMC for Gaussian graphical   |
+//     models, with the exact ( method ggm ) or the marginal pseudo-likelihood ( method mpl ). |
+//     The data are a CSV file ( n rows, p columns, an optional header ) or a binary file     |
+//     ( int n, int p, then the n x p doubles by column ). It writes the posterior            |
+//     probabilities of the links, and for ggm the estimated precision matrix, as CSV files.  |
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+
+#include "matrix.h"
+#include <fstream>
+#include <iostream>
+#include <cstdlib>
+
+extern "C" {
+	void rgwish_c( int G[], double Ts[], double K[], int *b, int *p, double *threshold );
+
+	void ggm_bdmcmc_ma( int *iter, int *burnin, int G[], double g_prior[], double Ts[], double K[],
+	                    int *p, double *threshold, double K_hat[], double p_links[],
+	                    int *b, int *b_star, double Ds[], double *mcse_tol, double p_links_mcse[], int *iter_used, double *time_budget, double timing[],
+	                    char **checkpoint_file, int *checkpoint_every, int *resume, int *print );
+
+	void ggm_bdmcmc_mpl_ma( int *iter, int *burnin, int G[], double g_prior[],
+	                        double S[], int *n, int *p, double p_links[],
+	                        char **checkpoint_file, int *checkpoint_every, int *resume, int *print );
+
+	void ggm_bdmcmc_sparse( int *iter, int *burnin, int G[], double g_prior[], double Ds[], double K[], int *p,
+	                        double K_hat[], double p_links[], int *b, int *b_star, int *print );
+
+	void omp_set_num_cores( int *cores, int *verbose_core );
+}
+
+struct cli_options
+{
+	string data_file, out, method, checkpoint_file;
+	int iter, burnin, df_prior, cores, checkpoint_every, resume, sparse, verbose;
+	double g_prior, threshold;
+	unsigned long long int seed;
+
+	cli_options() : out( "bdgraph" ), method( "ggm" ), iter( 5000 ), burnin( -1 ), df_prior( 3 ), cores( 0 ),
+		checkpoint_every( 0 ), resume( 0 ), sparse( 0 ), verbose( 1 ), g_prior( 0.2 ), threshold( 1e-8 ), seed( 5489ULL ) {}
+};
+
+static void usage()
+{
+	cerr << "Usage: bdgraph [options] data.csv | data.bin\n"
+	     << "  --method ggm|mpl     sampling algorithm ( default ggm )\n"
+	     << "  --iter N             number of iterations ( default 5000 )\n"
+	     << "  --burnin N           number of burn-in iterations ( default iter / 2 )\n"
+	     << "  --g-prior x          prior probability of a link ( default 0.2 )\n"
+	     << "  --df-prior b         degrees of freedom of the G-Wishart prior ( default 3 )\n"
+	     << "  --threshold x        threshold of the sampler of G-Wishart ( default 1e-8 )\n"
+	     << "  --seed N             seed of the random number generator\n"
+	     << "  --cores N            number of threads\n"
+	     << "  --checkpoint file    checkpoint file, to resume a stopped run\n"
+	     << "  --checkpoint-every N iterations between two checkpoints\n"
+	     << "  --resume             resume the run from the checkpoint file\n"
+	     << "  --sparse             sparse precision matrix, for large and sparse graphs ( ggm )\n"
+	     << "  --quiet              no progress\n"
+	     << "  --out prefix         prefix of the output files ( default bdgraph )\n";
+}
+
+static bool parse_options( int argc, char *argv[], cli_options *opt )
+{
+	for( int i = 1; i < argc; i++ )
+	{
+		string arg = argv[ i ];
+		bool has_value = ( i + 1 < argc );
+
+		if(      arg == "--resume" ) opt->resume  = 1;
+		else if( arg == "--sparse" ) opt->sparse  = 1;
+		else if( arg == "--quiet"  ) opt->verbose = 0;
+		else if( ( arg.compare( 0, 2, "--" ) == 0 ) and !has_value )
+			return false;
+		else if( arg == "--method"           ) opt->method           = argv[ ++i ];
+		else if( arg == "--iter"             ) opt->iter             = atoi( argv[ ++i ] );
+		else if( arg == "--burnin"           ) opt->burnin           = atoi( argv[ ++i ] );
+		else if( arg == "--g-prior"          ) opt->g_prior          = atof( argv[ ++i ] );
+		else if( arg == "--df-prior"         ) opt->df_prior         = atoi( argv[ ++i ] );
+		else if( arg == "--threshold"        ) opt->threshold        = atof( argv[ ++i ] );
+		else if( arg == "--seed"             ) opt->seed             = strtoull( argv[ ++i ], NULL, 10 );
+		else if( arg == "--cores"            ) opt->cores            = atoi( argv[ ++i ] );
+		else if( arg == "--checkpoint"       ) opt->checkpoint_file  = argv[ ++i ];
+		else if( arg == "--checkpoint-every" ) opt->checkpoint_every = atoi( argv[ ++i ] );
+		else if( arg == "--out"              ) opt->out              = argv[ ++i ];
+		else if( arg.compare( 0, 2, "--" ) == 0 )
+			return false;
+		else
+			opt->data_file = arg;
+	}
+
+	if( opt->burnin < 0 ) opt->burnin = opt->iter / 2;
+
+	return !opt->data_file.empty();
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// Data as an n x p matrix by column, from a binary or a CSV file
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+static void read_binary( const string &file_name, vector<double> *data, int *n, int *p )
+{
+	ifstream in( file_name.c_str(), ios::binary );
+	if( !in.read( reinterpret_cast<char *>( n ), sizeof( int ) ) or !in.read( reinterpret_cast<char *>( p ), sizeof( int ) ) or ( *n <= 0 ) or ( *p <= 0 ) )
+		Rf_error( "Cannot read the binary data file '%s'", file_name.c_str() );
+
+	data->resize( static_cast<size_t>( *n ) * *p );
+	if( !in.read( reinterpret_cast<char *>( &( *data )[0] ), sizeof( double ) * data->size() ) )
+		Rf_error( "The binary data file '%s' is incomplete", file_name.c_str() );
+}
+
+static void read_csv( const string &file_name, vector<double> *data, int *n, int *p )
+{
+	ifstream in( file_name.c_str() );
+	if( !in ) Rf_error( "Cannot read the data file '%s'", file_name.c_str() );
+
+	vector<double> rows;   // by row
+	string line;
+	*p = 0;
+	*n = 0;
+	while( getline( in, line ) )
+	{
+		replace( line.begin(), line.end(), ',', ' ' );
+		istringstream fields( line );
+		vector<double> row;
+		string field;
+		bool header = false;
+		while( fields >> field )
+		{
+			char *end;
+			double value = strtod( field.c_str(), &end );
+			if( *end != '\0' ) header = true;
+			row.push_back( value );
+		}
+
+		if( row.empty() ) continue;
+		if( header )
+		{
+			if( ( *n == 0 ) and ( *p == 0 ) ) continue;
+			Rf_error( "Line %d of the data file '%s' is not numeric", *n + 1, file_name.c_str() );
+		}
+
+		if( *p == 0 ) *p = static_cast<int>( row.size() );
+		if( static_cast<int>( row.size() ) != *p )
+			Rf_error( "Line %d of the data file '%s' has %d columns, not %d", *n + 1, file_name.c_str(), static_cast<int>( row.size() ), *p );
+
+		rows.insert( rows.end(), row.begin(), row.end() );
+		++*n;
+	}
+
+	if( *n == 0 ) Rf_error( "There are no data in the file '%s'", file_name.c_str() );
+
+	int dim = *p;
+	data->resize( rows.size() );
+	for( int i = 0; i < *n; i++ )
+		for( int j = 0; j < dim; j++ )
+			( *data )[ j * *n + i ] = rows[ i * dim + j ];
+}
+
+static void write_csv( const string &file_name, const vector<double> &A, int p )
+{
+	ofstream out( file_name.c_str() );
+	out.precision( 10 );
+	for( int i = 0; i < p; i++ )
+		for( int j = 0; j < p; j++ )
+			out << A[ j * p + i ] << ( ( j == p - 1 ) ? "\n" : "," );
+
+	if( !out ) Rf_error( "Cannot write the file '%s'", file_name.c_str() );
+}
+
+static int run( const cli_options &opt )
+{
+	if( ( opt.method != "ggm" ) and ( opt.method != "mpl" ) ) Rf_error( "'method' must be 'ggm' or 'mpl'" );
+	if( opt.iter < opt.burnin ) Rf_error( "'iter' must be higher than 'burnin'" );
+	if( ( opt.g_prior <= 0.0 ) or ( opt.g_prior >= 1.0 ) ) Rf_error( "'g-prior' must be between 0 and 1" );
+	if( opt.df_prior < 3 ) Rf_error( "'df-prior' must be >= 3" );
+	if( opt.sparse and ( ( opt.method != "ggm" ) or !opt.checkpoint_file.empty() ) ) Rf_error( "'sparse' is only for method 'ggm', without 'checkpoint'" );
+
+	vector<double> data;
+	int n, p;
+	if( ( opt.data_file.size() > 4 ) and ( opt.data_file.compare( opt.data_file.size() - 4, 4, ".bin" ) == 0 ) )
+		read_binary( opt.data_file, &data, &n, &p );
+	else
+		read_csv( opt.data_file, &data, &n, &p );
+
+	if( p < 3 ) Rf_error( "Number of variables/nodes ('p') must be more than 2" );
+
+	int cores = opt.cores, verbose_core = opt.verbose;
+	if( cores > 0 ) omp_set_num_cores( &cores, &verbose_core );
+	set_seed_standalone( opt.seed );
+
+	int pxp = p * p, iter = opt.iter, burnin = opt.burnin, print = opt.verbose ? 10 : iter + 1000;
+	int every = opt.checkpoint_every, resume = opt.resume;
+	char *checkpoint_file = const_cast<char *>( opt.checkpoint_file.c_str() );
+
+	// S = t( data ) %*% data, as in R
+	vector<double> S( pxp );
+	double alpha = 1.0, beta = 0.0;
+	char transT = 'T', transN = 'N';
+	F77_NAME(dgemm)( &transT, &transN, &p, &p, &n, &alpha, &data[0], &n, &data[0], &n, &beta, &S[0], &p FCONE FCONE );
+
+	vector<double> g_prior( pxp, opt.g_prior ), p_links( pxp, 0.0 );
+	for( int i = 0; i < p; i++ ) g_prior[ i * p + i ] = 0.0;
+	vector<int> G( pxp, 0 );
+
+	if( opt.verbose ) Rprintf( "%d MCMC sampling ... in progress: \n", iter );
+
+	if( opt.method == "mpl" )
+	{
+		ggm_bdmcmc_mpl_ma( &iter, &burnin, &G[0], &g_prior[0], &S[0], &n, &p, &p_links[0],
+		                   &checkpoint_file, &every, &resume, &print );
+	}else{
+		int b = opt.df_prior, b_star = b + n;
+		double threshold = opt.threshold, mcse_tol = 0.0, time_budget = 0.0, timing[ 3 ] = { 0.0, 0.0, 0.0 };
+
+		// Ds = D + S with D = I
+		vector<double> Ds( S ), K( pxp, 0.0 ), K_hat( pxp, 0.0 );
+		for( int i = 0; i < p; i++ ) Ds[ i * p + i ] += 1.0;
+
+		if( opt.sparse )
+		{
+			ggm_bdmcmc_sparse( &iter, &burnin, &G[0], &g_prior[0], &Ds[0], &K[0], &p, &K_hat[0], &p_links[0], &b, &b_star, &print );
+		}else{
+			// Ts = chol( solve( Ds ) )
+			vector<double> copy_Ds( Ds ), inv_Ds( pxp ), Ts( pxp ), p_links_mcse( pxp, 0.0 );
+			inverse( &copy_Ds[0], &inv_Ds[0], &p );
+			cholesky( &inv_Ds[0], &Ts[0], &p );
+
+			rgwish_c( &G[0], &Ts[0], &K[0], &b_star, &p, &threshold );
+
+			int iter_used = iter;
+			ggm_bdmcmc_ma( &iter, &burnin, &G[0], &g_prior[0], &Ts[0], &K[0], &p, &threshold, &K_hat[0], &p_links[0],
+			               &b, &b_star, &Ds[0], &mcse_tol, &p_links_mcse[0], &iter_used, &time_budget, timing,
+			               &checkpoint_file, &every, &resume, &print );
+		}
+
+		write_csv( opt.out + "_K_hat.csv", K_hat, p );
+	}
+
+	if( opt.verbose ) Rprintf( "\n" );
+
+	for( int j = 0; j < p; j++ )
+		for( int i = j + 1; i < p; i++ )
+			p_links[ j * p + i ] = 0.0;   // lower triangle, as in R
+
+	write_csv( opt.out + "_p_links.csv", p_links, p );
+
+	return 0;
+}
+
+int main( int argc, char *argv[] )
+{
+	cli_options opt;
+	if( !parse_options( argc, argv, &opt ) )
+	{
+		usage();
+		return 2;
+	}
+
+	try{
+		return run( opt );
+	}catch( const exception &e ){
+		cerr << "Error: " << e.what() << "\n";
+		return 1;
+	}
+}
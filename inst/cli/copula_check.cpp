@@ -0,0 +1,117 @@
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+//     Copyright (C) 2012 - 2022  Reza Mohammadi                                                   |
+//                                                                                                 |
+//     This file is part of BDgraph package.                                                       |
+//                                                                                                 |
+//     BDgraph is free software: you can redistribute it and/or modify it under                    |
+//     the terms of the GNU General Public License as published by the Free                        |
+//     Software Foundation; see <https://cran.r-project.org/web/licenses/GPL-3>.                   |
+//                                                                                                 |
+//     Maintainer: Reza Mohammadi <a.mohammadi@uva.nl>                                             |
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+//     Check of the copula of method "gcgm" with missing values: copula_NA, which updates the  |
+//     latent data column by column, against the Gibbs sampler of one value at a time with     |
+//     get_mean and get_bounds_NA. The data have missing values and ranks which are not all    |
+//     present in a column. The latent data must keep the order of the ranks, and the means    |
+//     of the two samplers must agree. It returns 1 if not.                                    |
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+
+#include "copula.h"
+#include <iostream>
+#include <cstdlib>
+
+extern "C" {
+	void omp_set_num_cores( int *cores, int *verbose_core );
+}
+
+// the Gibbs sampler of one value at a time, as copula_NA was before it was by columns
+static void copula_NA_by_value( double Z[], double K[], int R[], int not_continuous[], int n, int p )
+{
+	for( int j = 0; j < p; j++ )
+	{
+		if( !not_continuous[ j ] ) continue;
+
+		double sigma = 1.0 / K[ j * p + j ], sd_j = sqrt( sigma ), mu_ij, lb, ub;
+		for( int i = 0; i < n; i++ )
+		{
+			get_mean( Z, K, &mu_ij, &sigma, &i, &j, &n, &p );
+
+			int ij = j * n + i;
+			if( R[ ij ] != -1000 )
+			{
+				get_bounds_NA( Z, R, &lb, &ub, &i, &j, &n );
+				double pnorm_lb = Rf_pnorm5( lb, mu_ij, sd_j, TRUE, FALSE );
+				double pnorm_ub = Rf_pnorm5( ub, mu_ij, sd_j, TRUE, FALSE );
+				Z[ ij ] = Rf_qnorm5( pnorm_lb + unif_rand() * ( pnorm_ub - pnorm_lb ), mu_ij, sd_j, TRUE, FALSE );
+			}else
+				Z[ ij ] = mu_ij + norm_rand() * sd_j;
+		}
+	}
+}
+
+// number of pairs of observed values in a column whose latent data are not in the order of their ranks
+static int order_violations( const vector<double> &Z, const vector<int> &R, int n, int p )
+{
+	int violations = 0;
+	for( int j = 0; j < p; j++ )
+		for( int a = 0; a < n; a++ )
+			for( int b = 0; b < n; b++ )
+			{
+				int ra = R[ j * n + a ], rb = R[ j * n + b ];
+				if( ( ra > 0 ) and ( rb > 0 ) and ( ra < rb ) and ( Z[ j * n + a ] > Z[ j * n + b ] ) ) ++violations;
+			}
+
+	return violations;
+}
+
+int main()
+{
+	int n = 30, p = 3, burn = 500, iter = 20000;
+	double K[] = { 2.0, -0.8, 0.3, -0.8, 2.0, 0.5, 0.3, 0.5, 1.5 };
+
+	// column 0: ranks 1, 3, 4, and 7 only; column 1: ranks 1 to 5 with missing values; column 2 is continuous
+	vector<int> R( n * p ), not_continuous( p, 1 );
+	int ranks_0[] = { 1, 3, 4, 7 };
+	not_continuous[ 2 ] = 0;
+	for( int i = 0; i < n; i++ )
+	{
+		R[ i ]         = ranks_0[ ( i * 7 ) % 4 ];
+		R[ n + i ]     = ( i % 7 == 3 ) ? -1000 : 1 + ( i * 3 ) % 5;
+		R[ 2 * n + i ] = 0;
+	}
+
+	int cores = 2, verbose_core = 0;
+	omp_set_num_cores( &cores, &verbose_core );
+	set_seed_standalone( 5489ULL );
+
+	vector<double> data( n * p );
+	for( int k = 0; k < n * p; k++ )
+		data[ k ] = ( R[ k ] > 0 ) ? 0.5 * ( R[ k ] - 3 ) : 0.3 * norm_rand();
+
+	vector<double> mean_column( n * p, 0.0 ), mean_value( n * p, 0.0 );
+	int violations = 0;
+	for( int sampler = 0; sampler < 2; sampler++ )
+	{
+		vector<double> Z( data ), &mean = ( sampler == 0 ) ? mean_column : mean_value;
+		for( int t = 0; t < burn + iter; t++ )
+		{
+			if( sampler == 0 )
+			{
+				copula_NA( &Z[0], K, &R[0], &not_continuous[0], &n, &p );
+				violations += order_violations( Z, R, n, p );
+			}else
+				copula_NA_by_value( &Z[0], K, &R[0], &not_continuous[0], n, p );
+
+			if( t >= burn )
+				for( int k = 0; k < n * p; k++ ) mean[ k ] += Z[ k ] / iter;
+		}
+	}
+
+	double max_diff = 0.0;
+	for( int k = 0; k < 2 * n; k++ )
+		max_diff = max( max_diff, fabs( mean_column[ k ] - mean_value[ k ] ) );
+
+	cout << "order violations: " << violations << ", largest difference of the means: " << max_diff << "\n";
+
+	return ( ( violations == 0 ) and ( max_diff < 0.1 ) ) ? 0 : 1;
+}
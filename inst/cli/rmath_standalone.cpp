@@ -0,0 +1,123 @@
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+//     Copyright (C) 2012 - 2022  Reza Mohammadi                                                   |
+//                                                                                                 |
+//     This file is part of BDgraph package.                                                       |
+//                                                                                                 |
+//     BDgraph is free software: you can redistribute it and/or modify it under                    |
+//     the terms of the GNU General Public License as published by the Free                        |
+//     Software Foundation; see <https://cran.r-project.org/web/licenses/GPL-3>.                   |
+//                                                                                                 |
+//     Maintainer: Reza Mohammadi <a.mohammadi@uva.nl>                                             |
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+//     Random numbers of the core samplers without R ( BDGRAPH_STANDALONE ): the generator     |
+//     of R is replaced by one stream of chain_rng, qnorm by algorithm AS 241, and pnorm by    |
+//     erfc.                                                                                   |
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+
+#include "chain_rng.h"
+
+static chain_rng &standalone_rng()
+{
+	static chain_rng rng( 5489ULL );
+	return rng;
+}
+
+// state of the generator for the checkpoint files: the text of the engine, one int per char
+static string rng_state_text()
+{
+	ostringstream out;
+	out << standalone_rng().engine;
+	return out.str();
+}
+
+extern "C" {
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// Quantile of the normal distribution by Wichura (1988), algorithm AS 241, as in R
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+double Rf_qnorm5( double p, double mu, double sigma, int lower_tail, int log_p )
+{
+	if( log_p )       p = exp( p );
+	if( !lower_tail ) p = 1.0 - p;
+
+	if( ( p <= 0.0 ) or ( p >= 1.0 ) )
+		return ( p <= 0.0 ) ? R_NegInf : R_PosInf;
+
+	double q = p - 0.5, r, value;
+
+	if( fabs( q ) <= 0.425 )
+	{
+		r = 0.180625 - q * q;
+		value = q * ( ( ( ( ( ( ( r * 2509.0809287301226727 + 33430.575583588128105 ) * r + 67265.770927008700853 ) * r
+		            + 45921.953931549871457 ) * r + 13731.693765509461125 ) * r + 1971.5909503065514427 ) * r
+		            + 133.14166789178437745 ) * r + 3.387132872796366608 )
+		        / ( ( ( ( ( ( ( r * 5226.495278852545925 + 28729.085735721942674 ) * r + 39307.89580009271061 ) * r
+		            + 21213.794301586595867 ) * r + 5394.1960214247511077 ) * r + 687.1870074920579083 ) * r
+		            + 42.313330701600911252 ) * r + 1.0 );
+		return mu + sigma * value;
+	}
+
+	r = ( q < 0.0 ) ? p : 1.0 - p;
+	r = sqrt( -log( r ) );
+
+	if( r <= 5.0 )
+	{
+		r -= 1.6;
+		value = ( ( ( ( ( ( ( r * 7.7454501427834140764e-4 + 0.0227238449892691845833 ) * r + 0.24178072517745061177 ) * r
+		            + 1.27045825245236838258 ) * r + 3.64784832476320460504 ) * r + 5.7694972214606914055 ) * r
+		            + 4.6303378461565452959 ) * r + 1.42343711074968357734 )
+		        / ( ( ( ( ( ( ( r * 1.05075007164441684324e-9 + 5.475938084995344946e-4 ) * r + 0.0151986665636164571966 ) * r
+		            + 0.14810397642748007459 ) * r + 0.68976733498510000455 ) * r + 1.6763848301838038494 ) * r
+		            + 2.05319162663775882187 ) * r + 1.0 );
+	}else{
+		r -= 5.0;
+		value = ( ( ( ( ( ( ( r * 2.01033439929228813265e-7 + 2.71155556874348757815e-5 ) * r + 0.0012426609473880784386 ) * r
+		            + 0.026532189526576123093 ) * r + 0.29656057182850489123 ) * r + 1.7848265399172913358 ) * r
+		            + 5.4637849111641143699 ) * r + 6.6579046435011037772 )
+		        / ( ( ( ( ( ( ( r * 2.04426310338993978564e-15 + 1.4215117583164458887e-7 ) * r + 1.8463183175100546818e-5 ) * r
+		            + 7.868691311456132591e-4 ) * r + 0.0148753612908506148525 ) * r + 0.13692988092273580531 ) * r
+		            + 0.59983220655588793769 ) * r + 1.0 );
+	}
+
+	if( q < 0.0 ) value = -value;
+	return mu + sigma * value;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// Distribution function of the normal distribution
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+double Rf_pnorm5( double x, double mu, double sigma, int lower_tail, int log_p )
+{
+	double z = ( x - mu ) / ( sigma * sqrt( 2.0 ) );
+	double p = 0.5 * erfc( lower_tail ? -z : z );
+
+	return log_p ? log( p ) : p;
+}
+
+double unif_rand( void ){ return standalone_rng().unif(); }
+
+double norm_rand( void ){ return standalone_rng().norm(); }
+
+double Rf_rgamma( double shape, double scale ){ return standalone_rng().gamma( shape, scale ); }
+
+double Rf_runif( double a, double b ){ return a + ( b - a ) * standalone_rng().unif(); }
+
+void set_seed_standalone( unsigned long long int seed ){ standalone_rng().engine.seed( seed ); }
+
+int rng_state_size_standalone( void ){ return static_cast<int>( rng_state_text().size() ); }
+
+void get_rng_state_standalone( int state[] )
+{
+	string text = rng_state_text();
+	for( size_t i = 0; i < text.size(); i++ ) state[ i ] = text[ i ];
+}
+
+void set_rng_state_standalone( const int state[], int size )
+{
+	string text( size, ' ' );
+	for( int i = 0; i < size; i++ ) text[ i ] = static_cast<char>( state[ i ] );
+
+	istringstream in( text );
+	in >> standalone_rng().engine;
+}
+
+} // End of exturn "C"
@@ -1,4 +1,6 @@
 #include <stdlib.h> // for NULL
+#include <string.h> // for strcmp, strcpy
+#include <Rinternals.h>
 #include <R_ext/Rdynload.h>
 
 /* FIXME: 
@@ -16,7 +18,7 @@ extern void dgm_bdmcmc_mpl_map(void *, void *, void *, void *, void *, void *, v
 extern void dgm_bdmcmc_mpl_map_multi_update(void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *);
 extern void dgm_rjmcmc_mpl_ma(void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *);
 extern void dgm_rjmcmc_mpl_map(void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *);
-extern void gcgm_bdmcmc_ma(void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *);
+extern void gcgm_bdmcmc_ma(void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *);
 extern void gcgm_bdmcmc_ma_multi_update(void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *);
 extern void gcgm_bdmcmc_map(void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *);
 extern void gcgm_bdmcmc_map_multi_update(void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *);
@@ -24,38 +26,47 @@ extern void gcgm_DMH_bdmcmc_ma(void *, void *, void *, void *, void *, void *, v
 extern void gcgm_DMH_bdmcmc_ma_multi_update(void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *);
 extern void gcgm_DMH_bdmcmc_map(void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *);
 extern void gcgm_DMH_bdmcmc_map_multi_update(void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *);
-extern void gcgm_DMH_rjmcmc_ma(void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *);
-extern void gcgm_DMH_rjmcmc_map(void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *);
+extern void gcgm_DMH_rjmcmc_ma(void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *);
+extern void gcgm_DMH_rjmcmc_map(void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *);
 extern void gcgm_dw_bdmcmc_ma(void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *);
 extern void gcgm_dw_bdmcmc_ma_multi_update(void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *);
 extern void gcgm_dw_bdmcmc_map(void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *);
 extern void gcgm_dw_bdmcmc_map_multi_update(void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *);
-extern void gcgm_rjmcmc_ma(void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *);
-extern void gcgm_rjmcmc_map(void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *);
+extern void gcgm_rjmcmc_ma(void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *);
+extern void gcgm_rjmcmc_map(void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *);
 extern void get_Ds_tgm(void *, void *, void *, void *, void *, void *, void *, void *);
 extern void get_Ts(void *, void *, void *, void *, void *);
-extern void ggm_bdmcmc_ma(void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *);
-extern void ggm_bdmcmc_ma_multi_update(void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *);
-extern void ggm_bdmcmc_map(void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *);
+extern void ggm_bdmcmc_ma(void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *);
+extern void ggm_bdmcmc_ma_chains(void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *);
+extern void ggm_bdmcmc_ma_pt(void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *);
+extern void ggm_bdmcmc_ma_multi_update(void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *);
+extern void ggm_bdmcmc_map(void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *);
 extern void ggm_bdmcmc_map_multi_update(void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *);
-extern void ggm_bdmcmc_mpl_ma(void *, void *, void *, void *, void *, void *, void *, void *, void *);
+extern void ggm_bdmcmc_mpl_ma(void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *);
+extern void ggm_bdmcmc_mpl_ma_pt(void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *);
 extern void ggm_bdmcmc_mpl_ma_multi_update(void *, void *, void *, void *, void *, void *, void *, void *, void *, void *);
 extern void ggm_bdmcmc_mpl_map(void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *);
 extern void ggm_bdmcmc_mpl_map_multi_update(void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *);
+extern void ggm_bdmcmc_sparse(void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *);
 extern void ggm_DMH_bdmcmc_ma(void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *);
 extern void ggm_DMH_bdmcmc_ma_multi_update(void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *);
 extern void ggm_DMH_bdmcmc_map(void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *);
 extern void ggm_DMH_bdmcmc_map_multi_update(void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *);
-extern void ggm_DMH_rjmcmc_ma(void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *);
-extern void ggm_DMH_rjmcmc_map(void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *);
-extern void ggm_rjmcmc_ma(void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *);
-extern void ggm_rjmcmc_map(void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *);
+extern void ggm_DMH_rjmcmc_ma(void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *);
+extern void ggm_DMH_rjmcmc_map(void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *);
+extern void ggm_rjmcmc_ma(void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *);
+extern void ggm_rjmcmc_map(void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *);
 extern void ggm_rjmcmc_mpl_ma(void *, void *, void *, void *, void *, void *, void *, void *, void *);
 extern void ggm_rjmcmc_mpl_map(void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *);
+extern void hill_climb_mpl_binary(void *, void *, void *, void *, void *, void *, void *, void *, void *, void *);
+extern void hill_climb_mpl_dis(void *, void *, void *, void *, void *, void *, void *, void *, void *, void *, void *);
+extern void hill_climb_mpl_ggm(void *, void *, void *, void *, void *, void *, void *);
 extern void log_exp_mc(void *, void *, void *, void *, void *, void *, void *, void *);
-extern void log_mpl_binary_parallel_hc(void *, void *, void *, void *, void *, void *, void *, void *, void *);
-extern void log_mpl_dis(void *, void *, void *, void *, void *, void *, void *, void *, void *, void *);
+extern void log_mpl_binary_parallel_hc(void *, void *, void *, void *, void *, void *, void *, void *);
+extern void log_mpl_dis_c(void *, void *, void *, void *, void *, void *, void *, void *, void *, void *);
 extern void omp_set_num_cores(void *, void *);
+extern void profile_get(void *, void *, void *, void *);
+extern void profile_start(void *, void *);
 extern void rgwish_c(void *, void *, void *, void *, void *, void *);
 extern void rwish_c(void *, void *, void *, void *);
 extern void scale_free(void *, void *);
@@ -65,6 +76,20 @@ extern void transfer_data(void *, void *, void *, void *, void *);
 extern void update_mu(void *, void *, void *, void *, void *);
 extern void update_tu(void *, void *, void *, void *, void *, void *, void *);
 
+/* .Call calls */
+extern SEXP call_C(SEXP, SEXP);
+extern SEXP data_stream_add(SEXP, SEXP, SEXP);
+extern SEXP data_stream_get(SEXP);
+extern SEXP data_stream_new(SEXP, SEXP);
+extern SEXP get_Z_R(SEXP, SEXP, SEXP, SEXP, SEXP, SEXP);
+extern SEXP ggm_session_add_data(SEXP, SEXP, SEXP);
+extern SEXP ggm_session_new(SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP);
+extern SEXP ggm_session_reset(SEXP);
+extern SEXP ggm_session_run(SEXP, SEXP, SEXP, SEXP);
+extern SEXP ggm_session_set_prior(SEXP, SEXP);
+extern SEXP ggm_session_summary(SEXP);
+extern SEXP mapped_matrix_open(SEXP, SEXP, SEXP, SEXP);
+
 static const R_CMethodDef CEntries[] = {
     {"dgm_bdmcmc_mpl_binary_ma",               (DL_FUNC) &dgm_bdmcmc_mpl_binary_ma,               12},
     {"dgm_bdmcmc_mpl_binary_ma_multi_update",  (DL_FUNC) &dgm_bdmcmc_mpl_binary_ma_multi_update,  13},
@@ -76,7 +101,7 @@ static const R_CMethodDef CEntries[] = {
     {"dgm_bdmcmc_mpl_map_multi_update",        (DL_FUNC) &dgm_bdmcmc_mpl_map_multi_update,        19},
     {"dgm_rjmcmc_mpl_ma",                      (DL_FUNC) &dgm_rjmcmc_mpl_ma,                      13},
     {"dgm_rjmcmc_mpl_map",                     (DL_FUNC) &dgm_rjmcmc_mpl_map,                     17},
-    {"gcgm_bdmcmc_ma",                         (DL_FUNC) &gcgm_bdmcmc_ma,                         20},
+    {"gcgm_bdmcmc_ma",                         (DL_FUNC) &gcgm_bdmcmc_ma,                         23},
     {"gcgm_bdmcmc_ma_multi_update",            (DL_FUNC) &gcgm_bdmcmc_ma_multi_update,            21},
     {"gcgm_bdmcmc_map",                        (DL_FUNC) &gcgm_bdmcmc_map,                        24},
     {"gcgm_bdmcmc_map_multi_update",           (DL_FUNC) &gcgm_bdmcmc_map_multi_update,           26},
@@ -84,38 +109,47 @@ static const R_CMethodDef CEntries[] = {
     {"gcgm_DMH_bdmcmc_ma_multi_update",        (DL_FUNC) &gcgm_DMH_bdmcmc_ma_multi_update,        22},
     {"gcgm_DMH_bdmcmc_map",                    (DL_FUNC) &gcgm_DMH_bdmcmc_map,                    25},
     {"gcgm_DMH_bdmcmc_map_multi_update",       (DL_FUNC) &gcgm_DMH_bdmcmc_map_multi_update,       27},
-    {"gcgm_DMH_rjmcmc_ma",                     (DL_FUNC) &gcgm_DMH_rjmcmc_ma,                     21},
-    {"gcgm_DMH_rjmcmc_map",                    (DL_FUNC) &gcgm_DMH_rjmcmc_map,                    25},
+    {"gcgm_DMH_rjmcmc_ma",                     (DL_FUNC) &gcgm_DMH_rjmcmc_ma,                     22},
+    {"gcgm_DMH_rjmcmc_map",                    (DL_FUNC) &gcgm_DMH_rjmcmc_map,                    26},
     {"gcgm_dw_bdmcmc_ma",                      (DL_FUNC) &gcgm_dw_bdmcmc_ma,                      21},
     {"gcgm_dw_bdmcmc_ma_multi_update",         (DL_FUNC) &gcgm_dw_bdmcmc_ma_multi_update,         22},
     {"gcgm_dw_bdmcmc_map",                     (DL_FUNC) &gcgm_dw_bdmcmc_map,                     25},
     {"gcgm_dw_bdmcmc_map_multi_update",        (DL_FUNC) &gcgm_dw_bdmcmc_map_multi_update,        27},
-    {"gcgm_rjmcmc_ma",                         (DL_FUNC) &gcgm_rjmcmc_ma,                         20},
-    {"gcgm_rjmcmc_map",                        (DL_FUNC) &gcgm_rjmcmc_map,                        24},
+    {"gcgm_rjmcmc_ma",                         (DL_FUNC) &gcgm_rjmcmc_ma,                         21},
+    {"gcgm_rjmcmc_map",                        (DL_FUNC) &gcgm_rjmcmc_map,                        25},
     {"get_Ds_tgm",                             (DL_FUNC) &get_Ds_tgm,                              8},
     {"get_Ts",                                 (DL_FUNC) &get_Ts,                                  5},
-    {"ggm_bdmcmc_ma",                          (DL_FUNC) &ggm_bdmcmc_ma,                          14},
-    {"ggm_bdmcmc_ma_multi_update",             (DL_FUNC) &ggm_bdmcmc_ma_multi_update,             15},
-    {"ggm_bdmcmc_map",                         (DL_FUNC) &ggm_bdmcmc_map,                         18},
+    {"ggm_bdmcmc_ma",                          (DL_FUNC) &ggm_bdmcmc_ma,                          22},
+    {"ggm_bdmcmc_ma_chains",                   (DL_FUNC) &ggm_bdmcmc_ma_chains,                   24},
+    {"ggm_bdmcmc_ma_multi_update",             (DL_FUNC) &ggm_bdmcmc_ma_multi_update,             23},
+    {"ggm_bdmcmc_ma_pt",                       (DL_FUNC) &ggm_bdmcmc_ma_pt,                       18},
+    {"ggm_bdmcmc_map",                         (DL_FUNC) &ggm_bdmcmc_map,                         21},
     {"ggm_bdmcmc_map_multi_update",            (DL_FUNC) &ggm_bdmcmc_map_multi_update,            20},
-    {"ggm_bdmcmc_mpl_ma",                      (DL_FUNC) &ggm_bdmcmc_mpl_ma,                       9},
+    {"ggm_bdmcmc_mpl_ma",                      (DL_FUNC) &ggm_bdmcmc_mpl_ma,                       12},
+    {"ggm_bdmcmc_mpl_ma_pt",                   (DL_FUNC) &ggm_bdmcmc_mpl_ma_pt,                    13},
     {"ggm_bdmcmc_mpl_ma_multi_update",         (DL_FUNC) &ggm_bdmcmc_mpl_ma_multi_update,         10},
     {"ggm_bdmcmc_mpl_map",                     (DL_FUNC) &ggm_bdmcmc_mpl_map,                     13},
     {"ggm_bdmcmc_mpl_map_multi_update",        (DL_FUNC) &ggm_bdmcmc_mpl_map_multi_update,        15},
+    {"ggm_bdmcmc_sparse",                      (DL_FUNC) &ggm_bdmcmc_sparse,                      12},
     {"ggm_DMH_bdmcmc_ma",                      (DL_FUNC) &ggm_DMH_bdmcmc_ma,                      16},
     {"ggm_DMH_bdmcmc_ma_multi_update",         (DL_FUNC) &ggm_DMH_bdmcmc_ma_multi_update,         17},
     {"ggm_DMH_bdmcmc_map",                     (DL_FUNC) &ggm_DMH_bdmcmc_map,                     20},
     {"ggm_DMH_bdmcmc_map_multi_update",        (DL_FUNC) &ggm_DMH_bdmcmc_map_multi_update,        22},
-    {"ggm_DMH_rjmcmc_ma",                      (DL_FUNC) &ggm_DMH_rjmcmc_ma,                      16},
-    {"ggm_DMH_rjmcmc_map",                     (DL_FUNC) &ggm_DMH_rjmcmc_map,                     20},
-    {"ggm_rjmcmc_ma",                          (DL_FUNC) &ggm_rjmcmc_ma,                          14},
-    {"ggm_rjmcmc_map",                         (DL_FUNC) &ggm_rjmcmc_map,                         18},
+    {"ggm_DMH_rjmcmc_ma",                      (DL_FUNC) &ggm_DMH_rjmcmc_ma,                      17},
+    {"ggm_DMH_rjmcmc_map",                     (DL_FUNC) &ggm_DMH_rjmcmc_map,                     21},
+    {"ggm_rjmcmc_ma",                          (DL_FUNC) &ggm_rjmcmc_ma,                          15},
+    {"ggm_rjmcmc_map",                         (DL_FUNC) &ggm_rjmcmc_map,                         19},
     {"ggm_rjmcmc_mpl_ma",                      (DL_FUNC) &ggm_rjmcmc_mpl_ma,                       9},
     {"ggm_rjmcmc_mpl_map",                     (DL_FUNC) &ggm_rjmcmc_mpl_map,                     13},
+    {"hill_climb_mpl_binary",                  (DL_FUNC) &hill_climb_mpl_binary,                  10},
+    {"hill_climb_mpl_dis",                     (DL_FUNC) &hill_climb_mpl_dis,                     11},
+    {"hill_climb_mpl_ggm",                     (DL_FUNC) &hill_climb_mpl_ggm,                      7},
     {"log_exp_mc",                             (DL_FUNC) &log_exp_mc,                              8},
-    {"log_mpl_binary_parallel_hc",             (DL_FUNC) &log_mpl_binary_parallel_hc,              9},
-    {"log_mpl_dis",                            (DL_FUNC) &log_mpl_dis,                            10},
+    {"log_mpl_binary_parallel_hc",             (DL_FUNC) &log_mpl_binary_parallel_hc,              8},
+    {"log_mpl_dis_c",                          (DL_FUNC) &log_mpl_dis_c,                          10},
     {"omp_set_num_cores",                      (DL_FUNC) &omp_set_num_cores,                       2},
+    {"profile_get",                            (DL_FUNC) &profile_get,                             4},
+    {"profile_start",                          (DL_FUNC) &profile_start,                           2},
     {"rgwish_c",                               (DL_FUNC) &rgwish_c,                                6},
     {"rwish_c",                                (DL_FUNC) &rwish_c,                                 4},
     {"scale_free",                             (DL_FUNC) &scale_free,                              2},
@@ -127,8 +161,283 @@ static const R_CMethodDef CEntries[] = {
     {NULL, NULL, 0}
 };
 
+/* .Call interface of the .C routines: the routine works on the R vectors in place. 
+   The unnamed arguments are inputs, so they are not copied. The named arguments are 
+   the outputs, which are returned in a named list: an output given by 'out_C' in R 
+   ( list( value, length ) ) is allocated here once, with all elements equal to 
+   'value'; any other output is an input too, so it is copied once. */
+
+/* the routines of 'call_C' and their numbers of arguments */
+#define CALL_C_ROUTINES \
+    CALL_C(dgm_bdmcmc_mpl_binary_ma,               12) \
+    CALL_C(dgm_bdmcmc_mpl_binary_ma_multi_update,  13) \
+    CALL_C(dgm_bdmcmc_mpl_binary_map,              16) \
+    CALL_C(dgm_bdmcmc_mpl_binary_map_multi_update, 18) \
+    CALL_C(dgm_bdmcmc_mpl_ma,                      13) \
+    CALL_C(dgm_bdmcmc_mpl_ma_multi_update,         14) \
+    CALL_C(dgm_bdmcmc_mpl_map,                     17) \
+    CALL_C(dgm_bdmcmc_mpl_map_multi_update,        19) \
+    CALL_C(dgm_rjmcmc_mpl_ma,                      13) \
+    CALL_C(dgm_rjmcmc_mpl_map,                     17) \
+    CALL_C(gcgm_DMH_bdmcmc_ma,                     21) \
+    CALL_C(gcgm_DMH_bdmcmc_ma_multi_update,        22) \
+    CALL_C(gcgm_DMH_bdmcmc_map,                    25) \
+    CALL_C(gcgm_DMH_bdmcmc_map_multi_update,       27) \
+    CALL_C(gcgm_DMH_rjmcmc_ma,                     22) \
+    CALL_C(gcgm_DMH_rjmcmc_map,                    26) \
+    CALL_C(gcgm_bdmcmc_ma,                         23) \
+    CALL_C(gcgm_bdmcmc_ma_multi_update,            21) \
+    CALL_C(gcgm_bdmcmc_map,                        24) \
+    CALL_C(gcgm_bdmcmc_map_multi_update,           26) \
+    CALL_C(gcgm_dw_bdmcmc_ma,                      21) \
+    CALL_C(gcgm_dw_bdmcmc_ma_multi_update,         22) \
+    CALL_C(gcgm_dw_bdmcmc_map,                     25) \
+    CALL_C(gcgm_dw_bdmcmc_map_multi_update,        27) \
+    CALL_C(gcgm_rjmcmc_ma,                         21) \
+    CALL_C(gcgm_rjmcmc_map,                        25) \
+    CALL_C(get_Ds_tgm,                              8) \
+    CALL_C(ggm_DMH_bdmcmc_ma,                      16) \
+    CALL_C(ggm_DMH_bdmcmc_ma_multi_update,         17) \
+    CALL_C(ggm_DMH_bdmcmc_map,                     20) \
+    CALL_C(ggm_DMH_bdmcmc_map_multi_update,        22) \
+    CALL_C(ggm_DMH_rjmcmc_ma,                      17) \
+    CALL_C(ggm_DMH_rjmcmc_map,                     21) \
+    CALL_C(ggm_bdmcmc_ma,                          22) \
+    CALL_C(ggm_bdmcmc_ma_chains,                   24) \
+    CALL_C(ggm_bdmcmc_ma_multi_update,             23) \
+    CALL_C(ggm_bdmcmc_ma_pt,                       18) \
+    CALL_C(ggm_bdmcmc_map,                         21) \
+    CALL_C(ggm_bdmcmc_map_multi_update,            20) \
+    CALL_C(ggm_bdmcmc_mpl_ma,                      12) \
+    CALL_C(ggm_bdmcmc_mpl_ma_multi_update,         10) \
+    CALL_C(ggm_bdmcmc_mpl_ma_pt,                   13) \
+    CALL_C(ggm_bdmcmc_mpl_map,                     13) \
+    CALL_C(ggm_bdmcmc_mpl_map_multi_update,        15) \
+    CALL_C(ggm_bdmcmc_sparse,                      12) \
+    CALL_C(ggm_rjmcmc_ma,                          15) \
+    CALL_C(ggm_rjmcmc_map,                         19) \
+    CALL_C(ggm_rjmcmc_mpl_ma,                       9) \
+    CALL_C(ggm_rjmcmc_mpl_map,                     13) \
+    CALL_C(tgm_bdmcmc_ma,                          18) \
+    CALL_C(tgm_bdmcmc_map,                         24) \
+    CALL_C(update_mu,                               5)
+
+/* the typed calls of the routines with the arguments a[ 0 ], ..., a[ n - 1 ] */
+#define ARGS_1  a[0]
+#define ARGS_2  ARGS_1, a[1]
+#define ARGS_3  ARGS_2, a[2]
+#define ARGS_4  ARGS_3, a[3]
+#define ARGS_5  ARGS_4, a[4]
+#define ARGS_6  ARGS_5, a[5]
+#define ARGS_7  ARGS_6, a[6]
+#define ARGS_8  ARGS_7, a[7]
+#define ARGS_9  ARGS_8, a[8]
+#define ARGS_10 ARGS_9, a[9]
+#define ARGS_11 ARGS_10, a[10]
+#define ARGS_12 ARGS_11, a[11]
+#define ARGS_13 ARGS_12, a[12]
+#define ARGS_14 ARGS_13, a[13]
+#define ARGS_15 ARGS_14, a[14]
+#define ARGS_16 ARGS_15, a[15]
+#define ARGS_17 ARGS_16, a[16]
+#define ARGS_18 ARGS_17, a[17]
+#define ARGS_19 ARGS_18, a[18]
+#define ARGS_20 ARGS_19, a[19]
+#define ARGS_21 ARGS_20, a[20]
+#define ARGS_22 ARGS_21, a[21]
+#define ARGS_23 ARGS_22, a[22]
+#define ARGS_24 ARGS_23, a[23]
+#define ARGS_25 ARGS_24, a[24]
+#define ARGS_26 ARGS_25, a[25]
+#define ARGS_27 ARGS_26, a[26]
+#define ARGS_28 ARGS_27, a[27]
+#define ARGS_29 ARGS_28, a[28]
+#define ARGS_30 ARGS_29, a[29]
+
+#define CALL_C(f, n) static void call_##f(void **a) { f(ARGS_##n); }
+CALL_C_ROUTINES
+#undef CALL_C
+
+typedef struct { const char *name; void (*call)(void **); int numArgs; } call_C_def;
+
+#define CALL_C(f, n) {#f, &call_##f, n},
+static const call_C_def CallCRoutines[] = {
+    CALL_C_ROUTINES
+    {NULL, NULL, 0}
+};
+#undef CALL_C
+
+/* n_x copies of the strings ( recycled ), which the routine may change, in one block; as in .C */
+static char **strings_C(SEXP value, int n_x)
+{
+    int width = 0, k;
+    for (k = 0; k < n_x; k++)
+    {
+        int n_char = (int) strlen(CHAR(STRING_ELT(value, k % LENGTH(value))));
+        if (n_char > width) width = n_char;
+    }
+
+    char **strings = (char **) R_alloc(n_x, sizeof(char *));
+    char *block    = R_alloc((size_t) n_x * (width + 1), sizeof(char));
+    for (k = 0; k < n_x; k++)
+    {
+        strings[k] = block + (size_t) k * (width + 1);
+        strcpy(strings[k], CHAR(STRING_ELT(value, k % LENGTH(value))));
+    }
+
+    return strings;
+}
+
+SEXP call_C(SEXP name, SEXP args)
+{
+    const char *name_C = CHAR(STRING_ELT(name, 0));
+    void (*call)(void **) = NULL;
+    int n_args = LENGTH(args), i, j;
+
+    for (i = 0; CallCRoutines[i].name != NULL; i++)
+        if (strcmp(CallCRoutines[i].name, name_C) == 0)
+        {
+            if (CallCRoutines[i].numArgs != n_args)
+                error("'%s' needs %d arguments, not %d", name_C, CallCRoutines[i].numArgs, n_args);
+            call = CallCRoutines[i].call;
+            break;
+        }
+    if (call == NULL) error("'%s' is not a routine of BDgraph for 'call_C'", name_C);
+
+    SEXP names = getAttrib(args, R_NamesSymbol);
+    int n_out  = 0;
+    for (i = 0; i < n_args; i++)
+        if ((names != R_NilValue) && (CHAR(STRING_ELT(names, i))[0] != '\0')) n_out++;
+
+    SEXP out       = PROTECT(allocVector(VECSXP, n_out));
+    SEXP out_names = PROTECT(allocVector(STRSXP, n_out));
+    void **a         = (void **) R_alloc(n_args, sizeof(void *));
+    char ***strings  = (char ***) R_alloc(n_args, sizeof(char **));
+    int *n_strings   = (int *) R_alloc(n_args, sizeof(int));
+
+    for (i = 0, j = 0; i < n_args; i++)
+    {
+        SEXP x    = VECTOR_ELT(args, i);
+        int named = (names != R_NilValue) && (CHAR(STRING_ELT(names, i))[0] != '\0');
+        strings[i] = NULL;
+
+        if (TYPEOF(x) == VECSXP)
+        {
+            /* output of 'out_C': allocated once, with all elements equal to 'value' */
+            if (!named || (LENGTH(x) != 2) || (LENGTH(VECTOR_ELT(x, 0)) != 1))
+                error("argument %d of '%s' is not a valid output of 'out_C'", i + 1, name_C);
+
+            SEXP value = VECTOR_ELT(x, 0);
+            int n_x    = asInteger(VECTOR_ELT(x, 1)), k;
+            if (n_x < 0) n_x = 0;
+
+            SET_STRING_ELT(out_names, j, STRING_ELT(names, i));
+            switch (TYPEOF(value))
+            {
+                case INTSXP:
+                case LGLSXP:
+                {
+                    SEXP y = allocVector(TYPEOF(value), n_x);
+                    SET_VECTOR_ELT(out, j, y);
+                    int v = INTEGER(value)[0], *y_C = INTEGER(y);
+                    for (k = 0; k < n_x; k++) y_C[k] = v;
+                    a[i] = y_C;
+                    break;
+                }
+                case REALSXP:
+                {
+                    SEXP y = allocVector(REALSXP, n_x);
+                    SET_VECTOR_ELT(out, j, y);
+                    double v = REAL(value)[0], *y_C = REAL(y);
+                    for (k = 0; k < n_x; k++) y_C[k] = v;
+                    a[i] = y_C;
+                    break;
+                }
+                case STRSXP:
+                    /* the R strings are made once, after the call */
+                    strings[i]   = strings_C(value, n_x);
+                    n_strings[i] = n_x;
+                    a[i]         = strings[i];
+                    break;
+                default:
+                    error("argument %d of '%s' must be integer, logical, double or character", i + 1, name_C);
+            }
+            j++;
+            continue;
+        }
+
+        if (named)
+        {
+            SET_STRING_ELT(out_names, j, STRING_ELT(names, i));
+            if (TYPEOF(x) != STRSXP)
+            {
+                x = duplicate(x);
+                SET_VECTOR_ELT(out, j, x);
+            }
+            j++;
+        }
+
+        switch (TYPEOF(x))
+        {
+            case INTSXP:  a[i] = INTEGER(x); break;
+            case LGLSXP:  a[i] = LOGICAL(x); break;
+            case REALSXP: a[i] = REAL(x);    break;
+            /* memory-mapped data ( 'bdgraph.mmap' ): the address of the mapping */
+            case EXTPTRSXP:
+                a[i] = R_ExternalPtrAddr(x);
+                if (a[i] == NULL) error("argument %d of '%s' is not valid mapped data", i + 1, name_C);
+                break;
+            case STRSXP:
+                strings[i]   = strings_C(x, LENGTH(x));
+                n_strings[i] = LENGTH(x);
+                a[i]         = strings[i];
+                break;
+            default:
+                error("argument %d of '%s' must be integer, logical, double, character or mapped data", i + 1, name_C);
+        }
+    }
+
+    call(a);
+
+    /* the outputs which are strings */
+    for (i = 0, j = 0; i < n_args; i++)
+    {
+        if ((names == R_NilValue) || (CHAR(STRING_ELT(names, i))[0] == '\0')) continue;
+
+        if (strings[i] != NULL)
+        {
+            int k;
+            SEXP x = PROTECT(allocVector(STRSXP, n_strings[i]));
+            for (k = 0; k < n_strings[i]; k++) SET_STRING_ELT(x, k, mkChar(strings[i][k]));
+            SET_VECTOR_ELT(out, j, x);
+            UNPROTECT(1);
+        }
+        j++;
+    }
+
+    setAttrib(out, R_NamesSymbol, out_names);
+    UNPROTECT(2);
+    return out;
+}
+
+static const R_CallMethodDef CallEntries[] = {
+    {"call_C",                                 (DL_FUNC) &call_C,                                  2},
+    {"data_stream_add",                        (DL_FUNC) &data_stream_add,                         3},
+    {"data_stream_get",                        (DL_FUNC) &data_stream_get,                         1},
+    {"data_stream_new",                        (DL_FUNC) &data_stream_new,                         2},
+    {"get_Z_R",                                (DL_FUNC) &get_Z_R,                                 6},
+    {"ggm_session_add_data",                   (DL_FUNC) &ggm_session_add_data,                    3},
+    {"ggm_session_new",                        (DL_FUNC) &ggm_session_new,                         9},
+    {"ggm_session_reset",                      (DL_FUNC) &ggm_session_reset,                       1},
+    {"ggm_session_run",                        (DL_FUNC) &ggm_session_run,                         4},
+    {"ggm_session_set_prior",                  (DL_FUNC) &ggm_session_set_prior,                   2},
+    {"ggm_session_summary",                    (DL_FUNC) &ggm_session_summary,                     1},
+    {"mapped_matrix_open",                     (DL_FUNC) &mapped_matrix_open,                      4},
+    {NULL, NULL, 0}
+};
+
 void R_init_BDgraph(DllInfo *dll)
 {
-    R_registerRoutines(dll, CEntries, NULL, NULL, NULL);
+    R_registerRoutines(dll, CEntries, CallEntries, NULL, NULL);
     R_useDynamicSymbols(dll, FALSE);
 }
@@ -0,0 +1,83 @@
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+//     Copyright (C) 2012 - 2022  Reza Mohammadi                                                   |
+//                                                                                                 |
+//     This file is part of BDgraph package.                                                       |
+//                                                                                                 |
+//     BDgraph is free software: you can redistribute it and/or modify it under                    |
+//     the terms of the GNU General Public License as published by the Free                        |
+//     Software Foundation; see <https://cran.r-project.org/web/licenses/GPL-3>.                   |
+//                                                                                                 |
+//     Maintainer: Reza Mohammadi <a.mohammadi@uva.nl>                                             |
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+
+#ifndef batch_means_H
+#define batch_means_H
+
+#include "util.h"
+
+// Online batch means of the posterior probabilities of the links ( p_links ) in the
+// birth-death MCMC: the saved iterations are split into batches of 'size' iterations
+// and the Monte Carlo standard error ( MCSE ) of p_links is from the spread of the
+// batch estimates, weighted by the waiting times as for a ratio estimator. It needs
+// only sums over the batches, so the memory is O( p^2 ) for any number of batches.
+struct batch_means
+{
+	int size, pxp, counter, n_batches;
+	double weight, sum_weight, sum_weight2;
+	vector<double> x, sum_x, sum_x2, sum_wx;
+
+	batch_means( int batch_size, int p_x_p ) : size( batch_size ), pxp( p_x_p ), counter( 0 ), n_batches( 0 ),
+		weight( 0.0 ), sum_weight( 0.0 ), sum_weight2( 0.0 ), x( p_x_p, 0.0 ), sum_x( p_x_p, 0.0 ), sum_x2( p_x_p, 0.0 ), sum_wx( p_x_p, 0.0 ) {}
+
+	// adds one saved iteration; returns true at the end of a batch
+	bool add( int G[], double weight_C )
+	{
+		for( int i = 0; i < pxp; i++ )
+			if( G[ i ] ) x[ i ] += weight_C;
+
+		weight += weight_C;
+		if( ++counter < size ) return false;
+
+		for( int i = 0; i < pxp; i++ )
+		{
+			sum_x[ i ]  += x[ i ];
+			sum_x2[ i ] += x[ i ] * x[ i ];
+			sum_wx[ i ] += weight * x[ i ];
+			x[ i ]       = 0.0;
+		}
+
+		sum_weight  += weight;
+		sum_weight2 += weight * weight;
+		weight       = 0.0;
+		counter      = 0;
+		++n_batches;
+
+		return true;
+	}
+
+	// sum_b ( x_b - p * w_b )^2 / ( sum_b w_b )^2 * B / ( B - 1 ), with p = sum_b x_b / sum_b w_b
+	double mcse( int i )
+	{
+		if( n_batches < 2 ) return R_PosInf;
+
+		double p_hat = sum_x[ i ] / sum_weight;
+		double var   = sum_x2[ i ] - 2.0 * p_hat * sum_wx[ i ] + p_hat * p_hat * sum_weight2;
+		var = ( var > 0.0 ) ? var * n_batches / ( n_batches - 1.0 ) / ( sum_weight * sum_weight ) : 0.0;
+
+		return sqrt( var );
+	}
+
+	double max_mcse()
+	{
+		double max_mcse_C = 0.0;
+		for( int i = 0; i < pxp; i++ )
+		{
+			double mcse_i = mcse( i );
+			if( mcse_i > max_mcse_C ) max_mcse_C = mcse_i;
+		}
+
+		return max_mcse_C;
+	}
+};
+
+#endif
@@ -0,0 +1,566 @@
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+//     Copyright (C) 2012 - 2022  Reza Mohammadi                                                   |
+//                                                                                                 |
+//     This file is part of BDgraph package.                                                       |
+//                                                                                                 |
+//     BDgraph is free software: you can redistribute it and/or modify it under                    |
+//     the terms of the GNU General Public License as published by the Free                        |
+//     Software Foundation; see <https://cran.r-project.org/web/licenses/GPL-3>.                   |
+//                                                                                                 |
+//     Maintainer: Reza Mohammadi <a.mohammadi@uva.nl>                                             |
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+
+#ifndef bdmcmc_H
+#define bdmcmc_H
+
+#include "matrix.h"
+#include "rgwish.h"
+#include "copula.h"
+#include "batch_means.h"
+#include "run_budget.h"
+#include "checkpoint.h"
+#include <unordered_map>     // index of the sampled graphs for the MAP estimation
+
+// Main loop of the birth-death MCMC samplers with the G-Wishart prior ( ggm, gcgm, gcgm_dw,
+// tgm, and their DMH versions ), as one template with four policies:
+//
+//     Likelihood  birth/death rates and the sample of K for the new graph:
+//                 gwish_likelihood, dmh_likelihood ( double Metropolis-Hastings )
+//     Latent      latent data, which give Ds and Ts in each iteration:
+//                 no_latent, copula_latent, copula_dw_latent, tgm_latent
+//     Move        edges which are changed in one step:
+//                 single_edge_move, multi_edge_move
+//     Output      what is saved after burn-in:
+//                 ma_output ( Bayesian model averaging ), map_output ( graphs for MAP )
+//
+// The policies are plain structs, so each sampler ( e.g. gcgm_bdmcmc_map_multi_update ) is
+// one instance of bdmcmc_sampler with no virtual calls, and a change in the loop is in all
+// of the samplers. The run options ( time budget, checkpoint, MCSE stop ) are in bdmcmc_run;
+// a sampler without them has the defaults, for which they are off.
+//
+// Not yet ported, with their own loops: the reversible jump samplers ( gm_rj.cpp ), the
+// marginal pseudo-likelihood samplers ( ggm_mpl_bd.cpp, gm_mpl_bd_dis.cpp ), the sparse
+// sampler ( ggm_sparse_bd.cpp ), and parallel tempering ( ggm_pt_bd.cpp ).
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// iter and burnin, and the options of the run
+struct bdmcmc_run
+{
+	int *iter, *burnin, *iter_used, iter_used_C, print;
+	double time_budget, *timing;
+	const char *name, *checkpoint_file;
+	int checkpoint_every, resume;
+
+	bdmcmc_run( const char *sampler, int *iter_C, int *burnin_C, int *print_C ) : iter( iter_C ), burnin( burnin_C ),
+		iter_used( &iter_used_C ), iter_used_C( 0 ), print( *print_C ), time_budget( 0.0 ), timing( NULL ),
+		name( sampler ), checkpoint_file( NULL ), checkpoint_every( 0 ), resume( 0 ) {}
+};
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// state of the chain: graph G, K and its inverse sigma, and the edges which can change, which
+// are the ones with 0 < g_prior < 1
+struct bdmcmc_state
+{
+	int dim, pxp, qp, sub_qp;
+	int *G, *b, *b_star;
+	double *K, *Ts, *Ds, *threshold, sum_rates;
+
+	vector<double> sigma, rates, log_ratio_g_prior;
+	vector<int> size_node, index_row, index_col;
+
+	// - - allocation for rgwish_sigma
+	vector<double> sigma_start, inv_C, beta_star, sigma_i;
+	vector<double> sigma_start_N_i;          // For dynamic memory used
+	vector<double> sigma_N_i;                // For dynamic memory used
+	vector<int> N_i;                         // For dynamic memory used
+
+	bdmcmc_state( int G_C[], double g_prior[], double Ts_C[], double K_C[], double Ds_C[], int *p, double *threshold_C, int *b_C, int *b_star_C ) :
+		dim( *p ), pxp( *p * *p ), qp( *p * ( *p - 1 ) / 2 ), sub_qp( 0 ), G( G_C ), b( b_C ), b_star( b_star_C ),
+		K( K_C ), Ts( Ts_C ), Ds( Ds_C ), threshold( threshold_C ), sum_rates( 0.0 ),
+		sigma( pxp ), log_ratio_g_prior( pxp ), size_node( dim, 0 ), index_row( qp ), index_col( qp ),
+		sigma_start( pxp ), inv_C( pxp ), beta_star( dim ), sigma_i( dim ), sigma_start_N_i( dim ), sigma_N_i( pxp ), N_i( dim )
+	{
+		vector<double> copyK( K, K + pxp );
+		inverse( &copyK[0], &sigma[0], &dim );
+
+		// Counting size of notes
+		for( int i = 0; i < dim; i++ )
+			for( int j = 0; j < dim; j++ ) size_node[ i ] += G[ i * dim + j ];
+
+		// For finding the index of rates
+		for( int j = 1; j < dim; j++ )
+			for( int i = 0; i < j; i++ )
+			{
+				int ij = j * dim + i;
+
+				if( ( g_prior[ ij ] != 0.0 ) and ( g_prior[ ij ] != 1.0 ) )
+				{
+					index_row[ sub_qp ] = i;
+					index_col[ sub_qp ] = j;
+					sub_qp++;
+				}
+
+				log_ratio_g_prior[ ij ] = log( static_cast<double>( g_prior[ ij ] / ( 1 - g_prior[ ij ] ) ) );
+			}
+		rates.resize( sub_qp );
+	}
+
+	void add( checkpoint &ckpt )
+	{
+		ckpt.add( G, pxp );
+		ckpt.add( K, pxp );
+		ckpt.add( &sigma[0], pxp );
+		ckpt.add( &size_node[0], dim );
+	}
+
+	// Updating G (graph) based on selected edge
+	void flip_edge( int index_selected_edge )
+	{
+		int selected_edge_i  = index_row[ index_selected_edge ];
+		int selected_edge_j  = index_col[ index_selected_edge ];
+		int selected_edge_ij = selected_edge_j * dim + selected_edge_i;
+
+		G[ selected_edge_ij ] = 1 - G[ selected_edge_ij ];
+		G[ selected_edge_i * dim + selected_edge_j ] = G[ selected_edge_ij ];
+
+		if( G[ selected_edge_ij ] )
+		{
+			++size_node[ selected_edge_i ];
+			++size_node[ selected_edge_j ];
+		}else{
+			--size_node[ selected_edge_i ];
+			--size_node[ selected_edge_j ];
+		}
+	}
+};
+
+// - - - Likelihood policies - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// G-Wishart posterior with Ds = D + S
+struct gwish_likelihood
+{
+	vector<double> Dsijj;
+
+	gwish_likelihood( bdmcmc_state &s ) : Dsijj( s.pxp ) {}
+
+	void start( bdmcmc_state & ) {}
+
+	// for calculating the birth/death rates, for new Ds
+	void data( bdmcmc_state &s )
+	{
+		for( int j = 1; j < s.dim; j++ )
+			for( int i = 0; i < j; i++ )
+			{
+				int ij      = j * s.dim + i;
+				double Dsij = s.Ds[ ij ];
+				Dsijj[ ij ] = Dsij * Dsij / s.Ds[ j * s.dim + j ];
+			}
+	}
+
+	void rates( bdmcmc_state &s )
+	{
+		rates_bdmcmc_parallel( &s.rates[0], &s.log_ratio_g_prior[0], s.G, &s.index_row[0], &s.index_col[0], &s.sub_qp, s.Ds, &Dsijj[0], &s.sigma[0], s.K, s.b, &s.dim );
+	}
+
+	// Sampling from G-Wishart for new graph
+	void sample_K( bdmcmc_state &s, int )
+	{
+		rgwish_sigma( s.G, &s.size_node[0], s.Ts, s.K, &s.sigma[0], s.b_star, &s.dim, s.threshold, &s.sigma_start[0], &s.inv_C[0], &s.beta_star[0], &s.sigma_i[0], s.sigma_start_N_i, s.sigma_N_i, s.N_i );
+	}
+};
+
+// Double Metropolis-Hastings: the rates need K_dmh from the prior G-Wishart( b, Ti ), which
+// is sampled for the new graph in parallel with K ( rgwish_sigma_dmh )
+struct dmh_likelihood
+{
+	double *Ti, *D;
+	int b1;
+	vector<double> sigma_dmh, K_dmh;
+	// - -  for rgwish_sigma of K_dmh, in parallel with K
+	vector<double> sigma_start_dmh, inv_C_dmh, beta_star_dmh, sigma_i_dmh, sigma_start_N_i_dmh, sigma_N_i_dmh;
+	vector<int> N_i_dmh;
+
+	dmh_likelihood( bdmcmc_state &s, double Ti_C[], double D_C[] ) : Ti( Ti_C ), D( D_C ), b1( *s.b ),
+		sigma_dmh( s.pxp ), K_dmh( s.pxp ), sigma_start_dmh( s.pxp ), inv_C_dmh( s.pxp ), beta_star_dmh( s.dim ),
+		sigma_i_dmh( s.dim ), sigma_start_N_i_dmh( s.dim ), sigma_N_i_dmh( s.pxp ), N_i_dmh( s.dim ) {}
+
+	// sampling from K and sigma for double Metropolis-Hastings, for the first step
+	void start( bdmcmc_state &s )
+	{
+		rgwish_sigma( s.G, &s.size_node[0], Ti, &K_dmh[0], &sigma_dmh[0], &b1, &s.dim, s.threshold, &s.sigma_start[0], &s.inv_C[0], &s.beta_star[0], &s.sigma_i[0], s.sigma_start_N_i, s.sigma_N_i, s.N_i );
+	}
+
+	void data( bdmcmc_state & ) {}
+
+	void rates( bdmcmc_state &s )
+	{
+		rates_bdmcmc_dmh_parallel( &s.rates[0], &s.log_ratio_g_prior[0], s.G, &s.index_row[0], &s.index_col[0], &s.sub_qp, s.Ds, D, &s.sigma[0], s.K, &sigma_dmh[0], &K_dmh[0], &s.dim );
+	}
+
+	// K for the new graph, and K_dmh for the next step
+	void sample_K( bdmcmc_state &s, int next_dmh )
+	{
+		rgwish_sigma_dmh( s.G, &s.size_node[0], s.Ts, s.K, &s.sigma[0], s.b_star, Ti, &K_dmh[0], &sigma_dmh[0], &b1, &next_dmh, &s.dim, s.threshold,
+		                  &s.sigma_start[0], &s.inv_C[0], &s.beta_star[0], &s.sigma_i[0], s.sigma_start_N_i, s.sigma_N_i, s.N_i,
+		                  &sigma_start_dmh[0], &inv_C_dmh[0], &beta_star_dmh[0], &sigma_i_dmh[0], sigma_start_N_i_dmh, sigma_N_i_dmh, N_i_dmh );
+	}
+};
+
+// - - - Latent policies - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// Gaussian data: Ds and Ts are fixed
+struct no_latent
+{
+	static const bool updates_Ds = false;
+
+	void add( checkpoint & ) {}
+	void update( bdmcmc_state & ) {}
+	void update_after( bdmcmc_state & ) {}
+};
+
+// Gaussian copula: latent Z from the ranks R ( copula.cpp ) and Ds = D + Z'Z
+struct copula_latent
+{
+	static const bool updates_Ds = true;
+
+	double *Z, *D;
+	int *R, *not_continuous, *n, *gcgm, dim;
+	vector<double> S, inv_Ds, copy_Ds;
+
+	copula_latent( bdmcmc_state &s, double Z_C[], int R_C[], int not_continuous_C[], int *n_C, int *gcgm_C, double D_C[] ) :
+		Z( Z_C ), D( D_C ), R( R_C ), not_continuous( not_continuous_C ), n( n_C ), gcgm( gcgm_C ), dim( s.dim ),
+		S( s.pxp ), inv_Ds( s.pxp ), copy_Ds( s.pxp ) {}
+
+	// Ds and Ts are from K and the latent data Z
+	void add( checkpoint &ckpt ) { ckpt.add( Z, *n * dim ); }
+
+	void update( bdmcmc_state &s )
+	{
+		get_Ds( s.K, Z, R, not_continuous, D, s.Ds, &S[0], gcgm, n, &s.dim );
+		get_Ts( s.Ds, s.Ts, &inv_Ds[0], &copy_Ds[0], &s.dim );
+	}
+
+	void update_after( bdmcmc_state & ) {}
+};
+
+// Gaussian copula for discrete Weibull data ( bdgraph.dw ): latent Z from the bounds of Y
+struct copula_dw_latent
+{
+	static const bool updates_Ds = true;
+
+	double *Z, *lower_bounds, *upper_bounds, *D;
+	int *Y, *n, *gcgm;
+	vector<double> S, inv_Ds, copy_Ds;
+
+	copula_dw_latent( bdmcmc_state &s, double Z_C[], int Y_C[], double lower_bounds_C[], double upper_bounds_C[], int *n_C, int *gcgm_C, double D_C[] ) :
+		Z( Z_C ), lower_bounds( lower_bounds_C ), upper_bounds( upper_bounds_C ), D( D_C ), Y( Y_C ), n( n_C ), gcgm( gcgm_C ),
+		S( s.pxp ), inv_Ds( s.pxp ), copy_Ds( s.pxp ) {}
+
+	void add( checkpoint & ) {}
+
+	void update( bdmcmc_state &s )
+	{
+		get_Ds_dw( s.K, Z, Y, lower_bounds, upper_bounds, D, s.Ds, &S[0], gcgm, n, &s.dim );
+		get_Ts( s.Ds, s.Ts, &inv_Ds[0], &copy_Ds[0], &s.dim );
+	}
+
+	void update_after( bdmcmc_state & ) {}
+};
+
+// t model: Ds from the data with the weights tu and the mean mu, which are updated after K
+struct tgm_latent
+{
+	static const bool updates_Ds = true;
+
+	double *data, *D, *nu, *mu, *tu;
+	int *n;
+	vector<double> S, inv_Ds, copy_Ds;
+
+	tgm_latent( bdmcmc_state &s, double data_C[], int *n_C, double D_C[], double *nu_C, double mu_C[], double tu_C[] ) :
+		data( data_C ), D( D_C ), nu( nu_C ), mu( mu_C ), tu( tu_C ), n( n_C ), S( s.pxp ), inv_Ds( s.pxp ), copy_Ds( s.pxp ) {}
+
+	void add( checkpoint & ) {}
+
+	void update( bdmcmc_state &s )
+	{
+		get_Ds_tgm( data, D, mu, tu, s.Ds, &S[0], n, &s.dim );
+		get_Ts( s.Ds, s.Ts, &inv_Ds[0], &copy_Ds[0], &s.dim );
+	}
+
+	void update_after( bdmcmc_state &s )
+	{
+		update_tu( data, s.K, tu, mu, nu, n, &s.dim );
+		update_mu( data, mu, tu, n, &s.dim );
+	}
+};
+
+// - - - Move policies - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// one edge in each iteration
+struct single_edge_move
+{
+	static const int size_index   = 1;   // iterations of the step
+	static const int multi_update = 1;
+	int index_selected_edge;
+
+	void add( checkpoint & ) {}
+
+	// Selecting an edge based on birth and death rates
+	void select( bdmcmc_state &s )
+	{
+		select_edge( &s.rates[0], &index_selected_edge, &s.sum_rates, &s.sub_qp );
+	}
+
+	void update_graph( bdmcmc_state &s ) { s.flip_edge( index_selected_edge ); }
+};
+
+// up to 'multi_update' edges in each step, which count as size_index iterations
+struct multi_edge_move
+{
+	int size_index, multi_update;
+	vector<int> index_selected_edges;
+
+	multi_edge_move( int *multi_update_C ) : size_index( *multi_update_C ), multi_update( *multi_update_C ), index_selected_edges( *multi_update_C ) {}
+
+	void add( checkpoint &ckpt ) { ckpt.add( &size_index, 1 ); }
+
+	// Selecting multiple edges based on birth and death rates
+	void select( bdmcmc_state &s )
+	{
+		select_multi_edges( &s.rates[0], &index_selected_edges[0], &size_index, &s.sum_rates, &multi_update, &s.sub_qp );
+	}
+
+	void update_graph( bdmcmc_state &s )
+	{
+		for( int i = 0; i < size_index; i++ ) s.flip_edge( index_selected_edges[ i ] );
+	}
+};
+
+// - - - Output policies - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// Bayesian model averaging: K_hat and p_links, weighted by the waiting times; with mcse_tol > 0,
+// batch means for the MCSE of p_links, and the sampler stops when the largest MCSE is below mcse_tol
+struct ma_output
+{
+	double *K_hat, *p_links, *p_links_mcse, mcse_tol, sum_weights;
+	int pxp;
+	vector<double> p_links_Cpp, K_hat_Cpp;
+	batch_means batch;
+
+	ma_output( bdmcmc_state &s, double K_hat_C[], double p_links_C[], double p_links_mcse_C[] = NULL, double *mcse_tol_C = NULL ) :
+		K_hat( K_hat_C ), p_links( p_links_C ), p_links_mcse( ( ( mcse_tol_C != NULL ) and ( *mcse_tol_C > 0.0 ) ) ? p_links_mcse_C : NULL ),
+		mcse_tol( ( mcse_tol_C == NULL ) ? 0.0 : *mcse_tol_C ), sum_weights( 0.0 ), pxp( s.pxp ),
+		p_links_Cpp( s.pxp, 0.0 ), K_hat_Cpp( s.pxp, 0.0 ), batch( 1, ( p_links_mcse == NULL ) ? 0 : s.pxp ) {}
+
+	void add( checkpoint &ckpt )
+	{
+		ckpt.add( &p_links_Cpp[0], pxp );
+		ckpt.add( &K_hat_Cpp[0], pxp );
+		ckpt.add( &sum_weights, 1 );
+
+		if( p_links_mcse == NULL ) return;
+		ckpt.add( &batch.size, 1 );
+		ckpt.add( &batch.counter, 1 );
+		ckpt.add( &batch.n_batches, 1 );
+		ckpt.add( &batch.weight, 1 );
+		ckpt.add( &batch.sum_weight, 1 );
+		ckpt.add( &batch.sum_weight2, 1 );
+		ckpt.add( &batch.x[0], pxp );
+		ckpt.add( &batch.sum_x[0], pxp );
+		ckpt.add( &batch.sum_x2[0], pxp );
+		ckpt.add( &batch.sum_wx[0], pxp );
+	}
+
+	// returns true when the MCSE is below mcse_tol
+	bool save( bdmcmc_state &s, double weight_C, int iteration, int burn_in, int multi_update )
+	{
+		int one = 1;
+
+		// K_hat_Cpp[i] += K[i] * weight_C;
+		F77_NAME(daxpy)( &pxp, &weight_C, s.K, &one, &K_hat_Cpp[0], &one );
+
+		#pragma omp parallel for
+		for( int i = 0; i < pxp; i++ )
+			if( s.G[ i ] ) p_links_Cpp[ i ] += weight_C;
+
+		if( p_links_mcse == NULL )
+		{
+			sum_weights += weight_C;
+			return false;
+		}
+
+		// first saved iteration: size of the batches, as iteration and burn_in are known now
+		if( sum_weights == 0.0 )
+		{
+			int size_batch = ( iteration - burn_in ) / ( 50 * multi_update );
+			batch.size = ( size_batch > 0 ) ? size_batch : 1;
+		}
+
+		sum_weights += weight_C;
+
+		return batch.add( s.G, weight_C ) and ( batch.n_batches >= 20 ) and ( batch.max_mcse() < mcse_tol );
+	}
+
+	void finish()
+	{
+		#pragma omp parallel for
+		for( int i = 0; i < pxp; i++ )
+		{
+			p_links[ i ] = p_links_Cpp[ i ] / sum_weights;
+			K_hat[ i ]   = K_hat_Cpp[ i ]   / sum_weights;
+		}
+
+		if( p_links_mcse != NULL )
+			for( int i = 0; i < pxp; i++ ) p_links_mcse[ i ] = batch.mcse( i );
+	}
+};
+
+// maximum a posterior probability estimation: the sampled graphs as strings of the upper
+// triangle, their weights, and the index of the graph in each saved iteration
+struct map_output
+{
+	int *all_graphs, *size_sample_g, *counter_all_g, count_all_g, size_sample_graph, pxp;
+	double *all_weights, *K_hat, *graph_weights, sum_weights;
+	char **sample_graphs;
+	vector<char> char_g;                     // char string_g[pp];
+	vector<string> sample_graphs_C;
+	unordered_map<string, int> index_graph;  // index of each graph in sample_graphs_C
+
+	map_output( bdmcmc_state &s, int all_graphs_C[], double all_weights_C[], double K_hat_C[], char *sample_graphs_C_R[],
+	            double graph_weights_C[], int *size_sample_g_C, int *counter_all_g_C = NULL ) :
+		all_graphs( all_graphs_C ), size_sample_g( size_sample_g_C ), counter_all_g( counter_all_g_C ),
+		count_all_g( ( counter_all_g_C == NULL ) ? 0 : *counter_all_g_C ), size_sample_graph( *size_sample_g_C ), pxp( s.pxp ),
+		all_weights( all_weights_C ), K_hat( K_hat_C ), graph_weights( graph_weights_C ), sum_weights( 0.0 ),
+		sample_graphs( sample_graphs_C_R ), char_g( s.qp ), sample_graphs_C( size_sample_graph ) {}
+
+	void add( checkpoint &ckpt )
+	{
+		if( ckpt.on() ) Rf_error( "There is no checkpoint for the MAP estimation" );
+	}
+
+	bool save( bdmcmc_state &s, double weight_C, int, int, int )
+	{
+		int counter = 0, one = 1;
+		for( int j = 1; j < s.dim; j++ )
+			for( int i = 0; i < j; i++ )
+				char_g[ counter++ ] = s.G[ j * s.dim + i ] + '0';
+
+		//for( i = 0; i < pxp; i++ ) K_hat[i] += K[i] * weight_C;
+		F77_NAME(daxpy)( &pxp, &weight_C, s.K, &one, &K_hat[0], &one );
+
+		all_weights[ count_all_g ] = weight_C;
+
+		pair<unordered_map<string, int>::iterator, bool> graph = index_graph.insert( make_pair( string( char_g.begin(), char_g.end() ), size_sample_graph ) );
+		if( graph.second )
+		{
+			sample_graphs_C.push_back( graph.first->first );
+			graph_weights[ size_sample_graph ] = weight_C;
+			size_sample_graph++;
+		}else{
+			graph_weights[ graph.first->second ] += weight_C;
+		}
+		all_graphs[ count_all_g ] = graph.first->second;
+
+		count_all_g++;
+		sum_weights += weight_C;
+
+		return false;
+	}
+
+	void finish()
+	{
+		int qp = static_cast<int>( char_g.size() );
+
+		#pragma omp parallel for
+		for( int i = 0; i < size_sample_graph; i++ )
+		{
+			sample_graphs_C[ i ].copy( sample_graphs[ i ], qp, 0 );
+			sample_graphs[ i ][ qp ] = '\0';
+		}
+
+		*size_sample_g = size_sample_graph;
+		if( counter_all_g != NULL ) *counter_all_g = count_all_g;
+
+		#pragma omp parallel for
+		for( int i = 0; i < pxp; i++ )
+			K_hat[ i ] /= sum_weights;
+	}
+};
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// birth-death MCMC: the main loop for all of the policies; the RNG state is from the caller
+// ( GetRNGstate or chain_rng )
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+template< class Likelihood, class Latent, class Move, class Output >
+void bdmcmc_sampler( bdmcmc_run &run, bdmcmc_state &s, Likelihood &likelihood, Latent &latent, Move &move, Output &output )
+{
+	int print_c = run.print, iteration = *run.iter, burn_in = *run.burnin;
+	bool converged = false;
+
+	// run time; with a time budget, it sets iteration and burn_in ( run_budget.h )
+	run_budget budget( run.time_budget, &iteration, &burn_in );
+
+	// checkpoint of the run; a resumed run continues from the checkpoint with its burn_in
+	checkpoint ckpt( run.checkpoint_file, run.checkpoint_every, run.name, s.dim );
+	s.add( ckpt );
+	latent.add( ckpt );
+	output.add( ckpt );
+	move.add( ckpt );
+	int i_start    = ( run.resume ) ? ckpt.resume( &iteration, &burn_in ) : 0;
+	*run.iter_used = iteration;
+
+	if( !Latent::updates_Ds ) likelihood.data( s );
+	likelihood.start( s );
+
+// - - Main loop for birth-death MCMC - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -|
+	int print_conter = ( print_c * iteration >= 100 ) ? i_start / ( ( print_c * iteration ) / 100 ) : 0;
+	for( int i_mcmc = i_start; i_mcmc < iteration; i_mcmc += move.size_index )
+	{
+		if( !budget.check( i_mcmc, &iteration, &burn_in ) )
+		{
+			*run.iter_used = i_mcmc;   // deadline of the time budget
+			break;
+		}
+
+		if( ckpt.due( i_mcmc ) ) ckpt.save( i_mcmc, iteration, burn_in );
+
+		print_progress( i_mcmc + move.size_index, iteration, print_c, &print_conter );
+
+// - - - STEP 1: latent data - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+		if( Latent::updates_Ds )
+		{
+			latent.update( s );
+			likelihood.data( s );
+		}
+
+// - - - STEP 2: calculating birth and death rates - - - - - - - - - - - - - - - - - - - - - - - - |
+
+		likelihood.rates( s );
+		move.select( s );
+
+// - - - saving result - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+		if( i_mcmc >= burn_in )
+			if( output.save( s, 1.0 / s.sum_rates, iteration, burn_in, move.multi_update ) )
+			{
+				*run.iter_used = i_mcmc + move.size_index;
+				if( print_c <= 100 ) Rprintf( " converged at iteration %i", *run.iter_used );
+				converged = true;   // the iteration is completed, so a resumed run continues from it
+			}
+// - - - End of saving result - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -|
+
+		move.update_graph( s );
+
+// - - - STEP 3: Sampling from G-Wishart for new graph - - - - - - - - - - - - - - - - - - - - - - |
+		likelihood.sample_K( s, i_mcmc + move.size_index < iteration );
+		latent.update_after( s );
+
+		if( converged ) break;
+	}
+// - - End of main loop for birth-death MCMC - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+
+	if( *run.iter_used > iteration ) *run.iter_used = iteration;
+	ckpt.save( *run.iter_used, iteration, burn_in );
+
+	output.finish();
+
+	*run.burnin = burn_in;
+	if( run.timing != NULL ) budget.report( run.timing, *run.iter_used );
+}
+
+#endif
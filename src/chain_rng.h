@@ -0,0 +1,86 @@
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+//     Copyright (C) 2012 - 2022  Reza Mohammadi                                                   |
+//                                                                                                 |
+//     This file is part of BDgraph package.                                                       |
+//                                                                                                 |
+//     BDgraph is free software: you can redistribute it and/or modify it under                    |
+//     the terms of the GNU General Public License as published by the Free                        |
+//     Software Foundation; see <https://cran.r-project.org/web/licenses/GPL-3>.                   |
+//                                                                                                 |
+//     Maintainer: Reza Mohammadi <a.mohammadi@uva.nl>                                             |
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+
+#ifndef chain_rng_H
+#define chain_rng_H
+
+#include "util.h"
+#include <random>            // std::mt19937_64
+
+// Random stream of one MCMC chain, for running several chains at the same time ( the R
+// generator is global and not thread-safe ). The stream is set for the thread running the
+// chain; in all other cases the samplers take the random numbers from the R generator.
+struct chain_rng
+{
+	std::mt19937_64 engine;
+
+	chain_rng( unsigned long long int seed ) : engine( seed ) {}
+
+	// uniform in ( 0, 1 ), as unif_rand()
+	double unif()
+	{
+		return ( static_cast<double>( engine() >> 11 ) + 0.5 ) * ( 1.0 / 9007199254740992.0 );
+	}
+
+	// standard normal by inversion, as norm_rand()
+	double norm()
+	{
+		return Rf_qnorm5( unif(), 0.0, 1.0, TRUE, FALSE );
+	}
+
+	// gamma( shape, scale ) by Marsaglia and Tsang (2000), as Rf_rgamma()
+	double gamma( double shape, double scale )
+	{
+		if( shape < 1.0 )
+			return gamma( shape + 1.0, scale ) * pow( unif(), 1.0 / shape );
+
+		double d = shape - 1.0 / 3.0, c = 1.0 / sqrt( 9.0 * d ), x, v, u;
+		for( ; ; )
+		{
+			do{
+				x = norm();
+				v = 1.0 + c * x;
+			}while( v <= 0.0 );
+
+			v = v * v * v;
+			u = unif();
+			if( log( u ) < 0.5 * x * x + d - d * v + d * log( v ) ) return d * v * scale;
+		}
+	}
+};
+
+// stream of the chain running on this thread; NULL means the R generator
+inline chain_rng *&current_chain_rng()
+{
+	static thread_local chain_rng *rng = NULL;
+	return rng;
+}
+
+inline double unif_rand_chain()
+{
+	chain_rng *rng = current_chain_rng();
+	return ( rng == NULL ) ? unif_rand() : rng->unif();
+}
+
+inline double norm_rand_chain()
+{
+	chain_rng *rng = current_chain_rng();
+	return ( rng == NULL ) ? norm_rand() : rng->norm();
+}
+
+inline double rgamma_chain( double shape, double scale )
+{
+	chain_rng *rng = current_chain_rng();
+	return ( rng == NULL ) ? Rf_rgamma( shape, scale ) : rng->gamma( shape, scale );
+}
+
+#endif
@@ -0,0 +1,237 @@
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+//     Copyright (C) 2012 - 2022  Reza Mohammadi                                                   |
+//                                                                                                 |
+//     This file is part of BDgraph package.                                                       |
+//                                                                                                 |
+//     BDgraph is free software: you can redistribute it and/or modify it under                    |
+//     the terms of the GNU General Public License as published by the Free                        |
+//     Software Foundation; see <https://cran.r-project.org/web/licenses/GPL-3>.                   |
+//                                                                                                 |
+//     Maintainer: Reza Mohammadi <a.mohammadi@uva.nl>                                             |
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+
+#ifndef checkpoint_H
+#define checkpoint_H
+
+#ifndef R_NO_REMAP
+#define R_NO_REMAP
+#endif
+
+#include "util.h"
+#ifndef BDGRAPH_STANDALONE
+#include <Rinternals.h>      // .Random.seed
+#endif
+#include <fstream>           // std::ofstream, std::ifstream
+#include <cstdio>            // std::rename, std::remove
+
+// Checkpoint of a sampler run, to resume a long run after it is stopped. The sampler
+// registers its state ( graph, precision matrix, accumulators, ... ) as blocks of its own
+// arrays; the blocks and the state of the random number generator ( .Random.seed in R )
+// are written to a binary file every 'every' iterations and at the end of the run. A run
+// resumed from the file takes the same random numbers, so it gives the same results as
+// the run without the stop. With an empty file name there is no checkpoint.
+struct checkpoint
+{
+	struct block
+	{
+		char type;   // 'i' for int, 'd' for double
+		void *x;
+		int size;
+	};
+
+	string file_name, sampler;
+	int every, dim, last_save;
+	vector<block> blocks;
+
+	checkpoint( const char *file, int every_iter, const char *name, int p ) : file_name( ( file == NULL ) ? "" : file ),
+		sampler( name ), every( every_iter ), dim( p ), last_save( 0 ) {}
+
+	bool on() const { return !file_name.empty(); }
+
+	void add( int x[], int size )   { blocks.push_back( { 'i', x, size } ); }
+	void add( double x[], int size ){ blocks.push_back( { 'd', x, size } ); }
+
+	// at the start of iteration i_mcmc: 'every' iterations after the last checkpoint
+	bool due( int i_mcmc ) const
+	{
+		return on() and ( every > 0 ) and ( i_mcmc - last_save >= every );
+	}
+
+	// writes the state before iteration i_next; the file is replaced only when it is complete
+	void save( int i_next, int iteration, int burn_in )
+	{
+		if( !on() ) return;
+
+		// Rf_error jumps over the destructors, so it is called after the file and the buffers are gone
+		char message[ 1024 ] = "";
+		write_file( i_next, iteration, burn_in, message );
+		if( message[ 0 ] != '\0' ) Rf_error( "%s", message );
+
+		last_save = i_next;
+	}
+
+	// reads the state; returns the iteration to start from. 'burn_in' is the one of the
+	// checkpointed run, and 'iteration' is at least the number of iterations done.
+	int resume( int *iteration, int *burn_in )
+	{
+		char message[ 1024 ] = "";
+		int i_next = read_file( iteration, burn_in, message );
+		if( message[ 0 ] != '\0' ) Rf_error( "%s", message );
+
+		last_save = i_next;
+		return i_next;
+	}
+
+	// the message of an error is put in 'message'
+	void write_file( int i_next, int iteration, int burn_in, char message[] )
+	{
+		vector<int> seed;
+		get_seed( &seed );
+		int size_seed = static_cast<int>( seed.size() );
+
+		string file_tmp = file_name + ".tmp";
+		{
+			ofstream out( file_tmp.c_str(), ios::binary | ios::trunc );
+			if( !out )
+			{
+				set_error( message, "Cannot write the checkpoint file '%s'", file_tmp );
+				return;
+			}
+
+			out.write( magic(), 8 );
+			write_int( out, static_cast<int>( sampler.size() ) );
+			out.write( sampler.data(), sampler.size() );
+
+			int header[] = { dim, i_next, iteration, burn_in, static_cast<int>( blocks.size() ) };
+			out.write( reinterpret_cast<char *>( header ), sizeof( header ) );
+
+			for( size_t k = 0; k < blocks.size(); k++ )
+			{
+				out.put( blocks[ k ].type );
+				write_int( out, blocks[ k ].size );
+				out.write( static_cast<char *>( blocks[ k ].x ), blocks[ k ].size * block_bytes( blocks[ k ].type ) );
+			}
+
+			write_int( out, size_seed );
+			if( size_seed > 0 ) out.write( reinterpret_cast<char *>( &seed[0] ), sizeof( int ) * size_seed );
+
+			if( !out.flush() )
+			{
+				set_error( message, "Cannot write the checkpoint file '%s'", file_tmp );
+				return;
+			}
+		}
+
+		if( rename( file_tmp.c_str(), file_name.c_str() ) != 0 )
+		{
+			remove( file_name.c_str() );   // rename does not replace a file on Windows
+			if( rename( file_tmp.c_str(), file_name.c_str() ) != 0 )
+				set_error( message, "Cannot write the checkpoint file '%s'", file_name );
+		}
+	}
+
+	// as resume; the message of an error is put in 'message'
+	int read_file( int *iteration, int *burn_in, char message[] )
+	{
+		string buffer;
+		{
+			ifstream in( file_name.c_str(), ios::binary );
+			if( in ) buffer.assign( istreambuf_iterator<char>( in ), istreambuf_iterator<char>() );
+		}
+
+		size_t pos = 0;
+		const char *data = buffer.data();
+		int size_name = 0;
+		if( ( buffer.size() < 12 ) or ( buffer.compare( 0, 8, magic(), 8 ) != 0 ) )
+			return set_error( message, "'%s' is not a checkpoint file of BDgraph", file_name );
+
+		pos = 8;
+		read_int( data, &pos, &size_name );
+		if( ( buffer.size() < pos + size_name + 5 * sizeof( int ) ) or ( buffer.compare( pos, size_name, sampler ) != 0 ) )
+			return set_error( message, "The checkpoint file '%s' is not from this sampling algorithm", file_name );
+		pos += size_name;
+
+		int header[ 5 ];
+		for( int k = 0; k < 5; k++ ) read_int( data, &pos, &header[ k ] );
+		if( ( header[ 0 ] != dim ) or ( header[ 4 ] != static_cast<int>( blocks.size() ) ) )
+			return set_error( message, "The checkpoint file '%s' is not for this data", file_name );
+
+		for( size_t k = 0; k < blocks.size(); k++ )
+		{
+			int size_block = -1;
+			char type = ( pos < buffer.size() ) ? data[ pos++ ] : 0;
+			if( pos + sizeof( int ) <= buffer.size() ) read_int( data, &pos, &size_block );
+
+			size_t bytes = static_cast<size_t>( blocks[ k ].size ) * block_bytes( blocks[ k ].type );
+			if( ( type != blocks[ k ].type ) or ( size_block != blocks[ k ].size ) or ( pos + bytes > buffer.size() ) )
+				return set_error( message, "The checkpoint file '%s' is not for this data", file_name );
+
+			memcpy( blocks[ k ].x, data + pos, bytes );
+			pos += bytes;
+		}
+
+		int size_seed = 0;
+		if( pos + sizeof( int ) <= buffer.size() ) read_int( data, &pos, &size_seed );
+		if( pos + sizeof( int ) * size_seed != buffer.size() )
+			return set_error( message, "The checkpoint file '%s' is incomplete", file_name );
+
+		if( size_seed > 0 )
+		{
+			vector<int> seed( size_seed );
+			memcpy( &seed[0], data + pos, sizeof( int ) * size_seed );
+			set_seed( seed );
+		}
+
+		int i_next = header[ 1 ];
+		*burn_in   = header[ 3 ];
+		if( *iteration < i_next ) *iteration = i_next;
+
+		return i_next;
+	}
+
+	static int set_error( char message[], const char *format, const string &file )
+	{
+		snprintf( message, 1024, format, file.c_str() );
+		return 0;
+	}
+
+	static const char *magic(){ return "BDGckpt1"; }
+
+	// state of the random number generator, as ints
+	static void get_seed( vector<int> *seed )
+	{
+		#ifdef BDGRAPH_STANDALONE
+			seed->resize( rng_state_size_standalone() );
+			get_rng_state_standalone( &( *seed )[0] );
+		#else
+			PutRNGstate();
+			SEXP seed_R = Rf_findVarInFrame( R_GlobalEnv, R_SeedsSymbol );
+			if( TYPEOF( seed_R ) == INTSXP ) seed->assign( INTEGER( seed_R ), INTEGER( seed_R ) + LENGTH( seed_R ) );
+		#endif
+	}
+
+	static void set_seed( const vector<int> &seed )
+	{
+		#ifdef BDGRAPH_STANDALONE
+			set_rng_state_standalone( &seed[0], static_cast<int>( seed.size() ) );
+		#else
+			SEXP seed_R = PROTECT( Rf_allocVector( INTSXP, seed.size() ) );
+			memcpy( INTEGER( seed_R ), &seed[0], sizeof( int ) * seed.size() );
+			Rf_defineVar( R_SeedsSymbol, seed_R, R_GlobalEnv );
+			UNPROTECT( 1 );
+			GetRNGstate();
+		#endif
+	}
+
+	static size_t block_bytes( char type ){ return ( type == 'i' ) ? sizeof( int ) : sizeof( double ); }
+
+	static void write_int( ofstream &out, int x ){ out.write( reinterpret_cast<char *>( &x ), sizeof( int ) ); }
+
+	static void read_int( const char *data, size_t *pos, int *x )
+	{
+		memcpy( x, data + *pos, sizeof( int ) );
+		*pos += sizeof( int );
+	}
+};
+
+#endif
@@ -50,108 +50,211 @@ void get_bounds( double Z[], int R[], double *lb, double *ub, int *i, int *j, in
 }
     
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
-// copula for BDMCMC sampling algorithm
+// Mean of column j of Z given the other columns, for all the rows:
+// mu = - Z[ , -j ] %*% K[ -j, j ] / K[ j, j ]. The columns of Z are read one by
+// one, each thread for its block of rows, and the columns with K[ k, j ] = 0
+// ( no link ) are not read at all; the sum is in the same order as in get_mean
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
-void copula( double Z[], double K[], int R[], int not_continuous[], int *n, int *p )
+static void get_mean_column( double Z[], double K[], double mu[], int j, int number, int dim )
 {
-    int number = *n, dim = *p, nxp = number * dim, dimp1 = dim + 1;
+    double sigma = 1.0 / K[ j * dim + j ];
     
     #pragma omp parallel
-    {	
-        double sigma, sd_j, mu_ij, lb, ub, runif_value, pnorm_lb, pnorm_ub;
-        int i, j;
+    {
+        int id = 0, n_threads = 1;
+#ifdef _OPENMP
+        id        = omp_get_thread_num();
+        n_threads = omp_get_num_threads();
+#endif
+        long row_begin = static_cast<long>( number ) * id / n_threads;
+        long row_end   = static_cast<long>( number ) * ( id + 1 ) / n_threads;
+        long i;
         
-        #pragma omp for
-        for( int counter = 0; counter < nxp; counter++ )
-        {   
-            j = counter / number;
-            i = counter % number;
+        for( i = row_begin; i < row_end; i++ ) mu[ i ] = 0.0;
+        
+        for( int k = 0; k < dim; k++ )
+        {
+            double K_kj = K[ j * dim + k ];
+            if( ( k == j ) or ( K_kj == 0.0 ) ) continue;
             
-            if( not_continuous[ j ] )
+            const double *Z_k = Z + static_cast<long>( k ) * number;
+            for( i = row_begin; i < row_end; i++ ) mu[ i ] += Z_k[ i ] * K_kj;
+        }
+        
+        for( i = row_begin; i < row_end; i++ ) mu[ i ] *= - sigma;
+    }
+}
+    
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// Draws column j of Z given the other columns. The bounds of Z[ i, j ] are the
+// largest Z of the ranks below R[ i, j ] and the smallest Z of the ranks above,
+// as in get_bounds; they are taken from the largest and smallest Z of each rank,
+// which takes O( n ) for the column in place of O( n ) for each row. The ranks
+// of the column, in order, are in two blocks by turns ( rank_parity ), also when
+// some ranks are not in the column; the rows of the first block are drawn first
+// and then the rows of the other one, so that the rows which are drawn together
+// do not bound each other, and they are drawn in parallel. The random numbers
+// are drawn before, in 'draws', since unif_rand() is not thread-safe.
+// The rows with missing values ( R = -1000 ) are drawn with no bounds, and they
+// do not bound the others, as in get_bounds_NA; copula() has no such rows, as
+// the data with missing values are for copula_NA().
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+static void copula_column( double Z[], double K[], int R[], double mu[], double draws[], int j, int number, int dim, 
+                           vector<double> &below_max, vector<double> &above_min, vector<int> &rank_parity )
+{
+    double sd_j = sqrt( 1.0 / K[ j * dim + j ] );
+    double *Z_j = Z + static_cast<long>( j ) * number;
+    int    *R_j = R + static_cast<long>( j ) * number;
+    int i, r, size_ranks = 0;
+    
+    get_mean_column( Z, K, mu, j, number, dim );
+    
+    for( i = 0; i < number; i++ ) size_ranks = max( size_ranks, R_j[ i ] );
+    
+    rank_parity.assign( size_ranks + 1, -1 );
+    for( i = 0; i < number; i++ ) 
+        if( R_j[ i ] > 0 ) rank_parity[ R_j[ i ] ] = 0;
+    for( r = 1, i = 1; r <= size_ranks; r++ )
+        if( rank_parity[ r ] == 0 )
+        {
+            rank_parity[ r ] = i;
+            i = 1 - i;
+        }
+    
+    for( int parity = 1; parity >= 0; parity-- )
+    {
+        // below_max[ r ]: largest Z with rank < r; above_min[ r ]: smallest Z with rank > r
+        below_max.assign( size_ranks + 2, -1e308 );
+        above_min.assign( size_ranks + 2, +1e308 );
+        
+        for( i = 0; i < number; i++ )
+        {
+            r = R_j[ i ];
+            if( r > 0 )   // here NA values have been replaced by -1000
             {
-                sigma = 1.0 / K[ j * dimp1 ]; // 1.0 / K[ j * dim + j ];
-                sd_j  = sqrt( sigma );
-                
-                get_mean( Z, K, &mu_ij, &sigma, &i, &j, &number, &dim );
-                
-                get_bounds( Z, R, &lb, &ub, &i, &j, &number );
-                
-                pnorm_lb     = Rf_pnorm5( lb, mu_ij, sd_j, TRUE, FALSE );
-                pnorm_ub     = Rf_pnorm5( ub, mu_ij, sd_j, TRUE, FALSE );
-                //runif_value = runif( pnorm_lb, pnorm_ub );
-                runif_value  = pnorm_lb + unif_rand() * ( pnorm_ub - pnorm_lb );
-                Z[ counter ] = Rf_qnorm5( runif_value, mu_ij, sd_j, TRUE, FALSE );
+                below_max[ r + 1 ] = max( below_max[ r + 1 ], Z_j[ i ] );
+                above_min[ r - 1 ] = min( above_min[ r - 1 ], Z_j[ i ] );
             }
         }
+        
+        for( r = 1; r <= size_ranks + 1; r++ ) below_max[ r ] = max( below_max[ r ], below_max[ r - 1 ] );
+        for( r = size_ranks; r >= 0; r-- )     above_min[ r ] = min( above_min[ r ], above_min[ r + 1 ] );
+        
+        for( i = 0; i < number; i++ )
+        {
+            r = R_j[ i ];
+            if( r != -1000 )
+            {
+                if( rank_parity[ r ] == parity ) draws[ i ] = unif_rand();
+            }else if( parity == 1 )
+                draws[ i ] = norm_rand();
+        }
+        
+        #pragma omp parallel for
+        for( int ii = 0; ii < number; ii++ )
+        {
+            int r_i = R_j[ ii ];
+            
+            if( r_i != -1000 )
+            {
+                if( rank_parity[ r_i ] != parity ) continue;
+                
+                double pnorm_lb    = Rf_pnorm5( below_max[ r_i ], mu[ ii ], sd_j, TRUE, FALSE );
+                double pnorm_ub    = Rf_pnorm5( above_min[ r_i ], mu[ ii ], sd_j, TRUE, FALSE );
+                double runif_value = pnorm_lb + draws[ ii ] * ( pnorm_ub - pnorm_lb );
+                Z_j[ ii ] = Rf_qnorm5( runif_value, mu[ ii ], sd_j, TRUE, FALSE );
+            }else if( parity == 1 )
+                Z_j[ ii ] = mu[ ii ] + draws[ ii ] * sd_j;  // rnorm( mu_ij, sd_j );
+        }
     }
 }
     
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// copula for BDMCMC sampling algorithm: one column after the other, so that
+// the data are read column by column ( as they are in a memory-mapped file )
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+void copula( double Z[], double K[], int R[], int not_continuous[], int *n, int *p )
+{
+	profile_phase timer( run_profile::copula );
+    int number = *n, dim = *p;
+    
+    vector<double> mu( number ), draws( number ), below_max, above_min;
+    vector<int> rank_parity;
+    
+    for( int j = 0; j < dim; j++ )
+        if( not_continuous[ j ] )
+            copula_column( Z, K, R, &mu[0], &draws[0], j, number, dim, below_max, above_min, rank_parity );
+}
+    
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -|
-// copula - Discrete Weibull for BDMCMC sampling algorithm
+// copula - Discrete Weibull for BDMCMC sampling algorithm; one column after the
+// other, and the rows of a column in parallel, as they do not depend on each
+// other given the other columns. The uniforms are drawn before the parallel
+// loops, since unif_rand() is not thread-safe
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -|
 void copula_dw( double Z[], double K[], int Y[], double lower_bounds[], double upper_bounds[], 
                 int *n, int *p )
 {
+	profile_phase timer( run_profile::copula );
     int number = *n, dim = *p, nxp = number * dim, dimp1 = dim + 1;
     
-    #pragma omp parallel
-    {	
-        double sigma, sd_j, mu_ij, runif_value, pnorm_lb, pnorm_ub;
-        int i, j;
+    vector<double> draws( nxp ), mu( number );
+    for( int counter = 0; counter < nxp; counter++ ) draws[ counter ] = unif_rand();
+    
+    for( int j = 0; j < dim; j++ )
+    {
+        double sd_j = sqrt( 1.0 / K[ j * dimp1 ] ); // 1.0 / K[ j * dim + j ];
         
-        #pragma omp for
-        for( int counter = 0; counter < nxp; counter++ )
+        get_mean_column( Z, K, &mu[0], j, number, dim );
+        
+        #pragma omp parallel for
+        for( int i = 0; i < number; i++ )
         {   
-            j = counter / number;
-            i = counter % number;
-            
-            sigma = 1.0 / K[ j * dimp1 ]; // 1.0 / K[ j * dim + j ];
-            sd_j  = sqrt( sigma );
+            int counter = j * number + i;
             
-            get_mean( Z, K, &mu_ij, &sigma, &i, &j, &number, &dim );
-            
-            pnorm_lb     = Rf_pnorm5( lower_bounds[ counter ], mu_ij, sd_j, TRUE, FALSE );
-            pnorm_ub     = Rf_pnorm5( upper_bounds[ counter ], mu_ij, sd_j, TRUE, FALSE );
+            double pnorm_lb    = Rf_pnorm5( lower_bounds[ counter ], mu[ i ], sd_j, TRUE, FALSE );
+            double pnorm_ub    = Rf_pnorm5( upper_bounds[ counter ], mu[ i ], sd_j, TRUE, FALSE );
             //runif_value = runif( pnorm_lb, pnorm_ub );
-            runif_value  = pnorm_lb + unif_rand() * ( pnorm_ub - pnorm_lb );
-            Z[ counter ] = Rf_qnorm5( runif_value, mu_ij, sd_j, TRUE, FALSE );
+            double runif_value = pnorm_lb + draws[ counter ] * ( pnorm_ub - pnorm_lb );
+            Z[ counter ] = Rf_qnorm5( runif_value, mu[ i ], sd_j, TRUE, FALSE );
         }
     }
 }
    
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -|
-// copula - Discrete Weibull for data with missing values 
+// copula - Discrete Weibull for data with missing values; by columns, and the
+// random numbers are drawn before the parallel loops, as in copula_dw
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -|
 void copula_dw_NA( double Z[], double K[], int Y[], double lower_bounds[], double upper_bounds[], 
                    int *n, int *p )
 {
+	profile_phase timer( run_profile::copula );
     int number = *n, dim = *p, nxp = number * dim, dimp1 = dim + 1;
     
-    #pragma omp parallel
-    {	
-        double sigma, sd_j, mu_ij, runif_value, pnorm_lb, pnorm_ub;
-        int i, j;
+    vector<double> draws( nxp ), mu( number );
+    for( int counter = 0; counter < nxp; counter++ )
+        draws[ counter ] = ( Y[ counter ] != -1000 ) ? unif_rand() : norm_rand();
+    
+    for( int j = 0; j < dim; j++ )
+    {
+        double sd_j = sqrt( 1.0 / K[ j * dimp1 ] ); // 1.0 / K[ j * dim + j ];
+        
+        get_mean_column( Z, K, &mu[0], j, number, dim );
         
-        #pragma omp for
-        for( int counter = 0; counter < nxp; counter++ )
+        #pragma omp parallel for
+        for( int i = 0; i < number; i++ )
         {   
-            j = counter / number;
-            i = counter % number;
-            
-            sigma = 1.0 / K[ j * dimp1 ]; // 1.0 / K[ j * dim + j ];
-            sd_j  = sqrt( sigma );
-            
-            get_mean( Z, K, &mu_ij, &sigma, &i, &j, &number, &dim );
+            int counter = j * number + i;
             
             if( Y[ counter ] != -1000 ) // here NA values have been replaced by -1000
             {
-                pnorm_lb     = Rf_pnorm5( lower_bounds[ counter ], mu_ij, sd_j, TRUE, FALSE );
-                pnorm_ub     = Rf_pnorm5( upper_bounds[ counter ], mu_ij, sd_j, TRUE, FALSE );
+                double pnorm_lb    = Rf_pnorm5( lower_bounds[ counter ], mu[ i ], sd_j, TRUE, FALSE );
+                double pnorm_ub    = Rf_pnorm5( upper_bounds[ counter ], mu[ i ], sd_j, TRUE, FALSE );
                 //runif_value = runif( pnorm_lb, pnorm_ub );
-                runif_value  = pnorm_lb + unif_rand() * ( pnorm_ub - pnorm_lb );
-                Z[ counter ] = Rf_qnorm5( runif_value, mu_ij, sd_j, TRUE, FALSE );
+                double runif_value = pnorm_lb + draws[ counter ] * ( pnorm_ub - pnorm_lb );
+                Z[ counter ] = Rf_qnorm5( runif_value, mu[ i ], sd_j, TRUE, FALSE );
             }else
-                Z[ counter ] = mu_ij + norm_rand() * sd_j;  // rnorm( mu_ij, sd_j );
+                Z[ counter ] = mu[ i ] + draws[ counter ] * sd_j;  // rnorm( mu_ij, sd_j );
         }
     }
 }
@@ -163,6 +266,7 @@ void get_Ds_dw( double K[], double Z[], int Y[], double lower_bounds[],
                 double upper_bounds[], double D[], double Ds[], double S[], 
                 int *gcgm, int *n, int *p )
 {
+	profile_phase timer( run_profile::copula );
     int dim = *p;
     
     ( *gcgm == 0 ) ? copula_dw( Z, K, Y, lower_bounds, upper_bounds, n, &dim ) : copula_dw_NA( Z, K, Y, lower_bounds, upper_bounds, n, &dim );
@@ -203,44 +307,20 @@ void get_bounds_NA( double Z[], int R[], double *lb, double *ub, int *i, int *j,
 }
     
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
-// copula for data with missing values 
+// copula for data with missing values; the ranks of the observed values bound
+// each other as in get_bounds_NA, and the missing values have no bounds
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
 void copula_NA( double Z[], double K[], int R[], int not_continuous[], int *n, int *p )
 {
-    int number = *n, dim = *p, nxp = number * dim, dimp1 = dim + 1;
+	profile_phase timer( run_profile::copula );
+    int number = *n, dim = *p;
     
-    #pragma omp parallel
-    {	
-        double sigma, sd_j, mu_ij, lb, ub, runif_value, pnorm_lb, pnorm_ub;
-        int i, j;
-        
-        #pragma omp for
-        for( int counter = 0; counter < nxp; counter++ )
-        {   
-            j = counter / number;
-            i = counter % number;
-            
-            if( not_continuous[ j ] )
-            {
-                sigma = 1.0 / K[ j * dimp1 ]; // 1.0 / K[ j * dim + j ];
-                sd_j  = sqrt( sigma );
-                
-                get_mean( Z, K, &mu_ij, &sigma, &i, &j, &number, &dim );
-                
-                if( R[ counter ] != -1000 ) // here NA values have been replaced by -1000
-                {
-                    get_bounds_NA( Z, R, &lb, &ub, &i, &j, &number );
-                    
-                    pnorm_lb     = Rf_pnorm5( lb, mu_ij, sd_j, TRUE, FALSE );
-                    pnorm_ub     = Rf_pnorm5( ub, mu_ij, sd_j, TRUE, FALSE );
-                    //runif_value = runif( pnorm_lb, pnorm_ub );
-                    runif_value  = pnorm_lb + unif_rand() * ( pnorm_ub - pnorm_lb );
-                    Z[ counter ] = Rf_qnorm5( runif_value, mu_ij, sd_j, TRUE, FALSE );
-                }else
-                    Z[ counter ] = mu_ij + norm_rand() * sd_j;  // rnorm( mu_ij, sd_j );
-            }
-        }
-    }
+    vector<double> mu( number ), draws( number ), below_max, above_min;
+    vector<int> rank_parity;
+    
+    for( int j = 0; j < dim; j++ )
+        if( not_continuous[ j ] )
+            copula_column( Z, K, R, &mu[0], &draws[0], j, number, dim, below_max, above_min, rank_parity );
 }
     
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
@@ -249,6 +329,7 @@ void copula_NA( double Z[], double K[], int R[], int not_continuous[], int *n, i
 void get_Ds( double K[], double Z[], int R[], int not_continuous[], double D[], 
              double Ds[], double S[], int *gcgm, int *n, int *p )
 {
+	profile_phase timer( run_profile::copula );
 	int dim = *p;
 
 	( *gcgm == 0 ) ? copula( Z, K, R, not_continuous, n, &dim ) : copula_NA( Z, K, R, not_continuous, n, &dim );
@@ -268,6 +349,7 @@ void get_Ds( double K[], double Z[], int R[], int not_continuous[], double D[],
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
 void get_Ts( double Ds[], double Ts[], double inv_Ds[], double copy_Ds[], int *p )
 {
+	profile_phase timer( run_profile::copula );
 	int dim = *p; 
 
 	memcpy( &copy_Ds[0], Ds, sizeof( double ) * dim * dim );
@@ -289,6 +371,7 @@ void get_Ts( double Ds[], double Ts[], double inv_Ds[], double copy_Ds[], int *p
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
 void update_tu( double data[], double K[], double tu[], double mu[], double *nu, int *n, int *p )
 {
+	profile_phase timer( run_profile::copula );
     int i, j, k, l, dim = *p, size_data = *n; //, one = 1;
     double nu_c = *nu, delta_y_i, shape_tu_i, rate_tu_i;
     
@@ -332,6 +415,7 @@ void update_tu( double data[], double K[], double tu[], double mu[], double *nu,
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
 void get_Ds_tgm( double data[], double D[], double mu[], double tu[], double Ds[], double S[], int *n, int *p )
 {
+	profile_phase timer( run_profile::copula );
 	int i, j, k, ij, dim = *p, size_data = *n;
 
     for( i = 0; i < dim; i++ )
@@ -353,6 +437,7 @@ void get_Ds_tgm( double data[], double D[], double mu[], double tu[], double Ds[
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
 void update_mu( double data[], double mu[], double tu[], int *n, int *p )
 {
+	profile_phase timer( run_profile::copula );
    	int i, j, dim = *p, one = 1;
     
    	// mu = tu %*% data / sum( tu )
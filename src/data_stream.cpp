@@ -0,0 +1,207 @@
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+//    Copyright (C) 2012 - 2022  Reza Mohammadi                                |
+//                                                                             |
+//    This file is part of BDgraph package.                                    |
+//                                                                             |
+//    BDgraph is free software: you can redistribute it and/or modify it under |
+//    the terms of the GNU General Public License as published by the Free     |
+//    Software Foundation; see <https://cran.r-project.org/web/licenses/GPL-3>.|
+//                                                                             |
+//    Maintainer: Reza Mohammadi <a.mohammadi@uva.nl>                          |
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+
+#ifndef R_NO_REMAP
+#define R_NO_REMAP
+#endif
+
+#include "matrix.h"
+#include <Rinternals.h>      // SEXP, external pointers for .Call
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// Data which come in chunks of rows ( function 'bdgraph.stream' in R ): only the
+// sufficient statistics are kept, S = X'X for continuous data, and the unique
+// patterns of the rows with their frequencies for discrete data ( as from the
+// function 'transfer' ). The hash table of the patterns is kept between the
+// chunks, so a chunk of n rows takes O( n p ) for any number of patterns found
+// so far. It is owned by an external pointer of R.
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+struct data_stream
+{
+	int dim, discrete, n;
+	vector<double> S;                          // X'X ( upper triangle ), for continuous data
+
+	vector<int> patterns;                      // unique rows, one after the other
+	vector<int> freq;
+	vector<unsigned long long int> key;        // hash keys of the patterns
+	vector<int> hash_table;                    // size is a power of 2, at most half full
+
+	data_stream( int p, int discrete_data ) : dim( p ), discrete( discrete_data ), n( 0 ), hash_table( 16, -1 )
+	{
+		if( !discrete ) S.assign( p * p, 0.0 );
+	}
+
+	// S += X'X for the chunk X ( n_chunk x p )
+	void add_continuous( double X[], int n_chunk )
+	{
+		double alpha = 1.0, beta = 1.0;
+		char uplo = 'U', transT = 'T';
+
+		F77_NAME(dsyrk)( &uplo, &transT, &dim, &n_chunk, &alpha, X, &n_chunk, &beta, &S[0], &dim FCONE FCONE );
+		n += n_chunk;
+	}
+
+	// adds the rows of the chunk X ( n_chunk x p ) to the patterns, in the order of their first appearance
+	void add_discrete( int X[], int n_chunk )
+	{
+		vector<unsigned long long int> key_X( n_chunk );
+
+		#pragma omp parallel
+		{
+			int id = 0, n_threads = 1;
+			#ifdef _OPENMP
+				id        = omp_get_thread_num();
+				n_threads = omp_get_num_threads();
+			#endif
+
+			hash_rows( X, n_chunk, dim, (long)n_chunk * id / n_threads, (long)n_chunk * ( id + 1 ) / n_threads, &key_X[0] );
+		}
+
+		for( int r = 0; r < n_chunk; r++ )
+		{
+			int mask = hash_table.size() - 1;
+			int slot = key_X[ r ] & mask;
+			while( ( hash_table[ slot ] >= 0 ) and ( ( key[ hash_table[ slot ] ] != key_X[ r ] ) or !equal_pattern( hash_table[ slot ], X, n_chunk, r ) ) )
+				slot = ( slot + 1 ) & mask;
+
+			if( hash_table[ slot ] >= 0 )
+			{
+				++freq[ hash_table[ slot ] ];
+				continue;
+			}
+
+			hash_table[ slot ] = freq.size();
+			freq.push_back( 1 );
+			key.push_back( key_X[ r ] );
+			for( int j = 0; j < dim; j++ ) patterns.push_back( X[ j * n_chunk + r ] );
+
+			if( 2 * freq.size() > hash_table.size() ) grow_hash_table();
+		}
+
+		n += n_chunk;
+	}
+
+	bool equal_pattern( int l, int X[], int n_X, int r ) const
+	{
+		const int *pattern_l = &patterns[ l * dim ];
+		for( int j = 0; j < dim; j++ )
+			if( pattern_l[ j ] != X[ j * n_X + r ] ) return false;
+
+		return true;
+	}
+
+	void grow_hash_table()
+	{
+		hash_table.assign( 2 * hash_table.size(), -1 );
+		int mask = hash_table.size() - 1;
+
+		for( int l = 0; l < (int)key.size(); l++ )
+		{
+			int slot = key[ l ] & mask;
+			while( hash_table[ slot ] >= 0 ) slot = ( slot + 1 ) & mask;
+			hash_table[ slot ] = l;
+		}
+	}
+};
+
+static void data_stream_finalizer( SEXP stream )
+{
+	data_stream *state = static_cast<data_stream *>( R_ExternalPtrAddr( stream ) );
+	if( state != NULL )
+	{
+		delete state;
+		R_ClearExternalPtr( stream );
+	}
+}
+
+static data_stream *get_stream( SEXP stream )
+{
+	data_stream *state = ( TYPEOF( stream ) == EXTPTRSXP ) ? static_cast<data_stream *>( R_ExternalPtrAddr( stream ) ) : NULL;
+	if( state == NULL ) Rf_error( "The stream is not valid; a stream can not be saved and loaded in a new R session" );
+
+	return state;
+}
+
+extern "C" {
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// new stream of data with p variables; discrete = 1 for the patterns of discrete data
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+SEXP data_stream_new( SEXP p, SEXP discrete )
+{
+	data_stream *state = new data_stream( Rf_asInteger( p ), Rf_asInteger( discrete ) );
+
+	SEXP stream = PROTECT( R_MakeExternalPtr( state, R_NilValue, R_NilValue ) );
+	R_RegisterCFinalizerEx( stream, data_stream_finalizer, TRUE );
+	UNPROTECT( 1 );
+
+	return stream;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// adds the chunk X ( n x p ), double for continuous data and integer for discrete data
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+SEXP data_stream_add( SEXP stream, SEXP X, SEXP n )
+{
+	data_stream *state = get_stream( stream );
+	int n_chunk = Rf_asInteger( n );
+
+	if( n_chunk > 0 )
+	{
+		if( state->discrete )
+			state->add_discrete( INTEGER( X ), n_chunk );
+		else
+			state->add_continuous( REAL( X ), n_chunk );
+	}
+
+	return R_NilValue;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// the number of rows and, for continuous data, S ( p x p ) or, for discrete data, 
+// the patterns and their frequencies ( as a matrix with p + 1 columns )
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+SEXP data_stream_get( SEXP stream )
+{
+	data_stream *state = get_stream( stream );
+	int dim = state->dim;
+
+	SEXP data;
+	if( state->discrete )
+	{
+		int size_unique = state->freq.size();
+		data = PROTECT( Rf_allocVector( INTSXP, size_unique * ( dim + 1 ) ) );
+
+		int *data_C = INTEGER( data );
+		for( int l = 0; l < size_unique; l++ )
+		{
+			for( int j = 0; j < dim; j++ ) data_C[ j * size_unique + l ] = state->patterns[ l * dim + j ];
+			data_C[ dim * size_unique + l ] = state->freq[ l ];
+		}
+	}else{
+		data = PROTECT( Rf_allocVector( REALSXP, dim * dim ) );
+
+		double *S = REAL( data );
+		for( int j = 0; j < dim; j++ )
+			for( int i = 0; i <= j; i++ )
+				S[ j * dim + i ] = S[ i * dim + j ] = state->S[ j * dim + i ];
+	}
+
+	const char *names[] = { "data", "n", "" };
+	SEXP result = PROTECT( Rf_mkNamed( VECSXP, names ) );
+	SET_VECTOR_ELT( result, 0, data );
+	SET_VECTOR_ELT( result, 1, Rf_ScalarInteger( state->n ) );
+	UNPROTECT( 2 );
+
+	return result;
+}
+
+} // End of exturn "C"
@@ -10,8 +10,7 @@
 //   Maintainer: Reza Mohammadi <a.mohammadi@uva.nl>                           |
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
 
-#include "matrix.h"
-#include "rgwish.h"
+#include "bdmcmc.h"
 
 extern "C" {
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
@@ -19,307 +18,66 @@ extern "C" {
 // for case D = I_p 
 // it is for Bayesian model averaging (MA)
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
-void ggm_bdmcmc_ma( int *iter, int *burnin, int G[], double g_prior[], double Ts[], double K[], 
+static void ggm_bdmcmc_ma_sampler( int *iter, int *burnin, int G[], double g_prior[], double Ts[], double K[], 
                     int *p, double *threshold, double K_hat[], double p_links[],
-			        int *b, int *b_star, double Ds[], int *print )
+			        int *b, int *b_star, double Ds[], double *mcse_tol, double p_links_mcse[], int *iter_used, double *time_budget, double timing[], 
+                    char **checkpoint_file, int *checkpoint_every, int *resume, int *print )
 {
-	//omp_set_num_threads( 2 );
-	int print_c = *print, iteration = *iter, burn_in = *burnin;
-	int index_selected_edge, selected_edge_i, selected_edge_j, selected_edge_ij;
-	int counter = 0, ip, i, j, ij, one = 1, dim = *p, pxp = dim * dim;
-	int qp = dim * ( dim - 1 ) / 2;
-	double Dsij, sum_weights = 0.0, weight_C, sum_rates;
-	
-	vector<double> p_links_Cpp( pxp, 0.0 ); 
-	vector<double> K_hat_Cpp( pxp, 0.0 ); 
-
-	// - - allocation for rgwish_sigma 
-	vector<double> sigma_start( pxp ); 
-	vector<double> inv_C( pxp ); 
-	vector<double> beta_star( dim ); 
-	vector<double> sigma_i( dim ); 
-	vector<double> sigma_start_N_i( dim );   // For dynamic memory used
-	vector<double> sigma_N_i( pxp );         // For dynamic memory used
-	vector<int> N_i( dim );                  // For dynamic memory used
-	// - - - - - - - - - - - - - - 
-	
-	vector<double> sigma( pxp ); 
-	vector<double> copyK( pxp ); 
-	memcpy( &copyK[0], K, sizeof( double ) * pxp );
-	inverse( &copyK[0], &sigma[0], &dim );			
-
-	// Counting size of notes
-	vector<int> size_node( dim, 0 );
-	for( i = 0; i < dim; i++ )
-	{
-		ip = i * dim;
-		for( j = 0; j < dim; j++ ) size_node[ i ] += G[ ip + j ];
-	}
-	
-	// For finding the index of rates 
-	vector<int> index_row( qp );
-	vector<int> index_col( qp );
-	vector<double> Dsijj( pxp ); 
-	for( j = 1; j < dim; j++ )
-		for( i = 0; i < j; i++ )
-		{
-		    ij = j * dim + i;
-		   
-			if( ( g_prior[ ij ] != 0.0 ) and ( g_prior[ ij ] != 1.0 ) )
-			{
-    			index_row[ counter ] = i;
-    			index_col[ counter ] = j;
-    			counter++;
-			}
-			
-			// for calculating the birth/death rates
-			Dsij        = Ds[ ij ];
-			Dsijj[ ij ] = Dsij * Dsij / Ds[ j * dim + j ]; 
-		}
-	int sub_qp = counter;
-	vector<double> rates( sub_qp );	
+	bdmcmc_run run( "ggm_bdmcmc_ma", iter, burnin, print );
+	run.iter_used        = iter_used;
+	run.time_budget      = *time_budget;
+	run.timing           = timing;
+	run.checkpoint_file  = *checkpoint_file;
+	run.checkpoint_every = *checkpoint_every;
+	run.resume           = *resume;
+
+	bdmcmc_state s( G, g_prior, Ts, K, Ds, p, threshold, b, b_star );
+	gwish_likelihood likelihood( s );
+	no_latent latent;
+	single_edge_move move;
+	ma_output output( s, K_hat, p_links, p_links_mcse, mcse_tol );
+
+	bdmcmc_sampler( run, s, likelihood, latent, move, output );
+}
 
-	vector<double> log_ratio_g_prior( pxp );	
-	for( j = 1; j < dim; j++ )
-		for( i = 0; i < j; i++ )
-		{
-			ij = j * dim + i;
-			log_ratio_g_prior[ ij ] = log( static_cast<double>( g_prior[ ij ] / ( 1 - g_prior[ ij ] ) ) );
-		}
-   
-// - - Main loop for birth-death MCMC - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -| 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// birth-death MCMC for Gaussian Graphical models (MA) with the RNG of R
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+void ggm_bdmcmc_ma( int *iter, int *burnin, int G[], double g_prior[], double Ts[], double K[], 
+                    int *p, double *threshold, double K_hat[], double p_links[],
+                    int *b, int *b_star, double Ds[], double *mcse_tol, double p_links_mcse[], int *iter_used, double *time_budget, double timing[], 
+                    char **checkpoint_file, int *checkpoint_every, int *resume, int *print )
+{
 	GetRNGstate();
-	int print_conter = 0;
-	for( int i_mcmc = 0; i_mcmc < iteration; i_mcmc++ )
-	{
-		if( ( i_mcmc + 1 ) % ( ( print_c * iteration ) / 100 ) == 0 ){
-		    ++print_conter;
-		    ( ( i_mcmc + 1 ) != iteration ) ? Rprintf( "%i%%->", print_c * print_conter ) : Rprintf( " done" );
-		}
-		
-// - - - STEP 1: calculating birth and death rates - - - - - - - - - - - - - - - - - - - - - - - - |		
-
-		rates_bdmcmc_parallel( &rates[0], &log_ratio_g_prior[0], G, &index_row[0], &index_col[0], &sub_qp, Ds, &Dsijj[0], &sigma[0], &K[0], b, &dim );
-
-		// Selecting an edge based on birth and death rates
-		select_edge( &rates[0], &index_selected_edge, &sum_rates, &sub_qp );
-		selected_edge_i = index_row[ index_selected_edge ];
-		selected_edge_j = index_col[ index_selected_edge ];
-
-// - - - saving result - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |	
-		if( i_mcmc >= burn_in )
-		{
-			weight_C = 1.0 / sum_rates;
-			
-			// K_hat_Cpp[i] += K[i] * weight_C;
-			F77_NAME(daxpy)( &pxp, &weight_C, &K[0], &one, &K_hat_Cpp[0], &one );
-			
-			#pragma omp parallel for
-			for( i = 0; i < pxp; i++ )
-				if( G[ i ] ) p_links_Cpp[ i ] += weight_C;
-			
-			sum_weights += weight_C;
-		} 
-// - - - End of saving result - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -|	
-			
-		// Updating G (graph) based on selected edge
-		selected_edge_ij    = selected_edge_j * dim + selected_edge_i;
-		G[ selected_edge_ij ] = 1 - G[ selected_edge_ij ];
-		G[ selected_edge_i * dim + selected_edge_j ] = G[ selected_edge_ij ];
-
-		if( G[ selected_edge_ij ] )
-		{ 
-			++size_node[ selected_edge_i ]; 
-			++size_node[ selected_edge_j ]; 
-		}else{ 
-			--size_node[ selected_edge_i ]; 
-			--size_node[ selected_edge_j ]; 
-		}
-
-// - - - STEP 2: Sampling from G-Wishart for new graph - - - - - - - - - - - - - - - - - - - - - - |
-		rgwish_sigma( G, &size_node[0], Ts, K, &sigma[0], b_star, &dim, threshold, &sigma_start[0], &inv_C[0], &beta_star[0], &sigma_i[0], sigma_start_N_i, sigma_N_i, N_i );		
-	}  
+	ggm_bdmcmc_ma_sampler( iter, burnin, G, g_prior, Ts, K, p, threshold, K_hat, p_links, b, b_star, Ds, mcse_tol, p_links_mcse, iter_used, time_budget, timing, checkpoint_file, checkpoint_every, resume, print );
 	PutRNGstate();
-// - - End of main loop for birth-death MCMC - - - - - - - - - - - - - - - - - - - - - - - - - - - | 
-
-	#pragma omp parallel for
-	for( i = 0; i < pxp; i++ )
-	{	
-		p_links[ i ] = p_links_Cpp[ i ] / sum_weights;
-		K_hat[ i ]   = K_hat_Cpp[ i ]   / sum_weights;
-	}
 }
        
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
 // birth-death MCMC for Gaussian Graphical models  
 // for case D = I_p 
 // it is for maximum a posterior probability estimation (MAP)
+// with a time budget, up to 'iter' graphs are saved
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
 void ggm_bdmcmc_map( int *iter, int *burnin, int G[], double g_prior[], double Ts[], double K[], 
                     int *p, double *threshold, int all_graphs[], double all_weights[], double K_hat[], 
                     char *sample_graphs[], double graph_weights[], int *size_sample_g,
-                    int *b, int *b_star, double Ds[], int *print )
+                    int *b, int *b_star, double Ds[], int *iter_used, double *time_budget, double timing[], int *print )
 {
-	int print_c = *print, iteration = *iter, burn_in = *burnin, count_all_g = 0;
-	int index_selected_edge, selected_edge_i, selected_edge_j, selected_edge_ij, size_sample_graph = *size_sample_g;
-	int i, j, ij, one = 1, dim = *p, pxp = dim * dim;
-
-	double Dsij, sum_weights = 0.0, weight_C, sum_rates;
-	
-	bool this_one;
-
-	string string_g;
-	vector<string> sample_graphs_C( iteration - burn_in );
+	bdmcmc_run run( "ggm_bdmcmc_map", iter, burnin, print );
+	run.iter_used   = iter_used;
+	run.time_budget = *time_budget;
+	run.timing      = timing;
 
-	// - - allocation for rgwish_sigma 
-	vector<double> sigma_start( pxp ); 
-	vector<double> inv_C( pxp ); 
-	vector<double> beta_star( dim ); 
-	vector<double> sigma_i( dim ); 
-	vector<double> sigma_start_N_i( dim );   // For dynamic memory used
-	vector<double> sigma_N_i( pxp );         // For dynamic memory used
-	vector<int> N_i( dim );                  // For dynamic memory used
-	// - - - - - - - - - - - - - - 
+	bdmcmc_state s( G, g_prior, Ts, K, Ds, p, threshold, b, b_star );
+	gwish_likelihood likelihood( s );
+	no_latent latent;
+	single_edge_move move;
+	map_output output( s, all_graphs, all_weights, K_hat, sample_graphs, graph_weights, size_sample_g );
 
-	vector<double> sigma( pxp ); 
-	vector<double> copyK( pxp ); 
-	memcpy( &copyK[0], K, sizeof( double ) * pxp );
-	inverse( &copyK[0], &sigma[0], &dim );			
-
-	int qp = dim * ( dim - 1 ) / 2;
-	vector<char> char_g( qp );              // char string_g[pp];
-
-	// Counting size of notes
-	int ip;
-	vector<int> size_node( dim, 0 );
-	for( i = 0; i < dim; i++ )
-	{
-		ip = i * dim;
-		for( j = 0; j < dim; j++ ) size_node[ i ] += G[ ip + j ];
-	}
-	
-	// For finding the index of rates 
-	vector<int> index_row( qp );
-	vector<int> index_col( qp );
-	int counter = 0;
-	vector<double> Dsijj( pxp ); 
-	for( j = 1; j < dim; j++ )
-		for( i = 0; i < j; i++ )
-		{
-		    ij = j * dim + i;
-		    
-		    if( ( g_prior[ ij ] != 0.0 ) or ( g_prior[ ij ] != 1.0 ) )
-		    {
-		        index_row[ counter ] = i;
-		        index_col[ counter ] = j;
-		        counter++;
-		    }
-		    
-		    // for calculating the birth/death rates
-		    Dsij        = Ds[ ij ];
-		    Dsijj[ ij ] = Dsij * Dsij / Ds[ j * dim + j ]; 
-		}
-	int sub_qp = counter;
-	vector<double> rates( sub_qp );
-
-	vector<double> log_ratio_g_prior( pxp );	
-	for( j = 1; j < dim; j++ )
-		for( i = 0; i < j; i++ )
-		{
-			ij = j * dim + i;
-			log_ratio_g_prior[ ij ] = log( static_cast<double>( g_prior[ ij ] / ( 1 - g_prior[ ij ] ) ) );
-		}
-
-// - - Main loop for birth-death MCMC - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -| 
 	GetRNGstate();
-	int print_conter = 0;
-	for( int i_mcmc = 0; i_mcmc < iteration; i_mcmc++ )
-	{
-		if( ( i_mcmc + 1 ) % ( ( print_c * iteration ) / 100 ) == 0 ){
-		    ++print_conter;
-		    ( ( i_mcmc + 1 ) != iteration ) ? Rprintf( "%i%%->", print_c * print_conter ) : Rprintf( " done" );
-		}
-	  		
-// - - - STEP 1: calculating birth and death rates - - - - - - - - - - - - - - - - - - - - - - - - |		
-
-		rates_bdmcmc_parallel( &rates[0], &log_ratio_g_prior[0], G, &index_row[0], &index_col[0], &sub_qp, Ds, &Dsijj[0], &sigma[0], &K[0], b, &dim );
-		
-		// Selecting an edge based on birth and death rates
-		select_edge( &rates[0], &index_selected_edge, &sum_rates, &sub_qp );
-		selected_edge_i = index_row[ index_selected_edge ];
-		selected_edge_j = index_col[ index_selected_edge ];
-
-// - - - saving result - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |	
-		if( i_mcmc >= burn_in )
-		{
-			counter = 0;	
-			for( j = 1; j < dim; j++ )
-				for( i = 0; i < j; i++ )
-					char_g[ counter++ ] = G[ j * dim + i ] + '0'; 
-
-			weight_C = 1.0 / sum_rates;
-			
-			//for( i = 0; i < pxp; i++ ) K_hat[i] += K[i] * weight_C;
-			F77_NAME(daxpy)( &pxp, &weight_C, &K[0], &one, &K_hat[0], &one );			
-
-			string_g = string( char_g.begin(), char_g.end() );	
-			all_weights[ count_all_g ] = weight_C;
-			
-			this_one = false;
-			for( i = 0; i < size_sample_graph; i++ )
-				if( sample_graphs_C[ i ] == string_g )
-				{
-					graph_weights[ i ] += all_weights[ count_all_g ];
-					all_graphs[ count_all_g ] = i;
-					this_one = true;
-					break;
-				} 
-			
-			if( !this_one || size_sample_graph == 0 )
-			{
-				sample_graphs_C[ size_sample_graph ] = string_g;
-				graph_weights[ size_sample_graph ]   = all_weights[ count_all_g ];
-				all_graphs[ count_all_g ]            = size_sample_graph; 
-				size_sample_graph++;				
-			}
-			
-			count_all_g++; 
-			sum_weights += weight_C;
-		} 
-// - - - End of saving result - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -|	
-    			
-		// Updating G (graph) based on selected edge
-		selected_edge_ij    = selected_edge_j * dim + selected_edge_i;
-		G[ selected_edge_ij ] = 1 - G[ selected_edge_ij ];
-		G[ selected_edge_i * dim + selected_edge_j ] = G[ selected_edge_ij ];
-
-		if( G[ selected_edge_ij ] )
-		{ 
-			++size_node[ selected_edge_i ]; 
-			++size_node[ selected_edge_j ]; 
-		}else{ 
-			--size_node[ selected_edge_i ]; 
-			--size_node[ selected_edge_j ]; 
-		}
-
-// - - - STEP 2: Sampling from G-Wishart for new graph - - - - - - - - - - - - - - - - - - - - - - |
-		rgwish_sigma( G, &size_node[0], Ts, K, &sigma[0], b_star, &dim, threshold, &sigma_start[0], &inv_C[0], &beta_star[0], &sigma_i[0], sigma_start_N_i, sigma_N_i, N_i );		
-	}  
+	bdmcmc_sampler( run, s, likelihood, latent, move, output );
 	PutRNGstate();
-// - - End of main loop for birth-death MCMC - - - - - - - - - - - - - - - - - - - - - - - - - - - | 
-
-	#pragma omp parallel for
-	for( i = 0; i < size_sample_graph; i++ ) 
-	{
-		sample_graphs_C[ i ].copy( sample_graphs[ i ], qp, 0 );
-		sample_graphs[ i ][ qp ] = '\0';
-	}
-	
-	*size_sample_g = size_sample_graph;
-	
-	#pragma omp parallel for
-	for( i = 0; i < pxp; i++ )
-		K_hat[ i ] /= sum_weights;
 }
         
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
@@ -327,144 +85,39 @@ void ggm_bdmcmc_map( int *iter, int *burnin, int G[], double g_prior[], double T
 // for D = I_p 
 // it is for Bayesian model averaging
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
-void ggm_bdmcmc_ma_multi_update( int *iter, int *burnin, int G[], double g_prior[], double Ts[], 
+static void ggm_bdmcmc_ma_multi_update_sampler( int *iter, int *burnin, int G[], double g_prior[], double Ts[], 
                             double K[], int *p, double *threshold, double K_hat[], double p_links[],
-                            int *b, int *b_star, double Ds[], int *multi_update, int *print )
+                            int *b, int *b_star, double Ds[], int *multi_update, double *mcse_tol, double p_links_mcse[], int *iter_used, double *time_budget, double timing[], 
+                    char **checkpoint_file, int *checkpoint_every, int *resume, int *print )
 {
-	int print_c = *print, iteration = *iter, burn_in = *burnin, multi_update_C = *multi_update;
-	int selected_edge_i, selected_edge_j, selected_edge_ij;
-	int i, j,ij, one = 1, dim = *p, pxp = dim * dim;
-
-	double Dsij, sum_weights = 0.0, weight_C, sum_rates;
-
-	vector<double> p_links_Cpp( pxp, 0.0 ); 
-	vector<double> K_hat_Cpp( pxp, 0.0 ); 
-
-	// - - allocation for rgwish_sigma 
-	vector<double> sigma_start( pxp ); 
-	vector<double> inv_C( pxp ); 
-	vector<double> beta_star( dim ); 
-	vector<double> sigma_i( dim ); 
-	vector<double> sigma_start_N_i( dim );   // For dynamic memory used
-	vector<double> sigma_N_i( pxp );         // For dynamic memory used
-	vector<int> N_i( dim );                  // For dynamic memory used
-	// - - - - - - - - - - - - - - 
-
-	vector<double> sigma( pxp ); 
-	vector<double> copyK( pxp ); 
-	memcpy( &copyK[0], K, sizeof( double ) * pxp );
-	inverse( &copyK[0], &sigma[0], &dim );			
-
-	// Count size of notes
-	int ip;
-	vector<int> size_node( dim, 0 );
-	for( i = 0; i < dim; i++ )
-	{
-		ip = i * dim;
-		for( j = 0; j < dim; j++ ) size_node[ i ] += G[ ip + j ];
-	}
-
-	// For finding the index of rates 
-	int qp = dim * ( dim - 1 ) / 2;
-	vector<int> index_row( qp );
-	vector<int> index_col( qp );
-	int counter = 0;
-	vector<double> Dsijj( pxp ); 
-	for( j = 1; j < dim; j++ )
-		for( i = 0; i < j; i++ )
-		{
-		    ij = j * dim + i;
-		    
-		    if( ( g_prior[ ij ] != 0.0 ) or ( g_prior[ ij ] != 1.0 ) )
-		    {
-		        index_row[ counter ] = i;
-		        index_col[ counter ] = j;
-		        counter++;
-		    }
-		    
-		    // for calculating the birth/death rates
-		    Dsij        = Ds[ ij ];
-		    Dsijj[ ij ] = Dsij * Dsij / Ds[ j * dim + j ]; 
-		}
-	int sub_qp = counter;
-	vector<double> rates( sub_qp );
-
-	vector<double> log_ratio_g_prior( pxp );	
-	for( j = 1; j < dim; j++ )
-		for( i = 0; i < j; i++ )
-		{
-			ij = j * dim + i;
-			log_ratio_g_prior[ ij ] = log( static_cast<double>( g_prior[ ij ] / ( 1 - g_prior[ ij ] ) ) );
-		}
-
-	int size_index = multi_update_C;
-	vector<int> index_selected_edges( multi_update_C );
+	bdmcmc_run run( "ggm_bdmcmc_ma_multi_update", iter, burnin, print );
+	run.iter_used        = iter_used;
+	run.time_budget      = *time_budget;
+	run.timing           = timing;
+	run.checkpoint_file  = *checkpoint_file;
+	run.checkpoint_every = *checkpoint_every;
+	run.resume           = *resume;
+
+	bdmcmc_state s( G, g_prior, Ts, K, Ds, p, threshold, b, b_star );
+	gwish_likelihood likelihood( s );
+	no_latent latent;
+	multi_edge_move move( multi_update );
+	ma_output output( s, K_hat, p_links, p_links_mcse, mcse_tol );
+
+	bdmcmc_sampler( run, s, likelihood, latent, move, output );
+}
 
-// - - Main loop for birth-death MCMC - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -| 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// Multiple birth-death MCMC for Gaussian Graphical models (MA) with the RNG of R
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+void ggm_bdmcmc_ma_multi_update( int *iter, int *burnin, int G[], double g_prior[], double Ts[], 
+                            double K[], int *p, double *threshold, double K_hat[], double p_links[],
+                            int *b, int *b_star, double Ds[], int *multi_update, double *mcse_tol, double p_links_mcse[], int *iter_used, double *time_budget, double timing[], 
+                    char **checkpoint_file, int *checkpoint_every, int *resume, int *print )
+{
 	GetRNGstate();
-	int print_conter = 0;
-	for( int i_mcmc = 0; i_mcmc < iteration; i_mcmc += size_index )
-	{
-		if( ( i_mcmc + size_index ) % ( ( print_c * iteration ) / 100 ) == 0 ){
-		    ++print_conter;
-		    ( ( i_mcmc + size_index ) != iteration ) ? Rprintf( "%i%%->", print_c * print_conter ) : Rprintf( " done" );
-		}
-	 			
-// - - - STEP 1: calculating birth and death rates - - - - - - - - - - - - - - - - - - - - - - - - |		
-
-		rates_bdmcmc_parallel( &rates[0], &log_ratio_g_prior[0], G, &index_row[0], &index_col[0], &sub_qp, Ds, &Dsijj[0], &sigma[0], &K[0], b, &dim );
-
-		// Selecting multiple edges based on birth and death rates
-		select_multi_edges( &rates[0], &index_selected_edges[0], &size_index, &sum_rates, &multi_update_C, &sub_qp );
-
-// - - - Saving result - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |	
-		if( i_mcmc >= burn_in )
-		{
-			weight_C = 1.0 / sum_rates;
-			
-			// K_hat_Cpp[i] += K[i] / sum_rates;
-			F77_NAME(daxpy)( &pxp, &weight_C, &K[0], &one, &K_hat_Cpp[0], &one );
-			
-			#pragma omp parallel for
-			for( i = 0; i < pxp ; i++ )
-				if( G[ i ] ) p_links_Cpp[ i ] += weight_C;
-			
-			sum_weights += weight_C;
-		} 
-// - - - End of saving result - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |	
-
-		// Updating graph based on selected edges
-		for ( i = 0; i < size_index; i++ )
-		{
-			selected_edge_i = index_row[ index_selected_edges[ i ] ];
-			selected_edge_j = index_col[ index_selected_edges[ i ] ];
-			
-			selected_edge_ij    = selected_edge_j * dim + selected_edge_i;
-			G[ selected_edge_ij ] = 1 - G[ selected_edge_ij ];
-			G[ selected_edge_i * dim + selected_edge_j ] = G[ selected_edge_ij ];
-		
-			if( G[ selected_edge_ij ] )
-			{ 
-				++size_node[ selected_edge_i ]; 
-				++size_node[ selected_edge_j ]; 
-			}else{ 
-				--size_node[ selected_edge_i ]; 
-				--size_node[ selected_edge_j ]; 
-			}		
-		}
-
-// - - - STEP 2: Sampling from G-Wishart for new graph - - - - - - - - - - - - - - - - - - - - - - |
-		rgwish_sigma( G, &size_node[0], Ts, K, &sigma[0], b_star, &dim, threshold, &sigma_start[0], &inv_C[0], &beta_star[0], &sigma_i[0], sigma_start_N_i, sigma_N_i, N_i );		
-	}  
+	ggm_bdmcmc_ma_multi_update_sampler( iter, burnin, G, g_prior, Ts, K, p, threshold, K_hat, p_links, b, b_star, Ds, multi_update, mcse_tol, p_links_mcse, iter_used, time_budget, timing, checkpoint_file, checkpoint_every, resume, print );
 	PutRNGstate();
-// - - End of main loop for birth-death MCMC - - - - - - - - - - - - - - - - - - - - - - - - - - - | 
-
-	#pragma omp parallel for
-	for( i = 0; i < pxp; i++ )
-	{	
-		p_links[ i ] = p_links_Cpp[ i ] / sum_weights;
-		K_hat[ i ]   = K_hat_Cpp[ i ]   / sum_weights;
-	}
 }
     
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
@@ -477,173 +130,124 @@ void ggm_bdmcmc_map_multi_update( int *iter, int *burnin, int G[], double g_prio
                 char *sample_graphs[], double graph_weights[], int *size_sample_g, int *counter_all_g,
                 int *b, int *b_star, double Ds[], int *multi_update, int *print )
 {
-	int print_c = *print, multi_update_C = *multi_update, iteration = *iter, burn_in = *burnin;
-	int count_all_g = *counter_all_g, selected_edge_i, selected_edge_j, selected_edge_ij, size_sample_graph = *size_sample_g;
-	int i, j,ij, one = 1, dim = *p, pxp = dim * dim;
-	
-	double Dsij, sum_weights = 0.0, weight_C, sum_rates;
-	bool this_one;
+	bdmcmc_run run( "ggm_bdmcmc_map_multi_update", iter, burnin, print );
 
-	string string_g;
-	vector<string> sample_graphs_C( iteration - burn_in );
+	bdmcmc_state s( G, g_prior, Ts, K, Ds, p, threshold, b, b_star );
+	gwish_likelihood likelihood( s );
+	no_latent latent;
+	multi_edge_move move( multi_update );
+	map_output output( s, all_graphs, all_weights, K_hat, sample_graphs, graph_weights, size_sample_g, counter_all_g );
 
-	// - - allocation for rgwish_sigma 
-	vector<double> sigma_start( pxp ); 
-	vector<double> inv_C( pxp ); 
-	vector<double> beta_star( dim ); 
-	vector<double> sigma_i( dim ); 
-	vector<double> sigma_start_N_i( dim );   // For dynamic memory used
-	vector<double> sigma_N_i( pxp );         // For dynamic memory used
-	vector<int> N_i( dim );                  // For dynamic memory used
-	// - - - - - - - - - - - - - - 
-
-	vector<double> sigma( pxp ); 
-	vector<double> copyK( pxp ); 
-	memcpy( &copyK[0], K, sizeof( double ) * pxp );
-	inverse( &copyK[0], &sigma[0], &dim );			
-
-	int qp = dim * ( dim - 1 ) / 2;
-	vector<char> char_g( qp );              // char string_g[pp];
-
-	// Counting size of notes
-	int ip;
-	vector<int> size_node( dim, 0 );
-	for( i = 0; i < dim; i++ )
-	{
-		ip = i * dim;
-		for( j = 0; j < dim; j++ ) size_node[ i ] += G[ ip + j ];
-	}
+	GetRNGstate();
+	bdmcmc_sampler( run, s, likelihood, latent, move, output );
+	PutRNGstate();
+}
+              
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// Several birth-death MCMC chains for Gaussian Graphical models (MA), which
+// run at the same time, each from its own starting graph and with its own
+// random stream ( chain_rng.h ). The threads are split between the chains and
+// the birth/death rates of each chain.
+// burnin, iter_used: for each chain; timing: 3 x n_chains ( run_budget.h )
+// G_chains, K_chains, K_hat_chains, p_links_chains: p x p x n_chains
+// p_links and K_hat are the averages over the chains, p_links_mcse is the MCSE
+// of the average, and rhat is the potential scale reduction of p_links
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+void ggm_bdmcmc_ma_chains( int *iter, int *burnin, int G_chains[], double g_prior[], double Ts[], 
+                    double K_chains[], int *p, double *threshold, double K_hat[], double p_links[],
+                    double K_hat_chains[], double p_links_chains[], int *b, int *b_star, double Ds[], 
+                    int *multi_update, double *mcse_tol, double p_links_mcse[], double rhat[], int iter_used[], 
+                    double *time_budget, double timing[], int *n_chains, int *print )
+{
+	int n_chains_C = *n_chains, multi_update_C = *multi_update, dim = *p, pxp = dim * dim;
+	vector<double> p_links_mcse_chains( pxp * n_chains_C );
+	int print_chain = 200;  // no printing inside of the chains; Rprintf is not thread-safe
 	
-	// For finding the index of rates 
-	vector<int> index_row( qp );
-	vector<int> index_col( qp );
-	int counter = 0;
-	vector<double> Dsijj( pxp ); 
-	for( j = 1; j < dim; j++ )
-		for( i = 0; i < j; i++ )
-		{
-		    ij = j * dim + i;
-		    
-		    if( ( g_prior[ ij ] != 0.0 ) or ( g_prior[ ij ] != 1.0 ) )
-		    {
-		        index_row[ counter ] = i;
-		        index_col[ counter ] = j;
-		        counter++;
-		    }
-		    
-		    // for calculating the birth/death rates
-		    Dsij        = Ds[ ij ];
-		    Dsijj[ ij ] = Dsij * Dsij / Ds[ j * dim + j ]; 
-		}
-	int sub_qp = counter;
-	vector<double> rates( sub_qp );
-
-	vector<double> log_ratio_g_prior( pxp );	
-	for( j = 1; j < dim; j++ )
-		for( i = 0; i < j; i++ )
-		{
-			ij = j * dim + i;
-			log_ratio_g_prior[ ij ] = log( static_cast<double>( g_prior[ ij ] / ( 1 - g_prior[ ij ] ) ) );
-		}
-
-	int size_index = multi_update_C;
-	vector<int> index_selected_edges( multi_update_C );
-
-// - - Main loop for birth-death MCMC - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -| 
+	// seeds of the chains from the RNG of R, so set.seed() gives the same chains
+	vector<unsigned long long int> seeds( n_chains_C );
 	GetRNGstate();
-	int print_conter = 0;
-	for( int i_mcmc = 0; i_mcmc < iteration; i_mcmc += size_index )
-	{
-		if( ( i_mcmc + size_index ) % ( ( print_c * iteration ) / 100 ) == 0 ){
-		    ++print_conter;
-		    ( ( i_mcmc + size_index ) != iteration ) ? Rprintf( "%i%%->", print_c * print_conter ) : Rprintf( " done" );
-		}
-	 			
-// - - - STEP 1: calculating birth and death rates - - - - - - - - - - - - - - - - - - - - - - - - |		
+	for( int chain = 0; chain < n_chains_C; chain++ )
+		seeds[ chain ] = ( static_cast<unsigned long long int>( unif_rand() * 4294967296.0 ) << 32 ) 
+		               ^ static_cast<unsigned long long int>( unif_rand() * 4294967296.0 );
+	PutRNGstate();
 
-		rates_bdmcmc_parallel( &rates[0], &log_ratio_g_prior[0], G, &index_row[0], &index_col[0], &sub_qp, Ds, &Dsijj[0], &sigma[0], &K[0], b, &dim );
-				
-		// Selecting multiple edges based on birth and death rates
-		select_multi_edges( &rates[0], &index_selected_edges[0], &size_index, &sum_rates, &multi_update_C, &sub_qp );
+	int threads_chains = 1, threads_rates = 1;
+	#ifdef _OPENMP
+		int max_threads    = omp_get_max_threads();
+		int max_levels     = omp_get_max_active_levels();
+		threads_chains     = ( n_chains_C < max_threads ) ? n_chains_C : max_threads;
+		threads_rates      = max_threads / threads_chains;
+		if( threads_rates < 1 ) threads_rates = 1;
+		omp_set_max_active_levels( 2 );
+	#endif
+
+	char *no_checkpoint = NULL;   // no checkpoint for the chains
+	int zero = 0;
+	
+	#pragma omp parallel for schedule( dynamic ) num_threads( threads_chains )
+	for( int chain = 0; chain < n_chains_C; chain++ )
+	{
+		#ifdef _OPENMP
+			omp_set_num_threads( threads_rates );
+		#endif
 
-// - - - Saving result - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |	
-		if( i_mcmc >= burn_in )
-		{
-			counter = 0;	
-			for( j = 1; j < dim; j++ )
-				for( i = 0; i < j; i++ )
-					char_g[ counter++ ] = G[ j * dim + i ] + '0'; 
+		chain_rng rng( seeds[ chain ] );
+		current_chain_rng() = &rng;
+		
+		int shift = chain * pxp;
+		if( multi_update_C == 1 )
+			ggm_bdmcmc_ma_sampler( iter, &burnin[ chain ], &G_chains[ shift ], g_prior, Ts, &K_chains[ shift ], p, threshold, 
+			                       &K_hat_chains[ shift ], &p_links_chains[ shift ], b, b_star, Ds, 
+			                       mcse_tol, &p_links_mcse_chains[ shift ], &iter_used[ chain ], time_budget, &timing[ 3 * chain ], 
+			                       &no_checkpoint, &zero, &zero, &print_chain );
+		else
+			ggm_bdmcmc_ma_multi_update_sampler( iter, &burnin[ chain ], &G_chains[ shift ], g_prior, Ts, &K_chains[ shift ], p, threshold, 
+			                                    &K_hat_chains[ shift ], &p_links_chains[ shift ], b, b_star, Ds, multi_update, 
+			                                    mcse_tol, &p_links_mcse_chains[ shift ], &iter_used[ chain ], time_budget, &timing[ 3 * chain ], 
+			                       &no_checkpoint, &zero, &zero, &print_chain );
+		
+		current_chain_rng() = NULL;
+	}
 
-			weight_C = 1.0 / sum_rates;
-			
-			//for( i = 0; i < pxp; i++ ) K_hat[i] += K[i] / sum_rates;
-			F77_NAME(daxpy)( &pxp, &weight_C, &K[0], &one, &K_hat[0], &one );			
+	#ifdef _OPENMP
+		omp_set_max_active_levels( max_levels );
+	#endif
+	if( *print <= 100 ) Rprintf( " %i chains done", n_chains_C );
 
-			string_g = string( char_g.begin(), char_g.end() );	
-			all_weights[ count_all_g ] = weight_C;
-			
-			this_one = false;
-			for( i = 0; i < size_sample_graph; i++ )
-				if( sample_graphs_C[ i ] == string_g )
-				{
-					graph_weights[ i ] += all_weights[ count_all_g ];
-					all_graphs[ count_all_g ] = i;
-					this_one = true;
-					break;
-				} 
-			
-			if( !this_one || size_sample_graph == 0 )
-			{
-				sample_graphs_C[ size_sample_graph ] = string_g;
-				graph_weights[size_sample_graph ]   = all_weights[ count_all_g ];
-				all_graphs[count_all_g ]            = size_sample_graph; 
-				size_sample_graph++;				
-			}
-			
-			count_all_g++; 
-			sum_weights += weight_C;
-		} 
-// - - - End of saving result - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -|	
-			
-		// Updating graph based on selected edges
-		for ( i = 0; i < size_index; i++ )
+	// number of saved iterations of the shortest chain, for R-hat
+	int n_saved = *iter;
+	for( int chain = 0; chain < n_chains_C; chain++ )
+		if( iter_used[ chain ] - burnin[ chain ] < n_saved ) n_saved = iter_used[ chain ] - burnin[ chain ];
+	
+	for( int i = 0; i < pxp; i++ )
+	{
+		double sum_p_links = 0.0, sum_K_hat = 0.0, sum_mcse2 = 0.0;
+		for( int chain = 0; chain < n_chains_C; chain++ )
 		{
-			selected_edge_i = index_row[ index_selected_edges[ i ] ];
-			selected_edge_j = index_col[ index_selected_edges[ i ] ];
-			
-			selected_edge_ij      = selected_edge_j * dim + selected_edge_i;
-			G[ selected_edge_ij ] = 1 - G[ selected_edge_ij ];
-			G[ selected_edge_i * dim + selected_edge_j ] = G[ selected_edge_ij ];
+			sum_p_links += p_links_chains[ chain * pxp + i ];
+			sum_K_hat   += K_hat_chains[ chain * pxp + i ];
+			sum_mcse2   += p_links_mcse_chains[ chain * pxp + i ] * p_links_mcse_chains[ chain * pxp + i ];
+		}
 		
-			if( G[ selected_edge_ij ] )
-			{ 
-				++size_node[ selected_edge_i ]; 
-				++size_node[ selected_edge_j ]; 
-			}else{ 
-				--size_node[ selected_edge_i ]; 
-				--size_node[ selected_edge_j ]; 
-			}		
+		p_links[ i ]      = sum_p_links / n_chains_C;
+		K_hat[ i ]        = sum_K_hat   / n_chains_C;
+		p_links_mcse[ i ] = sqrt( sum_mcse2 ) / n_chains_C;
+
+		// R-hat of the link indicator: within-chain variance W = mean of p ( 1 - p ), 
+		// and between-chain variance B / n = variance of the p_links of the chains
+		double within = 0.0, between = 0.0;
+		for( int chain = 0; chain < n_chains_C; chain++ )
+		{
+			double p_chain = p_links_chains[ chain * pxp + i ];
+			within  += p_chain * ( 1.0 - p_chain ) / n_chains_C;
+			between += ( p_chain - p_links[ i ] ) * ( p_chain - p_links[ i ] ) / ( n_chains_C - 1.0 );
 		}
 
-// - - - STEP 2: Sampling from G-Wishart for new graph - - - - - - - - - - - - - - - - - - - - - - |
-		rgwish_sigma( G, &size_node[0], Ts, K, &sigma[0], b_star, &dim, threshold, &sigma_start[0], &inv_C[0], &beta_star[0], &sigma_i[0], sigma_start_N_i, sigma_N_i, N_i );		
-	}  
-	PutRNGstate();
-// - - End of main loop for birth-death MCMC - - - - - - - - - - - - - - - - - - - - - - - - - - - | 
-
-	#pragma omp parallel for
-	for( i = 0; i < ( iteration - burn_in ); i++ ) 
-	{
-		sample_graphs_C[ i ].copy( sample_graphs[ i ], qp, 0 );
-		sample_graphs[ i ][ qp ] = '\0';
+		if( within > 0.0 )
+			rhat[ i ] = sqrt( ( ( n_saved - 1.0 ) / n_saved * within + between ) / within );
+		else
+			rhat[ i ] = ( between > 0.0 ) ? R_PosInf : 1.0;
 	}
-	
-	*size_sample_g = size_sample_graph;
-	*counter_all_g = count_all_g;
-	
-	#pragma omp parallel for
-	for( i = 0; i < pxp; i++ ) 
-		K_hat[ i ] /= sum_weights;		
 }
               
 } // End of exturn "C"
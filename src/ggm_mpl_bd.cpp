@@ -10,7 +10,8 @@
 //    Maintainer: Reza Mohammadi <a.mohammadi@uva.nl>                          |
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
 
-#include "matrix.h"
+#include "ggm_mpl_bd.h"
+#include "checkpoint.h"
 
 extern "C" {
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
@@ -50,18 +51,70 @@ void log_mpl( int *node, int mb_node[], int *size_node, double *log_mpl_node, do
 	}	
 }
     
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// log of the ratio of the MPL of the graph with edge ( i, j ) flipped to the MPL of G:
+// log_mpl of the new Markov blankets of nodes i and j minus their current log_mpl
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+static double log_ratio_mpl_edge( int i, int j, double curr_log_mpl[], int G[], int size_node[], 
+            int mb_node_i_new[], int mb_node_j_new[], double S_mb_node[], double S[], int *n, int dim )
+{
+	int t, nodexdim, count_mb, size_node_i_new, size_node_j_new;
+	double log_mpl_i_new, log_mpl_j_new;
+
+	if( G[ j * dim + i ] )
+	{ 
+		size_node_i_new = size_node[ i ] - 1; 
+		size_node_j_new = size_node[ j ] - 1; 
+
+		if( size_node_i_new > 0 )
+		{	
+			nodexdim = i * dim;
+			count_mb = 0; 
+			for( t = 0; t < dim; t++ ) 
+				if( G[ nodexdim + t ] and t != j ) mb_node_i_new[ count_mb++ ] = t;
+		}	
+		
+		if( size_node_j_new > 0 )
+		{						
+			nodexdim = j * dim;
+			count_mb = 0; 
+			for( t = 0; t < dim; t++ ) 
+				if( G[ nodexdim + t ] and t != i ) mb_node_j_new[ count_mb++ ] = t;
+		}	
+	}else{ 
+		size_node_i_new = size_node[ i ] + 1; 
+		size_node_j_new = size_node[ j ] + 1; 
+
+		nodexdim = i * dim;
+		count_mb = 0; 
+		for( t = 0; t < dim; t++ ) 
+			if( G[ nodexdim + t ] or t == j ) mb_node_i_new[ count_mb++ ] = t;
+
+		nodexdim = j * dim;
+		count_mb = 0; 
+		for( t = 0; t < dim; t++ ) 
+			if( G[ nodexdim + t ] or t == i ) mb_node_j_new[ count_mb++ ] = t;
+	}
+
+	log_mpl( &i, mb_node_i_new, &size_node_i_new, &log_mpl_i_new, S, S_mb_node, n, &dim );		
+	log_mpl( &j, mb_node_j_new, &size_node_j_new, &log_mpl_j_new, S, S_mb_node, n, &dim );		
+
+	return log_mpl_i_new + log_mpl_j_new - curr_log_mpl[ i ] - curr_log_mpl[ j ];
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
 // Computing birth-death rates for all the possible edges for ggm_mpl method
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
 void rates_ggm_mpl( double rates[], double log_ratio_g_prior[], double curr_log_mpl[], int G[], 
         int index_row[], int index_col[], int *sub_qp, int size_node[], double S[], int *n, int *p )
 {
+	profile_phase timer( run_profile::rates );
 	int dim = *p;
 
 	#pragma omp parallel
 	{
-		int i, j, ij, t, nodexdim, count_mb, size_node_i_new, size_node_j_new;
-		double log_mpl_i_new, log_mpl_j_new, log_rate_ij;
+		int i, j, ij;
+		double log_rate_ij;
 		
 		int *mb_node_i_new = new int[ dim ];           // For dynamic memory used
 		int *mb_node_j_new = new int[ dim ];           // For dynamic memory used
@@ -70,49 +123,12 @@ void rates_ggm_mpl( double rates[], double log_ratio_g_prior[], double curr_log_
 		#pragma omp for
 		for( int counter = 0; counter < *sub_qp; counter++ )
 		{
+			profile_work work;
 			i  = index_row[ counter ];
 			j  = index_col[ counter ];
 			ij = j * dim + i;
 
-			if( G[ ij ] )
-			{ 
-				size_node_i_new = size_node[ i ] - 1; 
-				size_node_j_new = size_node[ j ] - 1; 
-
-				if( size_node_i_new > 0 )
-				{	
-					nodexdim = i * dim;
-					count_mb = 0; 
-					for( t = 0; t < dim; t++ ) 
-						if( G[ nodexdim + t ] and t != j ) mb_node_i_new[ count_mb++ ] = t;
-				}	
-				
-				if( size_node_j_new > 0 )
-				{						
-					nodexdim = j * dim;
-					count_mb = 0; 
-					for( t = 0; t < dim; t++ ) 
-						if( G[ nodexdim + t ] and t != i ) mb_node_j_new[ count_mb++ ] = t;
-				}	
-			}else{ 
-				size_node_i_new = size_node[ i ] + 1; 
-				size_node_j_new = size_node[ j ] + 1; 
-
-				nodexdim = i * dim;
-				count_mb = 0; 
-				for( t = 0; t < dim; t++ ) 
-					if( G[ nodexdim + t ] or t == j ) mb_node_i_new[ count_mb++ ] = t;
-
-				nodexdim = j * dim;
-				count_mb = 0; 
-				for( t = 0; t < dim; t++ ) 
-					if( G[ nodexdim + t ] or t == i ) mb_node_j_new[ count_mb++ ] = t;
-			}
-
-			log_mpl( &i, mb_node_i_new, &size_node_i_new, &log_mpl_i_new, S, S_mb_node, n, &dim );		
-			log_mpl( &j, mb_node_j_new, &size_node_j_new, &log_mpl_j_new, S, S_mb_node, n, &dim );		
-																		
-			log_rate_ij = log_mpl_i_new + log_mpl_j_new - curr_log_mpl[ i ] - curr_log_mpl[ j ];
+			log_rate_ij = log_ratio_mpl_edge( i, j, curr_log_mpl, G, size_node, mb_node_i_new, mb_node_j_new, S_mb_node, S, n, dim );
 			log_rate_ij = ( G[ ij ] ) ? log_rate_ij - log_ratio_g_prior[ ij ] : log_rate_ij + log_ratio_g_prior[ ij ];
 			
 			rates[ counter ] = ( log_rate_ij < 0.0 ) ? exp( log_rate_ij ) : 1.0;
@@ -131,12 +147,13 @@ void local_rates_ggm_mpl( double rates[], double log_ratio_g_prior[], int *selec
             double curr_log_mpl[], int G[], int index_row[], int index_col[], int *sub_qp, 
             int size_node[], double S[], int *n, int *p )
 {
+	profile_phase timer( run_profile::rates );
 	int dim = *p;
 
 	#pragma omp parallel
 	{
-		int i, j, ij, t, nodexdim, count_mb, size_node_i_new, size_node_j_new;
-		double log_mpl_i_new, log_mpl_j_new, log_rate_ij;
+		int i, j, ij;
+		double log_rate_ij;
 		
 		int *mb_node_i_new = new int[ dim ];           // For dynamic memory used
 		int *mb_node_j_new = new int[ dim ];           // For dynamic memory used
@@ -145,51 +162,14 @@ void local_rates_ggm_mpl( double rates[], double log_ratio_g_prior[], int *selec
 		#pragma omp for
 		for( int counter = 0; counter < *sub_qp; counter++ )
 		{
+			profile_work work;
 			i  = index_row[ counter ];
 			j  = index_col[ counter ];
 			ij = j * dim + i;
 
 			if( ( i == *selected_edge_i ) or ( j == *selected_edge_j ) )
 			{
-				if( G[ ij ] )
-				{ 
-					size_node_i_new = size_node[ i ] - 1; 
-					size_node_j_new = size_node[ j ] - 1; 
-
-					if( size_node_i_new > 0 )
-					{	
-						nodexdim = i * dim;
-						count_mb = 0; 
-						for( t = 0; t < dim; t++ ) 
-							if( G[ nodexdim + t ] and t != j ) mb_node_i_new[ count_mb++ ] = t;
-					}	
-					
-					if( size_node_j_new > 0 )
-					{						
-						nodexdim = j * dim;
-						count_mb = 0; 
-						for( t = 0; t < dim; t++ ) 
-							if( G[ nodexdim + t ] and t != i ) mb_node_j_new[ count_mb++ ] = t;
-					}	
-				}else{ 
-					size_node_i_new = size_node[ i ] + 1; 
-					size_node_j_new = size_node[ j ] + 1; 
-
-					nodexdim = i * dim;
-					count_mb = 0; 
-					for( t = 0; t < dim; t++ ) 
-						if( G[ nodexdim + t ] or t == j ) mb_node_i_new[ count_mb++ ] = t;
-
-					nodexdim = j * dim;
-					count_mb = 0; 
-					for( t = 0; t < dim; t++ ) 
-						if( G[ nodexdim + t ] or t == i ) mb_node_j_new[ count_mb++ ] = t;
-				}
-
-				log_mpl( &i, mb_node_i_new, &size_node_i_new, &log_mpl_i_new, S, S_mb_node, n, &dim );		
-				log_mpl( &j, mb_node_j_new, &size_node_j_new, &log_mpl_j_new, S, S_mb_node, n, &dim );		
-																			
-				log_rate_ij = log_mpl_i_new + log_mpl_j_new - curr_log_mpl[ i ] - curr_log_mpl[ j ];
+				log_rate_ij = log_ratio_mpl_edge( i, j, curr_log_mpl, G, size_node, mb_node_i_new, mb_node_j_new, S_mb_node, S, n, dim );
 				log_rate_ij = ( G[ ij ] ) ? log_rate_ij - log_ratio_g_prior[ ij ] : log_rate_ij + log_ratio_g_prior[ ij ];
 				
 				rates[ counter ] = ( log_rate_ij < 0.0 ) ? exp( log_rate_ij ) : 1.0;
@@ -202,12 +182,52 @@ void local_rates_ggm_mpl( double rates[], double log_ratio_g_prior[], int *selec
 	}	
 }			
      
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// log of the MPL ratios of all the possible edges ( log_ratio_mpl_edge ), without
+// the graph prior; with *selected_edge_i >= 0 only the ones which change after
+// the move of edge ( selected_edge_i, selected_edge_j ): the edges of these two nodes.
+// It is for the tempered chains ( ggm_pt_bd.cpp ), where the rate of an edge is
+// min( 1, exp( beta * log_ratio_mpl -/+ log_ratio_g_prior ) ) for any beta.
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+void log_ratio_mpl_ggm( double log_ratio_mpl[], int *selected_edge_i, int *selected_edge_j, 
+            double curr_log_mpl[], int G[], int index_row[], int index_col[], int *sub_qp, 
+            int size_node[], double S[], int *n, int *p )
+{
+	profile_phase timer( run_profile::rates );
+	int dim = *p;
+
+	#pragma omp parallel
+	{
+		int i, j;
+		
+		int *mb_node_i_new = new int[ dim ];           // For dynamic memory used
+		int *mb_node_j_new = new int[ dim ];           // For dynamic memory used
+		double *S_mb_node  = new double[ dim * dim ];  // For dynamic memory used
+		
+		#pragma omp for
+		for( int counter = 0; counter < *sub_qp; counter++ )
+		{
+			profile_work work;
+			i  = index_row[ counter ];
+			j  = index_col[ counter ];
+
+			if( ( *selected_edge_i < 0 ) or ( i == *selected_edge_i ) or ( j == *selected_edge_i ) or ( i == *selected_edge_j ) or ( j == *selected_edge_j ) )
+				log_ratio_mpl[ counter ] = log_ratio_mpl_edge( i, j, curr_log_mpl, G, size_node, mb_node_i_new, mb_node_j_new, S_mb_node, S, n, dim );
+		}
+		
+		delete[] mb_node_i_new;
+		delete[] mb_node_j_new;
+		delete[] S_mb_node;
+	}	
+}			
+     
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
 // birth-death MCMC for Gaussian Graphical models with marginal pseudo-likelihood  
 // for Bayesian model averaging (MA)
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
 void ggm_bdmcmc_mpl_ma( int *iter, int *burnin, int G[], double g_prior[], 
-                        double S[], int *n, int *p, double p_links[] , int *print )
+                        double S[], int *n, int *p, double p_links[], 
+                        char **checkpoint_file, int *checkpoint_every, int *resume, int *print )
 {
 	int print_c = *print, iteration = *iter, burn_in = *burnin, copy_n = *n;
 	int index_selected_edge, selected_edge_i, selected_edge_j, selected_edge_ij;
@@ -260,8 +280,7 @@ void ggm_bdmcmc_mpl_ma( int *iter, int *burnin, int G[], double g_prior[],
 	for( j = 1; j < dim; j++ )
 		for( i = 0; i < j; i++ )
 		{
-		    ij = g_prior[ j * dim + i ];
-		    if( ( ij != 0.0 ) or ( ij != 1.0 ) )
+		    if( ( g_prior[ j * dim + i ] != 0.0 ) and ( g_prior[ j * dim + i ] != 1.0 ) )
 		    {
     			index_row[ counter ] = i;
     			index_col[ counter ] = j;
@@ -274,15 +293,24 @@ void ggm_bdmcmc_mpl_ma( int *iter, int *burnin, int G[], double g_prior[],
 	// calculating all the birth and death rates 
 	rates_ggm_mpl( &rates[0], &log_ratio_g_prior[0], &curr_log_mpl[0], G, &index_row[0], &index_col[0], &sub_qp, &size_node[0], &copyS[0], &copy_n, &dim );
 
+	// checkpoint of the run ( checkpoint.h ); the rates are updated locally, so they are in the state
+	checkpoint ckpt( *checkpoint_file, *checkpoint_every, "ggm_bdmcmc_mpl_ma", dim );
+	ckpt.add( G, pxp );
+	ckpt.add( &size_node[0], dim );
+	ckpt.add( &curr_log_mpl[0], dim );
+	ckpt.add( &rates[0], sub_qp );
+	ckpt.add( &p_links_Cpp[0], pxp );
+	ckpt.add( &sum_weights, 1 );
+
 // - - main loop for birth-death MCMC sampling algorithm - - - - - - - - - - - - - - - - - - - - - |
 	GetRNGstate();
-	int print_conter = 0;
-	for( int i_mcmc = 0; i_mcmc < iteration; i_mcmc++ )
+	int i_start = ( *resume ) ? ckpt.resume( &iteration, &burn_in ) : 0;
+	int print_conter = ( print_c * iteration >= 100 ) ? i_start / ( ( print_c * iteration ) / 100 ) : 0;
+	for( int i_mcmc = i_start; i_mcmc < iteration; i_mcmc++ )
 	{
-		if( ( i_mcmc + 1 ) % ( ( print_c * iteration ) / 100 ) == 0 ){
-		    ++print_conter;
-		    ( ( i_mcmc + 1 ) != iteration ) ? Rprintf( "%i%%->", print_c * print_conter ) : Rprintf( " done" );
-		}
+		if( ckpt.due( i_mcmc ) ) ckpt.save( i_mcmc, iteration, burn_in );
+		
+		print_progress( i_mcmc + 1, iteration, print_c, &print_conter );
 	  						
 		// Selecting an edge based on birth and death rates
 		select_edge( &rates[0], &index_selected_edge, &sum_rates, &sub_qp );
@@ -340,12 +368,16 @@ void ggm_bdmcmc_mpl_ma( int *iter, int *burnin, int G[], double g_prior[],
 		
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
 	} 
+	ckpt.save( iteration, iteration, burn_in );
 	PutRNGstate();
 // - - - End of MCMC sampling algorithm - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -|
 
 	#pragma omp parallel for
 	for( i = 0; i < pxp; i++ )
 		p_links[ i ] = p_links_Cpp[ i ] / sum_weights;
+	
+	*iter   = iteration;
+	*burnin = burn_in;
 }
        
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
@@ -412,8 +444,7 @@ void ggm_bdmcmc_mpl_map( int *iter, int *burnin, int G[], double g_prior[],
 	for( j = 1; j < dim; j++ )
 	    for( i = 0; i < j; i++ )
 	    {
-	        ij = g_prior[ j * dim + i ];
-	        if( ( ij != 0.0 ) or ( ij != 1.0 ) )
+	        if( ( g_prior[ j * dim + i ] != 0.0 ) and ( g_prior[ j * dim + i ] != 1.0 ) )
 	        {
 	            index_row[ counter ] = i;
 	            index_col[ counter ] = j;
@@ -431,10 +462,7 @@ void ggm_bdmcmc_mpl_map( int *iter, int *burnin, int G[], double g_prior[],
 	int print_conter = 0;
 	for( int i_mcmc = 0; i_mcmc < iteration; i_mcmc++ )
 	{
-		if( ( i_mcmc + 1 ) % ( ( print_c * iteration ) / 100 ) == 0 ){
-		    ++print_conter;
-		    ( ( i_mcmc + 1 ) != iteration ) ? Rprintf( "%i%%->", print_c * print_conter ) : Rprintf( " done" );
-		}
+		print_progress( i_mcmc + 1, iteration, print_c, &print_conter );
 	  						
 		// Selecting an edge based on birth and death rates
 		select_edge( &rates[0], &index_selected_edge, &sum_rates, &sub_qp );
@@ -585,8 +613,7 @@ void ggm_bdmcmc_mpl_ma_multi_update( int *iter, int *burnin, int G[], double g_p
 	for( j = 1; j < dim; j++ )
 	    for( i = 0; i < j; i++ )
 	    {
-	        ij = g_prior[ j * dim + i ];
-	        if( ( ij != 0.0 ) or ( ij != 1.0 ) )
+	        if( ( g_prior[ j * dim + i ] != 0.0 ) and ( g_prior[ j * dim + i ] != 1.0 ) )
 	        {
 	            index_row[ counter ] = i;
 	            index_col[ counter ] = j;
@@ -604,10 +631,7 @@ void ggm_bdmcmc_mpl_ma_multi_update( int *iter, int *burnin, int G[], double g_p
 	int print_conter = 0;
 	for( int i_mcmc = 0; i_mcmc < iteration; i_mcmc += size_index )
 	{
-		if( ( i_mcmc + size_index ) % ( ( print_c * iteration ) / 100 ) == 0 ){
-		    ++print_conter;
-		    ( ( i_mcmc + size_index ) != iteration ) ? Rprintf( "%i%%->", print_c * print_conter ) : Rprintf( " done" );
-		}
+		print_progress( i_mcmc + size_index, iteration, print_c, &print_conter );
 	 				
 // - - - STEP 1: calculating birth and death rates - - - - - - - - - - - - - - - - - - - - - - - - |
 				
@@ -752,8 +776,7 @@ void ggm_bdmcmc_mpl_map_multi_update( int *iter, int *burnin, int G[], double g_
 	for( j = 1; j < dim; j++ )
 	    for( i = 0; i < j; i++ )
 	    {
-	        ij = g_prior[ j * dim + i ];
-	        if( ( ij != 0.0 ) or ( ij != 1.0 ) )
+	        if( ( g_prior[ j * dim + i ] != 0.0 ) and ( g_prior[ j * dim + i ] != 1.0 ) )
 	        {
 	            index_row[ counter ] = i;
 	            index_col[ counter ] = j;
@@ -771,10 +794,7 @@ void ggm_bdmcmc_mpl_map_multi_update( int *iter, int *burnin, int G[], double g_
 	int print_conter = 0;
 	for( int i_mcmc = 0; i_mcmc < iteration; i_mcmc += size_index )
 	{
-		if( ( i_mcmc + size_index ) % ( ( print_c * iteration ) / 100 ) == 0 ){
-		    ++print_conter;
-		    ( ( i_mcmc + size_index ) != iteration ) ? Rprintf( "%i%%->", print_c * print_conter ) : Rprintf( " done" );
-		}
+		print_progress( i_mcmc + size_index, iteration, print_c, &print_conter );
 	 				
 // - - - STEP 1: calculating birth and death rates - - - - - - - - - - - - - - - - - - - - - - - - |
 				
@@ -889,6 +909,7 @@ void ggm_bdmcmc_mpl_map_multi_update( int *iter, int *burnin, int G[], double g_
 void log_alpha_rjmcmc_ggm_mpl( double *log_alpha_ij, double log_ratio_g_prior[], int *i, int *j, 
                         double curr_log_mpl[], int G[], int size_node[], double S[], int *n, int *p )
 {
+	profile_phase timer( run_profile::rates );
 	int t, nodexdim, dim = *p, count_mb, size_node_i_new, size_node_j_new;
 	double log_mpl_i_new, log_mpl_j_new;
 
@@ -997,8 +1018,7 @@ void ggm_rjmcmc_mpl_ma( int *iter, int *burnin, int G[], double g_prior[],
 	for( j = 1; j < dim; j++ )
 	    for( i = 0; i < j; i++ )
 	    {
-	        ij = g_prior[ j * dim + i ];
-	        if( ( ij != 0.0 ) or ( ij != 1.0 ) )
+	        if( ( g_prior[ j * dim + i ] != 0.0 ) and ( g_prior[ j * dim + i ] != 1.0 ) )
 	        {
 	            index_row[ counter ] = i;
 	            index_col[ counter ] = j;
@@ -1012,10 +1032,7 @@ void ggm_rjmcmc_mpl_ma( int *iter, int *burnin, int G[], double g_prior[],
 	int print_conter = 0;
 	for( int i_mcmc = 0; i_mcmc < iteration; i_mcmc++ )
 	{
-		if( ( i_mcmc + 1 ) % ( ( print_c * iteration ) / 100 ) == 0 ){
-		    ++print_conter;
-		    ( ( i_mcmc + 1 ) != iteration ) ? Rprintf( "%i%%->", print_c * print_conter ) : Rprintf( " done" );
-		}
+		print_progress( i_mcmc + 1, iteration, print_c, &print_conter );
 	  				
 // - - - STEP 1: selecting edge and calculating alpha - - - - - - - - - - - - - - - - - - - - - - -|		
 		// Randomly selecting one edge: NOTE qp = p * ( p - 1 ) / 2 
@@ -1146,8 +1163,7 @@ void ggm_rjmcmc_mpl_map( int *iter, int *burnin, int G[], double g_prior[], doub
 	for( j = 1; j < dim; j++ )
 	    for( i = 0; i < j; i++ )
 	    {
-	        ij = g_prior[ j * dim + i ];
-	        if( ( ij != 0.0 ) or ( ij != 1.0 ) )
+	        if( ( g_prior[ j * dim + i ] != 0.0 ) and ( g_prior[ j * dim + i ] != 1.0 ) )
 	        {
 	            index_row[ counter ] = i;
 	            index_col[ counter ] = j;
@@ -1161,10 +1177,7 @@ void ggm_rjmcmc_mpl_map( int *iter, int *burnin, int G[], double g_prior[], doub
 	int print_conter = 0;
 	for( int i_mcmc = 0; i_mcmc < iteration; i_mcmc++ )
 	{
-		if( ( i_mcmc + 1 ) % ( ( print_c * iteration ) / 100 ) == 0 ){
-		    ++print_conter;
-		    ( ( i_mcmc + 1 ) != iteration ) ? Rprintf( "%i%%->", print_c * print_conter ) : Rprintf( " done" );
-		}
+		print_progress( i_mcmc + 1, iteration, print_c, &print_conter );
 	  				
 // - - - STEP 1: selecting edge and calculating alpha - - - - - - - - - - - - - - - - - - - - - - -|		
 		// Randomly selecting one edge: NOTE qp = p * ( p - 1 ) / 2 
@@ -0,0 +1,27 @@
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+//     Copyright (C) 2012 - 2022  Reza Mohammadi                                                   |
+//                                                                                                 |
+//     This file is part of BDgraph package.                                                       |
+//                                                                                                 |
+//     BDgraph is free software: you can redistribute it and/or modify it under                    |
+//     the terms of the GNU General Public License as published by the Free                        |
+//     Software Foundation; see <https://cran.r-project.org/web/licenses/GPL-3>.                   |
+//                                                                                                 |
+//     Maintainer: Reza Mohammadi <a.mohammadi@uva.nl>                                             |
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+  
+#ifndef ggm_mpl_bd_H
+#define ggm_mpl_bd_H
+
+#include "matrix.h"
+
+extern "C" {
+	void log_mpl( int *node, int mb_node[], int *size_node, double *log_mpl_node, double S[], 
+	              double S_mb_node[], int *n, int *p );
+
+	void log_ratio_mpl_ggm( double log_ratio_mpl[], int *selected_edge_i, int *selected_edge_j, 
+	              double curr_log_mpl[], int G[], int index_row[], int index_col[], int *sub_qp, 
+	              int size_node[], double S[], int *n, int *p );
+}
+
+#endif
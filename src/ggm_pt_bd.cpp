@@ -0,0 +1,632 @@
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+//    Copyright (C) 2012 - 2022  Reza Mohammadi                                |
+//                                                                             |
+//    This file is part of BDgraph package.                                    |
+//                                                                             |
+//   BDgraph is a free software: you can redistribute it and/or modify it      |
+//   under the terms of the GNU General Public License as published by the Free|
+//   Software Foundation; see <https://cran.r-project.org/web/licenses/GPL-3>. |
+//                                                                             |
+//   Maintainer: Reza Mohammadi <a.mohammadi@uva.nl>                           |
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+
+#include "matrix.h"
+#include "rgwish.h"
+#include "ggm_mpl_bd.h"
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// Posterior of the tempered chain with inverse temperature beta: the likelihood
+// to the power beta is the likelihood of n_beta = beta * n data with scatter
+// matrix beta * S, so the chain is a birth-death MCMC with Ds = D + beta * S
+// and b_star = b + n_beta. Here n_beta is rounded, and beta = n_beta / n.
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+static void set_temperature( double *beta, int *b_star, double Ds[], double Ts[], double Dsijj[],
+                             double S[], double D[], int *n, int *b, int *p )
+{
+	int dim = *p, pxp = dim * dim, n_beta = static_cast<int>( *beta * *n + 0.5 );
+	double beta_C = static_cast<double>( n_beta ) / *n;
+
+	*beta   = beta_C;
+	*b_star = *b + n_beta;
+
+	for( int i = 0; i < pxp; i++ ) Ds[ i ] = D[ i ] + beta_C * S[ i ];
+
+	// Ts = chol( solve( Ds ) )
+	vector<double> copyDs( Ds, Ds + pxp );
+	vector<double> inv_Ds( pxp );
+	inverse( &copyDs[0], &inv_Ds[0], &dim );
+	cholesky( &inv_Ds[0], Ts, &dim );
+
+	for( int j = 1; j < dim; j++ )
+		for( int i = 0; i < j; i++ )
+			Dsijj[ j * dim + i ] = Ds[ j * dim + i ] * Ds[ j * dim + i ] / Ds[ j * dim + j ];
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// log-likelihood of precision matrix K: ( n * log|K| - trace( S %*% K ) ) / 2
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+static double log_likelihood( double K[], double S[], int *n, int *p )
+{
+	char uplo = 'U';
+	int info, dim = *p, pxp = dim * dim, dim1 = dim + 1;
+
+	vector<double> chol_K( K, K + pxp );
+	F77_NAME(dpotrf)( &uplo, &dim, &chol_K[0], &dim, &info FCONE );
+
+	double log_det_K = 0.0, trace_SK = 0.0;
+	for( int i = 0; i < dim; i++ ) log_det_K += 2.0 * log( chol_K[ i * dim1 ] );
+	for( int i = 0; i < pxp; i++ ) trace_SK  += S[ i ] * K[ i ];
+
+	return 0.5 * ( *n * log_det_K - trace_SK );
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// birth-death rates of the MPL chain with inverse temperature beta, from the
+// log MPL ratios of the edges ( log_ratio_mpl_ggm ): the MPL to the power beta
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+static void rates_mpl_tempered( double rates[], double log_ratio_mpl[], double log_ratio_g_prior[], int G[], 
+                                int index_row[], int index_col[], int sub_qp, double beta, int dim )
+{
+	for( int counter = 0; counter < sub_qp; counter++ )
+	{
+		int ij = index_col[ counter ] * dim + index_row[ counter ];
+
+		double log_rate = beta * log_ratio_mpl[ counter ];
+		log_rate = ( G[ ij ] ) ? log_rate - log_ratio_g_prior[ ij ] : log_rate + log_ratio_g_prior[ ij ];
+
+		rates[ counter ] = ( log_rate < 0.0 ) ? exp( log_rate ) : 1.0;
+	}
+}
+
+extern "C" {
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// Parallel tempering ( replica exchange ) birth-death MCMC for Gaussian
+// Graphical models; it is for Bayesian model averaging (MA)
+// The tempered chains run in parallel, each with its own random stream
+// ( chain_rng.h ), and after each 'swap_every' iterations the states of the
+// neighbour chains are swapped. Only the cold chain ( beta = 1 ) is saved.
+// The swap is an MH step for the jump chains, so its ratio includes the sums
+// of the birth/death rates of the two states at the two temperatures.
+// G_temps, K_temps: p x p x n_temps, starting states and last states
+// betas: inverse temperatures, betas[ 0 ] = 1; with 'adapt' the spacing of the
+// temperatures is adapted in burn-in to the swap acceptance of 0.234
+// swap_accept: acceptance rate of the swaps of each neighbour pair after burn-in
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+void ggm_bdmcmc_ma_pt( int *iter, int *burnin, int G_temps[], double g_prior[], double S[], double K_temps[],
+                       int *p, int *n, double *threshold, double K_hat[], double p_links[],
+                       double betas[], int *adapt, double swap_accept[], int *b, double D[], int *n_temps, int *print )
+{
+	int print_c = *print, iteration = *iter, burn_in = *burnin, n_temps_C = *n_temps;
+	int counter = 0, i, j, ij, one = 1, dim = *p, pxp = dim * dim;
+	int qp = dim * ( dim - 1 ) / 2, swap_every = 10;
+	double sum_weights = 0.0;
+
+	vector<double> p_links_Cpp( pxp, 0.0 );
+	vector<double> K_hat_Cpp( pxp, 0.0 );
+
+	// For finding the index of rates
+	vector<int> index_row( qp );
+	vector<int> index_col( qp );
+	for( j = 1; j < dim; j++ )
+		for( i = 0; i < j; i++ )
+		{
+		    ij = j * dim + i;
+
+			if( ( g_prior[ ij ] != 0.0 ) and ( g_prior[ ij ] != 1.0 ) )
+			{
+    			index_row[ counter ] = i;
+    			index_col[ counter ] = j;
+    			counter++;
+			}
+		}
+	int sub_qp = counter;
+
+	vector<double> log_ratio_g_prior( pxp );
+	for( j = 1; j < dim; j++ )
+		for( i = 0; i < j; i++ )
+		{
+			ij = j * dim + i;
+			log_ratio_g_prior[ ij ] = log( static_cast<double>( g_prior[ ij ] / ( 1 - g_prior[ ij ] ) ) );
+		}
+
+	// - - states and temperatures of the chains; chain 'temp' is in [ temp * pxp ]
+	vector<int> b_star( n_temps_C );
+	vector<double> Ds( pxp * n_temps_C );
+	vector<double> Ts( pxp * n_temps_C );
+	vector<double> Dsijj( pxp * n_temps_C, 0.0 );
+	vector<double> sigma( pxp * n_temps_C );
+	vector<double> rates( sub_qp * n_temps_C );
+	vector<double> sum_rates( n_temps_C );
+	vector<int> size_node( dim * n_temps_C, 0 );
+
+	vector<double> copyK( pxp );
+	for( int temp = 0; temp < n_temps_C; temp++ )
+	{
+		set_temperature( &betas[ temp ], &b_star[ temp ], &Ds[ temp * pxp ], &Ts[ temp * pxp ], &Dsijj[ temp * pxp ], S, D, n, b, &dim );
+
+		memcpy( &copyK[0], &K_temps[ temp * pxp ], sizeof( double ) * pxp );
+		inverse( &copyK[0], &sigma[ temp * pxp ], &dim );
+
+		for( i = 0; i < dim; i++ )
+			for( j = 0; j < dim; j++ ) size_node[ temp * dim + i ] += G_temps[ temp * pxp + i * dim + j ];
+
+		rates_bdmcmc_parallel( &rates[ temp * sub_qp ], &log_ratio_g_prior[0], &G_temps[ temp * pxp ], &index_row[0], &index_col[0], &sub_qp,
+		                       &Ds[ temp * pxp ], &Dsijj[ temp * pxp ], &sigma[ temp * pxp ], &K_temps[ temp * pxp ], b, &dim );
+	}
+
+	// for adapting the temperatures: rho[ temp ] = log( 1 / betas[ temp + 1 ] - 1 / betas[ temp ] )
+	vector<double> rho( n_temps_C, 0.0 );
+	for( int temp = 0; temp < n_temps_C - 1; temp++ )
+	{
+		double gap = 1.0 / betas[ temp + 1 ] - 1.0 / betas[ temp ];
+		rho[ temp ] = log( ( gap > 1e-3 ) ? gap : 1e-3 );   // after rounding, two betas can be the same
+	}
+
+	vector<double> cross_rates( sub_qp * 2 );
+	vector<double> log_lik( n_temps_C );
+	vector<int> n_swaps( n_temps_C, 0 );
+	vector<int> n_accept( n_temps_C, 0 );
+
+	// - - random streams of the chains, seeds from the RNG of R
+	GetRNGstate();
+	vector<chain_rng> rngs;
+	for( int temp = 0; temp < n_temps_C; temp++ )
+		rngs.push_back( chain_rng( ( static_cast<unsigned long long int>( unif_rand() * 4294967296.0 ) << 32 )
+		                           ^ static_cast<unsigned long long int>( unif_rand() * 4294967296.0 ) ) );
+
+	int threads_chains = 1, threads_rates = 1;
+	#ifdef _OPENMP
+		int max_threads    = omp_get_max_threads();
+		int max_levels     = omp_get_max_active_levels();
+		threads_chains     = ( n_temps_C < max_threads ) ? n_temps_C : max_threads;
+		threads_rates      = max_threads / threads_chains;
+		if( threads_rates < 1 ) threads_rates = 1;
+		omp_set_max_active_levels( 2 );
+	#endif
+
+// - - Main loop for birth-death MCMC - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -|
+	int print_conter = 0, swap_step = 0;
+	for( int i_mcmc = 0; i_mcmc < iteration; i_mcmc += swap_every )
+	{
+		int size_block = ( iteration - i_mcmc < swap_every ) ? iteration - i_mcmc : swap_every;
+
+		#pragma omp parallel for schedule( dynamic ) num_threads( threads_chains )
+		for( int temp = 0; temp < n_temps_C; temp++ )
+		{
+			#ifdef _OPENMP
+				omp_set_num_threads( threads_rates );
+			#endif
+			current_chain_rng() = &rngs[ temp ];
+
+			int index_selected_edge, selected_edge_i, selected_edge_j, selected_edge_ij;
+			int *G = &G_temps[ temp * pxp ];
+			double *K = &K_temps[ temp * pxp ], weight_C;
+
+			// - - allocation for rgwish_sigma
+			vector<double> sigma_start( pxp );
+			vector<double> inv_C( pxp );
+			vector<double> beta_star( dim );
+			vector<double> sigma_i( dim );
+			vector<double> sigma_start_N_i( dim );   // For dynamic memory used
+			vector<double> sigma_N_i( pxp );         // For dynamic memory used
+			vector<int> N_i( dim );                  // For dynamic memory used
+			// - - - - - - - - - - - - - -
+
+			for( int i_block = i_mcmc; i_block < i_mcmc + size_block; i_block++ )
+			{
+				// Selecting an edge based on birth and death rates of the current state
+				select_edge( &rates[ temp * sub_qp ], &index_selected_edge, &sum_rates[ temp ], &sub_qp );
+				selected_edge_i = index_row[ index_selected_edge ];
+				selected_edge_j = index_col[ index_selected_edge ];
+
+// - - - saving result of the cold chain - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+				if( ( temp == 0 ) and ( i_block >= burn_in ) )
+				{
+					weight_C = 1.0 / sum_rates[ 0 ];
+
+					// K_hat_Cpp[i] += K[i] * weight_C;
+					F77_NAME(daxpy)( &pxp, &weight_C, &K[0], &one, &K_hat_Cpp[0], &one );
+
+					for( int k = 0; k < pxp; k++ )
+						if( G[ k ] ) p_links_Cpp[ k ] += weight_C;
+
+					sum_weights += weight_C;
+				}
+// - - - End of saving result - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -|
+
+				// Updating G (graph) based on selected edge
+				selected_edge_ij    = selected_edge_j * dim + selected_edge_i;
+				G[ selected_edge_ij ] = 1 - G[ selected_edge_ij ];
+				G[ selected_edge_i * dim + selected_edge_j ] = G[ selected_edge_ij ];
+
+				if( G[ selected_edge_ij ] )
+				{
+					++size_node[ temp * dim + selected_edge_i ];
+					++size_node[ temp * dim + selected_edge_j ];
+				}else{
+					--size_node[ temp * dim + selected_edge_i ];
+					--size_node[ temp * dim + selected_edge_j ];
+				}
+
+				// Sampling from G-Wishart for new graph, and the birth and death rates of the new state
+				rgwish_sigma( G, &size_node[ temp * dim ], &Ts[ temp * pxp ], K, &sigma[ temp * pxp ], &b_star[ temp ], &dim, threshold,
+				              &sigma_start[0], &inv_C[0], &beta_star[0], &sigma_i[0], sigma_start_N_i, sigma_N_i, N_i );
+
+				rates_bdmcmc_parallel( &rates[ temp * sub_qp ], &log_ratio_g_prior[0], G, &index_row[0], &index_col[0], &sub_qp,
+				                       &Ds[ temp * pxp ], &Dsijj[ temp * pxp ], &sigma[ temp * pxp ], K, b, &dim );
+			}
+
+			current_chain_rng() = NULL;
+		}
+
+		if( print_c <= 100 )
+			while( ( ( print_c * iteration ) / 100 > 0 ) and ( ( print_conter + 1 ) * ( ( print_c * iteration ) / 100 ) <= i_mcmc + size_block ) )
+			{
+				++print_conter;
+				( ( print_conter * ( ( print_c * iteration ) / 100 ) ) != iteration ) ? Rprintf( "%i%%->", print_c * print_conter ) : Rprintf( " done" );
+			}
+
+// - - - Swapping the states of the neighbour chains - - - - - - - - - - - - - - - - - - - - - - - |
+		if( n_temps_C == 1 ) continue;
+
+		for( int temp = 0; temp < n_temps_C; temp++ )
+		{
+			double sum = 0.0;
+			for( int e = 0; e < sub_qp; e++ ) sum += rates[ temp * sub_qp + e ];
+			sum_rates[ temp ] = sum;
+			log_lik[ temp ]   = log_likelihood( &K_temps[ temp * pxp ], S, n, &dim );
+		}
+
+		double gamma_adapt = 1.0 / pow( swap_step + 1.0, 0.6 );
+		bool adapting = ( *adapt == 1 ) and ( i_mcmc + size_block <= burn_in );
+
+		// even pairs ( 0, 1 ), ( 2, 3 ), ... and odd pairs ( 1, 2 ), ( 3, 4 ), ... in turn
+		for( int temp = swap_step % 2; temp < n_temps_C - 1; temp += 2 )
+		{
+			int temp1 = temp + 1;
+
+			// rates of the state of chain temp1 at temperature of chain temp, and vice versa
+			rates_bdmcmc_parallel( &cross_rates[0], &log_ratio_g_prior[0], &G_temps[ temp1 * pxp ], &index_row[0], &index_col[0], &sub_qp,
+			                       &Ds[ temp * pxp ], &Dsijj[ temp * pxp ], &sigma[ temp1 * pxp ], &K_temps[ temp1 * pxp ], b, &dim );
+			rates_bdmcmc_parallel( &cross_rates[ sub_qp ], &log_ratio_g_prior[0], &G_temps[ temp * pxp ], &index_row[0], &index_col[0], &sub_qp,
+			                       &Ds[ temp1 * pxp ], &Dsijj[ temp1 * pxp ], &sigma[ temp * pxp ], &K_temps[ temp * pxp ], b, &dim );
+
+			double sum_cross = 0.0, sum_cross1 = 0.0;
+			for( int e = 0; e < sub_qp; e++ )
+			{
+				sum_cross  += cross_rates[ e ];
+				sum_cross1 += cross_rates[ sub_qp + e ];
+			}
+
+			double log_alpha = ( betas[ temp ] - betas[ temp1 ] ) * ( log_lik[ temp1 ] - log_lik[ temp ] )
+			                   + log( sum_cross ) + log( sum_cross1 ) - log( sum_rates[ temp ] ) - log( sum_rates[ temp1 ] );
+
+			bool accept = ( log( unif_rand() ) < log_alpha );
+			if( accept )
+			{
+				std::swap_ranges( &G_temps[ temp * pxp ], &G_temps[ temp * pxp ] + pxp, &G_temps[ temp1 * pxp ] );
+				std::swap_ranges( &K_temps[ temp * pxp ], &K_temps[ temp * pxp ] + pxp, &K_temps[ temp1 * pxp ] );
+				std::swap_ranges( &sigma[ temp * pxp ]  , &sigma[ temp * pxp ] + pxp  , &sigma[ temp1 * pxp ] );
+				std::swap_ranges( &size_node[ temp * dim ], &size_node[ temp * dim ] + dim, &size_node[ temp1 * dim ] );
+
+				memcpy( &rates[ temp * sub_qp ] , &cross_rates[0]     , sizeof( double ) * sub_qp );
+				memcpy( &rates[ temp1 * sub_qp ], &cross_rates[ sub_qp ], sizeof( double ) * sub_qp );
+			}
+
+			if( i_mcmc >= burn_in )
+			{
+				++n_swaps[ temp ];
+				if( accept ) ++n_accept[ temp ];
+			}
+
+			if( adapting ) rho[ temp ] += gamma_adapt * ( ( ( log_alpha < 0.0 ) ? exp( log_alpha ) : 1.0 ) - 0.234 );
+		}
+
+		if( adapting )
+		{
+			double temperature = 1.0;
+			for( int temp = 1; temp < n_temps_C; temp++ )
+			{
+				temperature += exp( rho[ temp - 1 ] );
+
+				int b_star_old = b_star[ temp ];
+				betas[ temp ]  = 1.0 / temperature;
+				set_temperature( &betas[ temp ], &b_star[ temp ], &Ds[ temp * pxp ], &Ts[ temp * pxp ], &Dsijj[ temp * pxp ], S, D, n, b, &dim );
+
+				// rounding of n_beta: the chain changes only if b_star changes
+				if( b_star[ temp ] != b_star_old )
+					rates_bdmcmc_parallel( &rates[ temp * sub_qp ], &log_ratio_g_prior[0], &G_temps[ temp * pxp ], &index_row[0], &index_col[0], &sub_qp,
+					                       &Ds[ temp * pxp ], &Dsijj[ temp * pxp ], &sigma[ temp * pxp ], &K_temps[ temp * pxp ], b, &dim );
+			}
+		}
+
+		++swap_step;
+	}
+	PutRNGstate();
+// - - End of main loop for birth-death MCMC - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+
+	#ifdef _OPENMP
+		omp_set_max_active_levels( max_levels );
+	#endif
+
+	for( int temp = 0; temp < n_temps_C - 1; temp++ )
+		swap_accept[ temp ] = ( n_swaps[ temp ] > 0 ) ? static_cast<double>( n_accept[ temp ] ) / n_swaps[ temp ] : 0.0;
+
+	#pragma omp parallel for
+	for( i = 0; i < pxp; i++ )
+	{
+		p_links[ i ] = p_links_Cpp[ i ] / sum_weights;
+		K_hat[ i ]   = K_hat_Cpp[ i ]   / sum_weights;
+	}
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// Parallel tempering birth-death MCMC for Gaussian Graphical models with
+// marginal pseudo-likelihood; it is for Bayesian model averaging (MA)
+// The chain with inverse temperature beta has the MPL to the power beta, so
+// its rates are from the log MPL ratios of the edges times beta. The chains,
+// swaps, and adaptation of the temperatures are as in 'ggm_bdmcmc_ma_pt', with
+// the log MPL of the graph in place of the log-likelihood of K.
+// G_temps: p x p x n_temps, starting graphs and last graphs
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+void ggm_bdmcmc_mpl_ma_pt( int *iter, int *burnin, int G_temps[], double g_prior[], double S[], int *n, int *p, 
+                           double p_links[], double betas[], int *adapt, double swap_accept[], int *n_temps, int *print )
+{
+	int print_c = *print, iteration = *iter, burn_in = *burnin, n_temps_C = *n_temps;
+	int counter = 0, i, j, ij, dim = *p, pxp = dim * dim;
+	int qp = dim * ( dim - 1 ) / 2, swap_every = 10, all_edges = -1;
+	double sum_weights = 0.0;
+
+	vector<double> p_links_Cpp( pxp, 0.0 );
+
+	// For finding the index of rates
+	vector<int> index_row( qp );
+	vector<int> index_col( qp );
+	for( j = 1; j < dim; j++ )
+		for( i = 0; i < j; i++ )
+		{
+		    ij = j * dim + i;
+
+			if( ( g_prior[ ij ] != 0.0 ) and ( g_prior[ ij ] != 1.0 ) )
+			{
+    			index_row[ counter ] = i;
+    			index_col[ counter ] = j;
+    			counter++;
+			}
+		}
+	int sub_qp = counter;
+
+	vector<double> log_ratio_g_prior( pxp );
+	for( j = 1; j < dim; j++ )
+		for( i = 0; i < j; i++ )
+		{
+			ij = j * dim + i;
+			log_ratio_g_prior[ ij ] = log( static_cast<double>( g_prior[ ij ] / ( 1 - g_prior[ ij ] ) ) );
+		}
+
+	// - - states of the chains; chain 'temp' is in [ temp * pxp ], [ temp * dim ], and [ temp * sub_qp ]
+	vector<int> size_node( dim * n_temps_C, 0 );
+	vector<double> curr_log_mpl( dim * n_temps_C );
+	vector<double> log_ratio_mpl( sub_qp * n_temps_C );
+	vector<double> rates( sub_qp * n_temps_C );
+	vector<double> sum_rates( n_temps_C );
+
+	vector<int> mb_node( dim );
+	vector<double> S_mb_node( pxp );
+	for( int temp = 0; temp < n_temps_C; temp++ )
+	{
+		int *G = &G_temps[ temp * pxp ];
+
+		for( i = 0; i < dim; i++ )
+		{
+			for( j = 0; j < dim; j++ ) size_node[ temp * dim + i ] += G[ i * dim + j ];
+
+			int count_mb = 0;
+			for( j = 0; j < dim; j++ )
+				if( G[ i * dim + j ] ) mb_node[ count_mb++ ] = j;
+
+			log_mpl( &i, &mb_node[0], &size_node[ temp * dim + i ], &curr_log_mpl[ temp * dim + i ], S, &S_mb_node[0], n, &dim );
+		}
+
+		log_ratio_mpl_ggm( &log_ratio_mpl[ temp * sub_qp ], &all_edges, &all_edges, &curr_log_mpl[ temp * dim ], G, &index_row[0], &index_col[0], &sub_qp, 
+		                   &size_node[ temp * dim ], S, n, &dim );
+		rates_mpl_tempered( &rates[ temp * sub_qp ], &log_ratio_mpl[ temp * sub_qp ], &log_ratio_g_prior[0], G, &index_row[0], &index_col[0], sub_qp, betas[ temp ], dim );
+	}
+
+	// for adapting the temperatures: rho[ temp ] = log( 1 / betas[ temp + 1 ] - 1 / betas[ temp ] )
+	vector<double> rho( n_temps_C, 0.0 );
+	for( int temp = 0; temp < n_temps_C - 1; temp++ )
+	{
+		double gap = 1.0 / betas[ temp + 1 ] - 1.0 / betas[ temp ];
+		rho[ temp ] = log( ( gap > 1e-3 ) ? gap : 1e-3 );
+	}
+
+	vector<double> cross_rates( sub_qp * 2 );
+	vector<double> log_mpl_G( n_temps_C );
+	vector<int> n_swaps( n_temps_C, 0 );
+	vector<int> n_accept( n_temps_C, 0 );
+
+	// - - random streams of the chains, seeds from the RNG of R
+	GetRNGstate();
+	vector<chain_rng> rngs;
+	for( int temp = 0; temp < n_temps_C; temp++ )
+		rngs.push_back( chain_rng( ( static_cast<unsigned long long int>( unif_rand() * 4294967296.0 ) << 32 )
+		                           ^ static_cast<unsigned long long int>( unif_rand() * 4294967296.0 ) ) );
+
+	int threads_chains = 1, threads_rates = 1;
+	#ifdef _OPENMP
+		int max_threads    = omp_get_max_threads();
+		int max_levels     = omp_get_max_active_levels();
+		threads_chains     = ( n_temps_C < max_threads ) ? n_temps_C : max_threads;
+		threads_rates      = max_threads / threads_chains;
+		if( threads_rates < 1 ) threads_rates = 1;
+		omp_set_max_active_levels( 2 );
+	#endif
+
+// - - Main loop for birth-death MCMC - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -|
+	int print_conter = 0, swap_step = 0;
+	for( int i_mcmc = 0; i_mcmc < iteration; i_mcmc += swap_every )
+	{
+		int size_block = ( iteration - i_mcmc < swap_every ) ? iteration - i_mcmc : swap_every;
+
+		#pragma omp parallel for schedule( dynamic ) num_threads( threads_chains )
+		for( int temp = 0; temp < n_temps_C; temp++ )
+		{
+			#ifdef _OPENMP
+				omp_set_num_threads( threads_rates );
+			#endif
+			current_chain_rng() = &rngs[ temp ];
+
+			int index_selected_edge, selected_edge_i, selected_edge_j, selected_edge_ij, count_mb;
+			int *G = &G_temps[ temp * pxp ];
+			int *size_node_temp = &size_node[ temp * dim ];
+			double *curr_log_mpl_temp = &curr_log_mpl[ temp * dim ], weight_C;
+
+			vector<int> mb_node_temp( dim );
+			vector<double> S_mb_node_temp( pxp );
+
+			for( int i_block = i_mcmc; i_block < i_mcmc + size_block; i_block++ )
+			{
+				// Selecting an edge based on birth and death rates of the current state
+				select_edge( &rates[ temp * sub_qp ], &index_selected_edge, &sum_rates[ temp ], &sub_qp );
+				selected_edge_i = index_row[ index_selected_edge ];
+				selected_edge_j = index_col[ index_selected_edge ];
+
+// - - - saving result of the cold chain - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+				if( ( temp == 0 ) and ( i_block >= burn_in ) )
+				{
+					weight_C = 1.0 / sum_rates[ 0 ];
+
+					for( int k = 0; k < pxp; k++ )
+						if( G[ k ] ) p_links_Cpp[ k ] += weight_C;
+
+					sum_weights += weight_C;
+				}
+// - - - End of saving result - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -|
+
+				// Updating G (graph) based on selected edge
+				selected_edge_ij    = selected_edge_j * dim + selected_edge_i;
+				G[ selected_edge_ij ] = 1 - G[ selected_edge_ij ];
+				G[ selected_edge_i * dim + selected_edge_j ] = G[ selected_edge_ij ];
+
+				if( G[ selected_edge_ij ] )
+				{
+					++size_node_temp[ selected_edge_i ];
+					++size_node_temp[ selected_edge_j ];
+				}else{
+					--size_node_temp[ selected_edge_i ];
+					--size_node_temp[ selected_edge_j ];
+				}
+
+				// log MPL of the two nodes, and the rates of the new state
+				int nodes[ 2 ] = { selected_edge_i, selected_edge_j };
+				for( int k = 0; k < 2; k++ )
+				{
+					count_mb = 0;
+					for( int t = 0; t < dim; t++ )
+						if( G[ nodes[ k ] * dim + t ] ) mb_node_temp[ count_mb++ ] = t;
+
+					log_mpl( &nodes[ k ], &mb_node_temp[0], &size_node_temp[ nodes[ k ] ], &curr_log_mpl_temp[ nodes[ k ] ], S, &S_mb_node_temp[0], n, &dim );
+				}
+
+				log_ratio_mpl_ggm( &log_ratio_mpl[ temp * sub_qp ], &selected_edge_i, &selected_edge_j, curr_log_mpl_temp, G, &index_row[0], &index_col[0], &sub_qp, 
+				                   size_node_temp, S, n, &dim );
+				rates_mpl_tempered( &rates[ temp * sub_qp ], &log_ratio_mpl[ temp * sub_qp ], &log_ratio_g_prior[0], G, &index_row[0], &index_col[0], sub_qp, betas[ temp ], dim );
+			}
+
+			current_chain_rng() = NULL;
+		}
+
+		if( print_c <= 100 )
+			while( ( ( print_c * iteration ) / 100 > 0 ) and ( ( print_conter + 1 ) * ( ( print_c * iteration ) / 100 ) <= i_mcmc + size_block ) )
+			{
+				++print_conter;
+				( ( print_conter * ( ( print_c * iteration ) / 100 ) ) != iteration ) ? Rprintf( "%i%%->", print_c * print_conter ) : Rprintf( " done" );
+			}
+
+// - - - Swapping the states of the neighbour chains - - - - - - - - - - - - - - - - - - - - - - - |
+		if( n_temps_C == 1 ) continue;
+
+		for( int temp = 0; temp < n_temps_C; temp++ )
+		{
+			double sum = 0.0, sum_log_mpl = 0.0;
+			for( int e = 0; e < sub_qp; e++ ) sum += rates[ temp * sub_qp + e ];
+			for( i = 0; i < dim; i++ ) sum_log_mpl += curr_log_mpl[ temp * dim + i ];
+			sum_rates[ temp ] = sum;
+			log_mpl_G[ temp ] = sum_log_mpl;
+		}
+
+		double gamma_adapt = 1.0 / pow( swap_step + 1.0, 0.6 );
+		bool adapting = ( *adapt == 1 ) and ( i_mcmc + size_block <= burn_in );
+
+		// even pairs ( 0, 1 ), ( 2, 3 ), ... and odd pairs ( 1, 2 ), ( 3, 4 ), ... in turn
+		for( int temp = swap_step % 2; temp < n_temps_C - 1; temp += 2 )
+		{
+			int temp1 = temp + 1;
+
+			// rates of the state of chain temp1 at temperature of chain temp, and vice versa
+			rates_mpl_tempered( &cross_rates[0], &log_ratio_mpl[ temp1 * sub_qp ], &log_ratio_g_prior[0], &G_temps[ temp1 * pxp ], &index_row[0], &index_col[0], sub_qp, betas[ temp ], dim );
+			rates_mpl_tempered( &cross_rates[ sub_qp ], &log_ratio_mpl[ temp * sub_qp ], &log_ratio_g_prior[0], &G_temps[ temp * pxp ], &index_row[0], &index_col[0], sub_qp, betas[ temp1 ], dim );
+
+			double sum_cross = 0.0, sum_cross1 = 0.0;
+			for( int e = 0; e < sub_qp; e++ )
+			{
+				sum_cross  += cross_rates[ e ];
+				sum_cross1 += cross_rates[ sub_qp + e ];
+			}
+
+			double log_alpha = ( betas[ temp ] - betas[ temp1 ] ) * ( log_mpl_G[ temp1 ] - log_mpl_G[ temp ] )
+			                   + log( sum_cross ) + log( sum_cross1 ) - log( sum_rates[ temp ] ) - log( sum_rates[ temp1 ] );
+
+			bool accept = ( log( unif_rand() ) < log_alpha );
+			if( accept )
+			{
+				std::swap_ranges( &G_temps[ temp * pxp ], &G_temps[ temp * pxp ] + pxp, &G_temps[ temp1 * pxp ] );
+				std::swap_ranges( &size_node[ temp * dim ], &size_node[ temp * dim ] + dim, &size_node[ temp1 * dim ] );
+				std::swap_ranges( &curr_log_mpl[ temp * dim ], &curr_log_mpl[ temp * dim ] + dim, &curr_log_mpl[ temp1 * dim ] );
+				std::swap_ranges( &log_ratio_mpl[ temp * sub_qp ], &log_ratio_mpl[ temp * sub_qp ] + sub_qp, &log_ratio_mpl[ temp1 * sub_qp ] );
+				std::swap( log_mpl_G[ temp ], log_mpl_G[ temp1 ] );
+
+				memcpy( &rates[ temp * sub_qp ] , &cross_rates[0]     , sizeof( double ) * sub_qp );
+				memcpy( &rates[ temp1 * sub_qp ], &cross_rates[ sub_qp ], sizeof( double ) * sub_qp );
+			}
+
+			if( i_mcmc >= burn_in )
+			{
+				++n_swaps[ temp ];
+				if( accept ) ++n_accept[ temp ];
+			}
+
+			if( adapting ) rho[ temp ] += gamma_adapt * ( ( ( log_alpha < 0.0 ) ? exp( log_alpha ) : 1.0 ) - 0.234 );
+		}
+
+		if( adapting )
+		{
+			double temperature = 1.0;
+			for( int temp = 1; temp < n_temps_C; temp++ )
+			{
+				temperature  += exp( rho[ temp - 1 ] );
+				betas[ temp ] = 1.0 / temperature;
+
+				rates_mpl_tempered( &rates[ temp * sub_qp ], &log_ratio_mpl[ temp * sub_qp ], &log_ratio_g_prior[0], &G_temps[ temp * pxp ], &index_row[0], &index_col[0], sub_qp, betas[ temp ], dim );
+			}
+		}
+
+		++swap_step;
+	}
+	PutRNGstate();
+// - - End of main loop for birth-death MCMC - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+
+	#ifdef _OPENMP
+		omp_set_max_active_levels( max_levels );
+	#endif
+
+	for( int temp = 0; temp < n_temps_C - 1; temp++ )
+		swap_accept[ temp ] = ( n_swaps[ temp ] > 0 ) ? static_cast<double>( n_accept[ temp ] ) / n_swaps[ temp ] : 0.0;
+
+	for( i = 0; i < pxp; i++ )
+		p_links[ i ] = p_links_Cpp[ i ] / sum_weights;
+}
+
+} // End of exturn "C"
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
@@ -0,0 +1,310 @@
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+//    Copyright (C) 2012 - 2022  Reza Mohammadi                                |
+//                                                                             |
+//    This file is part of BDgraph package.                                    |
+//                                                                             |
+//    BDgraph is free software: you can redistribute it and/or modify it under |
+//    the terms of the GNU General Public License as published by the Free     |
+//    Software Foundation; see <https://cran.r-project.org/web/licenses/GPL-3>.|
+//                                                                             |
+//    Maintainer: Reza Mohammadi <a.mohammadi@uva.nl>                          |
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+
+#ifndef R_NO_REMAP
+#define R_NO_REMAP
+#endif
+
+#include "matrix.h"
+#include "rgwish.h"
+#include <Rinternals.h>      // SEXP, external pointers for .Call
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// Session of the birth-death MCMC for Gaussian Graphical models (MA): it keeps
+// the data-derived state ( Ds, Ts, the indices and the log prior ratios of the
+// links ), the state of the chain, the buffers of the sampler and the
+// accumulators between the calls from R, so the sampling runs in increments
+// with no setup. It is owned by an external pointer of R.
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+struct ggm_session
+{
+	int dim, pxp, b, b_star, sub_qp, iter_done, iter_saved;
+	double threshold, sum_weights;
+
+	vector<double> Ts, Ds, Dsijj, log_ratio_g_prior, rates;
+	vector<int> index_row, index_col;
+
+	// state of the chain and accumulators
+	vector<int> G, size_node;
+	vector<double> K, sigma, p_links_Cpp, K_hat_Cpp;
+
+	// - - buffers for rgwish_sigma
+	vector<double> sigma_start, inv_C, beta_star, sigma_i, sigma_start_N_i, sigma_N_i;
+	vector<int> N_i;
+
+	ggm_session( int G_start[], double K_start[], double g_prior[], double Ts_data[], double Ds_data[],
+	             int b_prior, int b_post, double threshold_C, int p ) :
+		dim( p ), pxp( p * p ), b( b_prior ), b_star( b_post ), sub_qp( 0 ), iter_done( 0 ), iter_saved( 0 ),
+		threshold( threshold_C ), sum_weights( 0.0 ),
+		Ts( Ts_data, Ts_data + p * p ), Ds( Ds_data, Ds_data + p * p ), Dsijj( p * p ), log_ratio_g_prior( p * p ),
+		G( G_start, G_start + p * p ), size_node( p, 0 ), K( K_start, K_start + p * p ), sigma( p * p ),
+		p_links_Cpp( p * p, 0.0 ), K_hat_Cpp( p * p, 0.0 ),
+		sigma_start( p * p ), inv_C( p * p ), beta_star( p ), sigma_i( p ), sigma_start_N_i( p ), sigma_N_i( p * p ), N_i( p )
+	{
+		vector<double> copyK( K );
+		inverse( &copyK[0], &sigma[0], &dim );
+
+		for( int i = 0; i < dim; i++ )
+			for( int j = 0; j < dim; j++ ) size_node[ i ] += G[ i * dim + j ];
+
+		set_Dsijj();
+		set_prior( g_prior );
+	}
+
+	// for calculating the birth/death rates
+	void set_Dsijj()
+	{
+		for( int j = 1; j < dim; j++ )
+			for( int i = 0; i < j; i++ )
+			{
+				int ij = j * dim + i;
+				Dsijj[ ij ] = Ds[ ij ] * Ds[ ij ] / Ds[ j * dim + j ];
+			}
+	}
+
+	// n_new new observations with S_new = X'X: Ds, Ts and b_star are for all the data; the saved 
+	// iterations are for the old data, so they are dropped; the chain goes on from its current state
+	void add_data( double S_new[], int n_new )
+	{
+		for( int i = 0; i < pxp; i++ ) Ds[ i ] += S_new[ i ];
+		b_star += n_new;
+
+		vector<double> copy_Ds( Ds ), inv_Ds( pxp );
+		inverse( &copy_Ds[0], &inv_Ds[0], &dim );
+		cholesky( &inv_Ds[0], &Ts[0], &dim );
+
+		set_Dsijj();
+		reset();
+	}
+
+	// indices of the links which are not fixed by the graph prior, and the log prior ratios;
+	// links which the new prior fixes are set in G, then K is sampled for the new graph
+	void set_prior( double g_prior[] )
+	{
+		index_row.resize( 0 );
+		index_col.resize( 0 );
+
+		bool changed_G = false;
+		for( int j = 1; j < dim; j++ )
+			for( int i = 0; i < j; i++ )
+			{
+				int ij = j * dim + i;
+
+				if( ( g_prior[ ij ] != 0.0 ) and ( g_prior[ ij ] != 1.0 ) )
+				{
+					index_row.push_back( i );
+					index_col.push_back( j );
+				}else if( G[ ij ] != static_cast<int>( g_prior[ ij ] ) ){
+					G[ ij ]           = 1 - G[ ij ];
+					G[ i * dim + j ]  = G[ ij ];
+					size_node[ i ]   += G[ ij ] ? 1 : -1;
+					size_node[ j ]   += G[ ij ] ? 1 : -1;
+					changed_G         = true;
+				}
+
+				log_ratio_g_prior[ ij ] = log( static_cast<double>( g_prior[ ij ] / ( 1 - g_prior[ ij ] ) ) );
+			}
+
+		sub_qp = index_row.size();
+		rates.resize( sub_qp );
+
+		if( changed_G )
+		{
+			GetRNGstate();
+			rgwish_sigma( &G[0], &size_node[0], &Ts[0], &K[0], &sigma[0], &b_star, &dim, &threshold,
+			              &sigma_start[0], &inv_C[0], &beta_star[0], &sigma_i[0], sigma_start_N_i, sigma_N_i, N_i );
+			PutRNGstate();
+		}
+	}
+
+	// drops the saved iterations; the chain goes on from its current state
+	void reset()
+	{
+		fill( p_links_Cpp.begin(), p_links_Cpp.end(), 0.0 );
+		fill( K_hat_Cpp.begin(), K_hat_Cpp.end(), 0.0 );
+		sum_weights = 0.0;
+		iter_saved  = 0;
+	}
+
+	// 'iteration' more iterations of the chain; the first 'burn_in' of them are not saved
+	void run( int iteration, int burn_in, int print_c )
+	{
+		int index_selected_edge, selected_edge_i, selected_edge_j, selected_edge_ij, one = 1;
+		double weight_C, sum_rates;
+
+		if( sub_qp == 0 ) return;   // the graph prior fixes all the links
+
+		GetRNGstate();
+		int print_conter = 0;
+		for( int i_mcmc = 0; i_mcmc < iteration; i_mcmc++ )
+		{
+			print_progress( i_mcmc + 1, iteration, print_c, &print_conter );
+
+// - - - STEP 1: calculating birth and death rates - - - - - - - - - - - - - - - - - - - - - - - - |
+
+			rates_bdmcmc_parallel( &rates[0], &log_ratio_g_prior[0], &G[0], &index_row[0], &index_col[0], &sub_qp, &Ds[0], &Dsijj[0], &sigma[0], &K[0], &b, &dim );
+
+			// Selecting an edge based on birth and death rates
+			select_edge( &rates[0], &index_selected_edge, &sum_rates, &sub_qp );
+			selected_edge_i = index_row[ index_selected_edge ];
+			selected_edge_j = index_col[ index_selected_edge ];
+
+// - - - saving result - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+			if( i_mcmc >= burn_in )
+			{
+				weight_C = 1.0 / sum_rates;
+
+				// K_hat_Cpp[i] += K[i] * weight_C;
+				F77_NAME(daxpy)( &pxp, &weight_C, &K[0], &one, &K_hat_Cpp[0], &one );
+
+				#pragma omp parallel for
+				for( int i = 0; i < pxp; i++ )
+					if( G[ i ] ) p_links_Cpp[ i ] += weight_C;
+
+				sum_weights += weight_C;
+				++iter_saved;
+			}
+// - - - End of saving result - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -|
+
+			// Updating G (graph) based on selected edge
+			selected_edge_ij    = selected_edge_j * dim + selected_edge_i;
+			G[ selected_edge_ij ] = 1 - G[ selected_edge_ij ];
+			G[ selected_edge_i * dim + selected_edge_j ] = G[ selected_edge_ij ];
+
+			if( G[ selected_edge_ij ] )
+			{
+				++size_node[ selected_edge_i ];
+				++size_node[ selected_edge_j ];
+			}else{
+				--size_node[ selected_edge_i ];
+				--size_node[ selected_edge_j ];
+			}
+
+// - - - STEP 2: Sampling from G-Wishart for new graph - - - - - - - - - - - - - - - - - - - - - - |
+			rgwish_sigma( &G[0], &size_node[0], &Ts[0], &K[0], &sigma[0], &b_star, &dim, &threshold,
+			              &sigma_start[0], &inv_C[0], &beta_star[0], &sigma_i[0], sigma_start_N_i, sigma_N_i, N_i );
+		}
+		PutRNGstate();
+
+		iter_done += iteration;
+	}
+};
+
+static void ggm_session_finalizer( SEXP session )
+{
+	ggm_session *state = static_cast<ggm_session *>( R_ExternalPtrAddr( session ) );
+	if( state != NULL )
+	{
+		delete state;
+		R_ClearExternalPtr( session );
+	}
+}
+
+static ggm_session *get_session( SEXP session )
+{
+	ggm_session *state = ( TYPEOF( session ) == EXTPTRSXP ) ? static_cast<ggm_session *>( R_ExternalPtrAddr( session ) ) : NULL;
+	if( state == NULL ) Rf_error( "The session is not valid; a session can not be saved and loaded in a new R session" );
+
+	return state;
+}
+
+extern "C" {
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// new session from the starting graph and precision matrix, the graph prior,
+// and the data-derived Ts and Ds
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+SEXP ggm_session_new( SEXP G, SEXP K, SEXP g_prior, SEXP Ts, SEXP Ds, SEXP b, SEXP b_star, SEXP threshold, SEXP p )
+{
+	ggm_session *state = new ggm_session( INTEGER( G ), REAL( K ), REAL( g_prior ), REAL( Ts ), REAL( Ds ),
+	                                      Rf_asInteger( b ), Rf_asInteger( b_star ), Rf_asReal( threshold ), Rf_asInteger( p ) );
+
+	SEXP session = PROTECT( R_MakeExternalPtr( state, R_NilValue, R_NilValue ) );
+	R_RegisterCFinalizerEx( session, ggm_session_finalizer, TRUE );
+	UNPROTECT( 1 );
+
+	return session;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+SEXP ggm_session_run( SEXP session, SEXP iter, SEXP burnin, SEXP print )
+{
+	get_session( session )->run( Rf_asInteger( iter ), Rf_asInteger( burnin ), Rf_asInteger( print ) );
+
+	return R_NilValue;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// estimates from the saved iterations, and the state of the chain
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+SEXP ggm_session_summary( SEXP session )
+{
+	ggm_session *state = get_session( session );
+	int pxp = state->pxp;
+
+	SEXP p_links = PROTECT( Rf_allocVector( REALSXP, pxp ) );
+	SEXP K_hat   = PROTECT( Rf_allocVector( REALSXP, pxp ) );
+	SEXP G       = PROTECT( Rf_allocVector( INTSXP , pxp ) );
+	SEXP K       = PROTECT( Rf_allocVector( REALSXP, pxp ) );
+
+	double sum_weights = state->sum_weights;
+	for( int i = 0; i < pxp; i++ )
+	{
+		REAL( p_links )[ i ] = ( sum_weights > 0.0 ) ? state->p_links_Cpp[ i ] / sum_weights : 0.0;
+		REAL( K_hat )[ i ]   = ( sum_weights > 0.0 ) ? state->K_hat_Cpp[ i ]   / sum_weights : 0.0;
+	}
+	memcpy( INTEGER( G ), &state->G[0], sizeof( int    ) * pxp );
+	memcpy( REAL( K )   , &state->K[0], sizeof( double ) * pxp );
+
+	const char *names[] = { "p_links", "K_hat", "G", "K", "iter", "iter_saved", "" };
+	SEXP result = PROTECT( Rf_mkNamed( VECSXP, names ) );
+	SET_VECTOR_ELT( result, 0, p_links );
+	SET_VECTOR_ELT( result, 1, K_hat );
+	SET_VECTOR_ELT( result, 2, G );
+	SET_VECTOR_ELT( result, 3, K );
+	SET_VECTOR_ELT( result, 4, Rf_ScalarInteger( state->iter_done ) );
+	SET_VECTOR_ELT( result, 5, Rf_ScalarInteger( state->iter_saved ) );
+	UNPROTECT( 5 );
+
+	return result;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// new graph prior; the saved iterations are for the old one, so they are dropped
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+SEXP ggm_session_set_prior( SEXP session, SEXP g_prior )
+{
+	ggm_session *state = get_session( session );
+	state->set_prior( REAL( g_prior ) );
+	state->reset();
+
+	return R_NilValue;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// new observations, as S = X'X of n rows; the saved iterations are dropped
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+SEXP ggm_session_add_data( SEXP session, SEXP S, SEXP n )
+{
+	get_session( session )->add_data( REAL( S ), Rf_asInteger( n ) );
+
+	return R_NilValue;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+SEXP ggm_session_reset( SEXP session )
+{
+	get_session( session )->reset();
+
+	return R_NilValue;
+}
+
+} // End of exturn "C"
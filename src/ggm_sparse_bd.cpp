@@ -0,0 +1,349 @@
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+//     Copyright (C) 2012 - 2022  Reza Mohammadi                                                   |
+//                                                                                                 |
+//     This file is part of BDgraph package.                                                       |
+//                                                                                                 |
+//     BDgraph is free software: you can redistribute it and/or modify it under                    |
+//     the terms of the GNU General Public License as published by the Free                        |
+//     Software Foundation; see <https://cran.r-project.org/web/licenses/GPL-3>.                   |
+//                                                                                                 |
+//     Maintainer: Reza Mohammadi <a.mohammadi@uva.nl>                                             |
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+
+#include "matrix.h"
+#include "sparse_K.h"
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// Birth-death rates with K in sparse_K. With sigma = K^{-1} and e = ( i, j ), the terms of the
+// rates in rates_bdmcmc_parallel are
+//     K[ e, -e ] K[ -e, -e ]^{-1} K[ -e, e ] = K[ e, e ] - sigma[ e, e ]^{-1}
+//     K[ j, -j ] K[ -j, -j ]^{-1} K[ -j, j ] = K[ j, j ] - 1 / sigma[ j, j ]
+// so a rate takes sigma[ i, i ], sigma[ i, j ], and sigma[ j, j ] only; sigma[ , j ] is from
+// two solves with L, one column at a time, and the diagonal of sigma is kept by the sampler
+// ( sparse_node_work ).
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+static void rates_bdmcmc_sparse( double rates[], double g_prior[], int G[], int index_row[], int start_col[],
+                                 double Ds[], sparse_K &K, const double sigma_diag[], int *b )
+{
+	profile_phase timer( run_profile::rates );
+	int dim = K.dim;
+
+	#pragma omp parallel
+	{
+		vector<double> sigma_j( dim ), y( dim, 0.0 ), Kj( dim, 0.0 );
+		vector<int> G_j( dim, 0 );
+
+		#pragma omp for schedule( dynamic )
+		for( int j = 1; j < dim; j++ )
+		{
+			if( start_col[ j ] == start_col[ j + 1 ] ) continue;
+
+			profile_work work;
+			K.sigma_column( j, &sigma_j[0], &y[0] );
+
+			const vector<int> &adj_j = K.adj[ j ];
+			for( size_t k = 0; k < adj_j.size(); k++ )
+			{
+				Kj[ adj_j[ k ] ]  = K.value[ j ][ k ];
+				G_j[ adj_j[ k ] ] = 1;
+			}
+
+			double Kjj = K.diag[ j ], sigma_jj = sigma_j[ j ], Dsjj = Ds[ j * dim + j ];
+
+			for( int counter = start_col[ j ]; counter < start_col[ j + 1 ]; counter++ )
+			{
+				int i = index_row[ counter ], ij = j * dim + i;
+				double Kij = Kj[ i ], sigma_ii = sigma_diag[ i ], sigma_ij = sigma_j[ i ];
+
+				// K022 = K[ j, -j ] K[ -j, -j ]^{-1} K[ -j, j ] with K[ i, j ] = 0
+				double K022 = Kjj - 1.0 / sigma_jj + 2.0 * Kij * sigma_ij / sigma_jj + Kij * Kij * ( sigma_ii - sigma_ij * sigma_ij / sigma_jj );
+
+				// K121 = K[ e, e ] - sigma[ e, e ]^{-1}
+				double det_sigma = sigma_ii * sigma_jj - sigma_ij * sigma_ij;
+				double a11       = sigma_jj / det_sigma;
+				double K121_ij   = Kij + sigma_ij / det_sigma;
+				double K121_jj   = Kjj - sigma_ii / det_sigma;
+				double sum_diag  = Dsjj * ( K022 - K121_jj ) - 2.0 * Ds[ ij ] * K121_ij;
+
+				// nu_star = b + sum( Gf[,i] * Gf[,j] )
+				int common = 0;
+				for( size_t k = 0; k < K.adj[ i ].size(); k++ ) common += G_j[ K.adj[ i ][ k ] ];
+				double nu_star = 0.5 * ( *b + common );
+				double Dsijj   = Ds[ ij ] * Ds[ ij ] / Dsjj;
+
+				double log_rate = ( G[ ij ] )
+					? 0.5 * log( 2.0 * Dsjj / a11 ) + lgammafn( nu_star + 0.5 ) - lgammafn( nu_star ) - 0.5 * ( Dsijj * a11 + sum_diag )
+					: 0.5 * log( 0.5 * a11 / Dsjj ) - lgammafn( nu_star + 0.5 ) + lgammafn( nu_star ) + 0.5 * ( Dsijj * a11 + sum_diag );
+
+				double log_ratio_g_prior = log( g_prior[ ij ] / ( 1.0 - g_prior[ ij ] ) );
+				log_rate = ( G[ ij ] ) ? log_rate - log_ratio_g_prior : log_rate + log_ratio_g_prior;
+
+				rates[ counter ] = ( log_rate < 0.0 ) ? exp( log_rate ) : 1.0;
+			}
+
+			for( size_t k = 0; k < adj_j.size(); k++ )
+			{
+				Kj[ adj_j[ k ] ]  = 0.0;
+				G_j[ adj_j[ k ] ] = 0;
+			}
+		}
+	}
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// work space of rgwish_sparse_node, and the diagonal of sigma = K^{-1}
+struct sparse_node_work
+{
+	vector<double> Y, A, u, new_column;
+	vector<double> sigma_diag, sigma_old, sigma_new, y;   // y is zero, as in sparse_K::sigma_column
+
+	sparse_node_work( int dim ) : sigma_diag( dim ), sigma_old( dim ), sigma_new( dim ), y( dim, 0.0 ) {}
+
+	// all of the diagonal of sigma, with p solves with L
+	void get_sigma_diag( const sparse_K &K )
+	{
+		#pragma omp parallel
+		{
+			vector<double> y_thread( K.dim, 0.0 );
+
+			#pragma omp for
+			for( int a = 0; a < K.dim; a++ )
+				sigma_diag[ a ] = K.sigma_diag( a, &y_thread[0] );
+		}
+	}
+};
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// New row and column j of K from their distribution given the rest of K, for K ~ G-Wishart( b, Ds ):
+// with M = K[ -j, -j ], u = K[ N, j ] for the neighbours N of j, and A = ( M^{-1} )[ N, N ],
+//     K[ j, j ] - u' A u ~ Gamma( b / 2, rate = Ds[ j, j ] / 2 ),
+//     u ~ N( - ( Ds[ j, j ] A )^{-1} Ds[ N, j ], ( Ds[ j, j ] A )^{-1} ).
+// A = Y'Y for Y = L^{-1} P[ , N ], with L the factor of M ( sparse_K::remove_node ). The links
+// in the pattern of K which are not in G are set to zero.
+// As M does not change, ( M^{-1} )[ a, a ] = sigma[ a, a ] - sigma[ a, j ]^2 / sigma[ j, j ] is
+// the same for the old and the new K, so with 'update_sigma' the diagonal of sigma is updated
+// from the old and the new column j of sigma, with four solves with L in place of p.
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+static void rgwish_sparse_node( int j, sparse_K &K, int G[], double Ds[], int b, sparse_node_work &work, bool update_sigma )
+{
+	vector<double> &Y = work.Y, &A = work.A, &u = work.u, &new_column = work.new_column;
+	int dim = K.dim, one = 1, info;
+	char uplo = 'U', side = 'L', transT = 'T', transN = 'N';
+	double alpha = 1.0, Dsjj = Ds[ j * dim + j ];
+	const vector<int> &adj_j = K.adj[ j ];
+
+	if( update_sigma ) K.sigma_column( j, &work.sigma_old[0], &work.y[0] );
+
+	vector<int> N, first;
+	for( size_t t = 0; t < adj_j.size(); t++ )
+		if( G[ j * dim + adj_j[ t ] ] ) N.push_back( static_cast<int>( t ) );
+	int size_N = static_cast<int>( N.size() );
+
+	K.remove_node( j );
+
+	if( static_cast<int>( Y.size() ) < size_N * dim ) Y.resize( size_N * dim );
+	first.resize( size_N );
+	for( int a = 0; a < size_N; a++ )
+	{
+		memset( Y.data() + a * dim, 0, sizeof( double ) * dim );
+		first[ a ] = K.lower_solve( adj_j[ N[ a ] ], Y.data() + a * dim );
+	}
+
+	// Q = Ds[ j, j ] A; u = Q^{-1/2} z - Q^{-1} Ds[ N, j ] by the Cholesky factor of Q
+	A.resize( size_N * size_N );
+	u.resize( size_N );
+	for( int a = 0; a < size_N; a++ )
+	{
+		for( int c = a; c < size_N; c++ )
+		{
+			double sum = 0.0;
+			for( int r = max( first[ a ], first[ c ] ); r < dim; r++ ) sum += Y[ a * dim + r ] * Y[ c * dim + r ];
+			A[ c * size_N + a ] = sum;
+			A[ a * size_N + c ] = sum;
+		}
+		u[ a ] = Ds[ j * dim + adj_j[ N[ a ] ] ];
+	}
+
+	double new_diag = rgamma_chain( 0.5 * b, 2.0 / Dsjj );
+
+	if( size_N > 0 )
+	{
+		vector<double> Q( A );
+		for( size_t k = 0; k < Q.size(); k++ ) Q[ k ] *= Dsjj;
+		F77_NAME(dpotrf)( &uplo, &size_N, &Q[0], &size_N, &info FCONE );
+		if( info != 0 ) Rf_error( "The precision matrix is not positive definite" );
+
+		// u = R^{-1} ( z - R'^{-1} Ds[ N, j ] ) for Q = R'R
+		F77_NAME(dtrsm)( &side, &uplo, &transT, &transN, &size_N, &one, &alpha, &Q[0], &size_N, &u[0], &size_N FCONE FCONE FCONE FCONE );
+		for( int a = 0; a < size_N; a++ ) u[ a ] = norm_rand_chain() - u[ a ];
+		F77_NAME(dtrsm)( &side, &uplo, &transN, &transN, &size_N, &one, &alpha, &Q[0], &size_N, &u[0], &size_N FCONE FCONE FCONE FCONE );
+
+		// K[ j, j ] = Gamma + u' A u
+		for( int a = 0; a < size_N; a++ )
+			for( int c = 0; c < size_N; c++ )
+				new_diag += u[ a ] * A[ c * size_N + a ] * u[ c ];
+	}
+
+	new_column.assign( adj_j.size(), 0.0 );
+	for( int a = 0; a < size_N; a++ ) new_column[ N[ a ] ] = u[ a ];
+
+	K.add_node( j, new_column.data(), new_diag );   // adj_j may be empty ( isolated node )
+
+	if( update_sigma )
+	{
+		K.sigma_column( j, &work.sigma_new[0], &work.y[0] );
+
+		vector<double> &sigma_diag = work.sigma_diag, &sigma_old = work.sigma_old, &sigma_new = work.sigma_new;
+		for( int a = 0; a < dim; a++ )
+			if( a != j )
+				sigma_diag[ a ] += sigma_new[ a ] * sigma_new[ a ] / sigma_new[ j ] - sigma_old[ a ] * sigma_old[ a ] / sigma_old[ j ];
+		sigma_diag[ j ] = sigma_new[ j ];
+	}
+}
+
+// one sweep over all the nodes, and the diagonal of sigma for the new K
+static void rgwish_sparse( sparse_K &K, int G[], double Ds[], int b, sparse_node_work &work )
+{
+	profile_phase timer( run_profile::gwishart );
+
+	for( int j = 0; j < K.dim; j++ ) rgwish_sparse_node( j, K, G, Ds, b, work, false );
+	work.get_sigma_diag( K );
+}
+
+extern "C" {
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// birth-death MCMC for Gaussian Graphical models with sparse K ( sparse_K ), for large sparse
+// graphs; it is for Bayesian model averaging (MA). At each iteration the rows and columns of K
+// of the two nodes of the selected edge, and of one more node in turn, are drawn from their
+// distribution given the rest of K ( rgwish_sparse_node ), in place of the exact sample of
+// G-Wishart in ggm_bdmcmc_ma; the diagonal of sigma is computed again after each turn.
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+void ggm_bdmcmc_sparse( int *iter, int *burnin, int G[], double g_prior[], double Ds[], double K[], int *p,
+                        double K_hat[], double p_links[], int *b, int *b_star, int *print )
+{
+	int print_c = *print, iteration = *iter, burn_in = *burnin;
+	int index_selected_edge, selected_edge_i, selected_edge_j, selected_edge_ij;
+	int counter = 0, i, j, ij, dim = *p, pxp = dim * dim;
+	double sum_weights = 0.0, weight_C, sum_rates;
+
+	GetRNGstate();
+
+	// K on the pattern of G, from the diagonal ( mean of K[ j, j ] for the empty graph )
+	sparse_K K_sp( dim );
+	for( j = 0; j < dim; j++ )
+	{
+		K_sp.diag[ j ] = *b_star / Ds[ j * dim + j ];
+		for( i = 0; i < j; i++ )
+			if( G[ j * dim + i ] ) K_sp.add_link( i, j );
+	}
+	K_sp.refactor();
+
+	sparse_node_work work( dim );
+	rgwish_sparse( K_sp, G, Ds, *b_star, work );
+	int node_turn = 0;
+
+	// For finding the index of rates, by column
+	vector<int> index_row;
+	vector<int> index_col;
+	vector<int> start_col( dim + 1, 0 );
+	for( j = 1; j < dim; j++ )
+	{
+		start_col[ j ] = counter;
+		for( i = 0; i < j; i++ )
+		{
+			ij = j * dim + i;
+			if( ( g_prior[ ij ] != 0.0 ) and ( g_prior[ ij ] != 1.0 ) )
+			{
+				index_row.push_back( i );
+				index_col.push_back( j );
+				counter++;
+			}
+		}
+	}
+	start_col[ dim ] = counter;
+	int sub_qp = counter;
+	vector<double> rates( sub_qp );
+
+	memset( K_hat,   0, sizeof( double ) * pxp );
+	memset( p_links, 0, sizeof( double ) * pxp );
+
+// - - Main loop for birth-death MCMC - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -|
+	int print_conter = 0;
+	for( int i_mcmc = 0; i_mcmc < iteration; i_mcmc++ )
+	{
+		print_progress( i_mcmc + 1, iteration, print_c, &print_conter );
+
+// - - - STEP 1: calculating birth and death rates - - - - - - - - - - - - - - - - - - - - - - - - |
+
+		rates_bdmcmc_sparse( rates.data(), g_prior, G, index_row.data(), &start_col[0], Ds, K_sp, &work.sigma_diag[0], b );
+
+		// Selecting an edge based on birth and death rates
+		select_edge( &rates[0], &index_selected_edge, &sum_rates, &sub_qp );
+		selected_edge_i = index_row[ index_selected_edge ];
+		selected_edge_j = index_col[ index_selected_edge ];
+
+// - - - saving result - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+		if( i_mcmc >= burn_in )
+		{
+			weight_C = 1.0 / sum_rates;
+
+			for( j = 0; j < dim; j++ )
+			{
+				K_hat[ j * dim + j ] += weight_C * K_sp.diag[ j ];
+				for( size_t k = 0; k < K_sp.adj[ j ].size(); k++ )
+				{
+					ij = j * dim + K_sp.adj[ j ][ k ];
+					K_hat[ ij ] += weight_C * K_sp.value[ j ][ k ];
+					if( G[ ij ] ) p_links[ ij ] += weight_C;
+				}
+			}
+
+			sum_weights += weight_C;
+		}
+// - - - End of saving result - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -|
+
+		// Updating G (graph) based on selected edge
+		selected_edge_ij    = selected_edge_j * dim + selected_edge_i;
+		G[ selected_edge_ij ] = 1 - G[ selected_edge_ij ];
+		G[ selected_edge_i * dim + selected_edge_j ] = G[ selected_edge_ij ];
+
+// - - - STEP 2: updating K for new graph - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+		// a new link is in the pattern of K with value zero, and a removed link is set to zero by
+		// node j before it leaves the pattern of K; the values of K do not change in refactor()
+		profile_phase timer( run_profile::gwishart );
+		if( G[ selected_edge_ij ] )
+		{
+			K_sp.add_link( selected_edge_i, selected_edge_j );
+			K_sp.refactor();
+			rgwish_sparse_node( selected_edge_j, K_sp, G, Ds, *b_star, work, true );
+		}else{
+			rgwish_sparse_node( selected_edge_j, K_sp, G, Ds, *b_star, work, true );
+			K_sp.remove_link( selected_edge_i, selected_edge_j );
+			K_sp.refactor();
+		}
+		rgwish_sparse_node( selected_edge_i, K_sp, G, Ds, *b_star, work, true );
+
+		// one more node in turn, so that all the rows of K are drawn; the diagonal of sigma is
+		// computed again after each turn, against rounding errors of the updates
+		if( ( node_turn != selected_edge_i ) and ( node_turn != selected_edge_j ) )
+			rgwish_sparse_node( node_turn, K_sp, G, Ds, *b_star, work, true );
+		if( ++node_turn == dim )
+		{
+			node_turn = 0;
+			work.get_sigma_diag( K_sp );
+		}
+	}
+// - - End of main loop for birth-death MCMC - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+
+	PutRNGstate();
+
+	for( i = 0; i < pxp; i++ )
+	{
+		p_links[ i ] /= sum_weights;
+		K_hat[ i ]   /= sum_weights;
+	}
+
+	K_sp.to_dense( K );
+}
+
+} // End of exturn "C"
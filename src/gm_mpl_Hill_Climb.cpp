@@ -10,7 +10,8 @@
 //    Maintainer: Reza Mohammadi <a.mohammadi@uva.nl>                          |
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
 
-#include "matrix.h"
+#include "mpl_count.h"
+#include "ggm_mpl_bd.h"
 
 extern "C" {
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
@@ -18,342 +19,535 @@ extern "C" {
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
 void log_mpl_binary_hc( int *node, int mb_node[], int *size_node, double *log_mpl_node, 
                   int data[], int freq_data[], int *length_freq_data, 
-                  double *alpha_ijl, int *n )
+                  double *alpha_ijl, mpl_lgamma_table &lgamma_table, mpl_count_buffer &buffer )
 {
 	double alpha_jl      = 2 * *alpha_ijl;
-	double log_alpha_ijl = lgammafn_sign( *alpha_ijl, NULL );
-	double log_alpha_jl  = lgammafn_sign( alpha_jl, NULL );
+	double log_alpha_ijl = lgamma_fam_conf( lgamma_table, 0, *alpha_ijl );
+	double log_alpha_jl  = lgamma_mb_conf( lgamma_table, 0, 2, alpha_jl );
 
-	int i_hash, counter, i, j, l, size_mb_conf, mb_node_x_lf, node_x_lf = *node * *length_freq_data;
-	double sum_lgamma_fam;
+	int l, size_mb_conf, fam_conf_count_0, fam_conf_count_1;
 
+	// ( count0, count1 ) for each observed MB configuration; unobserved ones add zero to the score
+	fam_conf_count_binary( node, mb_node, size_node, data, freq_data, length_freq_data, &size_mb_conf, buffer );
+	
 	*log_mpl_node = 0.0;
-	int fam_conf_count_0 = 0, fam_conf_count_1 = 0;
-		   
-	switch( *size_node )
+	for( l = 0; l < size_mb_conf; l++ )  // collects the necessary statistics from the data and calculates the score
 	{
-		case 0:
-			for( i = 0; i < *length_freq_data; i++ )
-				( data[ node_x_lf + i ] == 0 ) ? fam_conf_count_0 += freq_data[ i ] : fam_conf_count_1 += freq_data[ i ];
-				
-			sum_lgamma_fam = lgammafn_sign( fam_conf_count_0 + *alpha_ijl, NULL ) + lgammafn_sign( fam_conf_count_1 + *alpha_ijl, NULL );
-						   
-			*log_mpl_node = sum_lgamma_fam - lgammafn_sign( *n + alpha_jl, NULL ) + log_alpha_jl - 2 * log_alpha_ijl;      
-			break;
-				
-		case 1:
-			mb_node_x_lf = mb_node[0] * *length_freq_data; 		
-
-			for( l = 0; l < 2; l++ )  // collects the necessary statistics from the data and calculates the score
-			{
-				fam_conf_count_0 = 0;
-				fam_conf_count_1 = 0;
-				for( i = 0; i < *length_freq_data; i++ )
-					if( data[ mb_node_x_lf + i ] == l ) 
-						( data[ node_x_lf + i ] == 0 ) ? fam_conf_count_0 += freq_data[ i ] : fam_conf_count_1 += freq_data[ i ];
-								
-				sum_lgamma_fam = lgammafn_sign( fam_conf_count_0 + *alpha_ijl, NULL ) + lgammafn_sign( fam_conf_count_1 + *alpha_ijl, NULL );
-		   
-				//mb_conf_count = fam_conf_count[0] + fam_conf_count[1];
-				*log_mpl_node += sum_lgamma_fam - lgammafn_sign( fam_conf_count_0 + fam_conf_count_1 + alpha_jl, NULL );     
-			}		
-
-			// adding remaining terms 
-			*log_mpl_node += 2 * log_alpha_jl - 4 * log_alpha_ijl;   
-			break;
-	
-		default:			
-			int size_bit = sizeof( unsigned long long int ) * CHAR_BIT / 2;
-			int sz = size_bit;
-			
-			vector<int>vec_fam_conf_count_0( *length_freq_data );	
-			vector<int>vec_fam_conf_count_1( *length_freq_data );	
-
-			vector<vector<unsigned long long int> > mb_conf( *length_freq_data );		
-			vector<vector<unsigned long long int> > data_mb( *length_freq_data );		
-
-			int size_hash = *size_node / sz + 1;
-			vector<unsigned long long int> hash_mb( size_hash, 0 );			
-
-			// for case i = 0
-			for( j = 0; j < *size_node; j++ )
-			{
-				i_hash = j / sz;
-				//hash_mb[ i_hash ] |= data[ mb_node[j] * *length_freq_data ] << ( j - i_hash * sz );
-				hash_mb[ i_hash ] += (unsigned long long)data[ mb_node[ j ] * *length_freq_data ] << ( j - i_hash * sz );
-			}
-			mb_conf[0] = hash_mb;
-			size_mb_conf = 1;
-
-			if( data[ node_x_lf ] == 0 ) 
-			{
-				vec_fam_conf_count_0[0] = freq_data[0];
-				vec_fam_conf_count_1[0] = 0;
-			}else{
-				vec_fam_conf_count_1[0] = freq_data[0];
-				vec_fam_conf_count_0[0] = 0;
-			}
-
-			int sizeof_hash = size_hash * sizeof hash_mb[0];
-			for( i = 1; i < *length_freq_data; i++ )
-			{
-				//vector<unsigned long long int> hash_mb( size_hash, 0 );
-				memset( &hash_mb[0], 0, sizeof_hash );
-				
-				for( j = 0; j < *size_node; j++ )
-				{
-					i_hash = j / sz;
-					//hash_mb[ i_hash ] |= data[ mb_node[j] * *length_freq_data + i ] << ( j - i_hash * sz );
-					hash_mb[ i_hash ] += (unsigned long long)data[ mb_node[ j ] * *length_freq_data + i ] << ( j - i_hash * sz );
-				}
-				
-				//data_mb[i] = hash_mb;
-				counter = 1;
-				for( j = 0; j < size_mb_conf; j++ )
-					if( hash_mb == mb_conf[ j ] ) 
-					{
-						( data[ node_x_lf + i ] == 0 ) ? vec_fam_conf_count_0[ j ] += freq_data[ i ] : vec_fam_conf_count_1[ j ] += freq_data[ i ];
-						counter = 0;  
-						break;
-					}					
-				
-				if( counter )
-				{
-					//( data[ node_x_lf + i ] == 0 ) ? vec_fam_conf_count_0[ size_mb_conf ] = freq_data[i] : vec_fam_conf_count_1[ size_mb_conf ] = freq_data[i];
-					if( data[ node_x_lf + i ] == 0 ) 
-					{
-						vec_fam_conf_count_0[ size_mb_conf ] = freq_data[ i ];
-						vec_fam_conf_count_1[ size_mb_conf ] = 0;
-					}else{
-						vec_fam_conf_count_1[ size_mb_conf ] = freq_data[ i ];
-						vec_fam_conf_count_0[ size_mb_conf ] = 0;
-					}
-					
-					mb_conf[ size_mb_conf++ ] = hash_mb;
-				}
-			}
-						
-			for( l = 0; l < size_mb_conf; l++ )  // collects the necessary statistics from the data and calculates the score
-				*log_mpl_node += lgammafn_sign( vec_fam_conf_count_0[l] + *alpha_ijl, NULL ) + lgammafn_sign( vec_fam_conf_count_1[l] + *alpha_ijl, NULL ) - lgammafn_sign( vec_fam_conf_count_0[l] + vec_fam_conf_count_1[l] + alpha_jl, NULL );     
-
-			// adding remaining terms 
-			*log_mpl_node += size_mb_conf * ( log_alpha_jl - 2 * log_alpha_ijl );   
-
-			break;
+		fam_conf_count_0 = buffer.fam_conf_count[ 2 * l ];
+		fam_conf_count_1 = buffer.fam_conf_count[ 2 * l + 1 ];
+		
+		*log_mpl_node += lgamma_fam_conf( lgamma_table, fam_conf_count_0, *alpha_ijl ) + lgamma_fam_conf( lgamma_table, fam_conf_count_1, *alpha_ijl ) - lgamma_mb_conf( lgamma_table, fam_conf_count_0 + fam_conf_count_1, 2, alpha_jl );     
 	}
+
+	// adding remaining terms 
+	*log_mpl_node += size_mb_conf * ( log_alpha_jl - 2 * log_alpha_ijl );   
 }
     
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
 // Parallel function to compute the Marginal pseudo-likelihood for BINARY data
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
 void log_mpl_binary_parallel_hc( int *node, int mb_node[], int *size_node, double *log_mpl_node, 
-                  int data[], int freq_data[], int *length_freq_data, 
-                  double *alpha_ijl, int *n )
+                  int data[], int freq_data[], int *length_freq_data, double *alpha_ijl )
 {
 	double alpha_jl      = 2 * *alpha_ijl;
 	double log_alpha_ijl = lgammafn_sign( *alpha_ijl, NULL );
 	double log_alpha_jl  = lgammafn_sign( alpha_jl, NULL );
 
-	int i, l, size_mb_conf, mb_node_x_lf, node_x_lf = *node * *length_freq_data;
+	int l, size_mb_conf, fam_conf_count_0, fam_conf_count_1;
+
+	// a single score from R: no lgamma table, since building it costs more than the score
+	mpl_lgamma_table lgamma_table;
+	mpl_count_buffer buffer;
+	vector<mpl_count_buffer> thread_buffer;
+
+	// ( count0, count1 ) for each observed MB configuration; thread-local tables merged at the end
+	fam_conf_count_binary_parallel( node, mb_node, size_node, data, freq_data, length_freq_data, &size_mb_conf, buffer, thread_buffer );
+	
+	*log_mpl_node = 0.0;
+	for( l = 0; l < size_mb_conf; l++ )  // collects the necessary statistics from the data and calculates the score
+	{
+		fam_conf_count_0 = buffer.fam_conf_count[ 2 * l ];
+		fam_conf_count_1 = buffer.fam_conf_count[ 2 * l + 1 ];
+		
+		*log_mpl_node += lgamma_fam_conf( lgamma_table, fam_conf_count_0, *alpha_ijl ) + lgamma_fam_conf( lgamma_table, fam_conf_count_1, *alpha_ijl ) - lgamma_mb_conf( lgamma_table, fam_conf_count_0 + fam_conf_count_1, 2, alpha_jl );     
+	}
+
+	// adding remaining terms 
+	*log_mpl_node += size_mb_conf * ( log_alpha_jl - 2 * log_alpha_ijl );   
+}
+    	
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// Computing the Marginal pseudo-likelihood for discrete data
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+void log_mpl_hc_dis( int *node, int mb_node[], int *size_node, double *log_mpl_node, 
+                  int data[], int freq_data[], int *length_freq_data, 
+                  int max_range_nodes[], double *alpha_ijl, int *n, 
+                  mpl_lgamma_table &lgamma_table, mpl_count_buffer &buffer )
+{
+	int j, l, size_mb_conf, mb_conf_count;
+    int size_range_node = max_range_nodes[ *node ];
 	double sum_lgamma_fam;
+    double alpha_jl = size_range_node * *alpha_ijl;   
+
+	// n_ijl and n_jl for all observed MB configurations; unobserved ones add zero to the score
+	fam_conf_count_dis( node, mb_node, size_node, data, freq_data, length_freq_data, max_range_nodes, &size_range_node, &size_mb_conf, buffer );
 
 	*log_mpl_node = 0.0;
-	int fam_conf_count_0 = 0, fam_conf_count_1 = 0;
-		   
-	switch( *size_node )
+	for( l = 0; l < size_mb_conf; l++ )  // calculates the score from the contingency table
 	{
-		case 0:
-			for( i = 0; i < *length_freq_data; i++ )
-				( data[ node_x_lf + i ] == 0 ) ? fam_conf_count_0 += freq_data[ i ] : fam_conf_count_1 += freq_data[ i ];
-				
-			sum_lgamma_fam = lgammafn_sign( fam_conf_count_0 + *alpha_ijl, NULL ) + lgammafn_sign( fam_conf_count_1 + *alpha_ijl, NULL );
-						   
-			*log_mpl_node = sum_lgamma_fam - lgammafn_sign( *n + alpha_jl, NULL ) + log_alpha_jl - 2 * log_alpha_ijl;      
-			break;
-				
-		case 1:
-			mb_node_x_lf = mb_node[0] * *length_freq_data; 		
+		int *fam_conf_count = &buffer.fam_conf_count[ l * size_range_node ];
 
-			for( l = 0; l < 2; l++ )  // collects the necessary statistics from the data and calculates the score
-			{
-				fam_conf_count_0 = 0;
-				fam_conf_count_1 = 0;
-				for( i = 0; i < *length_freq_data; i++ )
-					if( data[ mb_node_x_lf + i ] == l ) 
-						( data[ node_x_lf + i ] == 0 ) ? fam_conf_count_0 += freq_data[ i ] : fam_conf_count_1 += freq_data[ i ];
-								
-				sum_lgamma_fam = lgammafn_sign( fam_conf_count_0 + *alpha_ijl, NULL ) + lgammafn_sign( fam_conf_count_1 + *alpha_ijl, NULL );
-		   
-				//mb_conf_count = fam_conf_count[0] + fam_conf_count[1];
-				*log_mpl_node += sum_lgamma_fam - lgammafn_sign( fam_conf_count_0 + fam_conf_count_1 + alpha_jl, NULL );     
-			}		
+		sum_lgamma_fam = 0.0;
+		for( j = 0; j < size_range_node; j++ ) 
+			sum_lgamma_fam += lgamma_fam_conf( lgamma_table, fam_conf_count[ j ], *alpha_ijl );
+   
+		mb_conf_count = ( *size_node == 0 ) ? *n : buffer.mb_conf_count[ l ];
+		*log_mpl_node += sum_lgamma_fam - lgamma_mb_conf( lgamma_table, mb_conf_count, size_range_node, alpha_jl );     
+	}		
+	
+	// adding remaining terms 
+    *log_mpl_node += size_mb_conf * lgamma_mb_conf( lgamma_table, 0, size_range_node, alpha_jl ) - size_mb_conf * size_range_node * lgamma_fam_conf( lgamma_table, 0, *alpha_ijl );     
+}
+     
+} // End of exturn "C"
 
-			// adding remaining terms 
-			*log_mpl_node += 2 * log_alpha_jl - 4 * log_alpha_ijl;   
-			break;
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// Data and run-scoped tables for the hill-climbing search, shared by all threads
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+struct mpl_hc_data
+{
+	int *data, *freq_data, *length_freq_data;
+	int *max_range_nodes;                               // NULL for binary data
+	double *alpha_ijl;
+	double *S;                                          // S = t( data ) %*% data for Gaussian data, else NULL
+	int *n, p;
+	mpl_lgamma_table lgamma_table;
+	vector< map< vector<int>, double > > score_cache;   // log_mpl of node for each MB ( sorted ) scored so far
+	bool cache_local;                                   // cache also the scores of PART 1
+};
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// Marginal pseudo-likelihood of node with Markov blanket mb_node, from the cache if
+// it is scored before; with cache = false a new score is not stored. Only one
+// thread may use the cache of a node at a time.
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+static double log_mpl_hc( int node, vector<int> &mb_node, mpl_hc_data &hc_data, mpl_count_buffer &buffer, bool cache = true )
+{
+	vector<int> mb_key( mb_node );
+	sort( mb_key.begin(), mb_key.end() );
+	
+	map< vector<int>, double >::iterator cached = hc_data.score_cache[ node ].find( mb_key );
+	if( cached != hc_data.score_cache[ node ].end() )
+	{
+		current_profile().add( run_profile::cache_hits );
+		return cached->second;
+	}
+	current_profile().add( run_profile::cache_misses );
+	
+	int size_node = mb_key.size();
+	int *mb_node_key = ( size_node > 0 ) ? &mb_key[0] : NULL;
+	double log_mpl_node;
 	
-		default:			
-			vector<vector<unsigned long long int> > mb_conf( *length_freq_data );		
-			vector<vector<unsigned long long int> > data_mb( *length_freq_data );		
-			int size_bit = sizeof( unsigned long long int ) * CHAR_BIT / 2;
+	if( hc_data.S != NULL )
+	{
+		// log_mpl needs room for the family, c( mb_node, node )
+		mb_key.push_back( node );
+		vector<double> S_mb_node( ( size_node + 1 ) * ( size_node + 1 ) );
+		log_mpl( &node, &mb_key[0], &size_node, &log_mpl_node, hc_data.S, &S_mb_node[0], hc_data.n, &hc_data.p );
+		mb_key.pop_back();
+	}else if( hc_data.max_range_nodes == NULL )
+		log_mpl_binary_hc( &node, mb_node_key, &size_node, &log_mpl_node, hc_data.data, hc_data.freq_data, hc_data.length_freq_data, hc_data.alpha_ijl, hc_data.lgamma_table, buffer );
+	else
+		log_mpl_hc_dis( &node, mb_node_key, &size_node, &log_mpl_node, hc_data.data, hc_data.freq_data, hc_data.length_freq_data, hc_data.max_range_nodes, hc_data.alpha_ijl, hc_data.n, hc_data.lgamma_table, buffer );
+	
+	if( cache ) hc_data.score_cache[ node ][ mb_key ] = log_mpl_node;
+	return log_mpl_node;
+}
 
-			int sz = size_bit;
-			int size_hash = *size_node / sz + 1;			
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// PART 1: Local Marginal Pseudo-likelihood optimization to discover the Markov 
+// blanket of node: greedy forward selection, with backward deletion once the 
+// blanket has more than two nodes
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+static void local_mb_hc( int node, vector<int> &mb_hat, mpl_hc_data &hc_data, mpl_count_buffer &buffer )
+{
+	int i, top, p = hc_data.p;
+	double log_mpl_candidate, log_mpl_top;
 	
-			#pragma omp parallel
+	vector<int> mb_potential, mb_candidate;
+	for( i = 0; i < p; i++ ) 
+		if( i != node ) mb_potential.push_back( i );
+	
+	mb_hat.clear();
+	double log_mpl_mb_hat = log_mpl_hc( node, mb_hat, hc_data, buffer, hc_data.cache_local );
+	bool cont = true;
+	
+	while( cont )
+	{
+		cont = false;
+		
+		top = -1;
+		for( i = 0; i < (int)mb_potential.size(); i++ )
+		{
+			mb_candidate = mb_hat;
+			mb_candidate.push_back( mb_potential[ i ] );
+			log_mpl_candidate = log_mpl_hc( node, mb_candidate, hc_data, buffer, hc_data.cache_local );
+			
+			if( ( top < 0 ) or ( log_mpl_candidate > log_mpl_top ) )
 			{
-				int j, i_hash;
-				vector<unsigned long long int> hash_mb( size_hash );
-				int sizeof_hash = size_hash * sizeof hash_mb[0];
+				top         = i;
+				log_mpl_top = log_mpl_candidate;
+			}
+		}
+		
+		if( ( top >= 0 ) and ( log_mpl_top > log_mpl_mb_hat ) )
+		{
+			mb_hat.push_back( mb_potential[ top ] );
+			mb_potential.erase( mb_potential.begin() + top );
+			log_mpl_mb_hat = log_mpl_top;
+			cont           = true;
+		}
+		
+		bool delete_node = ( mb_hat.size() > 2 ) and cont;
+		while( delete_node )
+		{
+			delete_node = false;
+			
+			top = -1;
+			for( i = 0; i < (int)mb_hat.size(); i++ )
+			{
+				mb_candidate = mb_hat;
+				mb_candidate.erase( mb_candidate.begin() + i );
+				log_mpl_candidate = log_mpl_hc( node, mb_candidate, hc_data, buffer, hc_data.cache_local );
 				
-				#pragma omp for
-				for( int i = 0; i < *length_freq_data; i++ )
+				if( ( top < 0 ) or ( log_mpl_candidate > log_mpl_top ) )
 				{
-					memset( &hash_mb[0], 0, sizeof_hash );
-					
-					for( j = 0; j < *size_node; j++ )
-					{
-						i_hash = j / sz;
-						//hash_mb[ i_hash ] |= data[ mb_node[j] * *length_freq_data + i ] << ( j - i_hash * sz );
-						hash_mb[ i_hash ] += (unsigned long long)data[ mb_node[ j ] * *length_freq_data + i ] << ( j - i_hash * sz );
-					}
-					data_mb[ i ] = hash_mb;
+					top         = i;
+					log_mpl_top = log_mpl_candidate;
 				}
 			}
 			
-			mb_conf = data_mb;
-			std::sort( mb_conf.begin(), mb_conf.end() );
-			mb_conf.erase( std::unique( mb_conf.begin(), mb_conf.end() ), mb_conf.end() );
-			size_mb_conf = mb_conf.size();
-
-			for( l = 0; l < size_mb_conf; l++ )  // collects the necessary statistics from the data and calculates the score
+			if( log_mpl_top > log_mpl_mb_hat )
 			{
-				fam_conf_count_0 = 0;
-				fam_conf_count_1 = 0;
-				for( i = 0; i < *length_freq_data; i++ )
-					if( data_mb[ i ] == mb_conf[ l ] ) 
-						( data[ node_x_lf + i ] == 0 ) ? fam_conf_count_0 += freq_data[ i ] : fam_conf_count_1 += freq_data[ i ];
-				
-				*log_mpl_node += lgammafn_sign( fam_conf_count_0 + *alpha_ijl, NULL ) + lgammafn_sign( fam_conf_count_1 + *alpha_ijl, NULL ) - lgammafn_sign( fam_conf_count_0 + fam_conf_count_1 + alpha_jl, NULL );     
+				mb_hat.erase( mb_hat.begin() + top );
+				log_mpl_mb_hat = log_mpl_top;
+				delete_node    = ( mb_hat.size() > 2 );
 			}
-
-			// adding remaining terms 
-			*log_mpl_node += size_mb_conf * ( log_alpha_jl - 2 * log_alpha_ijl );   
-
-			break;
+		}
 	}
 }
-    	
+
+// improvement of the score by changing an edge; version is to skip the outdated entries of the queue
+struct edge_gain
+{
+	double imp;
+	int edge, version;
+	
+	// the largest improvement first and, for equal improvements, the first edge
+	bool operator<( const edge_gain &other ) const
+	{
+		return ( imp < other.imp ) or ( ( imp == other.imp ) and ( edge > other.edge ) );
+	}
+};
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
-// Computing the Marginal pseudo-likelihood for discrete data
+// PART 2: Neighborhood search algorithm for global Marginal Pseudo-likelihood 
+// optimization, over the edges of G_local and starting from the empty graph. 
+// Each edge has two halves, the changes of the scores of its two nodes. Only the
+// halves of edges whose node changed its Markov blanket are scored again, in 
+// parallel, and the improvements are kept in a priority queue. log_mpl_trajectory
+// is the score of the graph, sum of log_mpl of the nodes, after each move.
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
-void log_mpl_hc_dis( int *node, int mb_node[], int *size_node, double *log_mpl_node, 
-                  int data[], int freq_data[], int *length_freq_data, 
-                  int max_range_nodes[], double *alpha_ijl, int *n )
+static void global_hc( int G_local[], int G[], mpl_hc_data &hc_data, vector<mpl_count_buffer> &thread_buffer, 
+                vector<double> &log_mpl_trajectory )
 {
-	int i, j, l, size_mb_conf;
-	int mb_node_x_lf, mb_conf_l, mb_conf_count;
-	int node_x_lf = *node * *length_freq_data;
-	double sum_lgamma_fam;
-
-	vector<int>mb_conf( *length_freq_data );
+	int i, j, e, h, t, p = hc_data.p;
 	
-    int max_range_node_j = max_range_nodes[ *node ];
-	vector<int>fam_conf_count( max_range_node_j );
-		   
-    double alpha_jl = max_range_node_j * *alpha_ijl;   
-
-	if( *size_node == 0 ) size_mb_conf = 1;
+	// edges ( i < j ) column by column, and the halves ( edge * 2 + h ) of each node
+	vector<int> edge_node;
+	vector< vector<int> > node_halves( p );
+	for( j = 0; j < p; j++ )
+		for( i = 0; i < j; i++ )
+			if( G_local[ j * p + i ] )
+			{
+				e = edge_node.size() / 2;
+				edge_node.push_back( i );
+				edge_node.push_back( j );
+				node_halves[ i ].push_back( 2 * e );
+				node_halves[ j ].push_back( 2 * e + 1 );
+			}
 	
-	vector<int>data_mb( *length_freq_data, 0 ); 
+	int size_edges = edge_node.size() / 2;
+
+	for( i = 0; i < p * p; i++ ) G[ i ] = 0;
 	
-	if( *size_node == 1 ) 
+	vector<double> curr_log_mpl( p );
+	vector<int> mb_empty;
+	double log_mpl_graph = 0.0;
+	for( i = 0; i < p; i++ ) 
 	{
-        // data_mb = data[ , mb_node ]          
-		mb_node_x_lf = mb_node[0] * *length_freq_data; 
-		//for( i = 0; i < *length_freq_data; i++ ) data_mb[i] = data[ mb_node_x_lf + i ]; 
-		memcpy( &data_mb[0], &data[0] + mb_node_x_lf, sizeof( int ) * *length_freq_data );    
-        
-        size_mb_conf = max_range_nodes[ mb_node[0] ];            
-        // mb_conf = 1:size_mb_conf;      
-		for( j = 0; j < size_mb_conf; j++ ) mb_conf[ j ] = j;     
+		curr_log_mpl[ i ] = log_mpl_hc( i, mb_empty, hc_data, thread_buffer[ 0 ] );
+		log_mpl_graph    += curr_log_mpl[ i ];
 	}
+	log_mpl_trajectory.push_back( log_mpl_graph );
 	
-	if( *size_node > 1 ) 
+	vector<double> change_imp( 2 * size_edges, 0.0 );
+	vector<int> change( 2 * size_edges, 1 ), change_edge( size_edges, 0 ), version( size_edges, 0 );
+	vector<int> change_nodes, change_edges;
+	vector< vector<int> > mb_half( 2 * size_edges );
+	priority_queue<edge_gain> queue_imp;
+
+	bool cont = true;
+	while( cont )
 	{
-		vector<int>cumprod_mb( *size_node );
-		cumprod_mb[0] = max_range_nodes[ mb_node[ 0 ] ];
-		//cumprod_mb   = t( t( c( 1, cumprod( max_range_nodes[ mb_node[ 2:length( mb_node ) ] ] ) ) ) )
-		for( j = 1; j < *size_node; j++ )
-			cumprod_mb[ j ] = cumprod_mb[ j - 1 ] * max_range_nodes[ mb_node[ j ] ];
+		cont = false;
+		
+		// Markov blankets of the nodes of the changed halves, after changing their edge
+		change_nodes.clear();
+		change_edges.clear();
+		for( int node = 0; node < p; node++ )
+		{
+			bool change_node = false;
+			for( h = 0; h < (int)node_halves[ node ].size(); h++ )
+			{
+				int half = node_halves[ node ][ h ];
+				if( !change[ half ] ) continue;
+				
+				int other = edge_node[ half ^ 1 ];
+				mb_half[ half ].clear();
+				for( t = 0; t < p; t++ ) 
+					if( ( t == other ) ? !G[ node * p + t ] : G[ node * p + t ] ) mb_half[ half ].push_back( t );
+
+				change_node = true;
+				if( !change_edge[ half / 2 ] )
+				{
+					change_edge[ half / 2 ] = 1;
+					change_edges.push_back( half / 2 );
+				}
+			}
 			
-        //data_mb = c( data[ , mb_node ] %*% cumprod_mb ) 
-		for( i = 0; i < *length_freq_data; i++ )
-			for( j = 0; j < *size_node; j++ )
-				data_mb[ i ] += cumprod_mb[ j ] * data[ mb_node[ j ] * *length_freq_data + i ];
+			if( change_node ) change_nodes.push_back( node );
+		}
+		
+		// scoring the changed halves in parallel, all halves of one node by one thread
+		{
+			profile_phase timer( run_profile::rates );
+			#pragma omp parallel
+			{
+				int id = 0;
+				#ifdef _OPENMP
+					id = omp_get_thread_num();
+				#endif
 			
-        //mb_conf      = unique( data_mb )            
-		//vector<int>mb_conf( *n );
-		//for( i = 0; i < *length_freq_data; i++ ) mb_conf[i] = data_mb[i];
-		memcpy( &mb_conf[0], &data_mb[0], sizeof( int ) * *length_freq_data );
-
-		std::sort( mb_conf.begin(), mb_conf.end() );
-		mb_conf.erase( std::unique( mb_conf.begin(), mb_conf.end() ), mb_conf.end() );	
+				#pragma omp for schedule( dynamic )
+				for( int k = 0; k < (int)change_nodes.size(); k++ )
+				{
+					profile_work work;
+					int node = change_nodes[ k ];
+					for( int h_node = 0; h_node < (int)node_halves[ node ].size(); h_node++ )
+					{
+						int half = node_halves[ node ][ h_node ];
+						if( change[ half ] )
+							change_imp[ half ] = log_mpl_hc( node, mb_half[ half ], hc_data, thread_buffer[ id ] ) - curr_log_mpl[ node ];
+					}
+				}
+			}
+		}
 		
-		size_mb_conf = mb_conf.size(); 
-	}
-	
-	if( *size_node == 0 ) 
-	{
-		//for( i in 1:max_range_node_j ) fam_conf_count[i] = sum( ( data[ , node ] == i ) * ind )
-		for( j = 0; j < max_range_node_j; j++ ) 
-		{  
-			 //fam_conf_count[j] = std::count( &data[0] + node_x_n, &data[0] + node_x_n + *n, j + 1 );
-			fam_conf_count[ j ] = 0;
-			for( i = 0; i < *length_freq_data; i++ )
-				if( data[ node_x_lf + i ] == j ) fam_conf_count[ j ] += freq_data[ i ];
+		for( int k = 0; k < (int)change_edges.size(); k++ )
+		{
+			e = change_edges[ k ];
+			change[ 2 * e ] = change[ 2 * e + 1 ] = change_edge[ e ] = 0;
+			
+			edge_gain gain = { change_imp[ 2 * e ] + change_imp[ 2 * e + 1 ], e, ++version[ e ] };
+			queue_imp.push( gain );
 		}
+		
+		// the edge with the largest improvement
+		while( !queue_imp.empty() and ( queue_imp.top().version != version[ queue_imp.top().edge ] ) ) 
+			queue_imp.pop();
+		
+		if( !queue_imp.empty() and ( queue_imp.top().imp > 0 ) )
+		{
+			e = queue_imp.top().edge;
+			queue_imp.pop();
 			
-		sum_lgamma_fam = 0.0;
-		for( j = 0; j < max_range_node_j; j++ ) 
-			sum_lgamma_fam += lgammafn( fam_conf_count[ j ] + *alpha_ijl );
-					   
-		*log_mpl_node = sum_lgamma_fam - lgammafn( *n + alpha_jl );      
+			i = edge_node[ 2 * e ];
+			j = edge_node[ 2 * e + 1 ];
+			G[ j * p + i ] = 1 - G[ j * p + i ];
+			G[ i * p + j ] = G[ j * p + i ];
+			
+			// new scores of i and j, from the cache
+			log_mpl_graph    -= curr_log_mpl[ i ] + curr_log_mpl[ j ];
+			curr_log_mpl[ i ] = log_mpl_hc( i, mb_half[ 2 * e ], hc_data, thread_buffer[ 0 ] );
+			curr_log_mpl[ j ] = log_mpl_hc( j, mb_half[ 2 * e + 1 ], hc_data, thread_buffer[ 0 ] );
+			log_mpl_graph    += curr_log_mpl[ i ] + curr_log_mpl[ j ];
+			log_mpl_trajectory.push_back( log_mpl_graph );
+			
+			for( h = 0; h < (int)node_halves[ i ].size(); h++ ) change[ node_halves[ i ][ h ] ] = 1;
+			for( h = 0; h < (int)node_halves[ j ].size(); h++ ) change[ node_halves[ j ][ h ] ] = 1;
+			
+			cont = true;
+		}
 	}
+}
 
-	if( *size_node > 0 ) 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// Divide-and-conquer type greedy hill climb algorithm ( Pensar et al. ): PART 1 
+// finds the Markov blanket of each node in parallel, PART 2 is the global search 
+// over the edges found in PART 1 ( G_local, with operator "or" ( operator_or = 1 )
+// or "and" ). G is the selected graph.
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+static void hill_climb_mpl( mpl_hc_data &hc_data, int *operator_or, int G[], vector<double> &log_mpl_trajectory )
+{
+	int i, j, dim = hc_data.p;
+	
+	hc_data.score_cache.resize( dim );
+	
+	// lgamma( k + alpha ) for all counts k = 0, ..., n and all ranges of the nodes
+	if( hc_data.S == NULL )
+		get_mpl_lgamma_table( hc_data.n, hc_data.alpha_ijl, hc_data.max_range_nodes, &dim, hc_data.lgamma_table );
+
+	int size_threads = 1;
+	#ifdef _OPENMP
+		size_threads = omp_get_max_threads();
+	#endif
+	vector<mpl_count_buffer> thread_buffer( size_threads );
+
+// - - PART 1: local search for the Markov blanket of each node - - - - - - - - |
+	Rprintf( " PART 1, running local search algorithm\n" );
+	
+	vector<int> G_mb( dim * dim, 0 );
 	{
-		*log_mpl_node = 0.0;
-		for( l = 0; l < size_mb_conf; l++ )  // collects the necessary statistics from the data and calculates the score
+		profile_phase timer( run_profile::rates );
+		#pragma omp parallel
 		{
-			//ind = c( ( data_mb == mb_conf[ l ] ) * 1 )   # finds positions of MB configuration 
-			//mb_conf_count = sum( ind )  # n_jl
-			mb_conf_l = mb_conf[ l ];
-			//mb_conf_count = std::count( data_mb.begin(), data_mb.end(), mb_conf_l );
-			mb_conf_count = 0;
-			for( i = 0; i < *length_freq_data; i++ )
-				if( data_mb[ i ] == mb_conf_l ) mb_conf_count += freq_data[ i ];
-			
-			//fam_conf_count = node_conf * 0
-			//for( j in 1:max_range_node_j ) fam_conf_count[j] = sum( ( data[ , node ] == j ) * ind )
-			for( j = 0; j < max_range_node_j; j++ )
+			int id = 0;
+			#ifdef _OPENMP
+				id = omp_get_thread_num();
+			#endif
+		
+			vector<int> mb_hat;
+		
+			#pragma omp for schedule( dynamic )
+			for( int node = 0; node < dim; node++ )
 			{
-				fam_conf_count[ j ] = 0;
-				for( i = 0; i < *length_freq_data; i++ )
-					if( ( data[ node_x_lf + i ] == j ) && ( data_mb[ i ] == mb_conf_l ) ) fam_conf_count[ j ] += freq_data[ i ];
+				profile_work work;
+				local_mb_hc( node, mb_hat, hc_data, thread_buffer[ id ] );
+				for( int k = 0; k < (int)mb_hat.size(); k++ ) G_mb[ node * dim + mb_hat[ k ] ] = 1;
 			}
+		}
+	}
+	
+	int size_edges = 0;
+	vector<int> G_local( dim * dim, 0 );
+	for( j = 0; j < dim; j++ )
+		for( i = 0; i < dim; i++ )
+		{
+			G_local[ j * dim + i ] = ( *operator_or ) ? ( G_mb[ j * dim + i ] or G_mb[ i * dim + j ] ) : ( G_mb[ j * dim + i ] and G_mb[ i * dim + j ] );
+			size_edges += G_local[ j * dim + i ];
+		}
 
-			sum_lgamma_fam = 0.0;
-			for( j = 0; j < max_range_node_j; j++ ) 
-				sum_lgamma_fam += lgammafn( fam_conf_count[ j ] + *alpha_ijl );
-	   
-			*log_mpl_node += sum_lgamma_fam - lgammafn( mb_conf_count + alpha_jl );     
-		}		
+// - - PART 2: global search over the edges found in PART 1 - - - - - - - - - - |
+	if( size_edges > 0 )
+	{
+		Rprintf( " PART 2, running global search algorithm\n" );
+		global_hc( &G_local[0], G, hc_data, thread_buffer, log_mpl_trajectory );
+	}else{
+		for( i = 0; i < dim * dim; i++ ) G[ i ] = 0;
+
+		// the trajectory is only the score of the empty graph
+		vector<int> mb_empty;
+		double log_mpl_graph = 0.0;
+		for( i = 0; i < dim; i++ ) log_mpl_graph += log_mpl_hc( i, mb_empty, hc_data, thread_buffer[ 0 ] );
+		log_mpl_trajectory.push_back( log_mpl_graph );
 	}
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// Copies the score trajectory to R: size_trajectory is the length of 
+// log_mpl_trajectory on input and the number of stored scores on output
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+static void copy_trajectory( vector<double> &trajectory, double log_mpl_trajectory[], int *size_trajectory )
+{
+	if( (int)trajectory.size() < *size_trajectory ) *size_trajectory = trajectory.size();
 	
-	// adding remaining terms 
-    *log_mpl_node += size_mb_conf * lgammafn( alpha_jl ) - size_mb_conf * max_range_node_j * lgammafn( *alpha_ijl );     
+	for( int i = 0; i < *size_trajectory; i++ ) log_mpl_trajectory[ i ] = trajectory[ i ];
 }
-     
+
+extern "C" {
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// Hill climb algorithm for discrete data
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+void hill_climb_mpl_dis( int data[], int freq_data[], int *length_freq_data, int max_range_nodes[], 
+                double *alpha_ijl, int *n, int *p, int *operator_or, int G[], 
+                double log_mpl_trajectory[], int *size_trajectory )
+{
+	mpl_hc_data hc_data;
+	hc_data.data             = data;
+	hc_data.freq_data        = freq_data;
+	hc_data.length_freq_data = length_freq_data;
+	hc_data.max_range_nodes  = max_range_nodes;
+	hc_data.alpha_ijl        = alpha_ijl;
+	hc_data.S                = NULL;
+	hc_data.n                = n;
+	hc_data.p                = *p;
+	hc_data.cache_local      = true;
+	
+	vector<double> trajectory;
+	hill_climb_mpl( hc_data, operator_or, G, trajectory );
+	
+	copy_trajectory( trajectory, log_mpl_trajectory, size_trajectory );
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// Hill climb algorithm for binary data
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+void hill_climb_mpl_binary( int data[], int freq_data[], int *length_freq_data, 
+                double *alpha_ijl, int *n, int *p, int *operator_or, int G[], 
+                double log_mpl_trajectory[], int *size_trajectory )
+{
+	mpl_hc_data hc_data;
+	hc_data.data             = data;
+	hc_data.freq_data        = freq_data;
+	hc_data.length_freq_data = length_freq_data;
+	hc_data.max_range_nodes  = NULL;
+	hc_data.alpha_ijl        = alpha_ijl;
+	hc_data.S                = NULL;
+	hc_data.n                = n;
+	hc_data.p                = *p;
+	hc_data.cache_local      = true;
+	
+	vector<double> trajectory;
+	hill_climb_mpl( hc_data, operator_or, G, trajectory );
+	
+	copy_trajectory( trajectory, log_mpl_trajectory, size_trajectory );
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// Hill climb algorithm for Gaussian data, with the scores of log_mpl ( as in 
+// ggm_bdmcmc_mpl_ma ). The scores are small determinants, so the scores of PART 1
+// are not cached: the cache would grow with p^2 for p in the thousands.
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+void hill_climb_mpl_ggm( double S[], int *n, int *p, int *operator_or, int G[], 
+                double log_mpl_trajectory[], int *size_trajectory )
+{
+	mpl_hc_data hc_data;
+	hc_data.data             = NULL;
+	hc_data.freq_data        = NULL;
+	hc_data.length_freq_data = NULL;
+	hc_data.max_range_nodes  = NULL;
+	hc_data.alpha_ijl        = NULL;
+	hc_data.S                = S;
+	hc_data.n                = n;
+	hc_data.p                = *p;
+	hc_data.cache_local      = false;
+	
+	vector<double> trajectory;
+	hill_climb_mpl( hc_data, operator_or, G, trajectory );
+	
+	copy_trajectory( trajectory, log_mpl_trajectory, size_trajectory );
+}
+      
 } // End of exturn "C"
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
@@ -10,222 +10,58 @@
 //     Maintainer: Reza Mohammadi <a.mohammadi@uva.nl>                                             |
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
 
-#include "matrix.h"
+#include "mpl_count.h"
 
-extern "C" {
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
-// Computing the Marginal pseudo-likelihood for BINARY data
+// Marginal pseudo-likelihood for BINARY data from the ( count0, count1 ) of each observed MB 
+// configuration; 'count_mb_conf( &size_mb_conf )' fills buffer.fam_conf_count
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
-void log_mpl_binary( int *node, int mb_node[], int *size_node, double *log_mpl_node, 
-                  int data[], int freq_data[], int *length_freq_data, 
-                  double *alpha_ijl, double *alpha_jl, double *log_alpha_ijl, double *log_alpha_jl, int *n, 
-                  int vec_fam_conf_count_0[], int vec_fam_conf_count_1[],
-                  vector<vector<unsigned long long int> > &mb_conf, int *size_bit )
+template< class count_routine >
+static void log_mpl_binary_counts( count_routine count_mb_conf, double *log_mpl_node, 
+                  double *alpha_ijl, double *alpha_jl, double *log_alpha_ijl, double *log_alpha_jl, 
+                  mpl_lgamma_table &lgamma_table, mpl_count_buffer &buffer )
 {
-	int i_hash, counter, i, j, l, size_mb_conf, mb_node_x_lf, node_x_lf = *node * *length_freq_data;
-	double sum_lgamma_fam;
+	int l, size_mb_conf, fam_conf_count_0, fam_conf_count_1;
+
+	count_mb_conf( &size_mb_conf );
 
 	*log_mpl_node = 0.0;
-	int fam_conf_count_0 = 0, fam_conf_count_1 = 0;
-		   
-	switch( *size_node )
+	for( l = 0; l < size_mb_conf; l++ )  // collects the necessary statistics from the data and calculates the score
 	{
-		case 0:
-			for( i = 0; i < *length_freq_data; i++ )
-				( data[ node_x_lf + i ] == 0 ) ? fam_conf_count_0 += freq_data[ i ] : fam_conf_count_1 += freq_data[ i ];
-				
-			sum_lgamma_fam = lgammafn_sign( fam_conf_count_0 + *alpha_ijl, NULL ) + lgammafn_sign( fam_conf_count_1 + *alpha_ijl, NULL );
-						   
-			*log_mpl_node = sum_lgamma_fam - lgammafn_sign( *n + *alpha_jl, NULL ) + *log_alpha_jl - 2 * *log_alpha_ijl;      
-			break;
-				
-		case 1:
-			mb_node_x_lf = mb_node[ 0 ] * *length_freq_data; 		
-
-			for( l = 0; l < 2; l++ )  // collects the necessary statistics from the data and calculates the score
-			{
-				fam_conf_count_0 = 0;
-				fam_conf_count_1 = 0;
-				for( i = 0; i < *length_freq_data; i++ )
-					if( data[ mb_node_x_lf + i ] == l ) 
-						( data[ node_x_lf + i ] == 0 ) ? fam_conf_count_0 += freq_data[ i ] : fam_conf_count_1 += freq_data[ i ];
-								
-				sum_lgamma_fam = lgammafn_sign( fam_conf_count_0 + *alpha_ijl, NULL ) + lgammafn_sign( fam_conf_count_1 + *alpha_ijl, NULL );
-		   
-				//mb_conf_count = fam_conf_count[0] + fam_conf_count[1];
-				*log_mpl_node += sum_lgamma_fam - lgammafn_sign( fam_conf_count_0 + fam_conf_count_1 + *alpha_jl, NULL );     
-			}		
-
-			// adding remaining terms 
-			*log_mpl_node += 2 * *log_alpha_jl - 4 * *log_alpha_ijl;   
-			break;
-	
-		default:			
-			int sz = *size_bit;
-			int size_hash = *size_node / sz + 1;
-			vector<unsigned long long int> hash_mb( size_hash, 0 );			
-
-			// for case i = 0
-			for( j = 0; j < *size_node; j++ )
-			{
-				i_hash = j / sz;
-				//hash_mb[ i_hash ] |= data[ mb_node[j] * *length_freq_data ] << ( j - i_hash * sz );
-				hash_mb[ i_hash ] += (unsigned long long)data[ mb_node[ j ] * *length_freq_data ] << ( j - i_hash * sz );
-			}
-			mb_conf[0] = hash_mb;
-			size_mb_conf = 1;
-
-			if( data[ node_x_lf ] == 0 ) 
-			{
-				vec_fam_conf_count_0[ 0 ] = freq_data[ 0 ];
-				vec_fam_conf_count_1[ 0 ] = 0;
-			}else{
-				vec_fam_conf_count_1[ 0 ] = freq_data[ 0 ];
-				vec_fam_conf_count_0[ 0 ] = 0;
-			}
-
-			int sizeof_hash = size_hash * sizeof hash_mb[ 0 ];
-			for( i = 1; i < *length_freq_data; i++ )
-			{
-				//vector<unsigned long long int> hash_mb( size_hash, 0 );
-				memset( &hash_mb[0], 0, sizeof_hash );
-				
-				for( j = 0; j < *size_node; j++ )
-				{
-					i_hash = j / sz;
-					//hash_mb[ i_hash ] |= data[ mb_node[j] * *length_freq_data + i ] << ( j - i_hash * sz );
-					hash_mb[ i_hash ] += (unsigned long long)data[ mb_node[ j ] * *length_freq_data + i ] << ( j - i_hash * sz );
-				}
-				
-				//data_mb[i] = hash_mb;
-				counter = 1;
-				for( j = 0; j < size_mb_conf; j++ )
-					if( hash_mb == mb_conf[ j ] ) 
-					{
-						( data[ node_x_lf + i ] == 0 ) ? vec_fam_conf_count_0[ j ] += freq_data[ i ] : vec_fam_conf_count_1[ j ] += freq_data[ i ];
-						counter = 0;  
-						break;
-					}					
-				
-				if( counter )
-				{
-					//( data[ node_x_lf + i ] == 0 ) ? vec_fam_conf_count_0[ size_mb_conf ] = freq_data[ i ] : vec_fam_conf_count_1[ size_mb_conf ] = freq_data[ i ];
-					if( data[ node_x_lf + i ] == 0 ) 
-					{
-						vec_fam_conf_count_0[ size_mb_conf ] = freq_data[ i ];
-						vec_fam_conf_count_1[ size_mb_conf ] = 0;
-					}else{
-						vec_fam_conf_count_1[ size_mb_conf ] = freq_data[ i ];
-						vec_fam_conf_count_0[ size_mb_conf ] = 0;
-					}
-					
-					mb_conf[ size_mb_conf++ ] = hash_mb;
-				}
-			}
-						
-			for( l = 0; l < size_mb_conf; l++ )  // collects the necessary statistics from the data and calculates the score
-				*log_mpl_node += lgammafn_sign( vec_fam_conf_count_0[ l ] + *alpha_ijl, NULL ) + lgammafn_sign( vec_fam_conf_count_1[ l ] + *alpha_ijl, NULL ) - lgammafn_sign( vec_fam_conf_count_0[l] + vec_fam_conf_count_1[l] + *alpha_jl, NULL );     
+		fam_conf_count_0 = buffer.fam_conf_count[ 2 * l ];
+		fam_conf_count_1 = buffer.fam_conf_count[ 2 * l + 1 ];
+		
+		*log_mpl_node += lgamma_fam_conf( lgamma_table, fam_conf_count_0, *alpha_ijl ) + lgamma_fam_conf( lgamma_table, fam_conf_count_1, *alpha_ijl ) - lgamma_mb_conf( lgamma_table, fam_conf_count_0 + fam_conf_count_1, 2, *alpha_jl );     
+	}
 
-			// adding remaining terms 
-			*log_mpl_node += size_mb_conf * ( *log_alpha_jl - 2 * *log_alpha_ijl );   
+	// adding remaining terms 
+	*log_mpl_node += size_mb_conf * ( *log_alpha_jl - 2 * *log_alpha_ijl );   
+}
 
-			break;
-	}
+extern "C" {
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// Computing the Marginal pseudo-likelihood for BINARY data, from the bit-sliced data
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+void log_mpl_binary( int *node, int mb_node[], int *size_node, double *log_mpl_node, 
+                  mpl_bit_data &bit_data, double *alpha_ijl, double *alpha_jl, 
+                  double *log_alpha_ijl, double *log_alpha_jl, 
+                  mpl_lgamma_table &lgamma_table, mpl_count_buffer &buffer )
+{
+	log_mpl_binary_counts( [&]( int *size_mb_conf ){ fam_conf_count_bit( node, mb_node, size_node, bit_data, size_mb_conf, buffer ); },
+	                       log_mpl_node, alpha_ijl, alpha_jl, log_alpha_ijl, log_alpha_jl, lgamma_table, buffer );
 }
     	
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
-// Parallel function to compute the Marginal pseudo-likelihood for BINARY data
+// Parallel function to compute the Marginal pseudo-likelihood for BINARY data: thread-local
+// count tables merged at the end
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
 void log_mpl_binary_parallel( int *node, int mb_node[], int *size_node, double *log_mpl_node, 
-                  int data[], int freq_data[], int *length_freq_data, 
-                  double *alpha_ijl, double *alpha_jl, double *log_alpha_ijl, double *log_alpha_jl, int *n, 
-                  vector<vector<unsigned long long int> > &mb_conf, 
-                  vector<vector<unsigned long long int> > &data_mb, int *size_bit )
+                  mpl_bit_data &bit_data, double *alpha_ijl, double *alpha_jl, 
+                  double *log_alpha_ijl, double *log_alpha_jl, mpl_lgamma_table &lgamma_table, 
+                  mpl_count_buffer &buffer, vector<mpl_count_buffer> &thread_buffer )
 {
-	int i, l, size_mb_conf, mb_node_x_lf, node_x_lf = *node * *length_freq_data;
-	double sum_lgamma_fam;
-
-	*log_mpl_node = 0.0;
-	int fam_conf_count_0 = 0, fam_conf_count_1 = 0;
-		   
-	switch( *size_node )
-	{
-		case 0:
-			for( i = 0; i < *length_freq_data; i++ )
-				( data[ node_x_lf + i ] == 0 ) ? fam_conf_count_0 += freq_data[ i ] : fam_conf_count_1 += freq_data[ i ];
-				
-			sum_lgamma_fam = lgammafn_sign( fam_conf_count_0 + *alpha_ijl, NULL ) + lgammafn_sign( fam_conf_count_1 + *alpha_ijl, NULL );
-						   
-			*log_mpl_node = sum_lgamma_fam - lgammafn_sign( *n + *alpha_jl, NULL ) + *log_alpha_jl - 2 * *log_alpha_ijl;      
-			break;
-				
-		case 1:
-			mb_node_x_lf = mb_node[0] * *length_freq_data; 		
-
-			for( l = 0; l < 2; l++ )  // collects the necessary statistics from the data and calculates the score
-			{
-				fam_conf_count_0 = 0;
-				fam_conf_count_1 = 0;
-				for( i = 0; i < *length_freq_data; i++ )
-					if( data[ mb_node_x_lf + i ] == l ) 
-						( data[ node_x_lf + i ] == 0 ) ? fam_conf_count_0 += freq_data[ i ] : fam_conf_count_1 += freq_data[ i ];
-								
-				sum_lgamma_fam = lgammafn_sign( fam_conf_count_0 + *alpha_ijl, NULL ) + lgammafn_sign( fam_conf_count_1 + *alpha_ijl, NULL );
-		   
-				//mb_conf_count = fam_conf_count[0] + fam_conf_count[1];
-				*log_mpl_node += sum_lgamma_fam - lgammafn_sign( fam_conf_count_0 + fam_conf_count_1 + *alpha_jl, NULL );     
-			}		
-
-			// adding remaining terms 
-			*log_mpl_node += 2 * *log_alpha_jl - 4 * *log_alpha_ijl;   
-			break;
-	
-		default:			
-			int sz = *size_bit;
-			int size_hash = *size_node / sz + 1;			
-
-			#pragma omp parallel
-			{
-				int j, i_hash;
-				vector<unsigned long long int> hash_mb( size_hash );
-				int sizeof_hash = size_hash * sizeof hash_mb[0];
-				
-				#pragma omp for
-				for( int i = 0; i < *length_freq_data; i++ )
-				{
-					memset( &hash_mb[0], 0, sizeof_hash );
-					
-					for( j = 0; j < *size_node; j++ )
-					{
-						i_hash = j / sz;
-						//hash_mb[ i_hash ] |= data[ mb_node[j] * *length_freq_data + i ] << ( j - i_hash * sz );
-						hash_mb[ i_hash ] += (unsigned long long)data[ mb_node[ j ] * *length_freq_data + i ] << ( j - i_hash * sz );
-					}
-					data_mb[ i ] = hash_mb;
-				}
-			}
-			
-			mb_conf = data_mb;
-			std::sort( mb_conf.begin(), mb_conf.end() );
-			mb_conf.erase( std::unique( mb_conf.begin(), mb_conf.end() ), mb_conf.end() );
-			size_mb_conf = mb_conf.size();
-
-			for( l = 0; l < size_mb_conf; l++ )  // collects the necessary statistics from the data and calculates the score
-			{
-				fam_conf_count_0 = 0;
-				fam_conf_count_1 = 0;
-				for( i = 0; i < *length_freq_data; i++ )
-					if( data_mb[ i ] == mb_conf[ l ] ) 
-						( data[ node_x_lf + i ] == 0 ) ? fam_conf_count_0 += freq_data[ i ] : fam_conf_count_1 += freq_data[ i ];
-				
-				*log_mpl_node += lgammafn_sign( fam_conf_count_0 + *alpha_ijl, NULL ) + lgammafn_sign( fam_conf_count_1 + *alpha_ijl, NULL ) - lgammafn_sign( fam_conf_count_0 + fam_conf_count_1 + *alpha_jl, NULL );     
-			}
-
-			// adding remaining terms 
-			*log_mpl_node += size_mb_conf * ( *log_alpha_jl - 2 * *log_alpha_ijl );   
-
-			break;
-	}
+	log_mpl_binary_counts( [&]( int *size_mb_conf ){ fam_conf_count_bit_parallel( node, mb_node, size_node, bit_data, size_mb_conf, buffer, thread_buffer ); },
+	                       log_mpl_node, alpha_ijl, alpha_jl, log_alpha_ijl, log_alpha_jl, lgamma_table, buffer );
 }
     	
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
@@ -234,12 +70,11 @@ void log_mpl_binary_parallel( int *node, int mb_node[], int *size_node, double *
 void rates_gm_mpl_binary( double rates[], double log_ratio_g_prior[], 
                     double log_mpl_pro_node_i[], double log_mpl_pro_node_j[], 
                     double curr_log_mpl[], int G[], double g_prior[], int index_row[], int index_col[], int *sub_qp, 
-                    int size_node[], int data[], int freq_data[], int *length_freq_data,
-                    double *alpha_ijl, double *alpha_jl, double *log_alpha_ijl, double *log_alpha_jl, 
-                    int *n, int *p )
+                    int size_node[], mpl_bit_data &bit_data, mpl_lgamma_table &lgamma_table,
+                    double *alpha_ijl, double *alpha_jl, double *log_alpha_ijl, double *log_alpha_jl, int *p )
 {
+	profile_phase timer( run_profile::rates );
 	int dim = *p;
-	int size_bit = sizeof( unsigned long long int ) * CHAR_BIT / 2;
 
 	#pragma omp parallel
 	{
@@ -249,18 +84,17 @@ void rates_gm_mpl_binary( double rates[], double log_ratio_g_prior[],
 		int *mb_node_i_new = new int[ dim ];          // For dynamic memory used
 		int *mb_node_j_new = new int[ dim ];          // For dynamic memory used
 
-		vector<vector<unsigned long long int> > mb_conf( *length_freq_data );		
-		vector<int>vec_fam_conf_count_0( *length_freq_data );	
-		vector<int>vec_fam_conf_count_1( *length_freq_data );	
+		mpl_count_buffer count_buffer;                // work space for log_mpl_binary, reused by this thread
 
 		#pragma omp for
 		for( int counter = 0; counter < *sub_qp; counter++ )
 		{
+			profile_work work;
 			i  = index_row[ counter ];
 			j  = index_col[ counter ];
 			ij =  j * dim + i;
 			
-			if( ( g_prior[ ij ] != 0.0 ) or ( g_prior[ ij ] != 1.0 ) )
+			if( ( g_prior[ ij ] != 0.0 ) and ( g_prior[ ij ] != 1.0 ) )
 			{
 			    if( G[ ij ] )
     			{ 
@@ -297,8 +131,8 @@ void rates_gm_mpl_binary( double rates[], double log_ratio_g_prior[],
     					if( G[ nodexdim + t ] or t == i ) mb_node_j_new[ count_mb++ ] = t;
     			}
     			
-    			log_mpl_binary( &i, mb_node_i_new, &size_node_i_new, &log_mpl_pro_node_i[ counter ], data, freq_data, length_freq_data, alpha_ijl, alpha_jl, log_alpha_ijl, log_alpha_jl, n, &vec_fam_conf_count_0[0], &vec_fam_conf_count_1[0], mb_conf, &size_bit );		
-    			log_mpl_binary( &j, mb_node_j_new, &size_node_j_new, &log_mpl_pro_node_j[ counter ], data, freq_data, length_freq_data, alpha_ijl, alpha_jl, log_alpha_ijl, log_alpha_jl, n, &vec_fam_conf_count_0[0], &vec_fam_conf_count_1[0], mb_conf, &size_bit );		
+    			log_mpl_binary( &i, mb_node_i_new, &size_node_i_new, &log_mpl_pro_node_i[ counter ], bit_data, alpha_ijl, alpha_jl, log_alpha_ijl, log_alpha_jl, lgamma_table, count_buffer );		
+    			log_mpl_binary( &j, mb_node_j_new, &size_node_j_new, &log_mpl_pro_node_j[ counter ], bit_data, alpha_ijl, alpha_jl, log_alpha_ijl, log_alpha_jl, lgamma_table, count_buffer );		
     																		
     			log_rate = log_mpl_pro_node_i[ counter ] + log_mpl_pro_node_j[ counter ] - curr_log_mpl[ i ] - curr_log_mpl[ j ];
     			//log_rate = ( G_ij ) ? log_rate - *log_ratio_g_prior : log_rate + *log_ratio_g_prior;
@@ -319,12 +153,11 @@ void rates_gm_mpl_binary( double rates[], double log_ratio_g_prior[],
 void local_rates_gm_mpl_binary( double rates[], double log_ratio_g_prior[], 
                     double log_mpl_pro_node_i[], double log_mpl_pro_node_j[], 
                     int *selected_edge_i, int *selected_edge_j, double curr_log_mpl[], int G[], double g_prior[],
-                    int size_node[], int data[], int freq_data[], int *length_freq_data,
-                    double *alpha_ijl, double *alpha_jl, double *log_alpha_ijl, double *log_alpha_jl, 
-                    int *n, int *p )
+                    int size_node[], mpl_bit_data &bit_data, mpl_lgamma_table &lgamma_table,
+                    double *alpha_ijl, double *alpha_jl, double *log_alpha_ijl, double *log_alpha_jl, int *p )
 {
+	profile_phase timer( run_profile::rates );
 	int dim = *p;
-	int size_bit = sizeof( unsigned long long int ) * CHAR_BIT / 2;
 	
 	#pragma omp parallel
 	{
@@ -333,18 +166,17 @@ void local_rates_gm_mpl_binary( double rates[], double log_ratio_g_prior[],
 		
 		int *mb_node_j_new = new int[ dim ];          // For dynamic memory used
 
-		vector<vector<unsigned long long int> > mb_conf( *length_freq_data );		
-		vector<int>vec_fam_conf_count_0( *length_freq_data );	
-		vector<int>vec_fam_conf_count_1( *length_freq_data );	
+		mpl_count_buffer count_buffer;                // work space for log_mpl_binary, reused by this thread
 
 		#pragma omp for
 		for( int ind = 0; ind < *selected_edge_i; ind++ )
 		{
+			profile_work work;
 			i  = ind;
 			j  = *selected_edge_i;
 			ij = j * dim + i;
 			
-			if( ( g_prior[ ij ] != 0.0 ) or ( g_prior[ ij ] != 1.0 ) )
+			if( ( g_prior[ ij ] != 0.0 ) and ( g_prior[ ij ] != 1.0 ) )
 			{
     			counter = j * ( j - 1 ) / 2 + i;
     
@@ -368,7 +200,7 @@ void local_rates_gm_mpl_binary( double rates[], double log_ratio_g_prior[],
     					if( G[ nodexdim + t ] or t == i ) mb_node_j_new[ count_mb++ ] = t;
     			}
     			
-    			log_mpl_binary( &j, mb_node_j_new, &size_node_j_new, &log_mpl_pro_node_j[ counter ], data, freq_data, length_freq_data, alpha_ijl, alpha_jl, log_alpha_ijl, log_alpha_jl, n, &vec_fam_conf_count_0[0], &vec_fam_conf_count_1[0], mb_conf, &size_bit );								
+    			log_mpl_binary( &j, mb_node_j_new, &size_node_j_new, &log_mpl_pro_node_j[ counter ], bit_data, alpha_ijl, alpha_jl, log_alpha_ijl, log_alpha_jl, lgamma_table, count_buffer );								
     
     			log_rate = log_mpl_pro_node_i[ counter ] + log_mpl_pro_node_j[ counter ] - curr_log_mpl[ i ] - curr_log_mpl[ j ];
     			// log_rate = ( G_ij ) ? log_rate - *log_ratio_g_prior : log_rate + *log_ratio_g_prior;
@@ -388,18 +220,17 @@ void local_rates_gm_mpl_binary( double rates[], double log_ratio_g_prior[],
 		
 		int *mb_node_i_new = new int[ dim ];          // For dynamic memory used
 
-		vector<vector<unsigned long long int> > mb_conf( *length_freq_data );		
-		vector<int>vec_fam_conf_count_0( *length_freq_data );	
-		vector<int>vec_fam_conf_count_1( *length_freq_data );	
+		mpl_count_buffer count_buffer;                // work space for log_mpl_binary, reused by this thread
 
 		#pragma omp for
 		for( int ind = *selected_edge_i + 1; ind < dim; ind++ )
 		{
+			profile_work work;
 			i  = *selected_edge_i;
 			j  = ind;
 			ij = j * dim + i;
 
-			if( ( g_prior[ ij ] != 0.0 ) or ( g_prior[ ij ] != 1.0 ) )
+			if( ( g_prior[ ij ] != 0.0 ) and ( g_prior[ ij ] != 1.0 ) )
 			{
 			    counter = j * ( j - 1 ) / 2 + i;
 
@@ -423,7 +254,7 @@ void local_rates_gm_mpl_binary( double rates[], double log_ratio_g_prior[],
     					if( G[ nodexdim + t ] or t == j ) mb_node_i_new[ count_mb++ ] = t;
     			}
     			
-    			log_mpl_binary( &i, mb_node_i_new, &size_node_i_new, &log_mpl_pro_node_i[ counter ], data, freq_data, length_freq_data, alpha_ijl, alpha_jl, log_alpha_ijl, log_alpha_jl, n, &vec_fam_conf_count_0[0], &vec_fam_conf_count_1[0], mb_conf, &size_bit );		
+    			log_mpl_binary( &i, mb_node_i_new, &size_node_i_new, &log_mpl_pro_node_i[ counter ], bit_data, alpha_ijl, alpha_jl, log_alpha_ijl, log_alpha_jl, lgamma_table, count_buffer );		
     
     			log_rate = log_mpl_pro_node_i[ counter ] + log_mpl_pro_node_j[ counter ] - curr_log_mpl[ i ] - curr_log_mpl[ j ];
     			//log_rate = ( G_ij ) ? log_rate - *log_ratio_g_prior : log_rate + *log_ratio_g_prior;
@@ -443,18 +274,17 @@ void local_rates_gm_mpl_binary( double rates[], double log_ratio_g_prior[],
 		
 		int *mb_node_j_new = new int[ dim ];          // For dynamic memory used
 
-		vector<vector<unsigned long long int> > mb_conf( *length_freq_data );		
-		vector<int>vec_fam_conf_count_0( *length_freq_data );	
-		vector<int>vec_fam_conf_count_1( *length_freq_data );	
+		mpl_count_buffer count_buffer;                // work space for log_mpl_binary, reused by this thread
 
 		#pragma omp for
 		for( int ind = 0; ind < *selected_edge_j; ind++ )
 		{
+			profile_work work;
 			i  = ind;
 			j  = *selected_edge_j;
 			ij = j * dim + i;
 
-			if( ( g_prior[ ij ] != 0.0 ) or ( g_prior[ ij ] != 1.0 ) )
+			if( ( g_prior[ ij ] != 0.0 ) and ( g_prior[ ij ] != 1.0 ) )
 			{
 			    counter = j * ( j - 1 ) / 2 + i;
 
@@ -478,7 +308,7 @@ void local_rates_gm_mpl_binary( double rates[], double log_ratio_g_prior[],
     					if( G[ nodexdim + t ] or t == i ) mb_node_j_new[ count_mb++ ] = t;
     			}
     			
-    			log_mpl_binary( &j, mb_node_j_new, &size_node_j_new, &log_mpl_pro_node_j[ counter ], data, freq_data, length_freq_data, alpha_ijl, alpha_jl, log_alpha_ijl, log_alpha_jl, n, &vec_fam_conf_count_0[0], &vec_fam_conf_count_1[0], mb_conf, &size_bit );								
+    			log_mpl_binary( &j, mb_node_j_new, &size_node_j_new, &log_mpl_pro_node_j[ counter ], bit_data, alpha_ijl, alpha_jl, log_alpha_ijl, log_alpha_jl, lgamma_table, count_buffer );								
     
     			log_rate = log_mpl_pro_node_i[ counter ] + log_mpl_pro_node_j[ counter ] - curr_log_mpl[ i ] - curr_log_mpl[ j ];
     			//log_rate = ( G_ij ) ? log_rate - *log_ratio_g_prior : log_rate + *log_ratio_g_prior;
@@ -498,18 +328,17 @@ void local_rates_gm_mpl_binary( double rates[], double log_ratio_g_prior[],
 		
 		int *mb_node_i_new = new int[ dim ];          // For dynamic memory used
 
-		vector<vector<unsigned long long int> > mb_conf( *length_freq_data );		
-		vector<int>vec_fam_conf_count_0( *length_freq_data );	
-		vector<int>vec_fam_conf_count_1( *length_freq_data );	
+		mpl_count_buffer count_buffer;                // work space for log_mpl_binary, reused by this thread
 
 		#pragma omp for
 		for( int ind = *selected_edge_j + 1; ind < dim; ind++ )
 		{
+			profile_work work;
 			i  = *selected_edge_j;
 			j  = ind;
 			ij = j * dim + i;
 
-			if( ( g_prior[ ij ] != 0.0 ) or ( g_prior[ ij ] != 1.0 ) )
+			if( ( g_prior[ ij ] != 0.0 ) and ( g_prior[ ij ] != 1.0 ) )
 			{
 			    counter = j * ( j - 1 ) / 2 + i;
 
@@ -533,7 +362,7 @@ void local_rates_gm_mpl_binary( double rates[], double log_ratio_g_prior[],
     					if( G[ nodexdim + t ] or t == j ) mb_node_i_new[ count_mb++ ] = t;
     			}
     			
-    			log_mpl_binary( &i, mb_node_i_new, &size_node_i_new, &log_mpl_pro_node_i[ counter ], data, freq_data, length_freq_data, alpha_ijl, alpha_jl, log_alpha_ijl, log_alpha_jl, n, &vec_fam_conf_count_0[0], &vec_fam_conf_count_1[0], mb_conf, &size_bit );		
+    			log_mpl_binary( &i, mb_node_i_new, &size_node_i_new, &log_mpl_pro_node_i[ counter ], bit_data, alpha_ijl, alpha_jl, log_alpha_ijl, log_alpha_jl, lgamma_table, count_buffer );		
     
     			log_rate = log_mpl_pro_node_i[ counter ] + log_mpl_pro_node_j[ counter ] - curr_log_mpl[ i ] - curr_log_mpl[ j ];
     			//log_rate = ( G_ij ) ? log_rate - *log_ratio_g_prior : log_rate + *log_ratio_g_prior;
@@ -578,11 +407,16 @@ void dgm_bdmcmc_mpl_binary_ma( int *iter, int *burnin, int G[], double g_prior[]
 	vector<int>mb_node( dim );     
 	vector<double>curr_log_mpl( dim );
 
-	int size_bit = sizeof( unsigned long long int ) * CHAR_BIT / 2;
-	vector<vector<unsigned long long int> > mb_conf( length_freq_data );		
-	vector<vector<unsigned long long int> > data_mb( length_freq_data );		
-	vector<int>vec_fam_conf_count_0( length_freq_data );	
-	vector<int>vec_fam_conf_count_1( length_freq_data );	
+	mpl_count_buffer count_buffer;
+	vector<mpl_count_buffer> thread_count_buffer;
+
+	// bit-sliced copy of the data, for counting with AND + popcount
+	mpl_bit_data bit_data;
+	get_mpl_bit_data( data, freq_data, &length_freq_data, &dim, bit_data );
+
+	// lgamma( k + alpha ) for all counts k = 0, ..., n, shared by all threads
+	mpl_lgamma_table lgamma_table;
+	get_mpl_lgamma_table( &copy_n, alpha_ijl, NULL, &dim, lgamma_table );
 
 	for( i = 0; i < dim; i++ ) 
 	{ 
@@ -594,7 +428,7 @@ void dgm_bdmcmc_mpl_binary_ma( int *iter, int *burnin, int G[], double g_prior[]
 				if( G[ nodexdim + t ] ) mb_node[ count_mb++ ] = t;
 		}
 				
-		log_mpl_binary_parallel( &i, &mb_node[0], &size_node[i], &curr_log_mpl[i], data, freq_data, &length_freq_data, alpha_ijl, &alpha_jl, &log_alpha_ijl, &log_alpha_jl, &copy_n, mb_conf, data_mb, &size_bit );
+		log_mpl_binary_parallel( &i, &mb_node[0], &size_node[i], &curr_log_mpl[i], bit_data, alpha_ijl, &alpha_jl, &log_alpha_ijl, &log_alpha_jl, lgamma_table, count_buffer, thread_count_buffer );
 	}
 
 	vector<double> log_ratio_g_prior( pxp );	
@@ -613,13 +447,11 @@ void dgm_bdmcmc_mpl_binary_ma( int *iter, int *burnin, int G[], double g_prior[]
 	for( j = 1; j < dim; j++ )
 	    for( i = 0; i < j; i++ )
 	    {
-	        ij = g_prior[ j * dim + i ];
-	        if( ( ij != 0.0 ) or ( ij != 1.0 ) )
-	        {
-	            index_row[ counter ] = i;
-	            index_col[ counter ] = j;
-	            counter++;
-	        }
+	        // all the links, as local_rates_gm_mpl_binary finds link ( i, j ) at j * ( j - 1 ) / 2 + i;
+	        // the links with g_prior 0 or 1 keep rate 0
+	        index_row[ counter ] = i;
+	        index_col[ counter ] = j;
+	        counter++;
 	    }
 	int sub_qp = counter;
 
@@ -627,17 +459,14 @@ void dgm_bdmcmc_mpl_binary_ma( int *iter, int *burnin, int G[], double g_prior[]
 	vector<double>log_mpl_pro_node_j( sub_qp );
 
 	vector<double> rates( sub_qp );
-	rates_gm_mpl_binary( &rates[0], &log_ratio_g_prior[0], &log_mpl_pro_node_i[0], &log_mpl_pro_node_j[0], &curr_log_mpl[0], G, g_prior, &index_row[0], &index_col[0], &sub_qp, &size_node[0], data, freq_data, &length_freq_data, alpha_ijl, &alpha_jl, &log_alpha_ijl, &log_alpha_jl, &copy_n, &dim );
+	rates_gm_mpl_binary( &rates[0], &log_ratio_g_prior[0], &log_mpl_pro_node_i[0], &log_mpl_pro_node_j[0], &curr_log_mpl[0], G, g_prior, &index_row[0], &index_col[0], &sub_qp, &size_node[0], bit_data, lgamma_table, alpha_ijl, &alpha_jl, &log_alpha_ijl, &log_alpha_jl, &dim );
 	
 // - - - main loop for birth-death MCMC sampling algorithm - - - - - - - - - - - - - - - - - - - - |
 	GetRNGstate();
 	int print_conter = 0;
 	for( int i_mcmc = 0; i_mcmc < iteration; i_mcmc++ )
 	{
-		if( ( i_mcmc + 1 ) % ( ( print_c * iteration ) / 100 ) == 0 ){
-		    ++print_conter;
-		    ( ( i_mcmc + 1 ) != iteration ) ? Rprintf( "%i%%->", print_c * print_conter ) : Rprintf( " done" );
-		}
+		print_progress( i_mcmc + 1, iteration, print_c, &print_conter );
 	  				
 // - - - STEP 1: calculating birth and death rates - - - - - - - - - - - - - - - - - - - - - - - - |
 				
@@ -685,7 +514,7 @@ void dgm_bdmcmc_mpl_binary_ma( int *iter, int *burnin, int G[], double g_prior[]
 			for( t = 0; t < dim; t++ ) 
 				if( G[ nodexdim + t ] ) mb_node[ count_mb++ ] = t;
 		}				
-		log_mpl_binary_parallel( &selected_edge_i, &mb_node[0], &size_node[ selected_edge_i ], &curr_log_mpl[ selected_edge_i ], data, freq_data, &length_freq_data, alpha_ijl, &alpha_jl, &log_alpha_ijl, &log_alpha_jl, &copy_n, mb_conf, data_mb, &size_bit );
+		log_mpl_binary_parallel( &selected_edge_i, &mb_node[0], &size_node[ selected_edge_i ], &curr_log_mpl[ selected_edge_i ], bit_data, alpha_ijl, &alpha_jl, &log_alpha_ijl, &log_alpha_jl, lgamma_table, count_buffer, thread_count_buffer );
 		
 		if( size_node[ selected_edge_j ] > 0 )
 		{	
@@ -694,9 +523,9 @@ void dgm_bdmcmc_mpl_binary_ma( int *iter, int *burnin, int G[], double g_prior[]
 			for( t = 0; t < dim; t++ ) 
 				if( G[ nodexdim + t ] ) mb_node[ count_mb++ ] = t;
 		}	
-		log_mpl_binary_parallel( &selected_edge_j, &mb_node[0], &size_node[ selected_edge_j ], &curr_log_mpl[ selected_edge_j ], data, freq_data, &length_freq_data, alpha_ijl, &alpha_jl, &log_alpha_ijl, &log_alpha_jl, &copy_n, mb_conf, data_mb, &size_bit );
+		log_mpl_binary_parallel( &selected_edge_j, &mb_node[0], &size_node[ selected_edge_j ], &curr_log_mpl[ selected_edge_j ], bit_data, alpha_ijl, &alpha_jl, &log_alpha_ijl, &log_alpha_jl, lgamma_table, count_buffer, thread_count_buffer );
 
-		local_rates_gm_mpl_binary( &rates[0], &log_ratio_g_prior[0], &log_mpl_pro_node_i[0], &log_mpl_pro_node_j[0], &selected_edge_i, &selected_edge_j, &curr_log_mpl[0], G, g_prior, &size_node[0], data, freq_data, &length_freq_data, alpha_ijl, &alpha_jl, &log_alpha_ijl, &log_alpha_jl, &copy_n, &dim );
+		local_rates_gm_mpl_binary( &rates[0], &log_ratio_g_prior[0], &log_mpl_pro_node_i[0], &log_mpl_pro_node_j[0], &selected_edge_i, &selected_edge_j, &curr_log_mpl[0], G, g_prior, &size_node[0], bit_data, lgamma_table, alpha_ijl, &alpha_jl, &log_alpha_ijl, &log_alpha_jl, &dim );
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
 	} 
 	PutRNGstate();
@@ -744,11 +573,16 @@ void dgm_bdmcmc_mpl_binary_map( int *iter, int *burnin, int G[], double g_prior[
 	vector<int>mb_node( dim );     
 	vector<double>curr_log_mpl( dim );
 	
-	int size_bit = sizeof( unsigned long long int ) * CHAR_BIT / 2;
-	vector<vector<unsigned long long int> > mb_conf( length_freq_data );		
-	vector<vector<unsigned long long int> > data_mb( length_freq_data );		
-	vector<int>vec_fam_conf_count_0( length_freq_data );	
-	vector<int>vec_fam_conf_count_1( length_freq_data );	
+	mpl_count_buffer count_buffer;
+	vector<mpl_count_buffer> thread_count_buffer;
+
+	// bit-sliced copy of the data, for counting with AND + popcount
+	mpl_bit_data bit_data;
+	get_mpl_bit_data( data, freq_data, &length_freq_data, &dim, bit_data );
+
+	// lgamma( k + alpha ) for all counts k = 0, ..., n, shared by all threads
+	mpl_lgamma_table lgamma_table;
+	get_mpl_lgamma_table( &copy_n, alpha_ijl, NULL, &dim, lgamma_table );
 
 	for( i = 0; i < dim; i++ ) 
 	{ 
@@ -760,7 +594,7 @@ void dgm_bdmcmc_mpl_binary_map( int *iter, int *burnin, int G[], double g_prior[
 				if( G[ nodexdim + t ] ) mb_node[ count_mb++ ] = t;
 		}
 				
-		log_mpl_binary_parallel( &i, &mb_node[0], &size_node[i], &curr_log_mpl[i], data, freq_data, &length_freq_data, alpha_ijl, &alpha_jl, &log_alpha_ijl, &log_alpha_jl, &copy_n, mb_conf, data_mb, &size_bit );
+		log_mpl_binary_parallel( &i, &mb_node[0], &size_node[i], &curr_log_mpl[i], bit_data, alpha_ijl, &alpha_jl, &log_alpha_ijl, &log_alpha_jl, lgamma_table, count_buffer, thread_count_buffer );
 	}
 
 	vector<double> log_ratio_g_prior( pxp );	
@@ -778,13 +612,11 @@ void dgm_bdmcmc_mpl_binary_map( int *iter, int *burnin, int G[], double g_prior[
 	for( j = 1; j < dim; j++ )
 	    for( i = 0; i < j; i++ )
 	    {
-	        ij = g_prior[ j * dim + i ];
-	        if( ( ij != 0.0 ) or ( ij != 1.0 ) )
-	        {
-	            index_row[ counter ] = i;
-	            index_col[ counter ] = j;
-	            counter++;
-	        }
+	        // all the links, as local_rates_gm_mpl_binary finds link ( i, j ) at j * ( j - 1 ) / 2 + i;
+	        // the links with g_prior 0 or 1 keep rate 0
+	        index_row[ counter ] = i;
+	        index_col[ counter ] = j;
+	        counter++;
 	    }
 	int sub_qp = counter;
 
@@ -792,17 +624,14 @@ void dgm_bdmcmc_mpl_binary_map( int *iter, int *burnin, int G[], double g_prior[
 	vector<double>log_mpl_pro_node_j( sub_qp );
 
 	vector<double> rates( sub_qp );
-	rates_gm_mpl_binary( &rates[0], &log_ratio_g_prior[0], &log_mpl_pro_node_i[0], &log_mpl_pro_node_j[0], &curr_log_mpl[0], G, g_prior, &index_row[0], &index_col[0], &sub_qp, &size_node[0], data, freq_data, &length_freq_data, alpha_ijl, &alpha_jl, &log_alpha_ijl, &log_alpha_jl, &copy_n, &dim );
+	rates_gm_mpl_binary( &rates[0], &log_ratio_g_prior[0], &log_mpl_pro_node_i[0], &log_mpl_pro_node_j[0], &curr_log_mpl[0], G, g_prior, &index_row[0], &index_col[0], &sub_qp, &size_node[0], bit_data, lgamma_table, alpha_ijl, &alpha_jl, &log_alpha_ijl, &log_alpha_jl, &dim );
  
 // - - - main loop for birth-death MCMC sampling algorithm - - - - - - - - - - - - - - - - - - - - |
 	GetRNGstate();
 	int print_conter = 0;
 	for( int i_mcmc = 0; i_mcmc < iteration; i_mcmc++ )
 	{
-		if( ( i_mcmc + 1 ) % ( ( print_c * iteration ) / 100 ) == 0 ){
-		    ++print_conter;
-		    ( ( i_mcmc + 1 ) != iteration ) ? Rprintf( "%i%%->", print_c * print_conter ) : Rprintf( " done" );
-		}
+		print_progress( i_mcmc + 1, iteration, print_c, &print_conter );
 	  				
 // - - - STEP 1: calculating birth and death rates - - - - - - - - - - - - - - - - - - - - - - - - |
 				
@@ -872,7 +701,7 @@ void dgm_bdmcmc_mpl_binary_map( int *iter, int *burnin, int G[], double g_prior[
 			for( t = 0; t < dim; t++ ) 
 				if( G[ nodexdim + t ] ) mb_node[ count_mb++ ] = t;
 		}				
-		log_mpl_binary_parallel( &selected_edge_i, &mb_node[0], &size_node[ selected_edge_i ], &curr_log_mpl[ selected_edge_i ], data, freq_data, &length_freq_data, alpha_ijl, &alpha_jl, &log_alpha_ijl, &log_alpha_jl, &copy_n, mb_conf, data_mb, &size_bit );
+		log_mpl_binary_parallel( &selected_edge_i, &mb_node[0], &size_node[ selected_edge_i ], &curr_log_mpl[ selected_edge_i ], bit_data, alpha_ijl, &alpha_jl, &log_alpha_ijl, &log_alpha_jl, lgamma_table, count_buffer, thread_count_buffer );
   		
 		if( size_node[ selected_edge_j ] > 0 )
 		{	
@@ -881,9 +710,9 @@ void dgm_bdmcmc_mpl_binary_map( int *iter, int *burnin, int G[], double g_prior[
 			for( t = 0; t < dim; t++ ) 
 				if( G[ nodexdim + t ] ) mb_node[ count_mb++ ] = t;
 		}	
-		log_mpl_binary_parallel( &selected_edge_j, &mb_node[0], &size_node[ selected_edge_j ], &curr_log_mpl[ selected_edge_j ], data, freq_data, &length_freq_data, alpha_ijl, &alpha_jl, &log_alpha_ijl, &log_alpha_jl, &copy_n, mb_conf, data_mb, &size_bit );
+		log_mpl_binary_parallel( &selected_edge_j, &mb_node[0], &size_node[ selected_edge_j ], &curr_log_mpl[ selected_edge_j ], bit_data, alpha_ijl, &alpha_jl, &log_alpha_ijl, &log_alpha_jl, lgamma_table, count_buffer, thread_count_buffer );
   		
-		local_rates_gm_mpl_binary( &rates[0], &log_ratio_g_prior[0], &log_mpl_pro_node_i[0], &log_mpl_pro_node_j[0], &selected_edge_i, &selected_edge_j, &curr_log_mpl[0], G, g_prior, &size_node[0], data, freq_data, &length_freq_data, alpha_ijl, &alpha_jl, &log_alpha_ijl, &log_alpha_jl, &copy_n, &dim );
+		local_rates_gm_mpl_binary( &rates[0], &log_ratio_g_prior[0], &log_mpl_pro_node_i[0], &log_mpl_pro_node_j[0], &selected_edge_i, &selected_edge_j, &curr_log_mpl[0], G, g_prior, &size_node[0], bit_data, lgamma_table, alpha_ijl, &alpha_jl, &log_alpha_ijl, &log_alpha_jl, &dim );
   				
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
 	} 
@@ -932,11 +761,16 @@ void dgm_bdmcmc_mpl_binary_ma_multi_update( int *iter, int *burnin, int G[], dou
 	vector<int>mb_node( dim );     
 	vector<double>curr_log_mpl( dim );
 
-	int size_bit = sizeof( unsigned long long int ) * CHAR_BIT / 2;
-	vector<vector<unsigned long long int> > mb_conf( length_freq_data );		
-	vector<vector<unsigned long long int> > data_mb( length_freq_data );		
-	vector<int>vec_fam_conf_count_0( length_freq_data );	
-	vector<int>vec_fam_conf_count_1( length_freq_data );	
+	mpl_count_buffer count_buffer;
+	vector<mpl_count_buffer> thread_count_buffer;
+
+	// bit-sliced copy of the data, for counting with AND + popcount
+	mpl_bit_data bit_data;
+	get_mpl_bit_data( data, freq_data, &length_freq_data, &dim, bit_data );
+
+	// lgamma( k + alpha ) for all counts k = 0, ..., n, shared by all threads
+	mpl_lgamma_table lgamma_table;
+	get_mpl_lgamma_table( &copy_n, alpha_ijl, NULL, &dim, lgamma_table );
 
 	for( i = 0; i < dim; i++ ) 
 	{ 
@@ -948,7 +782,7 @@ void dgm_bdmcmc_mpl_binary_ma_multi_update( int *iter, int *burnin, int G[], dou
 				if( G[ nodexdim + t ] ) mb_node[ count_mb++ ] = t;
 		}
 				
-		log_mpl_binary_parallel( &i, &mb_node[0], &size_node[i], &curr_log_mpl[i], data, freq_data, &length_freq_data, alpha_ijl, &alpha_jl, &log_alpha_ijl, &log_alpha_jl, &copy_n, mb_conf, data_mb, &size_bit );
+		log_mpl_binary_parallel( &i, &mb_node[0], &size_node[i], &curr_log_mpl[i], bit_data, alpha_ijl, &alpha_jl, &log_alpha_ijl, &log_alpha_jl, lgamma_table, count_buffer, thread_count_buffer );
 	}
 
 	vector<double> log_ratio_g_prior( pxp );	
@@ -967,13 +801,11 @@ void dgm_bdmcmc_mpl_binary_ma_multi_update( int *iter, int *burnin, int G[], dou
 	for( j = 1; j < dim; j++ )
 	    for( i = 0; i < j; i++ )
 	    {
-	        ij = g_prior[ j * dim + i ];
-	        if( ( ij != 0.0 ) or ( ij != 1.0 ) )
-	        {
-	            index_row[ counter ] = i;
-	            index_col[ counter ] = j;
-	            counter++;
-	        }
+	        // all the links, as local_rates_gm_mpl_binary finds link ( i, j ) at j * ( j - 1 ) / 2 + i;
+	        // the links with g_prior 0 or 1 keep rate 0
+	        index_row[ counter ] = i;
+	        index_col[ counter ] = j;
+	        counter++;
 	    }
 	int sub_qp = counter;
 
@@ -984,17 +816,14 @@ void dgm_bdmcmc_mpl_binary_ma_multi_update( int *iter, int *burnin, int G[], dou
 	vector<double>log_mpl_pro_node_j( sub_qp );
 
 	vector<double> rates( sub_qp );
-	rates_gm_mpl_binary( &rates[0], &log_ratio_g_prior[0], &log_mpl_pro_node_i[0], &log_mpl_pro_node_j[0], &curr_log_mpl[0], G, g_prior, &index_row[0], &index_col[0], &sub_qp, &size_node[0], data, freq_data, &length_freq_data, alpha_ijl, &alpha_jl, &log_alpha_ijl, &log_alpha_jl, &copy_n, &dim );
+	rates_gm_mpl_binary( &rates[0], &log_ratio_g_prior[0], &log_mpl_pro_node_i[0], &log_mpl_pro_node_j[0], &curr_log_mpl[0], G, g_prior, &index_row[0], &index_col[0], &sub_qp, &size_node[0], bit_data, lgamma_table, alpha_ijl, &alpha_jl, &log_alpha_ijl, &log_alpha_jl, &dim );
 
 // - - - main loop for birth-death MCMC sampling algorithm - - - - - - - - - - - - - - - - - - - - |
 	GetRNGstate();
 	int print_conter = 0;
 	for( int i_mcmc = 0; i_mcmc < iteration; i_mcmc += size_index )
 	{
-		if( ( i_mcmc + size_index ) % ( ( print_c * iteration ) / 100 ) == 0 ){
-		    ++print_conter;
-		    ( ( i_mcmc + size_index ) != iteration ) ? Rprintf( "%i%%->", print_c * print_conter ) : Rprintf( " done" );
-		}
+		print_progress( i_mcmc + size_index, iteration, print_c, &print_conter );
 	 				
 // - - - STEP 1: calculating birth and death rates - - - - - - - - - - - - - - - - - - - - - - - - |
 				
@@ -1048,7 +877,7 @@ void dgm_bdmcmc_mpl_binary_ma_multi_update( int *iter, int *burnin, int G[], dou
 				for( t = 0; t < dim; t++ ) 
 					if( G[ nodexdim + t ] ) mb_node[ count_mb++ ] = t;
 			}				
-			log_mpl_binary_parallel( &selected_edge_i, &mb_node[0], &size_node[ selected_edge_i ], &curr_log_mpl[ selected_edge_i ], data, freq_data, &length_freq_data, alpha_ijl, &alpha_jl, &log_alpha_ijl, &log_alpha_jl, &copy_n, mb_conf, data_mb, &size_bit );
+			log_mpl_binary_parallel( &selected_edge_i, &mb_node[0], &size_node[ selected_edge_i ], &curr_log_mpl[ selected_edge_i ], bit_data, alpha_ijl, &alpha_jl, &log_alpha_ijl, &log_alpha_jl, lgamma_table, count_buffer, thread_count_buffer );
 			
 			if( size_node[ selected_edge_j ] > 0 )
 			{	
@@ -1057,9 +886,9 @@ void dgm_bdmcmc_mpl_binary_ma_multi_update( int *iter, int *burnin, int G[], dou
 				for( t = 0; t < dim; t++ ) 
 					if( G[ nodexdim + t ] ) mb_node[ count_mb++ ] = t;
 			}	
-			log_mpl_binary_parallel( &selected_edge_j, &mb_node[0], &size_node[ selected_edge_j ], &curr_log_mpl[ selected_edge_j ], data, freq_data, &length_freq_data, alpha_ijl, &alpha_jl, &log_alpha_ijl, &log_alpha_jl, &copy_n, mb_conf, data_mb, &size_bit );
+			log_mpl_binary_parallel( &selected_edge_j, &mb_node[0], &size_node[ selected_edge_j ], &curr_log_mpl[ selected_edge_j ], bit_data, alpha_ijl, &alpha_jl, &log_alpha_ijl, &log_alpha_jl, lgamma_table, count_buffer, thread_count_buffer );
 
-			local_rates_gm_mpl_binary( &rates[0], &log_ratio_g_prior[0], &log_mpl_pro_node_i[0], &log_mpl_pro_node_j[0], &selected_edge_i, &selected_edge_j, &curr_log_mpl[0], G, g_prior, &size_node[0], data, freq_data, &length_freq_data, alpha_ijl, &alpha_jl, &log_alpha_ijl, &log_alpha_jl, &copy_n, &dim );
+			local_rates_gm_mpl_binary( &rates[0], &log_ratio_g_prior[0], &log_mpl_pro_node_i[0], &log_mpl_pro_node_j[0], &selected_edge_i, &selected_edge_j, &curr_log_mpl[0], G, g_prior, &size_node[0], bit_data, lgamma_table, alpha_ijl, &alpha_jl, &log_alpha_ijl, &log_alpha_jl, &dim );
 		}
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
 	} 
@@ -1109,11 +938,16 @@ void dgm_bdmcmc_mpl_binary_map_multi_update( int *iter, int *burnin, int G[], do
 	vector<int>mb_node( dim );     
 	vector<double>curr_log_mpl( dim );
 	
-	int size_bit = sizeof( unsigned long long int ) * CHAR_BIT / 2;
-	vector<vector<unsigned long long int> > mb_conf( length_freq_data );		
-	vector<vector<unsigned long long int> > data_mb( length_freq_data );		
-	vector<int>vec_fam_conf_count_0( length_freq_data );	
-	vector<int>vec_fam_conf_count_1( length_freq_data );	
+	mpl_count_buffer count_buffer;
+	vector<mpl_count_buffer> thread_count_buffer;
+
+	// bit-sliced copy of the data, for counting with AND + popcount
+	mpl_bit_data bit_data;
+	get_mpl_bit_data( data, freq_data, &length_freq_data, &dim, bit_data );
+
+	// lgamma( k + alpha ) for all counts k = 0, ..., n, shared by all threads
+	mpl_lgamma_table lgamma_table;
+	get_mpl_lgamma_table( &copy_n, alpha_ijl, NULL, &dim, lgamma_table );
 
 	for( i = 0; i < dim; i++ ) 
 	{ 
@@ -1125,7 +959,7 @@ void dgm_bdmcmc_mpl_binary_map_multi_update( int *iter, int *burnin, int G[], do
 				if( G[ nodexdim + t ] ) mb_node[ count_mb++ ] = t;
 		}
 				
-		log_mpl_binary_parallel( &i, &mb_node[0], &size_node[i], &curr_log_mpl[i], data, freq_data, &length_freq_data, alpha_ijl, &alpha_jl, &log_alpha_ijl, &log_alpha_jl, &copy_n, mb_conf, data_mb, &size_bit );
+		log_mpl_binary_parallel( &i, &mb_node[0], &size_node[i], &curr_log_mpl[i], bit_data, alpha_ijl, &alpha_jl, &log_alpha_ijl, &log_alpha_jl, lgamma_table, count_buffer, thread_count_buffer );
 	}
 
 	vector<double> log_ratio_g_prior( pxp );	
@@ -1143,13 +977,11 @@ void dgm_bdmcmc_mpl_binary_map_multi_update( int *iter, int *burnin, int G[], do
 	for( j = 1; j < dim; j++ )
 	    for( i = 0; i < j; i++ )
 	    {
-	        ij = g_prior[ j * dim + i ];
-	        if( ( ij != 0.0 ) or ( ij != 1.0 ) )
-	        {
-	            index_row[ counter ] = i;
-	            index_col[ counter ] = j;
-	            counter++;
-	        }
+	        // all the links, as local_rates_gm_mpl_binary finds link ( i, j ) at j * ( j - 1 ) / 2 + i;
+	        // the links with g_prior 0 or 1 keep rate 0
+	        index_row[ counter ] = i;
+	        index_col[ counter ] = j;
+	        counter++;
 	    }
 	int sub_qp = counter;
 
@@ -1160,17 +992,14 @@ void dgm_bdmcmc_mpl_binary_map_multi_update( int *iter, int *burnin, int G[], do
 	vector<double>log_mpl_pro_node_j( sub_qp );
 
 	vector<double> rates( sub_qp );
-	rates_gm_mpl_binary( &rates[0], &log_ratio_g_prior[0], &log_mpl_pro_node_i[0], &log_mpl_pro_node_j[0], &curr_log_mpl[0], G, g_prior, &index_row[0], &index_col[0], &sub_qp, &size_node[0], data, freq_data, &length_freq_data, alpha_ijl, &alpha_jl, &log_alpha_ijl, &log_alpha_jl, &copy_n, &dim );
+	rates_gm_mpl_binary( &rates[0], &log_ratio_g_prior[0], &log_mpl_pro_node_i[0], &log_mpl_pro_node_j[0], &curr_log_mpl[0], G, g_prior, &index_row[0], &index_col[0], &sub_qp, &size_node[0], bit_data, lgamma_table, alpha_ijl, &alpha_jl, &log_alpha_ijl, &log_alpha_jl, &dim );
 
 // - - - main loop for birth-death MCMC sampling algorithm - - - - - - - - - - - - - - - - - - - - |
 	GetRNGstate();
 	int print_conter = 0;
 	for( int i_mcmc = 0; i_mcmc < iteration; i_mcmc += size_index )
 	{
-		if( ( i_mcmc + size_index ) % ( ( print_c * iteration ) / 100 ) == 0 ){
-		    ++print_conter;
-		    ( ( i_mcmc + size_index ) != iteration ) ? Rprintf( "%i%%->", print_c * print_conter ) : Rprintf( " done" );
-		}
+		print_progress( i_mcmc + size_index, iteration, print_c, &print_conter );
 	 				
 // - - - STEP 1: calculating birth and death rates - - - - - - - - - - - - - - - - - - - - - - - - |
 				
@@ -1248,7 +1077,7 @@ void dgm_bdmcmc_mpl_binary_map_multi_update( int *iter, int *burnin, int G[], do
 				for( t = 0; t < dim; t++ ) 
 					if( G[ nodexdim + t ] ) mb_node[ count_mb++ ] = t;
 			}				
-			log_mpl_binary_parallel( &selected_edge_i, &mb_node[0], &size_node[ selected_edge_i ], &curr_log_mpl[ selected_edge_i ], data, freq_data, &length_freq_data, alpha_ijl, &alpha_jl, &log_alpha_ijl, &log_alpha_jl, &copy_n, mb_conf, data_mb, &size_bit );
+			log_mpl_binary_parallel( &selected_edge_i, &mb_node[0], &size_node[ selected_edge_i ], &curr_log_mpl[ selected_edge_i ], bit_data, alpha_ijl, &alpha_jl, &log_alpha_ijl, &log_alpha_jl, lgamma_table, count_buffer, thread_count_buffer );
 			
 			if( size_node[ selected_edge_j ] > 0 )
 			{	
@@ -1257,9 +1086,9 @@ void dgm_bdmcmc_mpl_binary_map_multi_update( int *iter, int *burnin, int G[], do
 				for( t = 0; t < dim; t++ ) 
 					if( G[ nodexdim + t ] ) mb_node[ count_mb++ ] = t;
 			}	
-			log_mpl_binary_parallel( &selected_edge_j, &mb_node[0], &size_node[ selected_edge_j ], &curr_log_mpl[ selected_edge_j ], data, freq_data, &length_freq_data, alpha_ijl, &alpha_jl, &log_alpha_ijl, &log_alpha_jl, &copy_n, mb_conf, data_mb, &size_bit );
+			log_mpl_binary_parallel( &selected_edge_j, &mb_node[0], &size_node[ selected_edge_j ], &curr_log_mpl[ selected_edge_j ], bit_data, alpha_ijl, &alpha_jl, &log_alpha_ijl, &log_alpha_jl, lgamma_table, count_buffer, thread_count_buffer );
 
-			local_rates_gm_mpl_binary( &rates[0], &log_ratio_g_prior[0], &log_mpl_pro_node_i[0], &log_mpl_pro_node_j[0], &selected_edge_i, &selected_edge_j, &curr_log_mpl[0], G, g_prior, &size_node[0], data, freq_data, &length_freq_data, alpha_ijl, &alpha_jl, &log_alpha_ijl, &log_alpha_jl, &copy_n, &dim );
+			local_rates_gm_mpl_binary( &rates[0], &log_ratio_g_prior[0], &log_mpl_pro_node_i[0], &log_mpl_pro_node_j[0], &selected_edge_i, &selected_edge_j, &curr_log_mpl[0], G, g_prior, &size_node[0], bit_data, lgamma_table, alpha_ijl, &alpha_jl, &log_alpha_ijl, &log_alpha_jl, &dim );
 		}
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
 	} 
@@ -1282,106 +1111,45 @@ void dgm_bdmcmc_mpl_binary_map_multi_update( int *iter, int *burnin, int G[], do
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
 void log_mpl_dis( int *node, int mb_node[], int *size_node, double *log_mpl_node, 
                   int data[], int freq_data[], int *length_freq_data, 
-                  int max_range_nodes[], double *alpha_ijl, int *n )
+                  int max_range_nodes[], double *alpha_ijl, int *n, 
+                  mpl_lgamma_table &lgamma_table, mpl_count_buffer &buffer )
 {
-	int i, j, l, size_mb_conf, mb_node_x_lf, mb_conf_l, mb_conf_count, node_x_lf = *node * *length_freq_data;
-    int max_range_node_j = max_range_nodes[ *node ];
+	int j, l, size_mb_conf, mb_conf_count;
+    int size_range_node = max_range_nodes[ *node ] + 1;
 	double sum_lgamma_fam;
-    double alpha_jl = ( max_range_node_j + 1 ) * *alpha_ijl;   
+    double alpha_jl = size_range_node * *alpha_ijl;   
 
-	vector<int>fam_conf_count( max_range_node_j );
-	vector<int>mb_conf( *length_freq_data );	
-	vector<int>data_mb( *length_freq_data, 0 ); 
-			   
-	if( *size_node == 0 ) size_mb_conf = 1;
-	
-	if( *size_node == 1 ) 
-	{
-		// data_mb = data[ , mb_node ]          
-		mb_node_x_lf = mb_node[0] * *length_freq_data; 
-		for( i = 0; i < *length_freq_data; i++ ) data_mb[ i ] = data[ mb_node_x_lf + i ]; 
-		//memcpy( &data_mb[0], &data[0] + mb_node_x_lf, sizeof( int ) * *length_freq_data );    
-		
-		size_mb_conf = max_range_nodes[ mb_node[0] ] + 1;            
-		// mb_conf = 1:size_mb_conf;      
-		for( j = 0; j < size_mb_conf; j++ ) mb_conf[ j ] = j;     
-	}	
-	
-	if( *size_node > 1 ) 
-	{
-		vector<int>cumprod_mb( *size_node );
-		cumprod_mb[0] = max_range_nodes[ mb_node[ 0 ] ] + 1;
-		//cumprod_mb   = t( t( c( 1, cumprod( max_range_nodes[ mb_node[ 2:length( mb_node ) ] ] ) ) ) )
-		for( j = 1; j < *size_node; j++ )
-			cumprod_mb[ j ] = cumprod_mb[ j - 1 ] * ( max_range_nodes[ mb_node[ j ] ] + 1 );
-			
-		//data_mb = c( data[ , mb_node ] %*% cumprod_mb ) 
-		for( i = 0; i < *length_freq_data; i++ )
-			for( j = 0; j < *size_node; j++ )
-				data_mb[ i ] += cumprod_mb[ j ] * data[ mb_node[ j ] * *length_freq_data + i ];
-			
-		// mb_conf = unique( data_mb )            
-		 for( i = 0; i < *length_freq_data; i++ ) mb_conf[ i ] = data_mb[ i ];
-		//memcpy( &mb_conf[0], &data_mb[0], sizeof( int ) * *length_freq_data );
+	// n_ijl and n_jl for all observed MB configurations; unobserved ones add zero to the score
+	fam_conf_count_dis( node, mb_node, size_node, data, freq_data, length_freq_data, max_range_nodes, &size_range_node, &size_mb_conf, buffer );
 
-		std::sort( mb_conf.begin(), mb_conf.end() );
-		mb_conf.erase( std::unique( mb_conf.begin(), mb_conf.end() ), mb_conf.end() );	
+	*log_mpl_node = 0.0;
+	for( l = 0; l < size_mb_conf; l++ )  // calculates the score from the contingency table
+	{
+		int *fam_conf_count = &buffer.fam_conf_count[ l * size_range_node ];
 		
-		size_mb_conf = mb_conf.size(); 
-	}
-				
-	if( *size_node == 0 ) 
-	{   // n_ijl
-		// for( j in 0:max_range_node_j ) fam_conf_count[ j + 1 ] = sum( freq_data[ ( data[ , node ] == j ) ] )
-		for( j = 0; j < ( max_range_node_j + 1 ); j++ )  
-		{  
-			 //fam_conf_count[j] = std::count( &data[0] + node_x_n, &data[0] + node_x_n + *n, j + 1 );
-			fam_conf_count[ j ] = 0;
-			for( i = 0; i < *length_freq_data; i++ )
-				if( data[ node_x_lf + i ] == j ) fam_conf_count[ j ] += freq_data[ i ];
-		}
-			
 		sum_lgamma_fam = 0.0;
-		for( j = 0; j < ( max_range_node_j + 1 ); j++ ) 
-			sum_lgamma_fam += lgammafn_sign( fam_conf_count[ j ] + *alpha_ijl, NULL );
-					   
-		// log_mpl_node = sum( lgamma( fam_conf_count + alpha ) ) - lgamma( n + alpha_jl )    
-		*log_mpl_node = sum_lgamma_fam - lgammafn_sign( *n + alpha_jl, NULL );     
-	}
-	
-	if( *size_node > 0 ) 
-	{
-		*log_mpl_node = 0.0;
-		for( l = 0; l < size_mb_conf; l++ )  // collects the necessary statistics from the data and calculates the score
-		{
-			//ind = c( ( data_mb == mb_conf[ l ] ) * 1 ) * freq_data   # finds positions of MB configuration 
-			//mb_conf_count = sum( ind )  # n_jl
-			mb_conf_l = mb_conf[ l ];
-			// mb_conf_count = std::count( data_mb.begin(), data_mb.end(), mb_conf_l );
-			mb_conf_count = 0;
-			for( i = 0; i < *length_freq_data; i++ )
-				if( data_mb[ i ] == mb_conf_l ) mb_conf_count += freq_data[ i ];
-			
-			// fam_conf_count = node_conf * 0
-			// for( j in 1:max_range_node_j ) fam_conf_count[j] = sum( ( data[ , node ] == j ) * ind )
-			for( j = 0; j < ( max_range_node_j + 1 ); j++ )
-			{
-				fam_conf_count[ j ] = 0;
-				for( i = 0; i < *length_freq_data; i++ )
-					if( ( data[ node_x_lf + i ] == j ) && ( data_mb[ i ] == mb_conf_l ) ) fam_conf_count[ j ] += freq_data[ i ];
-			}
-
-			sum_lgamma_fam = 0.0;
-			for( j = 0; j < ( max_range_node_j + 1 ); j++ ) 
-				sum_lgamma_fam += lgammafn_sign( fam_conf_count[ j ] + *alpha_ijl, NULL );
-	   
-			*log_mpl_node += sum_lgamma_fam - lgammafn_sign( mb_conf_count + alpha_jl, NULL );     
-		}		
-	}
+		for( j = 0; j < size_range_node; j++ ) 
+			sum_lgamma_fam += lgamma_fam_conf( lgamma_table, fam_conf_count[ j ], *alpha_ijl );
+   
+		mb_conf_count = ( *size_node == 0 ) ? *n : buffer.mb_conf_count[ l ];
+		*log_mpl_node += sum_lgamma_fam - lgamma_mb_conf( lgamma_table, mb_conf_count, size_range_node, alpha_jl );     
+	}		
 
 	// adding remaining terms 
-	//log_mpl_node = log_mpl_node + size_mb_conf * lgamma( alpha_jl ) - size_mb_conf * ( max_range_node_j + 1 ) * lgamma( alpha ) - size_node * log( p ) / 2   # adds the remaining terms 
-	*log_mpl_node += ( size_mb_conf * lgammafn_sign( alpha_jl, NULL ) - size_mb_conf * ( max_range_node_j + 1 ) * lgammafn_sign( *alpha_ijl, NULL ) );     	
+	*log_mpl_node += ( size_mb_conf * lgamma_mb_conf( lgamma_table, 0, size_range_node, alpha_jl ) - size_mb_conf * size_range_node * lgamma_fam_conf( lgamma_table, 0, *alpha_ijl ) );     	
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// Marginal pseudo-likelihood for discrete data, to call from R
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+void log_mpl_dis_c( int *node, int mb_node[], int *size_node, double *log_mpl_node, 
+                  int data[], int freq_data[], int *length_freq_data, 
+                  int max_range_nodes[], double *alpha_ijl, int *n )
+{
+	mpl_count_buffer buffer;
+	mpl_lgamma_table lgamma_table;    // empty: a single score does not pay off a table
+	
+	log_mpl_dis( node, mb_node, size_node, log_mpl_node, data, freq_data, length_freq_data, max_range_nodes, alpha_ijl, n, lgamma_table, buffer );
 }
     
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
@@ -1389,8 +1157,10 @@ void log_mpl_dis( int *node, int mb_node[], int *size_node, double *log_mpl_node
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
 void rates_gm_mpl_dis( double rates[], double log_ratio_g_prior[], double curr_log_mpl[], int G[], double g_prior[],  
             int index_row[], int index_col[], int *sub_qp, int size_node[], int data[], int freq_data[], 
-            int *length_freq_data, int max_range_nodes[], double *alpha_ijl, int *n, int *p )
+            int *length_freq_data, int max_range_nodes[], double *alpha_ijl, int *n, int *p, 
+            mpl_lgamma_table &lgamma_table )
 {
+	profile_phase timer( run_profile::rates );
 	int dim = *p;
 	
 	#pragma omp parallel
@@ -1401,14 +1171,17 @@ void rates_gm_mpl_dis( double rates[], double log_ratio_g_prior[], double curr_l
 		int *mb_node_i_new = new int[ dim ];          // For dynamic memory used
 		int *mb_node_j_new = new int[ dim ];          // For dynamic memory used
 
+		mpl_count_buffer count_buffer;                // work space for log_mpl_dis, reused by this thread
+
 		#pragma omp for
 		for( int counter = 0; counter < *sub_qp; counter++ )
 		{
+			profile_work work;
 			i  = index_row[ counter ];
 			j  = index_col[ counter ];
 			ij = j * dim + i;
 
-			if( ( g_prior[ ij ] != 0.0 ) or ( g_prior[ ij ] != 1.0 ) )
+			if( ( g_prior[ ij ] != 0.0 ) and ( g_prior[ ij ] != 1.0 ) )
 			{
     			if( G[ ij ] )
     			{ 
@@ -1445,8 +1218,8 @@ void rates_gm_mpl_dis( double rates[], double log_ratio_g_prior[], double curr_l
     					if( G[ nodexdim + t ] or t == i ) mb_node_j_new[ count_mb++ ] = t;
     			}
     			
-    			log_mpl_dis( &i, mb_node_i_new, &size_node_i_new, &log_mpl_i_new, data, freq_data, length_freq_data, max_range_nodes, alpha_ijl, n );		
-    			log_mpl_dis( &j, mb_node_j_new, &size_node_j_new, &log_mpl_j_new, data, freq_data, length_freq_data, max_range_nodes, alpha_ijl, n );		
+    			log_mpl_dis( &i, mb_node_i_new, &size_node_i_new, &log_mpl_i_new, data, freq_data, length_freq_data, max_range_nodes, alpha_ijl, n, lgamma_table, count_buffer );		
+    			log_mpl_dis( &j, mb_node_j_new, &size_node_j_new, &log_mpl_j_new, data, freq_data, length_freq_data, max_range_nodes, alpha_ijl, n, lgamma_table, count_buffer );		
     																		
     			log_rate = log_mpl_i_new + log_mpl_j_new - curr_log_mpl[ i ] - curr_log_mpl[ j ];
     			log_rate = ( G[ ij ] ) ? log_rate - log_ratio_g_prior[ ij ] : log_rate + log_ratio_g_prior[ ij ];
@@ -1485,6 +1258,13 @@ void dgm_bdmcmc_mpl_ma( int *iter, int *burnin, int G[], double g_prior[], int d
 	// Caclulating the log_likelihood for the current graph G
 	vector<int>mb_node( dim );     
 	vector<double>curr_log_mpl( dim );
+	mpl_count_buffer count_buffer;
+
+	// lgamma( k + alpha ) for all counts k = 0, ..., n and all ranges of the nodes, shared by all threads
+	vector<int> size_range_nodes( dim );
+	for( i = 0; i < dim; i++ ) size_range_nodes[ i ] = max_range_nodes[ i ] + 1;
+	mpl_lgamma_table lgamma_table;
+	get_mpl_lgamma_table( &copy_n, alpha_ijl, &size_range_nodes[0], &dim, lgamma_table );
 
 	for( i = 0; i < dim; i++ ) 
 	{ 
@@ -1496,7 +1276,7 @@ void dgm_bdmcmc_mpl_ma( int *iter, int *burnin, int G[], double g_prior[], int d
 				if( G[ nodexdim + t ] ) mb_node[ count_mb++ ] = t;
 		}
 				
-		log_mpl_dis( &i, &mb_node[0], &size_node[i], &curr_log_mpl[i], data, freq_data, &length_freq_data, max_range_nodes, alpha_ijl, &copy_n );
+		log_mpl_dis( &i, &mb_node[0], &size_node[i], &curr_log_mpl[i], data, freq_data, &length_freq_data, max_range_nodes, alpha_ijl, &copy_n, lgamma_table, count_buffer );
 	}
 
 	vector<double> log_ratio_g_prior( pxp );	
@@ -1515,8 +1295,7 @@ void dgm_bdmcmc_mpl_ma( int *iter, int *burnin, int G[], double g_prior[], int d
 	for( j = 1; j < dim; j++ )
 	    for( i = 0; i < j; i++ )
 	    {
-	        ij = g_prior[ j * dim + i ];
-	        if( ( ij != 0.0 ) or ( ij != 1.0 ) )
+	        if( ( g_prior[ j * dim + i ] != 0.0 ) and ( g_prior[ j * dim + i ] != 1.0 ) )
 	        {
 	            index_row[ counter ] = i;
 	            index_col[ counter ] = j;
@@ -1531,14 +1310,11 @@ void dgm_bdmcmc_mpl_ma( int *iter, int *burnin, int G[], double g_prior[], int d
 	int print_conter = 0;
 	for( int i_mcmc = 0; i_mcmc < iteration; i_mcmc++ )
 	{
-		if( ( i_mcmc + 1 ) % ( ( print_c * iteration ) / 100 ) == 0 ){
-		    ++print_conter;
-		    ( ( i_mcmc + 1 ) != iteration ) ? Rprintf( "%i%%->", print_c * print_conter ) : Rprintf( " done" );
-		}
+		print_progress( i_mcmc + 1, iteration, print_c, &print_conter );
 	  				
 // - - - STEP 1: calculating birth and death rates - - - - - - - - - - - - - - - - - - - - - - - - |
 				
-		rates_gm_mpl_dis( &rates[0], &log_ratio_g_prior[0], &curr_log_mpl[0], G, g_prior, &index_row[0], &index_col[0], &sub_qp, &size_node[0], data, freq_data, &length_freq_data, max_range_nodes, alpha_ijl, &copy_n, &dim );
+		rates_gm_mpl_dis( &rates[0], &log_ratio_g_prior[0], &curr_log_mpl[0], G, g_prior, &index_row[0], &index_col[0], &sub_qp, &size_node[0], data, freq_data, &length_freq_data, max_range_nodes, alpha_ijl, &copy_n, &dim, lgamma_table );
 		
 		// Selecting an edge based on birth and death rates
 		select_edge( &rates[0], &index_selected_edge, &sum_rates, &sub_qp );
@@ -1582,7 +1358,7 @@ void dgm_bdmcmc_mpl_ma( int *iter, int *burnin, int G[], double g_prior[], int d
 			for( t = 0; t < dim; t++ ) 
 				if( G[ nodexdim + t ] ) mb_node[ count_mb++ ] = t;
 		}				
-		log_mpl_dis( &selected_edge_i, &mb_node[0], &size_node[ selected_edge_i ], &curr_log_mpl[ selected_edge_i ], data, freq_data, &length_freq_data, max_range_nodes, alpha_ijl, &copy_n );
+		log_mpl_dis( &selected_edge_i, &mb_node[0], &size_node[ selected_edge_i ], &curr_log_mpl[ selected_edge_i ], data, freq_data, &length_freq_data, max_range_nodes, alpha_ijl, &copy_n, lgamma_table, count_buffer );
 		
 		if( size_node[ selected_edge_j ] > 0 )
 		{	
@@ -1591,7 +1367,7 @@ void dgm_bdmcmc_mpl_ma( int *iter, int *burnin, int G[], double g_prior[], int d
 			for( t = 0; t < dim; t++ ) 
 				if( G[ nodexdim + t ] ) mb_node[ count_mb++ ] = t;
 		}	
-		log_mpl_dis( &selected_edge_j, &mb_node[0], &size_node[ selected_edge_j ], &curr_log_mpl[ selected_edge_j ], data, freq_data, &length_freq_data, max_range_nodes, alpha_ijl, &copy_n );
+		log_mpl_dis( &selected_edge_j, &mb_node[0], &size_node[ selected_edge_j ], &curr_log_mpl[ selected_edge_j ], data, freq_data, &length_freq_data, max_range_nodes, alpha_ijl, &copy_n, lgamma_table, count_buffer );
 		
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
 	} 
@@ -1636,6 +1412,13 @@ void dgm_bdmcmc_mpl_map( int *iter, int *burnin, int G[], double g_prior[], int
 	// Caclulating the log_likelihood for the current graph G
 	vector<int>mb_node( dim );     
 	vector<double>curr_log_mpl( dim );
+	mpl_count_buffer count_buffer;
+
+	// lgamma( k + alpha ) for all counts k = 0, ..., n and all ranges of the nodes, shared by all threads
+	vector<int> size_range_nodes( dim );
+	for( i = 0; i < dim; i++ ) size_range_nodes[ i ] = max_range_nodes[ i ] + 1;
+	mpl_lgamma_table lgamma_table;
+	get_mpl_lgamma_table( &copy_n, alpha_ijl, &size_range_nodes[0], &dim, lgamma_table );
 	for( i = 0; i < dim; i++ ) 
 	{ 
 		if( size_node[ i ] > 0 )
@@ -1646,7 +1429,7 @@ void dgm_bdmcmc_mpl_map( int *iter, int *burnin, int G[], double g_prior[], int
 				if( G[ nodexdim + t ] ) mb_node[ count_mb++ ] = t;
 		}
 				
-		log_mpl_dis( &i, &mb_node[0], &size_node[i], &curr_log_mpl[i], data, freq_data, &length_freq_data, max_range_nodes, alpha_ijl, &copy_n );
+		log_mpl_dis( &i, &mb_node[0], &size_node[i], &curr_log_mpl[i], data, freq_data, &length_freq_data, max_range_nodes, alpha_ijl, &copy_n, lgamma_table, count_buffer );
 	}
 
 	vector<double> log_ratio_g_prior( pxp );	
@@ -1664,8 +1447,7 @@ void dgm_bdmcmc_mpl_map( int *iter, int *burnin, int G[], double g_prior[], int
 	for( j = 1; j < dim; j++ )
 	    for( i = 0; i < j; i++ )
 	    {
-	        ij = g_prior[ j * dim + i ];
-	        if( ( ij != 0.0 ) or ( ij != 1.0 ) )
+	        if( ( g_prior[ j * dim + i ] != 0.0 ) and ( g_prior[ j * dim + i ] != 1.0 ) )
 	        {
 	            index_row[ counter ] = i;
 	            index_col[ counter ] = j;
@@ -1680,14 +1462,11 @@ void dgm_bdmcmc_mpl_map( int *iter, int *burnin, int G[], double g_prior[], int
 	int print_conter = 0;
 	for( int i_mcmc = 0; i_mcmc < iteration; i_mcmc++ )
 	{
-		if( ( i_mcmc + 1 ) % ( ( print_c * iteration ) / 100 ) == 0 ){
-		    ++print_conter;
-		    ( ( i_mcmc + 1 ) != iteration ) ? Rprintf( "%i%%->", print_c * print_conter ) : Rprintf( " done" );
-		}
+		print_progress( i_mcmc + 1, iteration, print_c, &print_conter );
 	  				
 // - - - STEP 1: calculating birth and death rates - - - - - - - - - - - - - - - - - - - - - - - - |
 				
-		rates_gm_mpl_dis( &rates[0], &log_ratio_g_prior[0], &curr_log_mpl[0], G, g_prior, &index_row[0], &index_col[0], &sub_qp, &size_node[0], data, freq_data, &length_freq_data, max_range_nodes, alpha_ijl, &copy_n, &dim );
+		rates_gm_mpl_dis( &rates[0], &log_ratio_g_prior[0], &curr_log_mpl[0], G, g_prior, &index_row[0], &index_col[0], &sub_qp, &size_node[0], data, freq_data, &length_freq_data, max_range_nodes, alpha_ijl, &copy_n, &dim, lgamma_table );
 		
 		// Selecting an edge based on birth and death rates
 		select_edge( &rates[0], &index_selected_edge, &sum_rates, &sub_qp );
@@ -1753,7 +1532,7 @@ void dgm_bdmcmc_mpl_map( int *iter, int *burnin, int G[], double g_prior[], int
 			for( t = 0; t < dim; t++ ) 
 				if( G[ nodexdim + t ] ) mb_node[ count_mb++ ] = t;
 		}				
-		log_mpl_dis( &selected_edge_i, &mb_node[0], &size_node[ selected_edge_i ], &curr_log_mpl[ selected_edge_i ], data, freq_data, &length_freq_data, max_range_nodes, alpha_ijl, &copy_n );
+		log_mpl_dis( &selected_edge_i, &mb_node[0], &size_node[ selected_edge_i ], &curr_log_mpl[ selected_edge_i ], data, freq_data, &length_freq_data, max_range_nodes, alpha_ijl, &copy_n, lgamma_table, count_buffer );
 		
 		if( size_node[ selected_edge_j ] > 0 )
 		{	
@@ -1762,7 +1541,7 @@ void dgm_bdmcmc_mpl_map( int *iter, int *burnin, int G[], double g_prior[], int
 			for( t = 0; t < dim; t++ ) 
 				if( G[ nodexdim + t ] ) mb_node[ count_mb++ ] = t;
 		}	
-		log_mpl_dis( &selected_edge_j, &mb_node[0], &size_node[ selected_edge_j ], &curr_log_mpl[ selected_edge_j ], data, freq_data, &length_freq_data, max_range_nodes, alpha_ijl, &copy_n );
+		log_mpl_dis( &selected_edge_j, &mb_node[0], &size_node[ selected_edge_j ], &curr_log_mpl[ selected_edge_j ], data, freq_data, &length_freq_data, max_range_nodes, alpha_ijl, &copy_n, lgamma_table, count_buffer );
 		
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
 	} 
@@ -1807,6 +1586,13 @@ void dgm_bdmcmc_mpl_ma_multi_update( int *iter, int *burnin, int G[], double g_p
 	// Caclulating the log_likelihood for the current graph G
 	vector<int>mb_node( dim );     
 	vector<double>curr_log_mpl( dim );
+	mpl_count_buffer count_buffer;
+
+	// lgamma( k + alpha ) for all counts k = 0, ..., n and all ranges of the nodes, shared by all threads
+	vector<int> size_range_nodes( dim );
+	for( i = 0; i < dim; i++ ) size_range_nodes[ i ] = max_range_nodes[ i ] + 1;
+	mpl_lgamma_table lgamma_table;
+	get_mpl_lgamma_table( &copy_n, alpha_ijl, &size_range_nodes[0], &dim, lgamma_table );
 
 	for( i = 0; i < dim; i++ ) 
 	{ 
@@ -1818,7 +1604,7 @@ void dgm_bdmcmc_mpl_ma_multi_update( int *iter, int *burnin, int G[], double g_p
 				if( G[ nodexdim + t ] ) mb_node[ count_mb++ ] = t;
 		}
 				
-		log_mpl_dis( &i, &mb_node[0], &size_node[i], &curr_log_mpl[i], data, freq_data, &length_freq_data, max_range_nodes, alpha_ijl, &copy_n );
+		log_mpl_dis( &i, &mb_node[0], &size_node[i], &curr_log_mpl[i], data, freq_data, &length_freq_data, max_range_nodes, alpha_ijl, &copy_n, lgamma_table, count_buffer );
 	}
 
 	vector<double> log_ratio_g_prior( pxp );	
@@ -1837,8 +1623,7 @@ void dgm_bdmcmc_mpl_ma_multi_update( int *iter, int *burnin, int G[], double g_p
 	for( j = 1; j < dim; j++ )
 	    for( i = 0; i < j; i++ )
 	    {
-	        ij = g_prior[ j * dim + i ];
-	        if( ( ij != 0.0 ) or ( ij != 1.0 ) )
+	        if( ( g_prior[ j * dim + i ] != 0.0 ) and ( g_prior[ j * dim + i ] != 1.0 ) )
 	        {
 	            index_row[ counter ] = i;
 	            index_col[ counter ] = j;
@@ -1856,14 +1641,11 @@ void dgm_bdmcmc_mpl_ma_multi_update( int *iter, int *burnin, int G[], double g_p
 	int print_conter = 0;
 	for( int i_mcmc = 0; i_mcmc < iteration; i_mcmc += size_index )
 	{
-		if( ( i_mcmc + size_index ) % ( ( print_c * iteration ) / 100 ) == 0 ){
-		    ++print_conter;
-		    ( ( i_mcmc + size_index ) != iteration ) ? Rprintf( "%i%%->", print_c * print_conter ) : Rprintf( " done" );
-		}
+		print_progress( i_mcmc + size_index, iteration, print_c, &print_conter );
 	 				
 // - - - STEP 1: calculating birth and death rates - - - - - - - - - - - - - - - - - - - - - - - - |
 				
-		rates_gm_mpl_dis( &rates[0], &log_ratio_g_prior[0], &curr_log_mpl[0], G, g_prior, &index_row[0], &index_col[0], &sub_qp, &size_node[0], data, freq_data, &length_freq_data, max_range_nodes, alpha_ijl, &copy_n, &dim );
+		rates_gm_mpl_dis( &rates[0], &log_ratio_g_prior[0], &curr_log_mpl[0], G, g_prior, &index_row[0], &index_col[0], &sub_qp, &size_node[0], data, freq_data, &length_freq_data, max_range_nodes, alpha_ijl, &copy_n, &dim, lgamma_table );
 		
 		// Selecting multiple edges based on birth and death rates
 		select_multi_edges( &rates[0], &index_selected_edges[0], &size_index, &sum_rates, &multi_update_C, &sub_qp );
@@ -1908,7 +1690,7 @@ void dgm_bdmcmc_mpl_ma_multi_update( int *iter, int *burnin, int G[], double g_p
 			for( t = 0; t < dim; t++ ) 
 				if( G[ nodexdim + t ] ) mb_node[ count_mb++ ] = t;
 		}				
-		log_mpl_dis( &selected_edge_i, &mb_node[0], &size_node[ selected_edge_i ], &curr_log_mpl[ selected_edge_i ], data, freq_data, &length_freq_data, max_range_nodes, alpha_ijl, &copy_n );
+		log_mpl_dis( &selected_edge_i, &mb_node[0], &size_node[ selected_edge_i ], &curr_log_mpl[ selected_edge_i ], data, freq_data, &length_freq_data, max_range_nodes, alpha_ijl, &copy_n, lgamma_table, count_buffer );
 		
 		if( size_node[ selected_edge_j ] > 0 )
 		{	
@@ -1917,7 +1699,7 @@ void dgm_bdmcmc_mpl_ma_multi_update( int *iter, int *burnin, int G[], double g_p
 			for( t = 0; t < dim; t++ ) 
 				if( G[ nodexdim + t ] ) mb_node[ count_mb++ ] = t;
 		}	
-		log_mpl_dis( &selected_edge_j, &mb_node[0], &size_node[ selected_edge_j ], &curr_log_mpl[ selected_edge_j ], data, freq_data, &length_freq_data, max_range_nodes, alpha_ijl, &copy_n );
+		log_mpl_dis( &selected_edge_j, &mb_node[0], &size_node[ selected_edge_j ], &curr_log_mpl[ selected_edge_j ], data, freq_data, &length_freq_data, max_range_nodes, alpha_ijl, &copy_n, lgamma_table, count_buffer );
 		
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
 	} 
@@ -1963,6 +1745,13 @@ void dgm_bdmcmc_mpl_map_multi_update( int *iter, int *burnin, int G[], double g_
 	// Caclulating the log_likelihood for the current graph G
 	vector<int>mb_node( dim );     
 	vector<double>curr_log_mpl( dim );
+	mpl_count_buffer count_buffer;
+
+	// lgamma( k + alpha ) for all counts k = 0, ..., n and all ranges of the nodes, shared by all threads
+	vector<int> size_range_nodes( dim );
+	for( i = 0; i < dim; i++ ) size_range_nodes[ i ] = max_range_nodes[ i ] + 1;
+	mpl_lgamma_table lgamma_table;
+	get_mpl_lgamma_table( &copy_n, alpha_ijl, &size_range_nodes[0], &dim, lgamma_table );
 
 	for( i = 0; i < dim; i++ ) 
 	{ 
@@ -1974,7 +1763,7 @@ void dgm_bdmcmc_mpl_map_multi_update( int *iter, int *burnin, int G[], double g_
 				if( G[ nodexdim + t ] ) mb_node[ count_mb++ ] = t;
 		}
 				
-		log_mpl_dis( &i, &mb_node[0], &size_node[i], &curr_log_mpl[i], data, freq_data, &length_freq_data, max_range_nodes, alpha_ijl, &copy_n );
+		log_mpl_dis( &i, &mb_node[0], &size_node[i], &curr_log_mpl[i], data, freq_data, &length_freq_data, max_range_nodes, alpha_ijl, &copy_n, lgamma_table, count_buffer );
 	}
 
 	vector<double> log_ratio_g_prior( pxp );	
@@ -1992,8 +1781,7 @@ void dgm_bdmcmc_mpl_map_multi_update( int *iter, int *burnin, int G[], double g_
 	for( j = 1; j < dim; j++ )
 	    for( i = 0; i < j; i++ )
 	    {
-	        ij = g_prior[ j * dim + i ];
-	        if( ( ij != 0.0 ) or ( ij != 1.0 ) )
+	        if( ( g_prior[ j * dim + i ] != 0.0 ) and ( g_prior[ j * dim + i ] != 1.0 ) )
 	        {
 	            index_row[ counter ] = i;
 	            index_col[ counter ] = j;
@@ -2011,14 +1799,11 @@ void dgm_bdmcmc_mpl_map_multi_update( int *iter, int *burnin, int G[], double g_
 	int print_conter = 0;
 	for( int i_mcmc = 0; i_mcmc < iteration; i_mcmc += size_index )
 	{
-		if( ( i_mcmc + size_index ) % ( ( print_c * iteration ) / 100 ) == 0 ){
-		    ++print_conter;
-		    ( ( i_mcmc + size_index ) != iteration ) ? Rprintf( "%i%%->", print_c * print_conter ) : Rprintf( " done" );
-		}
+		print_progress( i_mcmc + size_index, iteration, print_c, &print_conter );
 	 				
 // - - - STEP 1: calculating birth and death rates - - - - - - - - - - - - - - - - - - - - - - - - |
 				
-		rates_gm_mpl_dis( &rates[0], &log_ratio_g_prior[0], &curr_log_mpl[0], G, g_prior, &index_row[0], &index_col[0], &sub_qp, &size_node[0], data, freq_data, &length_freq_data, max_range_nodes, alpha_ijl, &copy_n, &dim );
+		rates_gm_mpl_dis( &rates[0], &log_ratio_g_prior[0], &curr_log_mpl[0], G, g_prior, &index_row[0], &index_col[0], &sub_qp, &size_node[0], data, freq_data, &length_freq_data, max_range_nodes, alpha_ijl, &copy_n, &dim, lgamma_table );
 		
 		// Selecting multiple edges based on birth and death rates
 		select_multi_edges( &rates[0], &index_selected_edges[0], &size_index, &sum_rates, &multi_update_C, &sub_qp );
@@ -2086,7 +1871,7 @@ void dgm_bdmcmc_mpl_map_multi_update( int *iter, int *burnin, int G[], double g_
 			for( t = 0; t < dim; t++ ) 
 				if( G[ nodexdim + t ] ) mb_node[ count_mb++ ] = t;
 		}				
-		log_mpl_dis( &selected_edge_i, &mb_node[0], &size_node[ selected_edge_i ], &curr_log_mpl[ selected_edge_i ], data, freq_data, &length_freq_data, max_range_nodes, alpha_ijl, &copy_n );
+		log_mpl_dis( &selected_edge_i, &mb_node[0], &size_node[ selected_edge_i ], &curr_log_mpl[ selected_edge_i ], data, freq_data, &length_freq_data, max_range_nodes, alpha_ijl, &copy_n, lgamma_table, count_buffer );
 		
 		if( size_node[ selected_edge_j ] > 0 )
 		{	
@@ -2095,7 +1880,7 @@ void dgm_bdmcmc_mpl_map_multi_update( int *iter, int *burnin, int G[], double g_
 			for( t = 0; t < dim; t++ ) 
 				if( G[ nodexdim + t ] ) mb_node[ count_mb++ ] = t;
 		}	
-		log_mpl_dis( &selected_edge_j, &mb_node[0], &size_node[ selected_edge_j ], &curr_log_mpl[ selected_edge_j ], data, freq_data, &length_freq_data, max_range_nodes, alpha_ijl, &copy_n );
+		log_mpl_dis( &selected_edge_j, &mb_node[0], &size_node[ selected_edge_j ], &curr_log_mpl[ selected_edge_j ], data, freq_data, &length_freq_data, max_range_nodes, alpha_ijl, &copy_n, lgamma_table, count_buffer );
 		
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
 	} 
@@ -2118,8 +1903,10 @@ void dgm_bdmcmc_mpl_map_multi_update( int *iter, int *burnin, int G[], double g_
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
 void log_alpha_rjmcmc_gm_mpl_dis( double *log_alpha_ij, double log_ratio_g_prior[], int *i, int *j, 
             double curr_log_mpl[], int G[], int size_node[], int data[], int freq_data[], 
-            int *length_freq_data, int max_range_nodes[], double *alpha_ijl, int *n, int *p )
+            int *length_freq_data, int max_range_nodes[], double *alpha_ijl, int *n, int *p, 
+            mpl_lgamma_table &lgamma_table, mpl_count_buffer &buffer )
 {
+	profile_phase timer( run_profile::rates );
 	int t, nodexdim, count_mb, dim = *p, size_node_i_new, size_node_j_new;
 	double log_mpl_i_new, log_mpl_j_new;
 
@@ -2163,8 +1950,8 @@ void log_alpha_rjmcmc_gm_mpl_dis( double *log_alpha_ij, double log_ratio_g_prior
 			if( G[ nodexdim + t ] or t == *i ) mb_node_j_new[ count_mb++ ] = t;
 	}
 	
-	log_mpl_dis( i, &mb_node_i_new[0], &size_node_i_new, &log_mpl_i_new, data, freq_data, length_freq_data, max_range_nodes, alpha_ijl, n );		
-	log_mpl_dis( j, &mb_node_j_new[0], &size_node_j_new, &log_mpl_j_new, data, freq_data, length_freq_data, max_range_nodes, alpha_ijl, n );		
+	log_mpl_dis( i, &mb_node_i_new[0], &size_node_i_new, &log_mpl_i_new, data, freq_data, length_freq_data, max_range_nodes, alpha_ijl, n, lgamma_table, buffer );		
+	log_mpl_dis( j, &mb_node_j_new[0], &size_node_j_new, &log_mpl_j_new, data, freq_data, length_freq_data, max_range_nodes, alpha_ijl, n, lgamma_table, buffer );		
 																
 	*log_alpha_ij = log_mpl_i_new + log_mpl_j_new - curr_log_mpl[ *i ] - curr_log_mpl[ *j ];
 	*log_alpha_ij = ( G[ ij ] ) ? *log_alpha_ij - log_ratio_g_prior[ ij ] : *log_alpha_ij + log_ratio_g_prior[ ij ];
@@ -2200,6 +1987,13 @@ void dgm_rjmcmc_mpl_ma( int *iter, int *burnin, int G[], double g_prior[],
 	// Caclulating the log_likelihood for the current graph G
 	vector<int>mb_node( dim );     
 	vector<double>curr_log_mpl( dim );
+	mpl_count_buffer count_buffer;
+
+	// lgamma( k + alpha ) for all counts k = 0, ..., n and all ranges of the nodes, shared by all threads
+	vector<int> size_range_nodes( dim );
+	for( i = 0; i < dim; i++ ) size_range_nodes[ i ] = max_range_nodes[ i ] + 1;
+	mpl_lgamma_table lgamma_table;
+	get_mpl_lgamma_table( &copy_n, alpha_ijl, &size_range_nodes[0], &dim, lgamma_table );
 	for( i = 0; i < dim; i++ ) 
 	{ 
 		if( size_node[ i ] > 0 )
@@ -2210,7 +2004,7 @@ void dgm_rjmcmc_mpl_ma( int *iter, int *burnin, int G[], double g_prior[],
 				if( G[ nodexdim + t ] ) mb_node[ count_mb++ ] = t;
 		}
 				
-		log_mpl_dis( &i, &mb_node[0], &size_node[i], &curr_log_mpl[i], data, freq_data, &length_freq_data, max_range_nodes, alpha_ijl, &copy_n );
+		log_mpl_dis( &i, &mb_node[0], &size_node[i], &curr_log_mpl[i], data, freq_data, &length_freq_data, max_range_nodes, alpha_ijl, &copy_n, lgamma_table, count_buffer );
 	}
 
 	vector<double> log_ratio_g_prior( pxp );	
@@ -2228,8 +2022,7 @@ void dgm_rjmcmc_mpl_ma( int *iter, int *burnin, int G[], double g_prior[],
 	for( j = 1; j < dim; j++ )
 	    for( i = 0; i < j; i++ )
 	    {
-	        ij = g_prior[ j * dim + i ];
-	        if( ( ij != 0.0 ) or ( ij != 1.0 ) )
+	        if( ( g_prior[ j * dim + i ] != 0.0 ) and ( g_prior[ j * dim + i ] != 1.0 ) )
 	        {
 	            index_row[ counter ] = i;
 	            index_col[ counter ] = j;
@@ -2243,10 +2036,7 @@ void dgm_rjmcmc_mpl_ma( int *iter, int *burnin, int G[], double g_prior[],
 	int print_conter = 0;
 	for( int i_mcmc = 0; i_mcmc < iteration; i_mcmc++ )
 	{
-		if( ( i_mcmc + 1 ) % ( ( print_c * iteration ) / 100 ) == 0 ){
-		    ++print_conter;
-		    ( ( i_mcmc + 1 ) != iteration ) ? Rprintf( "%i%%->", print_c * print_conter ) : Rprintf( " done" );
-		}
+		print_progress( i_mcmc + 1, iteration, print_c, &print_conter );
 	  				
 // - - - STEP 1: selecting edge and calculating alpha - - - - - - - - - - - - - - - - - - - - - - -|		
 		// Randomly selecting one edge: NOTE qp = p * ( p - 1 ) / 2 
@@ -2256,7 +2046,7 @@ void dgm_rjmcmc_mpl_ma( int *iter, int *burnin, int G[], double g_prior[],
 
 // - - - STEP 1: calculating log_alpha_ij - - - - - - - - - - - - - - - - - - - - - - - - - - - - -|		
 				
-		log_alpha_rjmcmc_gm_mpl_dis( &log_alpha_ij, &log_ratio_g_prior[0], &selected_edge_i, &selected_edge_j, &curr_log_mpl[0], G, &size_node[0], data, freq_data, &length_freq_data, max_range_nodes, alpha_ijl, &copy_n, &dim );
+		log_alpha_rjmcmc_gm_mpl_dis( &log_alpha_ij, &log_ratio_g_prior[0], &selected_edge_i, &selected_edge_j, &curr_log_mpl[0], G, &size_node[0], data, freq_data, &length_freq_data, max_range_nodes, alpha_ijl, &copy_n, &dim, lgamma_table, count_buffer );
 		
 // - - - End of calculating log_alpha_ij - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |		
 		  		
@@ -2285,7 +2075,7 @@ void dgm_rjmcmc_mpl_ma( int *iter, int *burnin, int G[], double g_prior[],
 			for( t = 0; t < dim; t++ ) 
 				if( G[ nodexdim + t ] ) mb_node[ count_mb++ ] = t;
 		}				
-		log_mpl_dis( &selected_edge_i, &mb_node[0], &size_node[ selected_edge_i ], &curr_log_mpl[ selected_edge_i ], data, freq_data, &length_freq_data, max_range_nodes, alpha_ijl, &copy_n );
+		log_mpl_dis( &selected_edge_i, &mb_node[0], &size_node[ selected_edge_i ], &curr_log_mpl[ selected_edge_i ], data, freq_data, &length_freq_data, max_range_nodes, alpha_ijl, &copy_n, lgamma_table, count_buffer );
 		
 		if( size_node[ selected_edge_j ] > 0 )
 		{	
@@ -2294,7 +2084,7 @@ void dgm_rjmcmc_mpl_ma( int *iter, int *burnin, int G[], double g_prior[],
 			for( t = 0; t < dim; t++ ) 
 				if( G[ nodexdim + t ] ) mb_node[ count_mb++ ] = t;
 		}	
-		log_mpl_dis( &selected_edge_j, &mb_node[0], &size_node[ selected_edge_j ], &curr_log_mpl[ selected_edge_j ], data, freq_data, &length_freq_data, max_range_nodes, alpha_ijl, &copy_n );
+		log_mpl_dis( &selected_edge_j, &mb_node[0], &size_node[ selected_edge_j ], &curr_log_mpl[ selected_edge_j ], data, freq_data, &length_freq_data, max_range_nodes, alpha_ijl, &copy_n, lgamma_table, count_buffer );
 
 // - - - Saving result - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
 		if( i_mcmc >= burn_in )
@@ -2341,6 +2131,13 @@ void dgm_rjmcmc_mpl_map( int *iter, int *burnin, int G[], double g_prior[], int
 	// Caclulating the log_likelihood for the current graph G
 	vector<int>mb_node( dim );     
 	vector<double>curr_log_mpl( dim );
+	mpl_count_buffer count_buffer;
+
+	// lgamma( k + alpha ) for all counts k = 0, ..., n and all ranges of the nodes, shared by all threads
+	vector<int> size_range_nodes( dim );
+	for( i = 0; i < dim; i++ ) size_range_nodes[ i ] = max_range_nodes[ i ] + 1;
+	mpl_lgamma_table lgamma_table;
+	get_mpl_lgamma_table( &copy_n, alpha_ijl, &size_range_nodes[0], &dim, lgamma_table );
 
 	for( i = 0; i < dim; i++ ) 
 	{ 
@@ -2352,7 +2149,7 @@ void dgm_rjmcmc_mpl_map( int *iter, int *burnin, int G[], double g_prior[], int
 				if( G[ nodexdim + t ] ) mb_node[ count_mb++ ] = t;
 		}
 				
-		log_mpl_dis( &i, &mb_node[0], &size_node[i], &curr_log_mpl[i], data, freq_data, &length_freq_data, max_range_nodes, alpha_ijl, &copy_n );
+		log_mpl_dis( &i, &mb_node[0], &size_node[i], &curr_log_mpl[i], data, freq_data, &length_freq_data, max_range_nodes, alpha_ijl, &copy_n, lgamma_table, count_buffer );
 	}
 
 	vector<double> log_ratio_g_prior( pxp );	
@@ -2370,8 +2167,7 @@ void dgm_rjmcmc_mpl_map( int *iter, int *burnin, int G[], double g_prior[], int
 	for( j = 1; j < dim; j++ )
 	    for( i = 0; i < j; i++ )
 	    {
-	        ij = g_prior[ j * dim + i ];
-	        if( ( ij != 0.0 ) or ( ij != 1.0 ) )
+	        if( ( g_prior[ j * dim + i ] != 0.0 ) and ( g_prior[ j * dim + i ] != 1.0 ) )
 	        {
 	            index_row[ counter ] = i;
 	            index_col[ counter ] = j;
@@ -2385,10 +2181,7 @@ void dgm_rjmcmc_mpl_map( int *iter, int *burnin, int G[], double g_prior[], int
 	int print_conter = 0;
 	for( int i_mcmc = 0; i_mcmc < iteration; i_mcmc++ )
 	{
-		if( ( i_mcmc + 1 ) % ( ( print_c * iteration ) / 100 ) == 0 ){
-		    ++print_conter;
-		    ( ( i_mcmc + 1 ) != iteration ) ? Rprintf( "%i%%->", print_c * print_conter ) : Rprintf( " done" );
-		}
+		print_progress( i_mcmc + 1, iteration, print_c, &print_conter );
 	  				
 // - - - STEP 1: selecting edge and calculating alpha - - - - - - - - - - - - - - - - - - - - - - -|		
 		// Randomly selecting one edge: NOTE qp = p * ( p - 1 ) / 2 
@@ -2398,7 +2191,7 @@ void dgm_rjmcmc_mpl_map( int *iter, int *burnin, int G[], double g_prior[], int
 
 // - - - STEP 1: calculating log_alpha_ij - - - - - - - - - - - - - - - - - - - - - - - - - - - - -|		
 				
-		log_alpha_rjmcmc_gm_mpl_dis( &log_alpha_ij, &log_ratio_g_prior[0], &selected_edge_i, &selected_edge_j, &curr_log_mpl[0], G, &size_node[0], data, freq_data, &length_freq_data, max_range_nodes, alpha_ijl, &copy_n, &dim );
+		log_alpha_rjmcmc_gm_mpl_dis( &log_alpha_ij, &log_ratio_g_prior[0], &selected_edge_i, &selected_edge_j, &curr_log_mpl[0], G, &size_node[0], data, freq_data, &length_freq_data, max_range_nodes, alpha_ijl, &copy_n, &dim, lgamma_table, count_buffer );
 		
 // - - - End of calculating log_alpha_ij - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |		
 		  		
@@ -2427,7 +2220,7 @@ void dgm_rjmcmc_mpl_map( int *iter, int *burnin, int G[], double g_prior[], int
 			for( t = 0; t < dim; t++ ) 
 				if( G[ nodexdim + t ] ) mb_node[ count_mb++ ] = t;
 		}				
-		log_mpl_dis( &selected_edge_i, &mb_node[0], &size_node[ selected_edge_i ], &curr_log_mpl[ selected_edge_i ], data, freq_data, &length_freq_data, max_range_nodes, alpha_ijl, &copy_n );
+		log_mpl_dis( &selected_edge_i, &mb_node[0], &size_node[ selected_edge_i ], &curr_log_mpl[ selected_edge_i ], data, freq_data, &length_freq_data, max_range_nodes, alpha_ijl, &copy_n, lgamma_table, count_buffer );
 		
 		if( size_node[ selected_edge_j ] > 0 )
 		{	
@@ -2436,7 +2229,7 @@ void dgm_rjmcmc_mpl_map( int *iter, int *burnin, int G[], double g_prior[], int
 			for( t = 0; t < dim; t++ ) 
 				if( G[ nodexdim + t ] ) mb_node[ count_mb++ ] = t;
 		}	
-		log_mpl_dis( &selected_edge_j, &mb_node[0], &size_node[ selected_edge_j ], &curr_log_mpl[ selected_edge_j ], data, freq_data, &length_freq_data, max_range_nodes, alpha_ijl, &copy_n );
+		log_mpl_dis( &selected_edge_j, &mb_node[0], &size_node[ selected_edge_j ], &curr_log_mpl[ selected_edge_j ], data, freq_data, &length_freq_data, max_range_nodes, alpha_ijl, &copy_n, lgamma_table, count_buffer );
 
 // - - - Saving result - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
 		if( i_mcmc >= burn_in )
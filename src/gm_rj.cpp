@@ -86,6 +86,50 @@ void log_alpha_rjmcmc( double *log_alpha_ij, double log_ratio_g_prior[], int *se
 	if( G[ ij ] == 0 ) *log_alpha_ij = - *log_alpha_ij;	
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// Parallel computation of log_alpha_ij for the selected edges ( select_rj_edges ) in RJ-MCMC,
+// all for the current K. K is drawn once after the batch, so for multi_update > 1 it is the same
+// approximation as the multiple updates of the BDMCMC algorithm, not a sequence of RJ moves
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+void log_alpha_rjmcmc_parallel( double log_alpha[], int index_selected_edges[], int *size_index, double log_ratio_g_prior[], 
+                    int G[], int index_row[], int index_col[], double Ds[], double sigma[], double K[], int *b, int *p )
+{
+	profile_phase timer( run_profile::rates );
+	int dim = *p, p1 = dim - 1, p2 = dim - 2, p2x2 = p2 * 2;
+
+	#pragma omp parallel if( *size_index > 1 )
+	{
+		int selected_edge_i, selected_edge_j;
+
+		vector<double> K121( 4 ); 
+		vector<double> Kj12( p1 );              // K[j, -j]
+		vector<double> sigmaj12( p1 );          // sigma[-j, j]  
+		vector<double> sigmaj22( p1 * p1 );     // sigma[-j, -j]
+		vector<double> Kj12xK22_inv( p1 ); 
+
+		vector<double> K21( p2x2 );             // K[-e, e]
+		vector<double> sigma21( p2x2 );         // sigma[-e, e]
+		vector<double> sigma22( p2 * p2 );      // sigma[-e, -e]
+		vector<double> sigma11_inv( 4 );        // inv( sigma[e, e] )
+		vector<double> sigma21xsigma11_inv( p2x2 ); 
+		vector<double> K12xK22_inv( p2x2 );   
+
+		#pragma omp for
+		for( int e = 0; e < *size_index; e++ )
+		{
+			profile_work work;
+			selected_edge_i = index_row[ index_selected_edges[ e ] ];
+			selected_edge_j = index_col[ index_selected_edges[ e ] ];
+
+			log_alpha_rjmcmc( &log_alpha[ e ], log_ratio_g_prior, &selected_edge_i, &selected_edge_j, G, Ds, 
+			                  sigma, &sigma21[0], &sigma22[0], &sigmaj12[0], &sigmaj22[0],    
+			                  K, &K21[0], &K121[0], &Kj12[0], 
+			                  &K12xK22_inv[0], &Kj12xK22_inv[0], &sigma11_inv[0], &sigma21xsigma11_inv[0],  
+			                  b, &dim );
+		}
+	}
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
 // Reversible Jump MCMC for Gaussian Graphical models  
 // for D = I_p 
@@ -93,27 +137,16 @@ void log_alpha_rjmcmc( double *log_alpha_ij, double log_ratio_g_prior[], int *se
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
 void ggm_rjmcmc_ma( int *iter, int *burnin, int G[], double g_prior[], double Ts[], double K[], 
                     int *p, double *threshold, double K_hat[], int p_links[], 
-                    int *b, int *b_star, double Ds[], int *print )
+                    int *b, int *b_star, double Ds[], int *multi_update, int *print )
 {
-	int print_c = *print, iteration = *iter, burn_in = *burnin;
-	int selected_edge, selected_edge_i, selected_edge_j, ip, i, j, ij, counter;
-	int dim = *p, pxp = dim * dim, p1 = dim - 1, p2 = dim - 2, p2x2 = p2 * 2;
+	int print_c = *print, multi_update_C = *multi_update, iteration = *iter, burn_in = *burnin;
+	int selected_edge_i, selected_edge_j, size_index, ip, i, j, ij, counter;
+	int dim = *p, pxp = dim * dim;
 	int qp = dim * ( dim - 1 ) / 2;
-	double log_alpha_ij;
-
-	// - - allocation for log_alpha_ij 
-	vector<double> K121( 4 ); 
-	vector<double> Kj12( p1 );              // K[j, -j]
-	vector<double> sigmaj12( p1 );          // sigma[-j, j]  
-	vector<double> sigmaj22( p1 * p1 );     // sigma[-j, -j]
-	vector<double> Kj12xK22_inv( p1 ); 
-
-	vector<double> K21( p2x2 );                          // K[-e, e]
-	vector<double> sigma21( p2x2 );                      // sigma[-e, e]
-	vector<double> sigma22( ( dim - 2 ) * ( dim - 2 ) ); // sigma[-e, -e]
-	vector<double> sigma11_inv( 4 );                     // inv( sigma[e, e] )
-	vector<double> sigma21xsigma11_inv( p2x2 ); 
-	vector<double> K12xK22_inv( p2x2 );   
+
+	// - - for the selected edges and their log_alpha 
+	vector<int> index_selected_edges( multi_update_C );
+	vector<double> log_alpha( multi_update_C );
 	// - -  for rgwish_sigma 
 	vector<double> sigma_start( pxp ); 
 	vector<double> inv_C( pxp ); 
@@ -144,8 +177,7 @@ void ggm_rjmcmc_ma( int *iter, int *burnin, int G[], double g_prior[], double Ts
 	for( j = 1; j < dim; j++ )
 	    for( i = 0; i < j; i++ )
 	    {
-	        ij = g_prior[ j * dim + i ];
-	        if( ( ij != 0.0 ) or ( ij != 1.0 ) )
+	        if( ( g_prior[ j * dim + i ] != 0.0 ) and ( g_prior[ j * dim + i ] != 1.0 ) )
 	        {
 	            index_row[ counter ] = i;
 	            index_col[ counter ] = j;
@@ -167,43 +199,39 @@ void ggm_rjmcmc_ma( int *iter, int *burnin, int G[], double g_prior[], double Ts
 	int print_conter = 0;
 	for( int i_mcmc = 0; i_mcmc < iteration; i_mcmc++ )
 	{
-		if( ( i_mcmc + 1 ) % ( ( print_c * iteration ) / 100 ) == 0 ){
-		    ++print_conter;
-		    ( ( i_mcmc + 1 ) != iteration ) ? Rprintf( "%i%%->", print_c * print_conter ) : Rprintf( " done" );
-		}
+		print_progress( i_mcmc + 1, iteration, print_c, &print_conter );
 	  				
 // - - - STEP 1: selecting edge and calculating alpha - - - - - - - - - - - - - - - - - - - - - - -|		
-		// Randomly selecting one edge: NOTE qp = p * ( p - 1 ) / 2 
-		selected_edge   = static_cast<int>( unif_rand() * sub_qp );
-		selected_edge_i = index_row[ selected_edge ];
-		selected_edge_j = index_col[ selected_edge ];
+		// Randomly selecting a batch of edges ( one edge for multi_update = 1 ): NOTE qp = p * ( p - 1 ) / 2 
+		select_rj_edges( &index_row[0], &index_col[0], &index_selected_edges[0], &size_index, &multi_update_C, &sub_qp, &dim );
 
 // - - - STEP 1: calculating log_alpha_ij - - - - - - - - - - - - - - - - - - - - - - - - - - - - -|		
 
-		log_alpha_rjmcmc( &log_alpha_ij, &log_ratio_g_prior[0], &selected_edge_i, &selected_edge_j, G, Ds, 
-                      &sigma[0], &sigma21[0], &sigma22[0], &sigmaj12[0], &sigmaj22[0],    
-                      &K[0], &K21[0], &K121[0], &Kj12[0], 
-                      &K12xK22_inv[0], &Kj12xK22_inv[0], &sigma11_inv[0], &sigma21xsigma11_inv[0],  
-                      b, &dim );
+		log_alpha_rjmcmc_parallel( &log_alpha[0], &index_selected_edges[0], &size_index, &log_ratio_g_prior[0], 
+		                           G, &index_row[0], &index_col[0], Ds, &sigma[0], K, b, &dim );
 
 // - - - End of calculating log_alpha_ij - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |		
 		  		
-		// Selecting an edge and updating G (graph)
-		if( log( static_cast<double>( unif_rand() ) ) < log_alpha_ij )
-		{
-			ij    = selected_edge_j * dim + selected_edge_i;
-			G[ ij ] = 1 - G[ ij ];
-			G[ selected_edge_i * dim + selected_edge_j ] = G[ ij ];
-
-			if( G[ ij ] )
-			{ 
-				++size_node[ selected_edge_i ]; 
-				++size_node[ selected_edge_j ]; 
-			}else{ 
-				--size_node[ selected_edge_i ]; 
-				--size_node[ selected_edge_j ]; 
+		// Updating G (graph) for each selected edge
+		for( int e = 0; e < size_index; e++ )
+			if( log( static_cast<double>( unif_rand() ) ) < log_alpha[ e ] )
+			{
+				selected_edge_i = index_row[ index_selected_edges[ e ] ];
+				selected_edge_j = index_col[ index_selected_edges[ e ] ];
+
+				ij    = selected_edge_j * dim + selected_edge_i;
+				G[ ij ] = 1 - G[ ij ];
+				G[ selected_edge_i * dim + selected_edge_j ] = G[ ij ];
+
+				if( G[ ij ] )
+				{ 
+					++size_node[ selected_edge_i ]; 
+					++size_node[ selected_edge_j ]; 
+				}else{ 
+					--size_node[ selected_edge_i ]; 
+					--size_node[ selected_edge_j ]; 
+				}
 			}
-		}
 
 // - - - STEP 2: Sampling from G-Wishart for new graph - - - - - - - - - - - - - - - - - - - - - - |
 		rgwish_sigma( G, &size_node[0], Ts, K, &sigma[0], b_star, &dim, threshold, &sigma_start[0], &inv_C[0], &beta_star[0], &sigma_i[0], sigma_start_N_i, sigma_N_i, N_i );		
@@ -230,32 +258,21 @@ void ggm_rjmcmc_map( int *iter, int *burnin, int G[], double g_prior[], double T
                     int *p, double *threshold, 
                     int all_graphs[], double all_weights[], double K_hat[], 
                     char *sample_graphs[], double graph_weights[], int *size_sample_g,
-                    int *b, int *b_star, double Ds[], int *print )
+                    int *b, int *b_star, double Ds[], int *multi_update, int *print )
 {
-	int print_c = *print, iteration = *iter, burn_in = *burnin, count_all_g = 0;
-	int selected_edge, selected_edge_i, selected_edge_j, size_sample_graph = *size_sample_g;
-	int ip, i, j, ij, counter, dim = *p, pxp = dim * dim, p1 = dim - 1, p2 = dim - 2, p2x2 = p2 * 2;
+	int print_c = *print, multi_update_C = *multi_update, iteration = *iter, burn_in = *burnin, count_all_g = 0;
+	int selected_edge_i, selected_edge_j, size_index, size_sample_graph = *size_sample_g;
+	int ip, i, j, ij, counter, dim = *p, pxp = dim * dim;
 	int qp = dim * ( dim - 1 ) / 2;
 
-	double log_alpha_ij;
 	string string_g;
 	vector<string> sample_graphs_C( iteration - burn_in );
 
 	bool this_one;
 
-	// - - - allocation for log_alpha_ij 
-	vector<double> K121( 4 ); 
-	vector<double> Kj12( p1 );              // K[j, -j]
-	vector<double> sigmaj12( p1 );          // sigma[-j, j]  
-	vector<double> sigmaj22( p1 * p1 );     // sigma[-j, -j]
-	vector<double> Kj12xK22_inv( p1 ); 
-
-	vector<double> K21( p2x2 );                          // K[-e, e]
-	vector<double> sigma21( p2x2 );                      // sigma[-e, e]
-	vector<double> sigma22( ( dim - 2 ) * ( dim - 2 ) ); // sigma[-e, -e]
-	vector<double> sigma11_inv( 4 );                     // inv( sigma[e, e] )
-	vector<double> sigma21xsigma11_inv( p2x2 ); 
-	vector<double> K12xK22_inv( p2x2 );   
+	// - - for the selected edges and their log_alpha 
+	vector<int> index_selected_edges( multi_update_C );
+	vector<double> log_alpha( multi_update_C );
 	// - - for rgwish_sigma 
 	vector<double> sigma_start( pxp ); 
 	vector<double> inv_C( pxp ); 
@@ -286,8 +303,7 @@ void ggm_rjmcmc_map( int *iter, int *burnin, int G[], double g_prior[], double T
 	for( j = 1; j < dim; j++ )
 	    for( i = 0; i < j; i++ )
 	    {
-	        ij = g_prior[ j * dim + i ];
-	        if( ( ij != 0.0 ) or ( ij != 1.0 ) )
+	        if( ( g_prior[ j * dim + i ] != 0.0 ) and ( g_prior[ j * dim + i ] != 1.0 ) )
 	        {
 	            index_row[ counter ] = i;
 	            index_col[ counter ] = j;
@@ -309,43 +325,39 @@ void ggm_rjmcmc_map( int *iter, int *burnin, int G[], double g_prior[], double T
 	int print_conter = 0;
 	for( int i_mcmc = 0; i_mcmc < iteration; i_mcmc++ )
 	{
-		if( ( i_mcmc + 1 ) % ( ( print_c * iteration ) / 100 ) == 0 ){
-		    ++print_conter;
-		    ( ( i_mcmc + 1 ) != iteration ) ? Rprintf( "%i%%->", print_c * print_conter ) : Rprintf( " done" );
-		}
+		print_progress( i_mcmc + 1, iteration, print_c, &print_conter );
 	  				
 		// STEP 1: selecting edge and calculating alpha
-		// Randomly selecting one edge: NOTE qp = p * ( p - 1 ) / 2 
-		selected_edge   = static_cast<int>( unif_rand() * sub_qp );
-		selected_edge_i = index_row[ selected_edge ];
-		selected_edge_j = index_col[ selected_edge ];
+		// Randomly selecting a batch of edges ( one edge for multi_update = 1 ): NOTE qp = p * ( p - 1 ) / 2 
+		select_rj_edges( &index_row[0], &index_col[0], &index_selected_edges[0], &size_index, &multi_update_C, &sub_qp, &dim );
 
 // - - - STEP 1: calculating log_alpha_ij - - - - - - - - - - - - - - - - - - - - - - - - - - - - -|		
 
-		log_alpha_rjmcmc( &log_alpha_ij, &log_ratio_g_prior[0], &selected_edge_i, &selected_edge_j, G, Ds, 
-                      &sigma[0], &sigma21[0], &sigma22[0], &sigmaj12[0], &sigmaj22[0],    
-                      &K[0], &K21[0], &K121[0], &Kj12[0], 
-                      &K12xK22_inv[0], &Kj12xK22_inv[0], &sigma11_inv[0], &sigma21xsigma11_inv[0],  
-                      b, &dim );
+		log_alpha_rjmcmc_parallel( &log_alpha[0], &index_selected_edges[0], &size_index, &log_ratio_g_prior[0], 
+		                           G, &index_row[0], &index_col[0], Ds, &sigma[0], K, b, &dim );
 
 // - - - End of calculating log_alpha_ij - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |		
 		  		
-		// Selecting an edge and updating G (graph)
-		if( log( static_cast<double>( unif_rand() ) ) < log_alpha_ij )
-		{
-			ij    = selected_edge_j * dim + selected_edge_i;
-			G[ ij ] = 1 - G[ ij ];
-			G[ selected_edge_i * dim + selected_edge_j ] = G[ ij ];
-
-			if( G[ ij ] )
-			{ 
-				++size_node[ selected_edge_i ]; 
-				++size_node[ selected_edge_j ]; 
-			}else{ 
-				--size_node[ selected_edge_i ]; 
-				--size_node[ selected_edge_j ]; 
+		// Updating G (graph) for each selected edge
+		for( int e = 0; e < size_index; e++ )
+			if( log( static_cast<double>( unif_rand() ) ) < log_alpha[ e ] )
+			{
+				selected_edge_i = index_row[ index_selected_edges[ e ] ];
+				selected_edge_j = index_col[ index_selected_edges[ e ] ];
+
+				ij    = selected_edge_j * dim + selected_edge_i;
+				G[ ij ] = 1 - G[ ij ];
+				G[ selected_edge_i * dim + selected_edge_j ] = G[ ij ];
+
+				if( G[ ij ] )
+				{ 
+					++size_node[ selected_edge_i ]; 
+					++size_node[ selected_edge_j ]; 
+				}else{ 
+					--size_node[ selected_edge_i ]; 
+					--size_node[ selected_edge_j ]; 
+				}
 			}
-		}
 
 // - - - STEP 2: Sampling from G-Wishart for new graph - - - - - - - - - - - - - - - - - - - - - - |
 		rgwish_sigma( G, &size_node[0], Ts, K, &sigma[0], b_star, &dim, threshold, &sigma_start[0], &inv_C[0], &beta_star[0], &sigma_i[0], sigma_start_N_i, sigma_N_i, N_i );		
@@ -405,28 +417,17 @@ void gcgm_rjmcmc_ma( int *iter, int *burnin, int G[], double g_prior[], double T
                     int *p, double *threshold, 
                     double Z[], int R[], int not_continuous[], int *n, int *gcgm,
                     double K_hat[], int p_links[], 
-                    int *b, int *b_star, double D[], double Ds[], int *print )
+                    int *b, int *b_star, double D[], double Ds[], int *multi_update, int *print )
 {
-	int print_c = *print, iteration = *iter, burn_in = *burnin;
-	int selected_edge, counter, selected_edge_i, selected_edge_j;
-	int ip, i, j, ij, dim = *p, pxp = dim * dim, p1 = dim - 1, p2 = dim - 2, p2x2 = p2 * 2;
+	int print_c = *print, multi_update_C = *multi_update, iteration = *iter, burn_in = *burnin;
+	int counter, selected_edge_i, selected_edge_j, size_index;
+	int ip, i, j, ij, dim = *p, pxp = dim * dim;
 	int qp = dim * ( dim - 1 ) / 2;
-	
-	double log_alpha_ij;
-
-	// - - allocation for log_alpha_ij 
-	vector<double> K121( 4 ); 
-	vector<double> Kj12( p1 );              // K[j, -j]
-	vector<double> sigmaj12( p1 );          // sigma[-j, j]  
-	vector<double> sigmaj22( p1 * p1 );     // sigma[-j, -j]
-	vector<double> Kj12xK22_inv( p1 ); 
-
-	vector<double> K21( p2x2 );                          // K[-e, e]
-	vector<double> sigma21( p2x2 );                      // sigma[-e, e]
-	vector<double> sigma22( ( dim - 2 ) * ( dim - 2 ) ); // sigma[-e, -e]
-	vector<double> sigma11_inv( 4 );                     // inv( sigma[e, e] )
-	vector<double> sigma21xsigma11_inv( p2x2 ); 
-	vector<double> K12xK22_inv( p2x2 );   
+
+
+	// - - for the selected edges and their log_alpha 
+	vector<int> index_selected_edges( multi_update_C );
+	vector<double> log_alpha( multi_update_C );
 	// - - for rgwish_sigma  - - - - - - - - - 
 	vector<double> sigma_start( pxp ); 
 	vector<double> inv_C( pxp ); 
@@ -461,8 +462,7 @@ void gcgm_rjmcmc_ma( int *iter, int *burnin, int G[], double g_prior[], double T
 	for( j = 1; j < dim; j++ )
 	    for( i = 0; i < j; i++ )
 	    {
-	        ij = g_prior[ j * dim + i ];
-	        if( ( ij != 0.0 ) or ( ij != 1.0 ) )
+	        if( ( g_prior[ j * dim + i ] != 0.0 ) and ( g_prior[ j * dim + i ] != 1.0 ) )
 	        {
 	            index_row[ counter ] = i;
 	            index_col[ counter ] = j;
@@ -484,10 +484,7 @@ void gcgm_rjmcmc_ma( int *iter, int *burnin, int G[], double g_prior[], double T
 	int print_conter = 0;
 	for( int i_mcmc = 0; i_mcmc < iteration; i_mcmc++ )
 	{
-		if( ( i_mcmc + 1 ) % ( ( print_c * iteration ) / 100 ) == 0 ){
-		    ++print_conter;
-		    ( ( i_mcmc + 1 ) != iteration ) ? Rprintf( "%i%%->", print_c * print_conter ) : Rprintf( " done" );
-		}
+		print_progress( i_mcmc + 1, iteration, print_c, &print_conter );
 	  		
 // - - - STEP 1: copula - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -|		
 		
@@ -495,37 +492,36 @@ void gcgm_rjmcmc_ma( int *iter, int *burnin, int G[], double g_prior[], double T
 		get_Ts( Ds, Ts, &inv_Ds[0], &copy_Ds[0], &dim );
 		
 // - - - STEP 2: calculating log_alpha_ij - - - - - - - - - - - - - - - - - - - - - - - - - - - - -|		
-		// Randomly selecting one edge: NOTE qp = p * ( p - 1 ) / 2 
-		selected_edge   = static_cast<int>( unif_rand() * sub_qp );
-		selected_edge_i = index_row[ selected_edge ];
-		selected_edge_j = index_col[ selected_edge ];
-		
-// - - - STEP 2: calculating log_alpha_ij - - - - - - - - - - - - - - - - - - - - - - - - - - - - -|		
+		// Randomly selecting a batch of edges ( one edge for multi_update = 1 ): NOTE qp = p * ( p - 1 ) / 2 
+		select_rj_edges( &index_row[0], &index_col[0], &index_selected_edges[0], &size_index, &multi_update_C, &sub_qp, &dim );
 
-		log_alpha_rjmcmc( &log_alpha_ij, &log_ratio_g_prior[0], &selected_edge_i, &selected_edge_j, G, Ds, 
-                      &sigma[0], &sigma21[0], &sigma22[0], &sigmaj12[0], &sigmaj22[0],    
-                      &K[0], &K21[0], &K121[0], &Kj12[0], 
-                      &K12xK22_inv[0], &Kj12xK22_inv[0], &sigma11_inv[0], &sigma21xsigma11_inv[0],  
-                      b, &dim );
+// - - - STEP 1: calculating log_alpha_ij - - - - - - - - - - - - - - - - - - - - - - - - - - - - -|		
+
+		log_alpha_rjmcmc_parallel( &log_alpha[0], &index_selected_edges[0], &size_index, &log_ratio_g_prior[0], 
+		                           G, &index_row[0], &index_col[0], Ds, &sigma[0], K, b, &dim );
 
 // - - - End of calculating log_alpha_ij - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |		
-		
-		// Selecting an edge and updating G (graph)
-		if( log( static_cast<double>( unif_rand() ) ) < log_alpha_ij )
-		{
-			ij    = selected_edge_j * dim + selected_edge_i;
-			G[ ij ] = 1 - G[ ij ];
-			G[ selected_edge_i * dim + selected_edge_j ] = G[ ij ];
-
-			if( G[ ij ] )
-			{ 
-				++size_node[ selected_edge_i ]; 
-				++size_node[ selected_edge_j ]; 
-			}else{ 
-				--size_node[ selected_edge_i ]; 
-				--size_node[ selected_edge_j ]; 
+		  		
+		// Updating G (graph) for each selected edge
+		for( int e = 0; e < size_index; e++ )
+			if( log( static_cast<double>( unif_rand() ) ) < log_alpha[ e ] )
+			{
+				selected_edge_i = index_row[ index_selected_edges[ e ] ];
+				selected_edge_j = index_col[ index_selected_edges[ e ] ];
+
+				ij    = selected_edge_j * dim + selected_edge_i;
+				G[ ij ] = 1 - G[ ij ];
+				G[ selected_edge_i * dim + selected_edge_j ] = G[ ij ];
+
+				if( G[ ij ] )
+				{ 
+					++size_node[ selected_edge_i ]; 
+					++size_node[ selected_edge_j ]; 
+				}else{ 
+					--size_node[ selected_edge_i ]; 
+					--size_node[ selected_edge_j ]; 
+				}
 			}
-		}
 
 // - - - STEP 2: Sampling from G-Wishart for new graph - - - - - - - - - - - - - - - - - - - - - - |
 		rgwish_sigma( G, &size_node[0], Ts, K, &sigma[0], b_star, &dim, threshold, &sigma_start[0], &inv_C[0], &beta_star[0], &sigma_i[0], sigma_start_N_i, sigma_N_i, N_i );		
@@ -553,31 +549,20 @@ void gcgm_rjmcmc_map( int *iter, int *burnin, int G[], double g_prior[], double
                     double Z[], int R[], int not_continuous[], int *n, int *gcgm,
                     int all_graphs[], double all_weights[], double K_hat[], 
                     char *sample_graphs[], double graph_weights[], int *size_sample_g,
-                    int *b, int *b_star, double D[], double Ds[], int *print )
+                    int *b, int *b_star, double D[], double Ds[], int *multi_update, int *print )
 {
-	int print_c = *print, iteration = *iter, burn_in = *burnin, count_all_g = 0;
-	int selected_edge, counter, selected_edge_i, selected_edge_j, size_sample_graph = *size_sample_g;
-	int ip, i, j, ij, dim = *p, pxp = dim * dim, p1 = dim - 1, p2 = dim - 2, p2x2 = p2 * 2;
+	int print_c = *print, multi_update_C = *multi_update, iteration = *iter, burn_in = *burnin, count_all_g = 0;
+	int counter, selected_edge_i, selected_edge_j, size_index, size_sample_graph = *size_sample_g;
+	int ip, i, j, ij, dim = *p, pxp = dim * dim;
 	int qp = dim * ( dim - 1 ) / 2;
 	bool this_one;
-	double log_alpha_ij;
 
 	string string_g;
 	vector<string> sample_graphs_C( iteration - burn_in );
 	
-	// - - - allocation for log_alpha_ij 
-	vector<double> K121( 4 ); 
-	vector<double> Kj12( p1 );              // K[j, -j]
-	vector<double> sigmaj12( p1 );          // sigma[-j, j]  
-	vector<double> sigmaj22( p1 * p1 );     // sigma[-j, -j]
-	vector<double> Kj12xK22_inv( p1 ); 
-
-	vector<double> K21( p2x2 );                          // K[-e, e]
-	vector<double> sigma21( p2x2 );                      // sigma[-e, e]
-	vector<double> sigma22( ( dim - 2 ) * ( dim - 2 ) ); // sigma[-e, -e]
-	vector<double> sigma11_inv( 4 );                     // inv( sigma[e, e] )
-	vector<double> sigma21xsigma11_inv( p2x2 ); 
-	vector<double> K12xK22_inv( p2x2 );   
+	// - - for the selected edges and their log_alpha 
+	vector<int> index_selected_edges( multi_update_C );
+	vector<double> log_alpha( multi_update_C );
 	// - - for rgwish_sigma - - - - - - - - -
 	vector<double> sigma_start( pxp ); 
 	vector<double> inv_C( pxp ); 
@@ -613,8 +598,7 @@ void gcgm_rjmcmc_map( int *iter, int *burnin, int G[], double g_prior[], double
 	for( j = 1; j < dim; j++ )
 	    for( i = 0; i < j; i++ )
 	    {
-	        ij = g_prior[ j * dim + i ];
-	        if( ( ij != 0.0 ) or ( ij != 1.0 ) )
+	        if( ( g_prior[ j * dim + i ] != 0.0 ) and ( g_prior[ j * dim + i ] != 1.0 ) )
 	        {
 	            index_row[ counter ] = i;
 	            index_col[ counter ] = j;
@@ -636,10 +620,7 @@ void gcgm_rjmcmc_map( int *iter, int *burnin, int G[], double g_prior[], double
 	int print_conter = 0;
 	for( int i_mcmc = 0; i_mcmc < iteration; i_mcmc++ )
 	{
-		if( ( i_mcmc + 1 ) % ( ( print_c * iteration ) / 100 ) == 0 ){
-		    ++print_conter;
-		    ( ( i_mcmc + 1 ) != iteration ) ? Rprintf( "%i%%->", print_c * print_conter ) : Rprintf( " done" );
-		}
+		print_progress( i_mcmc + 1, iteration, print_c, &print_conter );
 	  		
 // - - - STEP 1: copula - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -|		
 		
@@ -647,37 +628,36 @@ void gcgm_rjmcmc_map( int *iter, int *burnin, int G[], double g_prior[], double
 		get_Ts( Ds, Ts, &inv_Ds[0], &copy_Ds[0], &dim );
 		
 // - - - STEP 2: calculating log_alpha_ij - - - - - - - - - - - - - - - - - - - - - - - - - - - - -|		
-		// Randomly selecting one edge: NOTE qp = p * ( p - 1 ) / 2 
-		selected_edge   = static_cast<int>( unif_rand() * sub_qp );
-		selected_edge_i = index_row[ selected_edge ];
-		selected_edge_j = index_col[ selected_edge ];
+		// Randomly selecting a batch of edges ( one edge for multi_update = 1 ): NOTE qp = p * ( p - 1 ) / 2 
+		select_rj_edges( &index_row[0], &index_col[0], &index_selected_edges[0], &size_index, &multi_update_C, &sub_qp, &dim );
 
-// - - - STEP 2: calculating log_alpha_ij - - - - - - - - - - - - - - - - - - - - - - - - - - - - -|		
+// - - - STEP 1: calculating log_alpha_ij - - - - - - - - - - - - - - - - - - - - - - - - - - - - -|		
 
-		log_alpha_rjmcmc( &log_alpha_ij, &log_ratio_g_prior[0], &selected_edge_i, &selected_edge_j, G, Ds, 
-                      &sigma[0], &sigma21[0], &sigma22[0], &sigmaj12[0], &sigmaj22[0],    
-                      &K[0], &K21[0], &K121[0], &Kj12[0], 
-                      &K12xK22_inv[0], &Kj12xK22_inv[0], &sigma11_inv[0], &sigma21xsigma11_inv[0],  
-                      b, &dim );
+		log_alpha_rjmcmc_parallel( &log_alpha[0], &index_selected_edges[0], &size_index, &log_ratio_g_prior[0], 
+		                           G, &index_row[0], &index_col[0], Ds, &sigma[0], K, b, &dim );
 
 // - - - End of calculating log_alpha_ij - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |		
-		
-		// Selecting an edge and updating G (graph)
-		if( log( static_cast<double>( unif_rand() ) ) < log_alpha_ij )
-		{
-			ij    = selected_edge_j * dim + selected_edge_i;
-			G[ ij ] = 1 - G[ ij ];
-			G[ selected_edge_i * dim + selected_edge_j ] = G[ ij ];
-
-			if( G[ ij ] )
-			{ 
-				++size_node[ selected_edge_i ]; 
-				++size_node[ selected_edge_j ]; 
-			}else{ 
-				--size_node[ selected_edge_i ]; 
-				--size_node[ selected_edge_j ]; 
+		  		
+		// Updating G (graph) for each selected edge
+		for( int e = 0; e < size_index; e++ )
+			if( log( static_cast<double>( unif_rand() ) ) < log_alpha[ e ] )
+			{
+				selected_edge_i = index_row[ index_selected_edges[ e ] ];
+				selected_edge_j = index_col[ index_selected_edges[ e ] ];
+
+				ij    = selected_edge_j * dim + selected_edge_i;
+				G[ ij ] = 1 - G[ ij ];
+				G[ selected_edge_i * dim + selected_edge_j ] = G[ ij ];
+
+				if( G[ ij ] )
+				{ 
+					++size_node[ selected_edge_i ]; 
+					++size_node[ selected_edge_j ]; 
+				}else{ 
+					--size_node[ selected_edge_i ]; 
+					--size_node[ selected_edge_j ]; 
+				}
 			}
-		}
 
 // - - - STEP 2: Sampling from G-Wishart for new graph - - - - - - - - - - - - - - - - - - - - - - |
 		rgwish_sigma( G, &size_node[0], Ts, K, &sigma[0], b_star, &dim, threshold, &sigma_start[0], &inv_C[0], &beta_star[0], &sigma_i[0], sigma_start_N_i, sigma_N_i, N_i );		
@@ -0,0 +1,221 @@
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+//    Copyright (C) 2012 - 2022  Reza Mohammadi                                |
+//                                                                             |
+//    This file is part of BDgraph package.                                    |
+//                                                                             |
+//    BDgraph is free software: you can redistribute it and/or modify it under |
+//    the terms of the GNU General Public License as published by the Free     |
+//    Software Foundation; see <https://cran.r-project.org/web/licenses/GPL-3>.|
+//                                                                             |
+//    Maintainer: Reza Mohammadi <a.mohammadi@uva.nl>                          |
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+
+#ifndef R_NO_REMAP
+#define R_NO_REMAP
+#endif
+
+#include "matrix.h"
+#include <Rinternals.h>      // SEXP, external pointers for .Call
+#include <algorithm>
+
+#ifndef _WIN32
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// Matrix in a file which is mapped into memory ( function 'bdgraph.mmap' in R ):
+// the data of the copula and t models, which are read column by column, and the
+// latent Z and the ranks R of the copula, which are written to a new file in the
+// same way. The samplers take the address of the mapping as a usual array (see
+// 'call_C'), so only the pages they read are in memory. The new files are
+// removed at once; their space is free when the mapping is closed.
+// It is owned by an external pointer of R.
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+struct mapped_matrix
+{
+	void  *address;
+	size_t size;
+
+	mapped_matrix() : address( NULL ), size( 0 ) {}
+
+	~mapped_matrix() { close(); }
+
+	void open( const char *file, size_t size_bytes, int writable, int create )
+	{
+#ifdef _WIN32
+		Rf_error( "Memory-mapped data are not available on Windows" );
+#else
+		int fd = ::open( file, ( writable ? O_RDWR : O_RDONLY ) | ( create ? O_CREAT | O_TRUNC : 0 ), 0600 );
+		if( fd < 0 ) Rf_error( "Can not open the file '%s'", file );
+
+		struct stat info;
+		if( create )
+		{
+			if( ftruncate( fd, size_bytes ) != 0 )
+			{
+				::close( fd );
+				Rf_error( "Can not make the file '%s' of %.0f bytes", file, static_cast<double>( size_bytes ) );
+			}
+		}else if( ( fstat( fd, &info ) != 0 ) or ( static_cast<size_t>( info.st_size ) < size_bytes ) ){
+			::close( fd );
+			Rf_error( "The file '%s' has less than %.0f bytes", file, static_cast<double>( size_bytes ) );
+		}
+
+		void *map = mmap( NULL, size_bytes, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0 );
+		::close( fd );
+		if( create ) unlink( file );
+		if( map == MAP_FAILED ) Rf_error( "Can not map the file '%s' into memory", file );
+
+		// the columns are read from the first row to the last; large pages where the system has them
+		madvise( map, size_bytes, MADV_SEQUENTIAL );
+	#ifdef MADV_HUGEPAGE
+		madvise( map, size_bytes, MADV_HUGEPAGE );
+	#endif
+
+		address = map;
+		size    = size_bytes;
+#endif
+	}
+
+	void close()
+	{
+#ifndef _WIN32
+		if( address != NULL ) munmap( address, size );
+#endif
+		address = NULL;
+	}
+};
+
+static void mapped_matrix_finalizer( SEXP matrix )
+{
+	mapped_matrix *state = static_cast<mapped_matrix *>( R_ExternalPtrAddr( matrix ) );
+	if( state != NULL )
+	{
+		delete state;
+		R_ClearExternalPtr( matrix );
+	}
+}
+
+extern "C" {
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// maps 'size' bytes of the file; create = 1 for a new file, which is removed
+// at once. It returns an external pointer to the address of the mapping, which
+// 'call_C' passes to the samplers as an array
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+SEXP mapped_matrix_open( SEXP file, SEXP size, SEXP writable, SEXP create )
+{
+	mapped_matrix *state = new mapped_matrix;
+
+	// the mapping is closed when the pointer to its address ( which keeps 'owner' ) is collected
+	SEXP owner = PROTECT( R_MakeExternalPtr( state, R_NilValue, R_NilValue ) );
+	R_RegisterCFinalizerEx( owner, mapped_matrix_finalizer, TRUE );
+
+	state->open( CHAR( STRING_ELT( file, 0 ) ), static_cast<size_t>( Rf_asReal( size ) ), Rf_asInteger( writable ), Rf_asInteger( create ) );
+
+	SEXP matrix = PROTECT( R_MakeExternalPtr( state->address, R_NilValue, owner ) );
+	UNPROTECT( 2 );
+
+	return matrix;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// Starting values of the copula from the mapped data ( n x p ), as in function
+// 'get_S_n_p' in R, one column at a time:
+//    R[ , j ] = ranks of the unique values of data[ , j ] if not_cont[ j ], else 0
+//    Z[ , j ] = qnorm( rank( data[ , j ], ties = "random" ) / ( n + 1 ) ),
+//               standardized; missing values are -1000 in R and rnorm() in Z
+// not_cont[ 0 ] = -1 for not_cont[ j ] = 1 if column j has at most n / 2 values.
+// It returns S = t( Z ) %*% Z, not_cont, and gcgm_NA = 1 for missing values.
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+SEXP get_Z_R( SEXP data, SEXP Z, SEXP R, SEXP not_cont, SEXP n, SEXP p )
+{
+	const double *data_C = static_cast<double *>( R_ExternalPtrAddr( data ) );
+	double *Z_C = static_cast<double *>( R_ExternalPtrAddr( Z ) );
+	int    *R_C = static_cast<int *>( R_ExternalPtrAddr( R ) );
+	if( ( data_C == NULL ) or ( Z_C == NULL ) or ( R_C == NULL ) )
+		Rf_error( "The mapped data are not valid; they can not be saved and loaded in a new R session" );
+
+	int number = Rf_asInteger( n ), dim = Rf_asInteger( p ), gcgm_NA = 0;
+	double n_plus_1 = number + 1.0;
+
+	SEXP not_cont_out = PROTECT( Rf_duplicate( not_cont ) );
+	int *not_cont_C   = INTEGER( not_cont_out );
+	bool auto_cont    = ( not_cont_C[ 0 ] < 0 );
+
+	vector<int>    order( number );
+	vector<double> key( number );
+
+	GetRNGstate();
+	for( int j = 0; j < dim; j++ )
+	{
+		const double *x = data_C + static_cast<long>( j ) * number;
+		double *Z_j     = Z_C    + static_cast<long>( j ) * number;
+		int    *R_j     = R_C    + static_cast<long>( j ) * number;
+
+		// observed values by value, the ties in random order; missing values last
+		for( int i = 0; i < number; i++ )
+		{
+			order[ i ] = i;
+			key[ i ]   = unif_rand();
+		}
+		std::sort( order.begin(), order.end(), [x, &key]( int a, int b ) {
+			if( std::isnan( x[ a ] ) or std::isnan( x[ b ] ) ) return !std::isnan( x[ a ] ) and std::isnan( x[ b ] );
+			return ( x[ a ] < x[ b ] ) or ( ( x[ a ] == x[ b ] ) and ( key[ a ] < key[ b ] ) );
+		} );
+
+		int size_obs = 0, size_unique = 0;
+		for( int k = 0; k < number; k++ )
+		{
+			int i = order[ k ];
+			if( std::isnan( x[ i ] ) ) break;
+
+			if( ( k == 0 ) or ( x[ i ] != x[ order[ k - 1 ] ] ) ) ++size_unique;
+			R_j[ i ] = size_unique;
+			Z_j[ i ] = Rf_qnorm5( ( k + 1 ) / n_plus_1, 0.0, 1.0, TRUE, FALSE );
+			++size_obs;
+		}
+
+		for( int k = size_obs; k < number; k++ )
+		{
+			R_j[ order[ k ] ] = -1000;   // here NA values are replaced by -1000
+			Z_j[ order[ k ] ] = norm_rand();
+		}
+		if( size_obs < number ) gcgm_NA = 1;
+
+		if( auto_cont ) not_cont_C[ j ] = ( size_unique + ( size_obs < number ) > number / 2.0 ) ? 0 : 1;
+		if( not_cont_C[ j ] == 0 )
+			for( int i = 0; i < number; i++ )
+				if( R_j[ i ] != -1000 ) R_j[ i ] = 0;
+
+		double mean = 0.0, sum_sq = 0.0;
+		for( int i = 0; i < number; i++ ) mean += Z_j[ i ];
+		mean /= number;
+		for( int i = 0; i < number; i++ ) sum_sq += ( Z_j[ i ] - mean ) * ( Z_j[ i ] - mean );
+		double sd = sqrt( sum_sq / ( number - 1 ) );
+		for( int i = 0; i < number; i++ ) Z_j[ i ] = ( Z_j[ i ] - mean ) / sd;
+	}
+	PutRNGstate();
+
+	// S <- t( Z ) %*% Z
+	SEXP S = PROTECT( Rf_allocVector( REALSXP, dim * dim ) );
+	double *S_C = REAL( S ), alpha = 1.0, beta = 0.0;
+	char uplo = 'U', transT = 'T';
+	F77_NAME(dsyrk)( &uplo, &transT, &dim, &number, &alpha, Z_C, &number, &beta, S_C, &dim FCONE FCONE );
+	for( int j = 0; j < dim; j++ )
+		for( int i = 0; i < j; i++ )
+			S_C[ i * dim + j ] = S_C[ j * dim + i ];
+
+	const char *names[] = { "S", "not.cont", "gcgm_NA", "" };
+	SEXP result = PROTECT( Rf_mkNamed( VECSXP, names ) );
+	SET_VECTOR_ELT( result, 0, S );
+	SET_VECTOR_ELT( result, 1, not_cont_out );
+	SET_VECTOR_ELT( result, 2, Rf_ScalarInteger( gcgm_NA ) );
+	UNPROTECT( 3 );
+
+	return result;
+}
+
+} // End of exturn "C"
@@ -289,6 +289,7 @@ void inverse( double A[], double A_inv[], int *p )
 	
 	// LAPACK function: computes solution to A * X = B, where A is symmetric positive definite matrix
 	F77_NAME(dposv)( &uplo, &dim, &dim, A, &dim, A_inv, &dim, &info FCONE );
+	current_profile().add( run_profile::dposv_calls );
 }
     
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
@@ -346,6 +347,7 @@ void determinant( double A[], double *det_A, int *p )
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
 void select_edge( double rates[], int *index_selected_edge, double *sum_rates, int *qp )
 {
+	profile_phase timer( run_profile::select );
 	int qp_star = *qp;
 
 	// rates = sum_sort_rates
@@ -357,7 +359,7 @@ void select_edge( double rates[], int *index_selected_edge, double *sum_rates, i
 	*sum_rates = cumulative_rates[ qp_star - 1 ];
 	
 	// GetRNGstate();
-	double random_value = *sum_rates * unif_rand(); // Rf_runif( 0.0, *sum_rates );
+	double random_value = *sum_rates * unif_rand_chain(); // Rf_runif( 0.0, *sum_rates );
 	// PutRNGstate();
 
 	//int counter = 0;
@@ -424,6 +426,7 @@ void select_edge_ts( long double rates[], int *index_selected_edge, long double
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
 void select_multi_edges( double rates[], int index_selected_edges[], int *size_index, double *sum_rates, int *multi_update, int *qp )
 {
+	profile_phase timer( run_profile::select );
 	int i, qp_star = *qp, qp_star_1 = qp_star - 1;
 
 	// rates = sum_sort_rates
@@ -441,7 +444,7 @@ void select_multi_edges( double rates[], int index_selected_edges[], int *size_i
 	int position    = upper_bound / 2; // ( lower_bound + upper_bound ) / 2;
 
 	//GetRNGstate();
-	double random_value = max_bound * unif_rand();
+	double random_value = max_bound * unif_rand_chain();
 	//PutRNGstate();
 
 	while( upper_bound - lower_bound > 1 )
@@ -462,7 +465,7 @@ void select_multi_edges( double rates[], int index_selected_edges[], int *size_i
 	{
 		if( counter == *multi_update ) break;
 		
-		random_value = max_bound * unif_rand();
+		random_value = max_bound * unif_rand_chain();
 	
 		// To start, find the subscript of the middle position.
 		lower_bound = 0;
@@ -491,6 +494,40 @@ void select_multi_edges( double rates[], int index_selected_edges[], int *size_i
 	*size_index = counter;
 	*sum_rates  = max_bound;
 } 
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// Uniformly selecting a batch of edges for RJ-MCMC algorithms with no common node;
+// their acceptance ratios are computed for the same K ( not redrawn between the edges )
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+void select_rj_edges( int index_row[], int index_col[], int index_selected_edges[], int *size_index, int *multi_update, int *sub_qp, int *p )
+{
+	profile_phase timer( run_profile::select );
+	int counter = 1, selected_edge;
+
+	index_selected_edges[ 0 ] = static_cast<int>( unif_rand() * *sub_qp );
+
+	if( *multi_update > 1 )
+	{
+		vector<int> used_node( *p, 0 );
+		used_node[ index_row[ index_selected_edges[ 0 ] ] ] = 1;
+		used_node[ index_col[ index_selected_edges[ 0 ] ] ] = 1;
+
+		for( int it = 0; it < 200 * *multi_update; it++ )
+		{
+			if( counter == *multi_update ) break;
+
+			selected_edge = static_cast<int>( unif_rand() * *sub_qp );
+			
+			if( used_node[ index_row[ selected_edge ] ] or used_node[ index_col[ selected_edge ] ] ) continue;
+
+			used_node[ index_row[ selected_edge ] ] = 1;
+			used_node[ index_col[ selected_edge ] ] = 1;
+			index_selected_edges[ counter++ ] = selected_edge;
+		}
+	}
+
+	*size_index = counter;
+} 
          
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
 // Parallel Computation for birth-death rates for BD-MCMC algorithm
@@ -498,6 +535,7 @@ void select_multi_edges( double rates[], int index_selected_edges[], int *size_i
 void rates_bdmcmc_parallel( double rates[], double log_ratio_g_prior[], int G[], int index_row[], int index_col[], int *sub_qp, double Ds[], double Dsijj[],
 				            double sigma[], double K[], int *b, int *p )
 {
+	profile_phase timer( run_profile::rates );
 	int b1 = *b, one = 1, two = 2, dim = *p, p1 = dim - 1, p2 = dim - 2, dim1 = dim + 1, p2x2 = ( dim - 2 ) * 2;
 	double alpha = 1.0, beta = 0.0, alpha1 = -1.0, beta1 = 1.0;
 	char transT = 'T', transN = 'N', sideL = 'L';																	
@@ -524,6 +562,7 @@ void rates_bdmcmc_parallel( double rates[], double log_ratio_g_prior[], int G[],
 		#pragma omp for
 		for( int counter = 0; counter < *sub_qp; counter++ )
 		{
+			profile_work work;
 			i  = index_row[ counter ];
 			j  = index_col[ counter ];
 			ij = j * dim + i;
@@ -846,82 +885,198 @@ void log_H_ij( double K[], double sigma[], double *log_Hij, int *selected_edge_i
 }    
      
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
-// Parallel Computation for birth-death rates for double BD-MCMC algorithm
+// Terms of log_H_ij shared by all (i,j) of column j: 
+// sigmaj22 = sigma[-j,-j] - sigma[-j,j] %*% sigma[j,-j] / sigma[j,j] ( both triangles ),
+// Kj12 = K[j,-j], Kj12xK22_inv = sigmaj22 %*% Kj12 and K022 = Kj12xK22_inv %*% Kj12
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+static void log_H_j( double K[], double sigma[], int *selected_edge_j, double Kj12[], double Kj12xK22_inv[], 
+               double sigmaj12[], double sigmaj22[], double *K022, int *dim, int *p1 )
+{
+	int r, c, one = 1, dim_p1 = *p1;
+	double alpha = 1.0, beta = 0.0;
+	char sideL = 'L';																	
+
+	sub_matrices1( sigma, sigmaj12, sigmaj22, selected_edge_j, dim );
+
+	double sigmajj_inv = - 1.0 / sigma[ *selected_edge_j * ( *dim + 1 ) ];
+	F77_NAME(dsyr)( &sideL, p1, &sigmajj_inv, sigmaj12, &one, sigmaj22, p1 FCONE );
+	
+	// upper triangle from the lower one, since column i of sigmaj22 is read for each (i,j)
+	for( c = 1; c < dim_p1; c++ )
+		for( r = 0; r < c; r++ )
+			sigmaj22[ c * dim_p1 + r ] = sigmaj22[ r * dim_p1 + c ];
+
+	sub_row_mins( K, Kj12, selected_edge_j, dim );   // Kj12 = K[j, -j]  
+
+	F77_NAME(dsymv)( &sideL, p1, &alpha, sigmaj22, p1, Kj12, &one, &beta, Kj12xK22_inv, &one FCONE );
+	
+	*K022 = F77_NAME(ddot)( p1, Kj12xK22_inv, &one, Kj12, &one );			
+}    
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// log_H_ij from the terms of column j ( log_H_j ); same as log_H_ij. 
+// sigma[-e,-e] - sigma[-e,e] %*% sigma[e,e]^{-1} %*% sigma[e,-e] for e = (i,j) is 
+// sigmaj22[-i,-i] - sigmaj22[-i,i] %*% sigmaj22[i,-i] / sigmaj22[i,i], so with 
+// Ki12 = K[-j,i] ( Ki12[i] = 0 ) only one product with sigmaj22 is needed for (i,j)
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+static void log_H_ij_j( double K[], double *log_Hij, int *selected_edge_i, int *selected_edge_j,
+               double Kj12[], double Kj12xK22_inv[], double sigmaj22[], double *K022, 
+               double Ki12[], double Ki12xK22_inv[], int *dim, int *p1,
+               double *Dsijj, double *Dsij, double *Dsjj )
+{
+	int one = 1, i = *selected_edge_i, j = *selected_edge_j, pdim = *dim, ixdim = i * pdim;
+	double alpha = 1.0, beta = 0.0;
+	char sideL = 'L';																	
+
+	// Ki12 = K[-j, i] and Ki12[i] = 0
+	memcpy( Ki12    , K + ixdim        , sizeof( double ) * j );		
+	memcpy( Ki12 + j, K + ixdim + j + 1, sizeof( double ) * ( pdim - j - 1 ) );	
+	Ki12[ i ] = 0.0;
+
+	// Ki12xK22_inv = sigmaj22 %*% Ki12
+	F77_NAME(dsymv)( &sideL, p1, &alpha, sigmaj22, p1, Ki12, &one, &beta, Ki12xK22_inv, &one FCONE );
+
+	double sigmaj22_ii = sigmaj22[ i * *p1 + i ];
+	double Kij         = Kj12[ i ];
+	double Ki_ii       = Ki12xK22_inv[ i ];                              // sigmaj22[i,] %*% Ki12
+	double Kj_ii       = Kj12xK22_inv[ i ] - sigmaj22_ii * Kij;          // sigmaj22[i,] %*% Kj12, with Kj12[i] = 0
+
+	// For (i,j) = 0: K022 with Kj12[i] = 0
+	double K022_i = *K022 - 2.0 * Kij * Kj12xK22_inv[ i ] + Kij * Kij * sigmaj22_ii;
+
+	// For (i,j) = 1: K121 = t( K21 ) %*% K22_inv %*% K21
+	double K121_11 = F77_NAME(ddot)( p1, Ki12, &one, Ki12xK22_inv, &one ) - Ki_ii * Ki_ii / sigmaj22_ii;
+	double K121_12 = F77_NAME(ddot)( p1, Kj12, &one, Ki12xK22_inv, &one ) - Kij * Ki_ii - Ki_ii * Kj_ii / sigmaj22_ii;
+	double K121_22 = K022_i - Kj_ii * Kj_ii / sigmaj22_ii;
+
+	double a11      = K[ ixdim + i ] - K121_11;	
+	double sum_diag = *Dsjj * ( K022_i - K121_22 ) - 2.0 * *Dsij * K121_12;
+
+	*log_Hij = 0.5 * ( log( *Dsjj / a11 ) + *Dsijj * a11 - sum_diag );
+}    
+     
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// Parallel Computation for birth-death rates for double BD-MCMC algorithm.
+// The edges are split in equal blocks ( static schedule ) in the order of index_row 
+// and index_col ( column by column ); the terms of column j are computed once per 
+// block and column, for both ( K, sigma ) and ( K_dmh, sigma_dmh )
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
 void rates_bdmcmc_dmh_parallel( double rates[], double log_ratio_g_prior[], int G[], int index_row[], int index_col[], int *sub_qp, double Ds[], double D[],
 				            double sigma[], double K[], double sigma_dmh[], 
-				            double K_dmh[], int *b, int *p )
+				            double K_dmh[], int *p )
 {
-	int dim = *p, p1 = dim - 1, p2 = dim - 2, p2x2 = ( dim - 2 ) * 2;
+	profile_phase timer( run_profile::rates );
+	int dim = *p, p1 = dim - 1;
 
 	#pragma omp parallel
 	{
-		int index_rate_j, i, j, ij, jj;
-		double Dsjj, Dsij, Dsijj, Dij, Dijj, Djj, log_rate;
-
-		double *K121                = new double[ 4 ];  
-		double *Kj12                = new double[ p1 ];  
-		double *sigmaj12            = new double[ p1 ];  
-		double *sigmaj22            = new double[ p1 * p1 ];  
-		double *Kj12xK22_inv        = new double[ p1 ];  
-		double *K21                 = new double[ p2x2 ];  
-		double *sigma12             = new double[ p2x2 ];  
-		double *sigma22             = new double[ p2 * p2 ];  
-		double *sigma11_inv         = new double[ 4 ];  
-		double *sigma21xsigma11_inv = new double[ p2x2 ];  
-		double *K12xK22_inv         = new double[ p2x2 ];
-		
-		double *K12                 = new double[ p2x2 ];
+		int i, j, ij, jj, j_block = -1;
+		double Dsjj, Dsij, Dsijj, Dij, Dijj, Djj, K022, K022_dmh, log_rate, logH_ij, logI_p;
+
+		vector<double> Kj12( p1 );  
+		vector<double> Kj12xK22_inv( p1 );  
+		vector<double> sigmaj22( p1 * p1 );  
+		vector<double> Kj12_dmh( p1 );  
+		vector<double> Kj12xK22_inv_dmh( p1 );  
+		vector<double> sigmaj22_dmh( p1 * p1 );  
+		vector<double> sigmaj12( p1 );  
+		vector<double> Ki12( p1 );  
+		vector<double> Ki12xK22_inv( p1 );  
   
-		#pragma omp for
-		for( j = 1; j < dim; j++ )
-		{			
-			index_rate_j = ( j * ( j - 1 ) ) / 2;
-
-			jj   = j * dim + j;
-			Dsjj = Ds[ jj ];
-			Djj  = D[ jj ];
+		#pragma omp for schedule( static )
+		for( int counter = 0; counter < *sub_qp; counter++ )
+		{
+			profile_work work;
+			i = index_row[ counter ];
+			j = index_col[ counter ];
 
-			for( i = 0; i < j; i++ )
+			if( j != j_block )
 			{
-				ij    = j * dim + i;
-				Dsij  = Ds[ ij ];
-				Dsijj = - Dsij * Dsij / Dsjj;
-				Dij   = D[ ij ];
-				Dijj  = - Dij * Dij / Djj;
-
-				double logH_ij, logI_p;
-				
-				log_H_ij( &K[0], &sigma[0], &logH_ij, &i, &j,
-					   &Kj12[0], &Kj12xK22_inv[0], &K12[0], &K12xK22_inv[0], &K121[0], 
-					   &sigmaj12[0], &sigmaj22[0], &sigma12[0], &sigma22[0], &sigma11_inv[0], &sigma21xsigma11_inv[0],
-					   &dim, &p1, &p2, &jj,
-					   &Dsijj, &Dsij, &Dsjj );
-
-				log_H_ij( &K_dmh[0], &sigma_dmh[0], &logI_p, &i, &j,
-					   &Kj12[0], &Kj12xK22_inv[0], &K12[0], &K12xK22_inv[0], &K121[0], 
-					   &sigmaj12[0], &sigmaj22[0], &sigma12[0], &sigma22[0], &sigma11_inv[0], &sigma21xsigma11_inv[0],
-					   &dim, &p1, &p2, &jj,
-					   &Dijj, &Dij, &Djj );
-				
-				//log_rate = ( G[ ij ] ) ? ( logH_ij - logI_p ) : ( logI_p - logH_ij );				
-				log_rate = ( G[ ij ] ) ? ( logH_ij - logI_p ) - log_ratio_g_prior[ ij ] : ( logI_p - logH_ij ) + log_ratio_g_prior[ ij ];				
-				rates[ index_rate_j + i ] = ( log_rate < 0.0 ) ? exp( log_rate ) : 1.0;
+				log_H_j( K, sigma, &j, &Kj12[0], &Kj12xK22_inv[0], &sigmaj12[0], &sigmaj22[0], &K022, &dim, &p1 );
+				log_H_j( K_dmh, sigma_dmh, &j, &Kj12_dmh[0], &Kj12xK22_inv_dmh[0], &sigmaj12[0], &sigmaj22_dmh[0], &K022_dmh, &dim, &p1 );
+				j_block = j;
 			}
+
+			jj    = j * dim + j;
+			ij    = j * dim + i;
+			Dsjj  = Ds[ jj ];
+			Djj   = D[ jj ];
+			Dsij  = Ds[ ij ];
+			Dsijj = - Dsij * Dsij / Dsjj;
+			Dij   = D[ ij ];
+			Dijj  = - Dij * Dij / Djj;
+
+			log_H_ij_j( K, &logH_ij, &i, &j, &Kj12[0], &Kj12xK22_inv[0], &sigmaj22[0], &K022, 
+			            &Ki12[0], &Ki12xK22_inv[0], &dim, &p1, &Dsijj, &Dsij, &Dsjj );
+
+			log_H_ij_j( K_dmh, &logI_p, &i, &j, &Kj12_dmh[0], &Kj12xK22_inv_dmh[0], &sigmaj22_dmh[0], &K022_dmh, 
+			            &Ki12[0], &Ki12xK22_inv[0], &dim, &p1, &Dijj, &Dij, &Djj );
+			
+			//log_rate = ( G[ ij ] ) ? ( logH_ij - logI_p ) : ( logI_p - logH_ij );				
+			log_rate = ( G[ ij ] ) ? ( logH_ij - logI_p ) - log_ratio_g_prior[ ij ] : ( logI_p - logH_ij ) + log_ratio_g_prior[ ij ];				
+			rates[ counter ] = ( log_rate < 0.0 ) ? exp( log_rate ) : 1.0;
 		}	
-		
-		delete[] K121;  
-		delete[] Kj12;  
-		delete[] sigmaj12;  
-		delete[] sigmaj22;  
-		delete[] Kj12xK22_inv;  		
-		delete[] K21;  
-		delete[] sigma12;  
-		delete[] sigma22;  
-		delete[] sigma11_inv;  
-		delete[] sigma21xsigma11_inv;  
-		delete[] K12xK22_inv;  
-		delete[] K12;  
+	}
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// Parallel Computation for log of alpha of the selected edges ( select_rj_edges )
+// it is for double Metropolis-Hasting RJ-MCMC algorithms
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+void log_alpha_rjmcmc_dmh_parallel( double log_alpha[], int index_selected_edges[], int *size_index, double log_ratio_g_prior[], 
+                                    int G[], int index_row[], int index_col[], double Ds[], double D[],
+                                    double sigma[], double K[], double sigma_dmh[], double K_dmh[], int *p )
+{
+	profile_phase timer( run_profile::rates );
+	int dim = *p, p1 = dim - 1, p2 = dim - 2, p2x2 = p2 * 2;
+
+	#pragma omp parallel if( *size_index > 1 )
+	{
+		int i, j, ij, jj;
+		double Dsijj, Dsij, Dsjj, Dijj, Dij, Djj, logH_ij, logI_p;
+
+		vector<double> K121( 4 ); 
+		vector<double> Kj12( p1 );  
+		vector<double> sigmaj12( p1 );  
+		vector<double> sigmaj22( p1 * p1 );  
+		vector<double> Kj12xK22_inv( p1 ); 
+		vector<double> K12( p2x2 );
+		vector<double> sigma12( p2x2 );
+		vector<double> sigma22( p2 * p2 );
+		vector<double> sigma11_inv( 4 ); 
+		vector<double> sigma21xsigma11_inv( p2x2 ); 
+		vector<double> K12xK22_inv( p2x2 );   
+
+		#pragma omp for
+		for( int e = 0; e < *size_index; e++ )
+		{
+			profile_work work;
+			i = index_row[ index_selected_edges[ e ] ];
+			j = index_col[ index_selected_edges[ e ] ];
+
+			ij    = j * dim + i;
+			jj    = j * dim + j;
+			Dsij  = Ds[ ij ];
+			Dsjj  = Ds[ jj ];
+			Dsijj = - Dsij * Dsij / Dsjj;
+			Dij   = D[ ij ];
+			Djj   = D[ jj ];
+			Dijj  = - Dij * Dij / Djj;
+
+			log_H_ij( K, sigma, &logH_ij, &i, &j,
+				   &Kj12[0], &Kj12xK22_inv[0], &K12[0], &K12xK22_inv[0], &K121[0], 
+				   &sigmaj12[0], &sigmaj22[0], &sigma12[0], &sigma22[0], &sigma11_inv[0], &sigma21xsigma11_inv[0],
+				   &dim, &p1, &p2, &jj,
+				   &Dsijj, &Dsij, &Dsjj );
+
+			log_H_ij( K_dmh, sigma_dmh, &logI_p, &i, &j,
+				   &Kj12[0], &Kj12xK22_inv[0], &K12[0], &K12xK22_inv[0], &K121[0], 
+				   &sigmaj12[0], &sigmaj22[0], &sigma12[0], &sigma22[0], &sigma11_inv[0], &sigma21xsigma11_inv[0],
+				   &dim, &p1, &p2, &jj,
+				   &Dijj, &Dij, &Djj );
+
+			log_alpha[ e ] = ( G[ ij ] ) ? ( logH_ij - logI_p ) - log_ratio_g_prior[ ij ] : ( logI_p - logH_ij ) + log_ratio_g_prior[ ij ];
+		}
 	}
 }
      	
@@ -1107,61 +1262,152 @@ void scale_free( int *G, int *p )
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
-// To transfer the raw discreate data 
+// Hash keys of rows [ row_begin, row_end ) of data ( n_data x p ), computed column by column
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
-void transfer_data( int r_data[], int data[], int *n, int *p, int *size_unique_data )
+void hash_rows( int data[], int n_data, int p, int row_begin, int row_end, unsigned long long int key[] )
 {
-	int i, j, l, counter;
+	int i, j;
 	
-// - - tranfer each row of raw data to string - - - - - - - - - - - - - - - - - - - - - - - - - - -|
-	vector<char> char_row( *p );             
-	vector<string>all_patterns( *n );
-	string *unique_patterns = new string[ *n ];
+	for( i = row_begin; i < row_end; i++ ) key[ i ] = 0xcbf29ce484222325ULL;
 	
-	for( i = 0; i < *n; i++ )
+	for( j = 0; j < p; j++ )
 	{
-		for( j = 0; j < *p; j++ )
-			char_row[ j ] = r_data[ j * *n + i ] + '0';
-		
-		all_patterns[ i ] = string( char_row.begin(), char_row.end() );
+		int *data_j = data + j * n_data;
+		for( i = row_begin; i < row_end; i++ ) 
+			key[ i ] = ( key[ i ] ^ (unsigned int)data_j[ i ] ) * 0x100000001b3ULL;
 	}
 
-// - - find the unique string-rows - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
-	unique_patterns[0] = all_patterns[0];
-	int length_unique_patterns = 1;
-	for( i = 1; i < *n; i++ )
+	// final mixing step of MurmurHash3, to spread the keys over the hash table
+	for( i = row_begin; i < row_end; i++ )
 	{
-		counter = 0;
-		//for( j = 0; j < length_unique_patterns; j++ )
-			//( all_patterns[i] == unique_patterns[j] ) ? j = length_unique_patterns : ++counter;					
-		while( ( counter < length_unique_patterns ) and ( all_patterns[ i ] != unique_patterns[ counter ] ) )
-			++counter;
-		
-		if( counter == length_unique_patterns )
-			unique_patterns[ length_unique_patterns++ ] = all_patterns[ i ];
+		key[ i ] ^= key[ i ] >> 33;
+		key[ i ] *= 0xff51afd7ed558ccdULL;
+		key[ i ] ^= key[ i ] >> 33;
 	}
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// Compares row i of A ( n_A x p ) with row j of B ( n_B x p )
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+static inline bool equal_rows( int A[], int n_A, int i, int B[], int n_B, int j, int p )
+{
+	for( int k = 0; k < p; k++ )
+		if( A[ k * n_A + i ] != B[ k * n_B + j ] ) return false;
+		
+	return true;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// Merges the raw data r_data ( n x p ) into the unique patterns in data ( size_data x ( p + 1 ) ), 
+// in which the first size_unique_data rows are the patterns found so far and the last column
+// is their frequency. New patterns are added in the order of their first appearance.
+// Rows are hashed in parallel and each thread finds the unique patterns of its block of rows 
+// in its own hash table; the blocks are merged in order, so the result does not depend on 
+// the number of threads.
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+static void merge_unique_rows( int r_data[], int n, int p, int data[], int size_data, int *size_unique_data )
+{
+	int i, j, l, slot;
+
+	vector<unsigned long long int> key_r( n );
+	
+	int size_threads = 1;
+	#ifdef _OPENMP
+		size_threads = omp_get_max_threads();
+	#endif
+	
+	// unique patterns of each block: first row in r_data and frequency
+	vector< vector<int> > block_row( size_threads ), block_freq( size_threads );
 
-// - - tranfer the data - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -|
-	int which_one = 0;
-	for( l = 0; l < length_unique_patterns; l++ )  
+	#pragma omp parallel num_threads( size_threads )
 	{
-		counter = 0;
-		for( i = 0; i < *n; i++ )
-			if( all_patterns[ i ] == unique_patterns[ l ] ) 
+		int id = 0, n_threads = 1;
+		#ifdef _OPENMP
+			id        = omp_get_thread_num();
+			n_threads = omp_get_num_threads();
+		#endif
+		
+		int row_begin = (long)n * id / n_threads;
+		int row_end   = (long)n * ( id + 1 ) / n_threads;
+
+		hash_rows( r_data, n, p, row_begin, row_end, &key_r[0] );
+
+		int size_table = 1;
+		while( size_table < 2 * ( row_end - row_begin ) ) size_table <<= 1;
+		vector<int> hash_table( size_table, -1 );
+		
+		vector<int> &row_id  = block_row[ id ];
+		vector<int> &freq_id = block_freq[ id ];
+		
+		for( int r = row_begin; r < row_end; r++ )
+		{
+			int slot_r = key_r[ r ] & ( size_table - 1 );
+			while( ( hash_table[ slot_r ] >= 0 ) and 
+			       ( ( key_r[ row_id[ hash_table[ slot_r ] ] ] != key_r[ r ] ) or !equal_rows( r_data, n, row_id[ hash_table[ slot_r ] ], r_data, n, r, p ) ) )
+				slot_r = ( slot_r + 1 ) & ( size_table - 1 );
+				
+			if( hash_table[ slot_r ] < 0 )
 			{
-				counter++;
-				which_one = i;
+				hash_table[ slot_r ] = row_id.size();
+				row_id.push_back( r );
+				freq_id.push_back( 0 );
 			}
 			
-		data[ *p * *n + l ] = counter;
-		
-		for( j = 0; j < *p; j++ )
-			data[ j * *n + l ] = r_data[ j * *n + which_one ]; 
+			freq_id[ hash_table[ slot_r ] ]++;
+		}
 	}
+
+// - - merging the blocks into the patterns found so far - - - - - - - - - - - - - - - - - - - - -|
+	int size_unique = *size_unique_data, size_new = 0;
+	for( int id = 0; id < size_threads; id++ ) size_new += block_row[ id ].size();
 	
-	*size_unique_data = length_unique_patterns;
+	vector<unsigned long long int> key_data( size_unique + size_new );
+	if( size_unique > 0 ) hash_rows( data, size_data, p, 0, size_unique, &key_data[0] );
+	
+	int size_table = 1;
+	while( size_table < 2 * ( size_unique + size_new ) ) size_table <<= 1;
+	vector<int> hash_table( size_table, -1 );
+
+	for( l = 0; l < size_unique; l++ )
+	{
+		slot = key_data[ l ] & ( size_table - 1 );
+		while( hash_table[ slot ] >= 0 ) slot = ( slot + 1 ) & ( size_table - 1 );
+		hash_table[ slot ] = l;
+	}
+	
+	for( int id = 0; id < size_threads; id++ )
+		for( int b = 0; b < (int)block_row[ id ].size(); b++ )
+		{
+			i    = block_row[ id ][ b ];
+			slot = key_r[ i ] & ( size_table - 1 );
+			while( ( hash_table[ slot ] >= 0 ) and 
+			       ( ( key_data[ hash_table[ slot ] ] != key_r[ i ] ) or !equal_rows( data, size_data, hash_table[ slot ], r_data, n, i, p ) ) )
+				slot = ( slot + 1 ) & ( size_table - 1 );
+
+			if( hash_table[ slot ] < 0 )
+			{
+				l = size_unique++;
+				hash_table[ slot ]        = l;
+				key_data[ l ]             = key_r[ i ];
+				data[ p * size_data + l ] = 0;
+				for( j = 0; j < p; j++ ) data[ j * size_data + l ] = r_data[ j * n + i ];
+			}
+			
+			data[ p * size_data + hash_table[ slot ] ] += block_freq[ id ][ b ];
+		}
+		
+	*size_unique_data = size_unique;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// To transfer the raw discreate data: unique rows of r_data ( n x p ) and their 
+// frequencies, in the first size_unique_data rows of data ( n x ( p + 1 ) )
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+void transfer_data( int r_data[], int data[], int *n, int *p, int *size_unique_data )
+{
+	*size_unique_data = 0;
 	
-	delete[] unique_patterns;
+	if( *n > 0 ) merge_unique_rows( r_data, *n, *p, data, *n, size_unique_data );
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
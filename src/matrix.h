@@ -14,6 +14,8 @@
 #define matrix_H
 
 #include "util.h"
+#include "chain_rng.h"
+#include "run_profile.h"
 
 extern "C" {
 	void sub_matrix( double A[], double sub_A[], int sub[], int *p_sub, int *p  );
@@ -46,6 +48,8 @@ extern "C" {
 
 	void select_multi_edges( double rates[], int index_selected_edges[], int *size_index, double *sum_rates, int *multi_update, int *qp );
 
+	void select_rj_edges( int index_row[], int index_col[], int index_selected_edges[], int *size_index, int *multi_update, int *sub_qp, int *p );
+
 	void rates_bdmcmc_parallel( double rates[], double log_ratio_g_prior[], int G[], int index_row[], int index_col[], int *sub_qp, double Ds[], double Dsijj[],
 					            double sigma[], double K[], int *b, int *p );
 
@@ -60,7 +64,11 @@ extern "C" {
 
 	void rates_bdmcmc_dmh_parallel( double rates[], double log_ratio_g_prior[], int G[], int index_row[], int index_col[], int *sub_qp, double Ds[], double D[],
 								double sigma[], double K[], double sigma_dmh[], 
-								double K_dmh[], int *b, int *p );
+								double K_dmh[], int *p );
+
+	void log_alpha_rjmcmc_dmh_parallel( double log_alpha[], int index_selected_edges[], int *size_index, double log_ratio_g_prior[], 
+								int G[], int index_row[], int index_col[], double Ds[], double D[],
+								double sigma[], double K[], double sigma_dmh[], double K_dmh[], int *p );
 				            
 // - - - - - - - NEW for Lang codes - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -|
 	// For Hermitian matrix
@@ -78,6 +86,8 @@ extern "C" {
 	void scale_free( int *G, int *p );
 	
 	void transfer_data( int r_data[], int data[], int *n, int *p, int *size_unique_data );
+
+	void hash_rows( int data[], int n_data, int p, int row_begin, int row_end, unsigned long long int key[] );
 }
 
 #endif
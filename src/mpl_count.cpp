@@ -0,0 +1,529 @@
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+//     Copyright (C) 2012 - 2022  Reza Mohammadi                                                   |
+//                                                                                                 |
+//     This file is part of BDgraph package.                                                       |
+//                                                                                                 |
+//     BDgraph is free software: you can redistribute it and/or modify it under                    |
+//     the terms of the GNU General Public License as published by the Free                        |
+//     Software Foundation; see <https://cran.r-project.org/web/licenses/GPL-3>.                   |
+//                                                                                                 |
+//     Maintainer: Reza Mohammadi <a.mohammadi@uva.nl>                                             |
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+
+#include "mpl_count.h"
+
+// final mixing step of MurmurHash3, to spread the MB keys over the hash table
+static inline unsigned long long int mix_key( unsigned long long int key )
+{
+	key ^= key >> 33;
+	key *= 0xff51afd7ed558ccdULL;
+	key ^= key >> 33;
+	key *= 0xc4ceb9fe1a85ec53ULL;
+	key ^= key >> 33;
+
+	return key;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// Keys of the MB configurations for rows [ row_begin, row_end ): data_mb = data[ , mb_node ] %*% cumprod_mb,
+// computed column by column. Range of MB node is max_range_nodes[ mb ] + 1, or 2 for binary data
+// ( max_range_nodes = NULL ). Returns false if the code does not fit in 64 bits and the keys are hashed.
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+static bool get_mb_key( int mb_node[], int size_node, int data[], int lf, int max_range_nodes[],
+                int row_begin, int row_end, unsigned long long int data_mb[], unsigned long long int *radix )
+{
+	bool exact_key = true;
+	unsigned long long int range_mb;
+
+	*radix = 1;
+	for( int i = row_begin; i < row_end; i++ ) data_mb[ i ] = 0;
+	
+	for( int j = 0; j < size_node; j++ )
+	{
+		int *data_mb_j = data + mb_node[ j ] * lf;
+		range_mb = ( max_range_nodes == NULL ) ? 2 : max_range_nodes[ mb_node[ j ] ] + 1;
+
+		if( exact_key && ( *radix <= ULLONG_MAX / range_mb ) )
+		{
+			for( int i = row_begin; i < row_end; i++ ) data_mb[ i ] += *radix * data_mb_j[ i ];
+			*radix *= range_mb;
+		}else{
+			// keep hashing, and compare rows on a match
+			exact_key = false;
+			for( int i = row_begin; i < row_end; i++ ) data_mb[ i ] = ( data_mb[ i ] ^ (unsigned long long int)data_mb_j[ i ] ) * 0x100000001b3ULL;
+		}
+	}
+
+	return exact_key;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// Empty hash table for up to size_rows MB configurations. Small exact codes index the table 
+// directly, otherwise it is a power of two with load factor <= 1/2. Returns the mask for probing.
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+static unsigned long long int init_hash_table( int size_rows, int size_range, bool direct, unsigned long long int radix, mpl_count_buffer &buffer )
+{
+	int size_table = 1;
+	if( direct )
+		size_table = radix;
+	else
+		while( size_table < 2 * size_rows ) size_table <<= 1;
+
+	if( (int)buffer.mb_conf.size() < size_rows )
+	{
+		buffer.mb_conf.resize( size_rows );
+		buffer.mb_conf_row.resize( size_rows );
+		buffer.mb_conf_count.resize( size_rows );
+	}
+	if( (int)buffer.fam_conf_count.size() < size_rows * size_range ) buffer.fam_conf_count.resize( size_rows * size_range );
+	if( (int)buffer.hash_table.size() < size_table ) buffer.hash_table.resize( size_table );
+
+	memset( &buffer.hash_table[0], 0, sizeof( int ) * size_table );
+
+	return size_table - 1;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// Index of the MB configuration with the given key ( and first row ) in the hash table,
+// adding it with zero counts if it is new
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+static inline int find_mb_conf( unsigned long long int key, int row, int mb_node[], int size_node, int data[], int lf,
+                bool exact_key, bool direct, unsigned long long int mask, int size_range, 
+                mpl_count_buffer &buffer, int *size_mb_conf )
+{
+	unsigned long long int slot = ( direct ) ? key : mix_key( key ) & mask;
+
+	while( true )
+	{
+		int l = buffer.hash_table[ slot ] - 1;
+		if( l < 0 )
+		{
+			l = ( *size_mb_conf )++;
+			buffer.mb_conf[ l ]       = key;
+			buffer.mb_conf_row[ l ]   = row;
+			buffer.mb_conf_count[ l ] = 0;
+			memset( &buffer.fam_conf_count[ l * size_range ], 0, sizeof( int ) * size_range );
+			buffer.hash_table[ slot ] = l + 1;
+			return l;
+		}
+
+		if( buffer.mb_conf[ l ] == key )
+		{
+			if( exact_key ) return l;
+
+			int j, first_row = buffer.mb_conf_row[ l ];
+			for( j = 0; j < size_node; j++ )
+				if( data[ mb_node[ j ] * lf + row ] != data[ mb_node[ j ] * lf + first_row ] ) break;
+
+			if( j == size_node ) return l;
+		}
+
+		slot = ( slot + 1 ) & mask;
+	}
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// Counting rows [ row_begin, row_end ) into the hash table of buffer
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+static void count_rows( int node, int mb_node[], int size_node, int data[], int freq_data[], int lf, 
+                int row_begin, int row_end, unsigned long long int data_mb[], bool exact_key, bool direct, 
+                unsigned long long int mask, int size_range, mpl_count_buffer &buffer, int *size_mb_conf )
+{
+	int *data_node = data + node * lf;
+	
+	for( int i = row_begin; i < row_end; i++ )
+	{
+		int l = find_mb_conf( data_mb[ i ], i, mb_node, size_node, data, lf, exact_key, direct, mask, size_range, buffer, size_mb_conf );
+
+		buffer.mb_conf_count[ l ] += freq_data[ i ];
+		buffer.fam_conf_count[ l * size_range + data_node[ i ] ] += freq_data[ i ];
+	}
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// Keys of the MB configurations for rows [ row_begin, row_end ) from the bit-sliced data; 
+// bit j of the key is the value of mb_node[ j ]. row_begin must be a multiple of 64.
+// Returns false if size_node > 64 and the keys are hashed.
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+static bool get_mb_key_bit( int mb_node[], int size_node, mpl_bit_data &bit_data,
+                int row_begin, int row_end, unsigned long long int data_mb[] )
+{
+	int size_bit = sizeof( unsigned long long int ) * CHAR_BIT;
+	bool exact_key = ( size_node <= size_bit );
+	
+	for( int i = row_begin; i < row_end; i++ ) data_mb[ i ] = 0;
+
+	for( int j = 0; j < size_node; j++ )
+	{
+		unsigned long long int *data_bit_j = &bit_data.data_bit[ mb_node[ j ] * bit_data.size_word ];
+		
+		for( int i = row_begin; i < row_end; i += size_bit )
+		{
+			unsigned long long int word = data_bit_j[ i / size_bit ];
+			int size_rows = ( row_end - i < size_bit ) ? row_end - i : size_bit;
+			unsigned long long int *data_mb_i = data_mb + i;
+
+			if( j < size_bit )
+			{
+				for( int r = 0; r < size_rows; r++ ) data_mb_i[ r ] |= ( ( word >> r ) & 1ULL ) << j;
+			}else{
+				for( int r = 0; r < size_rows; r++ ) data_mb_i[ r ] = ( data_mb_i[ r ] ^ ( ( word >> r ) & 1ULL ) ) * 0x100000001b3ULL;
+			}
+		}
+	}
+
+	return exact_key;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// Counting rows [ row_begin, row_end ) of the bit-sliced data into the hash table of buffer
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+static void count_rows_bit( int node, int mb_node[], int size_node, mpl_bit_data &bit_data,
+                int row_begin, int row_end, unsigned long long int data_mb[], bool exact_key, bool direct, 
+                unsigned long long int mask, mpl_count_buffer &buffer, int *size_mb_conf )
+{
+	int size_bit = sizeof( unsigned long long int ) * CHAR_BIT;
+	unsigned long long int *data_bit_node = &bit_data.data_bit[ node * bit_data.size_word ];
+	
+	for( int i = row_begin; i < row_end; i++ )
+	{
+		int l = find_mb_conf( data_mb[ i ], i, mb_node, size_node, bit_data.data, bit_data.length_freq_data, exact_key, direct, mask, 2, buffer, size_mb_conf );
+		int state = ( data_bit_node[ i / size_bit ] >> ( i % size_bit ) ) & 1ULL;
+
+		buffer.mb_conf_count[ l ] += bit_data.freq_data[ i ];
+		buffer.fam_conf_count[ 2 * l + state ] += bit_data.freq_data[ i ];
+	}
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// Contingency table for MBs of size 0, 1, 2 with AND + popcount: for each subset T of 
+// { node, mb_node } the weighted count of rows with all variables in T equal to 1 is a sum of 
+// popcounts over the bit planes of freq_data; the counts of the cells follow by inclusion-exclusion.
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+static void fam_conf_count_popcount( int node, int mb_node[], int size_node, mpl_bit_data &bit_data,
+                int *size_mb_conf, mpl_count_buffer &buffer )
+{
+	int size_var = size_node + 1, size_subset = 1 << size_var;
+	int w, b, T, x, size_word = bit_data.size_word;
+	
+	unsigned long long int *data_bit_var[ 3 ];
+	data_bit_var[ 0 ] = &bit_data.data_bit[ node * size_word ];
+	for( int j = 0; j < size_node; j++ ) data_bit_var[ j + 1 ] = &bit_data.data_bit[ mb_node[ j ] * size_word ];
+	
+	long long int count_subset[ 8 ] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+	unsigned long long int and_subset[ 8 ];
+	
+	for( w = 0; w < size_word; w++ )
+	{
+		and_subset[ 0 ] = ~0ULL;   // rows beyond length_freq_data have zero weight
+		for( T = 1; T < size_subset; T++ )
+		{
+			int v = 0;
+			while( !( ( T >> v ) & 1 ) ) v++;
+			and_subset[ T ] = and_subset[ T & ( T - 1 ) ] & data_bit_var[ v ][ w ];
+		}
+
+		for( b = 0; b < bit_data.size_plane; b++ )
+		{
+			unsigned long long int freq_bit_w = bit_data.freq_bit[ b * size_word + w ];
+			for( T = 0; T < size_subset; T++ )
+				count_subset[ T ] += (long long int)__builtin_popcountll( and_subset[ T ] & freq_bit_w ) << b;
+		}
+	}
+
+	if( (int)buffer.mb_conf_count.size() < 4 )
+	{
+		buffer.mb_conf_count.resize( 4 );
+		buffer.fam_conf_count.resize( 8 );
+	}
+
+	// n_ijl for the cell x ( bit 0: state of node, bits 1,2: MB configuration )
+	*size_mb_conf = 0;
+	for( int conf = 0; conf < ( 1 << size_node ); conf++ )
+	{
+		int count_cell[ 2 ];
+		for( int state = 0; state < 2; state++ )
+		{
+			x = ( conf << 1 ) | state;
+			long long int count_x = 0;
+			for( T = x; T < size_subset; T = ( T + 1 ) | x )
+				count_x += ( __builtin_popcount( T ^ x ) & 1 ) ? -count_subset[ T ] : count_subset[ T ];
+
+			count_cell[ state ] = count_x;
+		}
+
+		if( count_cell[ 0 ] + count_cell[ 1 ] > 0 )
+		{
+			int l = ( *size_mb_conf )++;
+			buffer.fam_conf_count[ 2 * l ]     = count_cell[ 0 ];
+			buffer.fam_conf_count[ 2 * l + 1 ] = count_cell[ 1 ];
+			buffer.mb_conf_count[ l ]          = count_cell[ 0 ] + count_cell[ 1 ];
+		}
+	}
+}
+
+extern "C" {
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// Counting the ( MB configuration x node state ) contingency table for discrete data in one pass
+// over the data. Each row gets a key for its MB configuration (mixed-radix code of the MB values,
+// or a hash of it if the code does not fit in 64 bits) and the keys are collected in an
+// open-addressing hash table. Only observed MB configurations are reported, in size_mb_conf.
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+void fam_conf_count_dis( int *node, int mb_node[], int *size_node, int data[], int freq_data[],
+                int *length_freq_data, int max_range_nodes[], int *size_range_node,
+                int *size_mb_conf, mpl_count_buffer &buffer )
+{
+	int lf = *length_freq_data;
+	unsigned long long int radix;
+
+	if( (int)buffer.data_mb.size() < lf ) buffer.data_mb.resize( lf );
+	
+	bool exact_key = get_mb_key( mb_node, *size_node, data, lf, max_range_nodes, 0, lf, &buffer.data_mb[0], &radix );
+	bool direct    = exact_key && ( radix <= (unsigned long long int)( 2 * lf ) );
+	unsigned long long int mask = init_hash_table( lf, *size_range_node, direct, radix, buffer );
+
+	*size_mb_conf = 0;
+	count_rows( *node, mb_node, *size_node, data, freq_data, lf, 0, lf, &buffer.data_mb[0], exact_key, direct, mask, *size_range_node, buffer, size_mb_conf );
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// Counting the ( MB configuration x node state ) contingency table for binary data; 
+// the MB configuration of each row is packed in bits.
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+void fam_conf_count_binary( int *node, int mb_node[], int *size_node, int data[], int freq_data[],
+                int *length_freq_data, int *size_mb_conf, mpl_count_buffer &buffer )
+{
+	int size_range = 2;
+	
+	fam_conf_count_dis( node, mb_node, size_node, data, freq_data, length_freq_data, NULL, &size_range, size_mb_conf, buffer );
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// Parallel version of fam_conf_count_binary: each thread counts its block of rows in its own 
+// hash table ( thread_buffer ), then the tables are merged into buffer.
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+void fam_conf_count_binary_parallel( int *node, int mb_node[], int *size_node, int data[], int freq_data[],
+                int *length_freq_data, int *size_mb_conf, mpl_count_buffer &buffer, 
+                vector<mpl_count_buffer> &thread_buffer )
+{
+	int lf = *length_freq_data, size_range = 2;
+	unsigned long long int radix = 1;
+	bool exact_key = true;
+
+	if( (int)buffer.data_mb.size() < lf ) buffer.data_mb.resize( lf );
+	unsigned long long int *data_mb = &buffer.data_mb[0];
+
+	int size_threads = 1;
+	#ifdef _OPENMP
+		size_threads = omp_get_max_threads();
+	#endif
+	if( (int)thread_buffer.size() < size_threads ) thread_buffer.resize( size_threads );
+	vector<int> size_thread_conf( size_threads, 0 );
+
+	#pragma omp parallel num_threads( size_threads )
+	{
+		int id = 0, n_threads = 1;
+		#ifdef _OPENMP
+			id        = omp_get_thread_num();
+			n_threads = omp_get_num_threads();
+		#endif
+		
+		int row_begin = (long)lf * id / n_threads;
+		int row_end   = (long)lf * ( id + 1 ) / n_threads;
+		unsigned long long int radix_id;
+		
+		bool exact_key_id = get_mb_key( mb_node, *size_node, data, lf, NULL, row_begin, row_end, data_mb, &radix_id );
+		bool direct       = exact_key_id && ( radix_id <= (unsigned long long int)( 2 * ( row_end - row_begin ) ) );
+		unsigned long long int mask = init_hash_table( row_end - row_begin, size_range, direct, radix_id, thread_buffer[ id ] );
+		
+		count_rows( *node, mb_node, *size_node, data, freq_data, lf, row_begin, row_end, data_mb, exact_key_id, direct, mask, size_range, thread_buffer[ id ], &size_thread_conf[ id ] );
+		
+		if( id == 0 )
+		{
+			exact_key = exact_key_id;
+			radix     = radix_id;
+		}
+	}
+
+	// merging the tables of the threads
+	bool direct = exact_key && ( radix <= (unsigned long long int)( 2 * lf ) );
+	unsigned long long int mask = init_hash_table( lf, size_range, direct, radix, buffer );
+
+	*size_mb_conf = 0;
+	for( int id = 0; id < size_threads; id++ )
+	{
+		mpl_count_buffer &buffer_id = thread_buffer[ id ];
+		
+		for( int l_id = 0; l_id < size_thread_conf[ id ]; l_id++ )
+		{
+			int l = find_mb_conf( buffer_id.mb_conf[ l_id ], buffer_id.mb_conf_row[ l_id ], mb_node, *size_node, data, lf, exact_key, direct, mask, size_range, buffer, size_mb_conf );
+
+			buffer.mb_conf_count[ l ]          += buffer_id.mb_conf_count[ l_id ];
+			buffer.fam_conf_count[ 2 * l ]     += buffer_id.fam_conf_count[ 2 * l_id ];
+			buffer.fam_conf_count[ 2 * l + 1 ] += buffer_id.fam_conf_count[ 2 * l_id + 1 ];
+		}
+	}
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// Bit-sliced column store of binary data for the discrete MPL scores
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+void get_mpl_bit_data( int data[], int freq_data[], int *length_freq_data, int *p, mpl_bit_data &bit_data )
+{
+	int size_bit = sizeof( unsigned long long int ) * CHAR_BIT;
+	int i, lf = *length_freq_data, size_word = ( lf + size_bit - 1 ) / size_bit;
+	
+	int max_freq = 0;
+	for( i = 0; i < lf; i++ ) 
+		if( freq_data[ i ] > max_freq ) max_freq = freq_data[ i ];
+
+	int size_plane = 0;
+	while( ( max_freq >> size_plane ) > 0 ) size_plane++;
+
+	bit_data.length_freq_data = lf;
+	bit_data.size_word        = size_word;
+	bit_data.size_plane       = size_plane;
+	bit_data.data             = data;
+	bit_data.freq_data        = freq_data;
+	bit_data.data_bit.assign( *p * size_word, 0 );
+	bit_data.freq_bit.assign( size_plane * size_word, 0 );
+
+	for( int node = 0; node < *p; node++ )
+	{
+		int *data_node = data + node * lf;
+		unsigned long long int *data_bit_node = &bit_data.data_bit[ node * size_word ];
+
+		for( i = 0; i < lf; i++ )
+			if( data_node[ i ] ) data_bit_node[ i / size_bit ] |= 1ULL << ( i % size_bit );
+	}
+
+	for( int b = 0; b < size_plane; b++ )
+		for( i = 0; i < lf; i++ )
+			if( ( freq_data[ i ] >> b ) & 1 ) bit_data.freq_bit[ b * size_word + i / size_bit ] |= 1ULL << ( i % size_bit );
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// Counting the ( MB configuration x node state ) contingency table from the bit-sliced data:
+// AND + popcount for MBs of size 0, 1, 2, and hash table on the bit-packed keys otherwise
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+void fam_conf_count_bit( int *node, int mb_node[], int *size_node, mpl_bit_data &bit_data,
+                int *size_mb_conf, mpl_count_buffer &buffer )
+{
+	if( *size_node < 3 )
+	{
+		fam_conf_count_popcount( *node, mb_node, *size_node, bit_data, size_mb_conf, buffer );
+		return;
+	}
+	
+	int lf = bit_data.length_freq_data;
+	if( (int)buffer.data_mb.size() < lf ) buffer.data_mb.resize( lf );
+
+	bool exact_key = get_mb_key_bit( mb_node, *size_node, bit_data, 0, lf, &buffer.data_mb[0] );
+	bool direct    = exact_key && ( *size_node < 31 ) && ( ( 1 << *size_node ) <= 2 * lf );
+	unsigned long long int mask = init_hash_table( lf, 2, direct, 1ULL << ( direct ? *size_node : 0 ), buffer );
+
+	*size_mb_conf = 0;
+	count_rows_bit( *node, mb_node, *size_node, bit_data, 0, lf, &buffer.data_mb[0], exact_key, direct, mask, buffer, size_mb_conf );
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// Parallel version of fam_conf_count_bit: for large MBs each thread counts a block of words in 
+// its own hash table ( thread_buffer ), then the tables are merged into buffer.
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+void fam_conf_count_bit_parallel( int *node, int mb_node[], int *size_node, mpl_bit_data &bit_data,
+                int *size_mb_conf, mpl_count_buffer &buffer, vector<mpl_count_buffer> &thread_buffer )
+{
+	if( *size_node < 3 )
+	{
+		fam_conf_count_popcount( *node, mb_node, *size_node, bit_data, size_mb_conf, buffer );
+		return;
+	}
+
+	int size_bit = sizeof( unsigned long long int ) * CHAR_BIT;
+	int lf = bit_data.length_freq_data, size_word = bit_data.size_word;
+	bool exact_key = ( *size_node <= size_bit );
+	
+	if( (int)buffer.data_mb.size() < lf ) buffer.data_mb.resize( lf );
+	unsigned long long int *data_mb = &buffer.data_mb[0];
+
+	int size_threads = 1;
+	#ifdef _OPENMP
+		size_threads = omp_get_max_threads();
+	#endif
+	if( (int)thread_buffer.size() < size_threads ) thread_buffer.resize( size_threads );
+	vector<int> size_thread_conf( size_threads, 0 );
+
+	#pragma omp parallel num_threads( size_threads )
+	{
+		int id = 0, n_threads = 1;
+		#ifdef _OPENMP
+			id        = omp_get_thread_num();
+			n_threads = omp_get_num_threads();
+		#endif
+		
+		// blocks of whole words, so the threads never share a word of data_bit
+		int row_begin = ( (long)size_word * id / n_threads ) * size_bit;
+		int row_end   = ( (long)size_word * ( id + 1 ) / n_threads ) * size_bit;
+		if( row_end > lf ) row_end = lf;
+		if( row_begin > row_end ) row_begin = row_end;
+		
+		get_mb_key_bit( mb_node, *size_node, bit_data, row_begin, row_end, data_mb );
+		bool direct = exact_key && ( *size_node < 31 ) && ( ( 1 << *size_node ) <= 2 * ( row_end - row_begin ) );
+		unsigned long long int mask = init_hash_table( row_end - row_begin, 2, direct, 1ULL << ( direct ? *size_node : 0 ), thread_buffer[ id ] );
+		
+		count_rows_bit( *node, mb_node, *size_node, bit_data, row_begin, row_end, data_mb, exact_key, direct, mask, thread_buffer[ id ], &size_thread_conf[ id ] );
+	}
+
+	// merging the tables of the threads
+	bool direct = exact_key && ( *size_node < 31 ) && ( ( 1 << *size_node ) <= 2 * lf );
+	unsigned long long int mask = init_hash_table( lf, 2, direct, 1ULL << ( direct ? *size_node : 0 ), buffer );
+
+	*size_mb_conf = 0;
+	for( int id = 0; id < size_threads; id++ )
+	{
+		mpl_count_buffer &buffer_id = thread_buffer[ id ];
+		
+		for( int l_id = 0; l_id < size_thread_conf[ id ]; l_id++ )
+		{
+			int l = find_mb_conf( buffer_id.mb_conf[ l_id ], buffer_id.mb_conf_row[ l_id ], mb_node, *size_node, bit_data.data, lf, exact_key, direct, mask, 2, buffer, size_mb_conf );
+
+			buffer.mb_conf_count[ l ]          += buffer_id.mb_conf_count[ l_id ];
+			buffer.fam_conf_count[ 2 * l ]     += buffer_id.fam_conf_count[ 2 * l_id ];
+			buffer.fam_conf_count[ 2 * l + 1 ] += buffer_id.fam_conf_count[ 2 * l_id + 1 ];
+		}
+	}
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// Tables of lgamma( k + alpha_ijl ) and lgamma( k + r * alpha_ijl ) for k = 0, ..., n and for the 
+// number of states r of each node ( size_range_nodes = NULL for binary data )
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+void get_mpl_lgamma_table( int *n, double *alpha_ijl, int size_range_nodes[], int *p, mpl_lgamma_table &lgamma_table )
+{
+	int k, size_table = *n + 1, max_range = 2;
+	
+	if( size_range_nodes != NULL )
+		for( int i = 0; i < *p; i++ ) 
+			if( size_range_nodes[ i ] > max_range ) max_range = size_range_nodes[ i ];
+		
+	lgamma_table.lgamma_ijl.resize( size_table );
+	lgamma_table.lgamma_jl.assign( max_range + 1, vector<double>() );
+	
+	if( size_range_nodes == NULL )
+		lgamma_table.lgamma_jl[ 2 ].resize( size_table );
+	else
+		for( int i = 0; i < *p; i++ ) 
+			lgamma_table.lgamma_jl[ size_range_nodes[ i ] ].resize( size_table );
+
+	#pragma omp parallel for
+	for( k = 0; k < size_table; k++ )
+	{
+		lgamma_table.lgamma_ijl[ k ] = lgammafn_sign( k + *alpha_ijl, NULL );
+		
+		for( int r = 0; r <= max_range; r++ )
+			if( !lgamma_table.lgamma_jl[ r ].empty() ) 
+				lgamma_table.lgamma_jl[ r ][ k ] = lgammafn_sign( k + r * *alpha_ijl, NULL );
+	}
+}
+
+} // End of exturn "C"
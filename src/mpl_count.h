@@ -0,0 +1,89 @@
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+//     Copyright (C) 2012 - 2022  Reza Mohammadi                                                   |
+//                                                                                                 |
+//     This file is part of BDgraph package.                                                       |
+//                                                                                                 |
+//     BDgraph is free software: you can redistribute it and/or modify it under                    |
+//     the terms of the GNU General Public License as published by the Free                        |
+//     Software Foundation; see <https://cran.r-project.org/web/licenses/GPL-3>.                   |
+//                                                                                                 |
+//     Maintainer: Reza Mohammadi <a.mohammadi@uva.nl>                                             |
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+
+#ifndef mpl_count_H
+#define mpl_count_H
+
+#include "matrix.h"
+
+// Work space for counting the ( MB configuration x node state ) contingency table.
+// The vectors only grow, so one buffer per thread can be reused for all scores of a run.
+struct mpl_count_buffer
+{
+	vector<unsigned long long int> data_mb;   // key of the MB configuration of each row of data
+	vector<unsigned long long int> mb_conf;   // key of each distinct MB configuration
+	vector<int> mb_conf_row;                  // first row of data with each MB configuration
+	vector<int> hash_table;                   // open-addressing table: slot -> MB configuration + 1
+	vector<int> mb_conf_count;                // n_jl
+	vector<int> fam_conf_count;               // n_ijl, stored as fam_conf_count[ l * size_range_node + state ]
+};
+
+// Bit-sliced copy of binary data: each variable is a bitset over the unique rows, and freq_data 
+// is split in bit planes, so weighted counts are sums of popcounts
+struct mpl_bit_data
+{
+	int length_freq_data;                     // number of unique rows
+	int size_word;                            // 64-bit words per variable
+	int size_plane;                           // bit planes of freq_data
+	int *data;                                // original data, to compare rows with hashed keys
+	int *freq_data;
+	vector<unsigned long long int> data_bit;  // data_bit[ node * size_word + w ]
+	vector<unsigned long long int> freq_bit;  // freq_bit[ b * size_word + w ]: bit b of freq_data
+};
+
+// Run-scoped tables of lgamma( k + alpha ) for the integer counts k = 0, ..., n of the MPL scores;
+// built once before sampling and only read by the threads
+struct mpl_lgamma_table
+{
+	vector<double> lgamma_ijl;                // lgamma( k + alpha_ijl )
+	vector< vector<double> > lgamma_jl;       // lgamma_jl[ r ][ k ] = lgamma( k + r * alpha_ijl ), for the ranges r in data
+};
+
+// lgamma( count + alpha_ijl ); counts outside the table ( or an empty table ) are computed directly
+static inline double lgamma_fam_conf( mpl_lgamma_table &lgamma_table, int count, double alpha_ijl )
+{
+	return ( count < (int)lgamma_table.lgamma_ijl.size() ) ? lgamma_table.lgamma_ijl[ count ] : lgammafn_sign( count + alpha_ijl, NULL );
+}
+
+// lgamma( count + alpha_jl ), with alpha_jl = size_range * alpha_ijl
+static inline double lgamma_mb_conf( mpl_lgamma_table &lgamma_table, int count, int size_range, double alpha_jl )
+{
+	if( ( size_range < (int)lgamma_table.lgamma_jl.size() ) and ( count < (int)lgamma_table.lgamma_jl[ size_range ].size() ) )
+		return lgamma_table.lgamma_jl[ size_range ][ count ];
+	else
+		return lgammafn_sign( count + alpha_jl, NULL );
+}
+
+extern "C" {
+	void fam_conf_count_dis( int *node, int mb_node[], int *size_node, int data[], int freq_data[],
+	                int *length_freq_data, int max_range_nodes[], int *size_range_node,
+	                int *size_mb_conf, mpl_count_buffer &buffer );
+
+	void fam_conf_count_binary( int *node, int mb_node[], int *size_node, int data[], int freq_data[],
+	                int *length_freq_data, int *size_mb_conf, mpl_count_buffer &buffer );
+
+	void fam_conf_count_binary_parallel( int *node, int mb_node[], int *size_node, int data[], int freq_data[],
+	                int *length_freq_data, int *size_mb_conf, mpl_count_buffer &buffer, 
+	                vector<mpl_count_buffer> &thread_buffer );
+
+	void get_mpl_bit_data( int data[], int freq_data[], int *length_freq_data, int *p, mpl_bit_data &bit_data );
+
+	void fam_conf_count_bit( int *node, int mb_node[], int *size_node, mpl_bit_data &bit_data,
+	                int *size_mb_conf, mpl_count_buffer &buffer );
+
+	void fam_conf_count_bit_parallel( int *node, int mb_node[], int *size_node, mpl_bit_data &bit_data,
+	                int *size_mb_conf, mpl_count_buffer &buffer, vector<mpl_count_buffer> &thread_buffer );
+
+	void get_mpl_lgamma_table( int *n, double *alpha_ijl, int size_range_nodes[], int *p, mpl_lgamma_table &lgamma_table );
+}
+
+#endif
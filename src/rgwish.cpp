@@ -76,6 +76,7 @@ void rgwish_c( int G[], double Ts[], double K[], int *b, int *p, double *thresho
     double mean_diff = 1.0;
 	while( mean_diff > threshold_c )
 	{
+		current_profile().add( run_profile::gwishart_sweeps );
 		memcpy( &sigma_last[0], &sigma[0], sizeof( double ) * pxp );
 		
 		for( i = 0; i < dim; i++ )
@@ -102,6 +103,7 @@ void rgwish_c( int G[], double Ts[], double K[], int *b, int *p, double *thresho
 					
 				// A * X = B   for   sigma_start_N_i := (sigma_N_i)^{-1} * sigma_start_N_i
 				F77_NAME(dposv)( &uplo, &size_node, &one, &sigma_N_i[0], &size_node, &sigma_start_N_i[0], &size_node, &info FCONE );
+				current_profile().add( run_profile::dposv_calls );
 
 				for( j = 0; j < size_node; j++ ) beta_star[ N_i[ j ] ] = sigma_start_N_i[ j ];
 				
@@ -149,6 +151,26 @@ void rgwish_c( int G[], double Ts[], double K[], int *b, int *p, double *thresho
 	inverse( &sigma[0], K, &dim );
 }
      
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// Random part of rgwish_sigma: Psi matrix of the Bartlett decomposition in sigma_start. 
+// It is the only part using the RNG ( of R, or of the chain; chain_rng.h ), so it runs on one thread.
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+void rgwish_sigma_psi( double sigma_start[], int *b_star, int *p )
+{
+	int i, j, dim = *p, dim1 = dim + 1, bKdim = *b_star + dim - 1;	
+
+	for( i = 0; i < dim; i++ )
+		sigma_start[ i * dim1 ] = sqrt( rgamma_chain( ( bKdim - i ) * 0.5, 2.0 ) ); // i * dim1 = i * dim + i
+		//sigma_start[i * dim1] = sqrt( rchisq( bKdim - i ) ); // i * dim1 = i * dim + i
+
+	for( j = 1; j < dim; j++ )
+		for( i = 0; i < j; i++ )
+		{
+			sigma_start[ j * dim + i ] = norm_rand_chain();
+			sigma_start[ i * dim + j ] = 0.0;
+		}
+}
+     
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
 // rgwish ONLY for inside of MCMC algorithm
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
@@ -157,30 +179,27 @@ void rgwish_sigma( int G[], int size_node[], double Ts[], double K[], double sig
 					double sigma_start[], double inv_C[], double beta_star[], double sigma_i[], 
 					vector<double> &sigma_start_N_i, vector<double> &sigma_N_i, vector<int> &N_i )
 {
-	int i, i1, j, ij, ip, l, size_node_i, info, one = 1, dim = *p, pxp = dim * dim, dim1 = dim + 1, bKdim = *b_star + dim - 1;	
+	profile_phase timer( run_profile::gwishart );
+	// - - STEP 1: sampling from wishart distributions  - - - - - - - - - - - - - - - - - - - - - -|
+	rgwish_sigma_psi( sigma_start, b_star, p );
+
+	rgwish_sigma_solve( G, size_node, Ts, K, sigma, p, threshold, sigma_start, inv_C, beta_star, sigma_i, sigma_start_N_i, sigma_N_i, N_i );
+}
+     
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// Deterministic part of rgwish_sigma, from the Psi matrix in sigma_start ( rgwish_sigma_psi )
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+void rgwish_sigma_solve( int G[], int size_node[], double Ts[], double K[], double sigma[], 
+					int *p, double *threshold,
+					double sigma_start[], double inv_C[], double beta_star[], double sigma_i[], 
+					vector<double> &sigma_start_N_i, vector<double> &sigma_N_i, vector<int> &N_i )
+{
+	int i, i1, j, ij, ip, l, size_node_i, info, one = 1, dim = *p, pxp = dim * dim;	
 	
 	double alpha = 1.0, beta  = 0.0;	
 	
 	char transT  = 'T', transN = 'N', side = 'R', upper = 'U';																	
 	
-	// - - STEP 1: sampling from wishart distributions  - - - - - - - - - - - - - - - - - - - - - -|
-	// - -  Sample values in Psi matrix
-	//GetRNGstate();
-	#pragma omp parallel for
-	for( i = 0; i < dim; i++ )
-		sigma_start[ i * dim1 ] = sqrt( Rf_rgamma( ( bKdim - i ) * 0.5, 2.0 ) ); // i * dim1 = i * dim + i
-		//sigma_start[i * dim1] = sqrt( rchisq( bKdim - i ) ); // i * dim1 = i * dim + i
-
-	#pragma omp parallel for
-	for( j = 1; j < dim; j++ )
-		for( int i = 0; i < j; i++ )
-		{
-			sigma_start[ j * dim + i ] = norm_rand();
-			sigma_start[ i * dim + j ] = 0.0;
-		}
-	//PutRNGstate();
-	// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
-	
 	// C = psi %*% Ts   I used psi = psi %*% Ts   Now is  sigma_start = sigma_start %*% Ts
 	F77_NAME(dtrmm)( &side, &upper, &transN, &transN, &dim, &dim, &alpha, Ts, &dim, &sigma_start[0], &dim FCONE FCONE FCONE FCONE );
 
@@ -205,6 +224,7 @@ void rgwish_sigma( int G[], int size_node[], double Ts[], double K[], double sig
 	while( ( mean_diff > threshold_c ) and ( counter < 5000 ) )
 	{
 		counter++;
+		current_profile().add( run_profile::gwishart_sweeps );
 	    mean_diff = 0.0;
 		
 		for( i = 0; i < dim; i++ )
@@ -232,6 +252,7 @@ void rgwish_sigma( int G[], int size_node[], double Ts[], double K[], double sig
 					
 				// A * X = B   for   sigma_start_N_i := (sigma_N_i)^{-1} * sigma_start_N_i
 				F77_NAME(dposv)( &upper, &size_node_i, &one, &sigma_N_i[0], &size_node_i, &sigma_start_N_i[0], &size_node_i, &info FCONE );
+				current_profile().add( run_profile::dposv_calls );
 
 				for( j = 0; j < size_node_i; j++ ) beta_star[ N_i[ j ] ] = sigma_start_N_i[ j ];
 	
@@ -303,6 +324,49 @@ void rgwish_sigma( int G[], int size_node[], double Ts[], double K[], double sig
 	//F77_NAME(dposv)( &upper, &dim, &dim, &sigma_start[0], &dim, K, &dim, &info );
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// For double Metropolis-Hastings algorithms: after the update of graph G, the posterior draw 
+// of K ( Ts, b_star ) and the prior draw of K_dmh ( Ti, b ) for the next step ( if next_dmh ) 
+// only depend on G. The random parts are drawn in order, then the two iterative parts run 
+// in parallel sections if there are 2 threads or nested parallelism is on; otherwise the
+// sections would run the parallel loops of rgwish_sigma_solve on one thread, so the two 
+// parts run one after the other.
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+void rgwish_sigma_dmh( int G[], int size_node[], double Ts[], double K[], double sigma[], int *b_star, 
+					double Ti[], double K_dmh[], double sigma_dmh[], int *b, int *next_dmh, 
+					int *p, double *threshold,
+					double sigma_start[], double inv_C[], double beta_star[], double sigma_i[], 
+					vector<double> &sigma_start_N_i, vector<double> &sigma_N_i, vector<int> &N_i,
+					double sigma_start_dmh[], double inv_C_dmh[], double beta_star_dmh[], double sigma_i_dmh[], 
+					vector<double> &sigma_start_N_i_dmh, vector<double> &sigma_N_i_dmh, vector<int> &N_i_dmh )
+{
+	profile_phase timer( run_profile::gwishart );
+	rgwish_sigma_psi( sigma_start, b_star, p );
+	if( *next_dmh ) rgwish_sigma_psi( sigma_start_dmh, b, p );
+	
+	bool sections = false;
+	#ifdef _OPENMP
+		sections = *next_dmh and ( ( omp_get_max_threads() == 2 ) or ( omp_get_max_active_levels() > 1 ) );
+	#endif
+	
+	if( sections )
+	{
+		#pragma omp parallel sections
+		{
+			#pragma omp section
+			rgwish_sigma_solve( G, size_node, Ts, K, sigma, p, threshold, sigma_start, inv_C, beta_star, sigma_i, sigma_start_N_i, sigma_N_i, N_i );
+			
+			#pragma omp section
+			rgwish_sigma_solve( G, size_node, Ti, K_dmh, sigma_dmh, p, threshold, sigma_start_dmh, inv_C_dmh, beta_star_dmh, sigma_i_dmh, sigma_start_N_i_dmh, sigma_N_i_dmh, N_i_dmh );
+		}
+	}else{
+		rgwish_sigma_solve( G, size_node, Ts, K, sigma, p, threshold, sigma_start, inv_C, beta_star, sigma_i, sigma_start_N_i, sigma_N_i, N_i );
+		
+		if( *next_dmh ) 
+			rgwish_sigma_solve( G, size_node, Ti, K_dmh, sigma_dmh, p, threshold, sigma_start_dmh, inv_C_dmh, beta_star_dmh, sigma_i_dmh, sigma_start_N_i_dmh, sigma_N_i_dmh, N_i_dmh );
+	}
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
 // Part of function "gnorm"
 // which is for calculating Normalizing constant of G-Wishart distribution 
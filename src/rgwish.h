@@ -20,11 +20,26 @@ extern "C" {
 
     void rgwish_c( int G[], double Ts[], double K[], int *b, int *p, double *threshold );
 
+	void rgwish_sigma_psi( double sigma_start[], int *b_star, int *p );
+
+	void rgwish_sigma_solve( int G[], int size_node[], double Ts[], double K[], double sigma[], 
+					int *p, double *threshold,
+					double sigma_start[], double inv_C[], double beta_star[], double sigma_i[], 
+					vector<double> &sigma_start_N_i, vector<double> &sigma_N_i, vector<int> &N_i );
+
 	void rgwish_sigma( int G[], int size_node[], double Ts[], double K[], double sigma[], int *b_star, 
 					int *p, double *threshold,
 					double sigma_start[], double inv_C[], double beta_star[], double sigma_i[], 
 					vector<double> &sigma_start_N_i, vector<double> &sigma_N_i, vector<int> &N_i );
 
+	void rgwish_sigma_dmh( int G[], int size_node[], double Ts[], double K[], double sigma[], int *b_star, 
+					double Ti[], double K_dmh[], double sigma_dmh[], int *b, int *next_dmh, 
+					int *p, double *threshold,
+					double sigma_start[], double inv_C[], double beta_star[], double sigma_i[], 
+					vector<double> &sigma_start_N_i, vector<double> &sigma_N_i, vector<int> &N_i,
+					double sigma_start_dmh[], double inv_C_dmh[], double beta_star_dmh[], double sigma_i_dmh[], 
+					vector<double> &sigma_start_N_i_dmh, vector<double> &sigma_N_i_dmh, vector<int> &N_i_dmh );
+
 	void log_exp_mc( int G[], int nu[], int *b, double H[], int *check_H, int *mc, int *p, double f_T[] );
 }
 
@@ -0,0 +1,91 @@
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+//     Copyright (C) 2012 - 2022  Reza Mohammadi                                                   |
+//                                                                                                 |
+//     This file is part of BDgraph package.                                                       |
+//                                                                                                 |
+//     BDgraph is free software: you can redistribute it and/or modify it under                    |
+//     the terms of the GNU General Public License as published by the Free                        |
+//     Software Foundation; see <https://cran.r-project.org/web/licenses/GPL-3>.                   |
+//                                                                                                 |
+//     Maintainer: Reza Mohammadi <a.mohammadi@uva.nl>                                             |
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+
+#ifndef run_budget_H
+#define run_budget_H
+
+#include "util.h"
+#include <chrono>            // std::chrono::steady_clock
+
+// Wall-clock time of a sampler run, and the run mode with a time budget ( in seconds ).
+// With a budget, 'iter' is the largest number of iterations: the time of one iteration is
+// estimated after 1% of the budget ( and at least 10 iterations ), then the number of
+// iterations is set to fit in the budget and burn-in to the same fraction of it as
+// 'burnin' / 'iter'. Up to then there is no saving. The run stops at the deadline; if no
+// iteration is saved by then, burn-in ends and one more iteration is run and saved.
+struct run_budget
+{
+	bool on, estimated, burnin_done;
+	int max_iteration;
+	double budget, burnin_rate, start, start_loop, time_burnin;
+
+	static double now()
+	{
+		return std::chrono::duration<double>( std::chrono::steady_clock::now().time_since_epoch() ).count();
+	}
+
+	run_budget( double time_budget, int *iteration, int *burn_in ) : on( time_budget > 0.0 ), estimated( false ), burnin_done( false ),
+		max_iteration( *iteration ), budget( time_budget ), burnin_rate( static_cast<double>( *burn_in ) / *iteration ),
+		start( now() ), start_loop( start ), time_burnin( 0.0 )
+	{
+		if( on ) *burn_in = *iteration;
+	}
+
+	// at the start of iteration i_mcmc; returns false at the deadline, after a saved iteration
+	bool check( int i_mcmc, int *iteration, int *burn_in )
+	{
+		double time_now = now(), time_run = time_now - start;
+		if( i_mcmc == 0 ) start_loop = time_now;   // the time before the main loop is not for the iterations
+
+		if( on )
+		{
+			if( time_run >= budget )
+			{
+				if( i_mcmc > *burn_in ) return false;
+
+				*burn_in   = i_mcmc;       // the estimates need at least one saved iteration
+				*iteration = i_mcmc + 1;
+				estimated  = true;
+			}
+
+			if( !estimated and ( i_mcmc >= 10 ) and ( time_run >= 0.01 * budget ) )
+			{
+				double total = i_mcmc + ( budget - time_run ) / ( ( time_now - start_loop ) / i_mcmc );
+				*iteration   = ( total < max_iteration ) ? static_cast<int>( total ) : max_iteration;
+				*burn_in     = static_cast<int>( burnin_rate * *iteration );
+				if( *burn_in < i_mcmc ) *burn_in = i_mcmc;
+				estimated = true;
+			}
+		}
+
+		if( !burnin_done and ( i_mcmc >= *burn_in ) )
+		{
+			time_burnin = time_run;
+			burnin_done = true;
+		}
+
+		return true;
+	}
+
+	// timing: time of burn-in, time of sampling after burn-in, and time of one iteration ( seconds )
+	void report( double timing[], int iter_used )
+	{
+		double time_run = now() - start;
+		if( !burnin_done ) time_burnin = time_run;
+
+		timing[ 0 ] = time_burnin;
+		timing[ 1 ] = time_run - time_burnin;
+		timing[ 2 ] = ( iter_used > 0 ) ? time_run / iter_used : 0.0;
+	}
+};
+
+#endif
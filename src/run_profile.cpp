@@ -0,0 +1,54 @@
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+//     Copyright (C) 2012 - 2022  Reza Mohammadi                                                   |
+//                                                                                                 |
+//     This file is part of BDgraph package.                                                       |
+//                                                                                                 |
+//     BDgraph is free software: you can redistribute it and/or modify it under                    |
+//     the terms of the GNU General Public License as published by the Free                        |
+//     Software Foundation; see <https://cran.r-project.org/web/licenses/GPL-3>.                   |
+//                                                                                                 |
+//     Maintainer: Reza Mohammadi <a.mohammadi@uva.nl>                                             |
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+
+#include "run_profile.h"
+
+extern "C" {
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// Profile of the next sampler runs on 'threads' threads; with on = 0 the profile is off
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+void profile_start( int *on, int *threads )
+{
+	run_profile &profile = current_profile();
+
+	if( *on )
+		profile.begin( *threads );
+	else
+		profile.on = false;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// phases: time of rates, select, gwishart, copula, the rest, and the run ( seconds );
+// counts: G-Wishart sweeps, dposv calls, cache hits and misses; busy: time of each thread
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+void profile_get( double phases[], double counts[], double busy[], int *threads )
+{
+	run_profile &profile = current_profile();
+
+	double time_run = run_profile::now() - profile.start, time_rest = time_run;
+	for( int i = 0; i < run_profile::n_phases; i++ )
+	{
+		phases[ i ] = profile.time[ i ];
+		time_rest  -= profile.time[ i ];
+	}
+	phases[ run_profile::n_phases ]     = ( time_rest > 0.0 ) ? time_rest : 0.0;
+	phases[ run_profile::n_phases + 1 ] = time_run;
+
+	for( int i = 0; i < run_profile::n_counts; i++ ) counts[ i ] = profile.count[ i ];
+
+	int size_busy = static_cast<int>( profile.busy.size() );
+	for( int i = 0; i < *threads; i++ ) busy[ i ] = ( i < size_busy ) ? profile.busy[ i ] : 0.0;
+
+	profile.on = false;
+}
+
+} // End of exturn "C"
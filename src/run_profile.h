@@ -0,0 +1,132 @@
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+//     Copyright (C) 2012 - 2022  Reza Mohammadi                                                   |
+//                                                                                                 |
+//     This file is part of BDgraph package.                                                       |
+//                                                                                                 |
+//     BDgraph is free software: you can redistribute it and/or modify it under                    |
+//     the terms of the GNU General Public License as published by the Free                        |
+//     Software Foundation; see <https://cran.r-project.org/web/licenses/GPL-3>.                   |
+//                                                                                                 |
+//     Maintainer: Reza Mohammadi <a.mohammadi@uva.nl>                                             |
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+
+#ifndef run_profile_H
+#define run_profile_H
+
+#include "util.h"
+#include <chrono>            // std::chrono::steady_clock
+
+// Profile of a sampler run ( option 'profile' in R ). The phases of the main loops are timed
+// in the routines which all the samplers share ( rates, selecting the edges, G-Wishart,
+// copula ), so the rest of the run is the graph bookkeeping and saving. It counts the sweeps
+// of G-Wishart, the calls of dposv, and the hits of the score cache, and takes the busy time
+// of each thread in the parallel loops of the rates. When it is off, a probe is one test.
+// The samplers with several chains at the same time are not profiled. The phases and 'depth'
+// are not atomic, so only the master thread times phases ( master() ); the phases which other
+// threads enter, as in the sections of rgwish_sigma_dmh, are in the time of the master.
+struct run_profile
+{
+	enum phase_id { rates, select, gwishart, copula, n_phases };
+	enum count_id { gwishart_sweeps, dposv_calls, cache_hits, cache_misses, n_counts };
+
+	bool on;
+	int depth;                          // phases inside a phase are in the outer one
+	double start, time[ n_phases ], count[ n_counts ];
+	vector<double> busy;                // per thread
+
+	run_profile() : on( false ), depth( 0 ), start( 0.0 ) {}
+
+	static double now()
+	{
+		return std::chrono::duration<double>( std::chrono::steady_clock::now().time_since_epoch() ).count();
+	}
+
+	void begin( int threads )
+	{
+		on    = true;
+		depth = 0;
+		start = now();
+		for( int i = 0; i < n_phases; i++ ) time[ i ]  = 0.0;
+		for( int i = 0; i < n_counts; i++ ) count[ i ] = 0.0;
+		busy.assign( ( threads > 0 ) ? threads : 1, 0.0 );
+	}
+
+	void add( int id )
+	{
+		if( on )
+		{
+			#pragma omp atomic
+			count[ id ] += 1.0;
+		}
+	}
+
+	static int thread()
+	{
+		#ifdef _OPENMP
+			return omp_get_thread_num();
+		#else
+			return 0;
+		#endif
+	}
+
+	// thread 0 of all the enclosing parallel regions
+	static bool master()
+	{
+		#ifdef _OPENMP
+			for( int level = omp_get_level(); level > 0; level-- )
+				if( omp_get_ancestor_thread_num( level ) != 0 ) return false;
+		#endif
+		return true;
+	}
+};
+
+inline run_profile &current_profile()
+{
+	static run_profile profile;
+	return profile;
+}
+
+// wall time of a phase, from here to the end of the scope; only on the master thread
+struct profile_phase
+{
+	int phase;
+	bool timed;
+	double start;
+
+	profile_phase( int phase_id ) : phase( phase_id ), timed( false ), start( -1.0 )
+	{
+		run_profile &profile = current_profile();
+		if( !profile.on or !run_profile::master() ) return;
+
+		timed = true;
+		if( profile.depth++ == 0 ) start = run_profile::now();
+	}
+
+	~profile_phase()
+	{
+		if( !timed ) return;
+
+		run_profile &profile = current_profile();
+		--profile.depth;
+		if( start >= 0.0 ) profile.time[ phase ] += run_profile::now() - start;
+	}
+};
+
+// busy time of this thread in a parallel loop, from here to the end of the scope
+struct profile_work
+{
+	double start;
+
+	profile_work() : start( current_profile().on ? run_profile::now() : -1.0 ) {}
+
+	~profile_work()
+	{
+		if( start < 0.0 ) return;
+
+		run_profile &profile = current_profile();
+		size_t i = run_profile::thread();
+		if( i < profile.busy.size() ) profile.busy[ i ] += run_profile::now() - start;
+	}
+};
+
+#endif
@@ -0,0 +1,392 @@
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+//     Copyright (C) 2012 - 2022  Reza Mohammadi                                                   |
+//                                                                                                 |
+//     This file is part of BDgraph package.                                                       |
+//                                                                                                 |
+//     BDgraph is free software: you can redistribute it and/or modify it under                    |
+//     the terms of the GNU General Public License as published by the Free                        |
+//     Software Foundation; see <https://cran.r-project.org/web/licenses/GPL-3>.                   |
+//                                                                                                 |
+//     Maintainer: Reza Mohammadi <a.mohammadi@uva.nl>                                             |
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+
+#include "sparse_K.h"
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// pattern and values of K
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+int sparse_K::find( int i, int j ) const
+{
+	vector<int>::const_iterator it = lower_bound( adj[ j ].begin(), adj[ j ].end(), i );
+	return ( ( it != adj[ j ].end() ) and ( *it == i ) ) ? static_cast<int>( it - adj[ j ].begin() ) : -1;
+}
+
+double sparse_K::get( int i, int j ) const
+{
+	if( i == j ) return diag[ j ];
+
+	int k = find( i, j );
+	return ( k < 0 ) ? 0.0 : value[ j ][ k ];
+}
+
+void sparse_K::add_link( int i, int j )
+{
+	if( find( i, j ) >= 0 ) return;
+
+	int k = static_cast<int>( lower_bound( adj[ j ].begin(), adj[ j ].end(), i ) - adj[ j ].begin() );
+	adj[ j ].insert( adj[ j ].begin() + k, i );
+	value[ j ].insert( value[ j ].begin() + k, 0.0 );
+
+	k = static_cast<int>( lower_bound( adj[ i ].begin(), adj[ i ].end(), j ) - adj[ i ].begin() );
+	adj[ i ].insert( adj[ i ].begin() + k, j );
+	value[ i ].insert( value[ i ].begin() + k, 0.0 );
+}
+
+void sparse_K::remove_link( int i, int j )
+{
+	int k = find( i, j );
+	if( k < 0 ) return;
+
+	adj[ j ].erase( adj[ j ].begin() + k );
+	value[ j ].erase( value[ j ].begin() + k );
+
+	k = find( j, i );
+	adj[ i ].erase( adj[ i ].begin() + k );
+	value[ i ].erase( value[ i ].begin() + k );
+}
+
+void sparse_K::to_dense( double K[] ) const
+{
+	memset( K, 0, sizeof( double ) * dim * dim );
+	for( int j = 0; j < dim; j++ )
+	{
+		K[ j * dim + j ] = diag[ j ];
+		for( size_t k = 0; k < adj[ j ].size(); k++ ) K[ j * dim + adj[ j ][ k ] ] = value[ j ][ k ];
+	}
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// Minimum degree ordering: the node of smallest degree in the elimination graph is the next one
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+void sparse_K::order()
+{
+	vector< vector<int> > graph( adj );
+	vector<char> done( dim, 0 );
+	vector<int> merged;
+
+	priority_queue< pair<int, int>, vector< pair<int, int> >, greater< pair<int, int> > > queue;
+	for( int j = 0; j < dim; j++ ) queue.push( make_pair( static_cast<int>( graph[ j ].size() ), j ) );
+
+	int c = 0;
+	while( !queue.empty() )
+	{
+		int degree = queue.top().first, v = queue.top().second;
+		queue.pop();
+		if( done[ v ] or ( degree != static_cast<int>( graph[ v ].size() ) ) ) continue;
+
+		done[ v ]  = 1;
+		perm[ c ]  = v;
+		iperm[ v ] = c++;
+
+		// the neighbours of v become a clique, without v
+		vector<int> &nbrs = graph[ v ];
+		for( size_t k = 0; k < nbrs.size(); k++ )
+		{
+			int a = nbrs[ k ];
+			merged.clear();
+			set_union( graph[ a ].begin(), graph[ a ].end(), nbrs.begin(), nbrs.end(), back_inserter( merged ) );
+			merged.erase( remove_if( merged.begin(), merged.end(), [a, v]( int x ){ return ( x == a ) or ( x == v ); } ), merged.end() );
+			graph[ a ].swap( merged );
+			queue.push( make_pair( static_cast<int>( graph[ a ].size() ), a ) );
+		}
+		vector<int>().swap( nbrs );
+	}
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// Pattern of row k of L in s[ top ], ..., s[ dim - 1 ], in topological order
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+int sparse_K::ereach( int k, int s[] )
+{
+	int top = dim, len, i;
+	int *mark = &work_mark[0];
+
+	mark[ k ] = k;
+	for( int q = Cp[ k ]; q < Cp[ k + 1 ]; q++ )
+	{
+		for( i = Ci[ q ], len = 0; mark[ i ] != k; i = parent[ i ] )
+		{
+			s[ len++ ] = i;
+			mark[ i ]  = k;
+		}
+		while( len > 0 ) s[ --top ] = s[ --len ];
+	}
+
+	for( int q = top; q < dim; q++ ) mark[ s[ q ] ] = -1;
+	mark[ k ] = -1;
+
+	return top;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// Symbolic factor: pattern of P K P', elimination tree, and size of the columns of L
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+void sparse_K::analyse()
+{
+	Cp.assign( dim + 1, 0 );
+	Ci.clear();
+	Cj.clear();
+	for( int c = 0; c < dim; c++ )
+	{
+		int node = perm[ c ];
+		for( size_t k = 0; k < adj[ node ].size(); k++ )
+			if( iperm[ adj[ node ][ k ] ] < c )
+			{
+				Ci.push_back( iperm[ adj[ node ][ k ] ] );
+				Cj.push_back( static_cast<int>( k ) );
+			}
+		Cp[ c + 1 ] = static_cast<int>( Ci.size() );
+	}
+
+	vector<int> ancestor( dim );
+	for( int k = 0; k < dim; k++ )
+	{
+		parent[ k ]   = -1;
+		ancestor[ k ] = -1;
+		for( int q = Cp[ k ]; q < Cp[ k + 1 ]; q++ )
+			for( int i = Ci[ q ], next; ( i != -1 ) and ( i < k ); i = next )
+			{
+				next          = ancestor[ i ];
+				ancestor[ i ] = k;
+				if( next == -1 ) parent[ i ] = k;
+			}
+	}
+
+	vector<int> count( dim, 1 );
+	for( int k = 0; k < dim; k++ )
+		for( int top = ereach( k, &work_s[0] ); top < dim; top++ ) ++count[ work_s[ top ] ];
+
+	Lp.assign( dim + 1, 0 );
+	for( int c = 0; c < dim; c++ ) Lp[ c + 1 ] = Lp[ c ] + count[ c ];
+
+	Li.resize( Lp[ dim ] );
+	Lx.resize( Lp[ dim ] );
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// Numeric factor, by rows ( up-looking ): row k of L from a sparse triangular solve
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+bool sparse_K::factor()
+{
+	vector<int> next( Lp.begin(), Lp.end() - 1 );
+	double *x = &work_x[0];
+
+	for( int k = 0; k < dim; k++ )
+	{
+		int node = perm[ k ], top = ereach( k, &work_s[0] );
+		for( int q = Cp[ k ]; q < Cp[ k + 1 ]; q++ ) x[ Ci[ q ] ] = value[ node ][ Cj[ q ] ];
+
+		double d = diag[ node ];
+		for( ; top < dim; top++ )
+		{
+			int i = work_s[ top ];
+			double lki = x[ i ] / Lx[ Lp[ i ] ];
+			x[ i ] = 0.0;
+			for( int q = Lp[ i ] + 1; q < next[ i ]; q++ ) x[ Li[ q ] ] -= Lx[ q ] * lki;
+
+			d -= lki * lki;
+			int q = next[ i ]++;
+			Li[ q ] = k;
+			Lx[ q ] = lki;
+		}
+
+		if( d <= 0.0 )
+		{
+			for( int c = 0; c < dim; c++ ) x[ c ] = 0.0;
+			return false;
+		}
+
+		int q = next[ k ]++;
+		Li[ q ] = k;
+		Lx[ q ] = sqrt( d );
+	}
+
+	return true;
+}
+
+void sparse_K::refactor()
+{
+	analyse();
+	if( ( size_L_ordered == 0 ) or ( Lp[ dim ] > 1.2 * size_L_ordered ) )
+	{
+		order();
+		analyse();
+		size_L_ordered = Lp[ dim ];
+	}
+	if( Lp[ dim ] < size_L_ordered ) size_L_ordered = Lp[ dim ];
+
+	if( !factor() ) Rf_error( "The precision matrix is not positive definite" );
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// Solves with L
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+int sparse_K::lower_solve( int a, double y[] ) const
+{
+	int k = iperm[ a ];
+
+	y[ k ] = 1.0;
+	for( int c = k; c < dim; c++ )
+		if( y[ c ] != 0.0 )
+		{
+			y[ c ] /= Lx[ Lp[ c ] ];
+			for( int q = Lp[ c ] + 1; q < Lp[ c + 1 ]; q++ ) y[ Li[ q ] ] -= Lx[ q ] * y[ c ];
+		}
+
+	return k;
+}
+
+double sparse_K::sigma_diag( int a, double y[] ) const
+{
+	double sum = 0.0;
+	for( int c = lower_solve( a, y ); c < dim; c++ )
+	{
+		sum   += y[ c ] * y[ c ];
+		y[ c ] = 0.0;
+	}
+
+	return sum;
+}
+
+void sparse_K::sigma_column( int a, double x[], double y[] ) const
+{
+	lower_solve( a, y );
+
+	for( int c = dim - 1; c >= 0; c-- )
+	{
+		double yc = y[ c ];
+		for( int q = Lp[ c ] + 1; q < Lp[ c + 1 ]; q++ ) yc -= Lx[ q ] * y[ Li[ q ] ];
+		y[ c ] = yc / Lx[ Lp[ c ] ];
+	}
+
+	for( int c = 0; c < dim; c++ )
+	{
+		x[ perm[ c ] ] = y[ c ];
+		y[ c ] = 0.0;
+	}
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// Rank-one update ( sign = 1 ) or downdate ( sign = -1 ) of L with w = work_w, which is zero but
+// on the column k of L below the diagonal; on the path of k in the elimination tree, as the
+// pattern of L does not change. work_w is zero on exit.
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+bool sparse_K::updown( int k, int sign )
+{
+	double *w = &work_w[0];
+	double alpha, beta = 1.0, beta2, delta, gamma, w1, w2;
+	bool positive = true;
+
+	for( int c = parent[ k ]; c != -1; c = parent[ c ] )
+	{
+		if( positive )
+		{
+			int q  = Lp[ c ];
+			alpha  = w[ c ] / Lx[ q ];
+			beta2  = beta * beta + sign * alpha * alpha;
+			if( beta2 > 0.0 )
+			{
+				beta2  = sqrt( beta2 );
+				delta  = ( sign > 0 ) ? ( beta / beta2 ) : ( beta2 / beta );
+				gamma  = sign * alpha / ( beta2 * beta );
+				Lx[ q ] = delta * Lx[ q ] + ( ( sign > 0 ) ? ( gamma * w[ c ] ) : 0.0 );
+				beta   = beta2;
+
+				for( q++; q < Lp[ c + 1 ]; q++ )
+				{
+					w1 = w[ Li[ q ] ];
+					w[ Li[ q ] ] = w2 = w1 - alpha * Lx[ q ];
+					Lx[ q ] = delta * Lx[ q ] + gamma * ( ( sign > 0 ) ? w1 : w2 );
+				}
+			}else
+				positive = false;
+		}
+		w[ c ] = 0.0;
+	}
+
+	return positive;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+// Row modification of L ( Davis and Hager, 2005 ): row and column j are deleted by an update of
+// the trailing factor with the old column of L, and they are added by a sparse triangular solve
+// for the new row of L and a downdate of the trailing factor with the new column of L.
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+void sparse_K::remove_node( int j )
+{
+	int k = iperm[ j ];
+
+	for( int q = Lp[ k ] + 1; q < Lp[ k + 1 ]; q++ )
+	{
+		work_w[ Li[ q ] ] = Lx[ q ];
+		Lx[ q ] = 0.0;
+	}
+	updown( k, 1 );
+	Lx[ Lp[ k ] ] = 1.0;
+
+	for( int top = ereach( k, &work_s[0] ); top < dim; top++ )
+	{
+		int i = work_s[ top ];
+		Lx[ lower_bound( Li.begin() + Lp[ i ], Li.begin() + Lp[ i + 1 ], k ) - Li.begin() ] = 0.0;
+	}
+}
+
+void sparse_K::add_node( int j, const double new_column[], double new_diag )
+{
+	int k = iperm[ j ];
+	double *x = &work_x[0], *w = &work_w[0];
+
+	diag[ j ] = new_diag;
+	for( size_t t = 0; t < adj[ j ].size(); t++ )
+	{
+		int a = adj[ j ][ t ];
+		value[ j ][ t ] = new_column[ t ];
+		value[ a ][ find( j, a ) ] = new_column[ t ];
+
+		if( iperm[ a ] < k ) x[ iperm[ a ] ] = new_column[ t ];
+		else                 w[ iperm[ a ] ] = new_column[ t ];
+	}
+
+	// row k of L: L[ 1:k-1, 1:k-1 ] l = K[ 1:k-1, k ]; and w = K[ k+1:p, k ] - L[ k+1:p, 1:k-1 ] l
+	double d = new_diag;
+	for( int top = ereach( k, &work_s[0] ); top < dim; top++ )
+	{
+		int i = work_s[ top ], q;
+		double lki = x[ i ] / Lx[ Lp[ i ] ];
+		x[ i ] = 0.0;
+		for( q = Lp[ i ] + 1; Li[ q ] < k; q++ ) x[ Li[ q ] ] -= Lx[ q ] * lki;
+
+		Lx[ q ] = lki;
+		for( q++; q < Lp[ i + 1 ]; q++ ) w[ Li[ q ] ] -= Lx[ q ] * lki;
+
+		d -= lki * lki;
+	}
+
+	bool positive = ( d > 0.0 );
+	if( positive )
+	{
+		double lkk = sqrt( d );
+		Lx[ Lp[ k ] ] = lkk;
+		for( int q = Lp[ k ] + 1; q < Lp[ k + 1 ]; q++ )
+		{
+			Lx[ q ] = w[ Li[ q ] ] / lkk;
+			w[ Li[ q ] ] = Lx[ q ];
+		}
+
+		positive = updown( k, -1 );
+	}else
+		for( int q = Lp[ k ] + 1; q < Lp[ k + 1 ]; q++ ) w[ Li[ q ] ] = 0.0;
+
+	// the downdate fails only by rounding errors, as the new K is positive definite
+	if( !positive and !factor() ) Rf_error( "The precision matrix is not positive definite" );
+}
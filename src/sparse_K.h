@@ -0,0 +1,70 @@
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+//     Copyright (C) 2012 - 2022  Reza Mohammadi                                                   |
+//                                                                                                 |
+//     This file is part of BDgraph package.                                                       |
+//                                                                                                 |
+//     BDgraph is free software: you can redistribute it and/or modify it under                    |
+//     the terms of the GNU General Public License as published by the Free                        |
+//     Software Foundation; see <https://cran.r-project.org/web/licenses/GPL-3>.                   |
+//                                                                                                 |
+//     Maintainer: Reza Mohammadi <a.mohammadi@uva.nl>                                             |
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+
+#ifndef sparse_K_H
+#define sparse_K_H
+
+#include "util.h"
+
+// Precision matrix K on the pattern of a sparse graph ( option 'sparse' in R ), with its sparse
+// Cholesky factor P K P' = L L'. The ordering P is by minimum degree and is computed again
+// when the factor has grown by a fifth since the last ordering. The pattern of K holds the
+// links of the graph and may hold more, with zero values. The memory is O( p + links + size
+// of L ) in place of the dense p x p matrices; solves with L take O( size of L ).
+struct sparse_K
+{
+	int dim;
+	vector< vector<int> >    adj;     // pattern of K: neighbours of each node, sorted
+	vector< vector<double> > value;   // K[ adj[ j ][ k ], j ]
+	vector<double> diag;              // K[ j, j ]
+
+	vector<int> perm, iperm;          // node perm[ c ] is column c of L; iperm is the inverse
+	vector<int> parent;               // elimination tree of L
+	vector<int> Cp, Ci, Cj;           // upper part of P K P' by column; Cj is the index in adj
+	vector<int> Lp, Li;               // L by column, the diagonal first
+	vector<double> Lx;
+	int size_L_ordered;               // size of L with the last ordering
+
+	sparse_K( int p ) : dim( p ), adj( p ), value( p ), diag( p, 0.0 ), perm( p ), iperm( p ),
+		parent( p ), size_L_ordered( 0 ), work_s( p ), work_mark( p, -1 ), work_x( p, 0.0 ), work_w( p, 0.0 ) {}
+
+	int find( int i, int j ) const;                // index of i in adj[ j ], or -1
+	double get( int i, int j ) const;
+	void add_link( int i, int j );                 // into the pattern, with value 0
+	void remove_link( int i, int j );
+	void to_dense( double K[] ) const;
+
+	void order();                                  // minimum degree ordering
+	void analyse();                                // symbolic factor for the ordering
+	bool factor();                                 // numeric factor; false if not positive definite
+	void refactor();                               // analyse, with a new ordering if needed, and factor
+
+	// column a of K^{-1} in x; y is work space, zero on entry and on exit
+	void sigma_column( int a, double x[], double y[] ) const;
+	// y = L^{-1} P e_a, with y zero on entry; returns the first nonzero row of y
+	int lower_solve( int a, double y[] ) const;
+	// ( K^{-1} )[ a, a ] = || L^{-1} P e_a ||^2; y as in sigma_column
+	double sigma_diag( int a, double y[] ) const;
+
+	// row and column j of K are set to e_j in L, so that L is the factor of K[ -j, -j ];
+	// then add_node puts the new values of them ( over adj[ j ] ) in K and in L
+	void remove_node( int j );
+	void add_node( int j, const double new_column[], double new_diag );
+
+	int ereach( int k, int s[] );
+	bool updown( int k, int sign );
+
+	vector<int> work_s, work_mark;    // work space of the serial routines
+	vector<double> work_x, work_w;
+};
+
+#endif
@@ -0,0 +1,111 @@
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+//     Copyright (C) 2012 - 2022  Reza Mohammadi                                                   |
+//                                                                                                 |
+//     This file is part of BDgraph package.                                                       |
+//                                                                                                 |
+//     BDgraph is free software: you can redistribute it and/or modify it under                    |
+//     the terms of the GNU General Public License as published by the Free                        |
+//     Software Foundation; see <https://cran.r-project.org/web/licenses/GPL-3>.                   |
+//                                                                                                 |
+//     Maintainer: Reza Mohammadi <a.mohammadi@uva.nl>                                             |
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - |
+
+#ifndef standalone_H
+#define standalone_H
+
+// The part of the R API which the core samplers use, for building them without R
+// ( BDGRAPH_STANDALONE; see inst/cli ). Printing goes to stderr, an error throws, and the
+// random numbers come from rmath_standalone.cpp; BLAS and LAPACK are the system ones.
+
+#include <cstdio>
+#include <cstdarg>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#ifndef TRUE
+#define TRUE  1
+#endif
+#ifndef FALSE
+#define FALSE 0
+#endif
+
+#define R_PosInf  (  std::numeric_limits<double>::infinity() )
+#define R_NegInf  ( -std::numeric_limits<double>::infinity() )
+
+inline void Rprintf( const char *format, ... )
+{
+	va_list args;
+	va_start( args, format );
+	vfprintf( stderr, format, args );
+	va_end( args );
+}
+
+inline void Rf_error( const char *format, ... )
+{
+	char message[ 1024 ];
+	va_list args;
+	va_start( args, format );
+	vsnprintf( message, sizeof( message ), format, args );
+	va_end( args );
+	throw std::runtime_error( message );
+}
+
+// the state of the generator is kept in rmath_standalone.cpp, not in .Random.seed
+inline void GetRNGstate(){}
+inline void PutRNGstate(){}
+inline void R_CheckUserInterrupt(){}
+
+inline double lgammafn( double x ){ return std::lgamma( x ); }
+
+inline double lgammafn_sign( double x, int *sgn )
+{
+	if( sgn != NULL ) *sgn = ( ( x < 0.0 ) and ( std::fmod( std::floor( -x ), 2.0 ) == 0.0 ) ) ? -1 : 1;
+	return std::lgamma( x );
+}
+
+extern "C" {
+	double unif_rand( void );
+	double norm_rand( void );
+	double Rf_rgamma( double shape, double scale );
+	double Rf_runif( double a, double b );
+	double Rf_qnorm5( double p, double mu, double sigma, int lower_tail, int log_p );
+	double Rf_pnorm5( double x, double mu, double sigma, int lower_tail, int log_p );
+
+	// seed, and the state of the generator as ints ( for the checkpoint files )
+	void set_seed_standalone( unsigned long long int seed );
+	int  rng_state_size_standalone( void );
+	void get_rng_state_standalone( int state[] );
+	void set_rng_state_standalone( const int state[], int size );
+}
+
+// - - - BLAS and LAPACK, with the hidden lengths of the character arguments - - - - - - - - - - - |
+
+#define F77_NAME(x) x ## _
+#define FC_LEN_T size_t
+#define FCONE ,(FC_LEN_T)1
+
+extern "C" {
+	void   daxpy_( const int *n, const double *alpha, const double *x, const int *incx, double *y, const int *incy );
+	double ddot_ ( const int *n, const double *x, const int *incx, const double *y, const int *incy );
+	void   dgemm_( const char *transa, const char *transb, const int *m, const int *n, const int *k,
+	               const double *alpha, const double *a, const int *lda, const double *b, const int *ldb,
+	               const double *beta, double *c, const int *ldc, FC_LEN_T, FC_LEN_T );
+	void   dsymv_( const char *uplo, const int *n, const double *alpha, const double *a, const int *lda,
+	               const double *x, const int *incx, const double *beta, double *y, const int *incy, FC_LEN_T );
+	void   dsyr_ ( const char *uplo, const int *n, const double *alpha, const double *x, const int *incx,
+	               double *a, const int *lda, FC_LEN_T );
+	void   dtrmm_( const char *side, const char *uplo, const char *transa, const char *diag, const int *m,
+	               const int *n, const double *alpha, const double *a, const int *lda, double *b, const int *ldb,
+	               FC_LEN_T, FC_LEN_T, FC_LEN_T, FC_LEN_T );
+	void   dtrsm_( const char *side, const char *uplo, const char *transa, const char *diag, const int *m,
+	               const int *n, const double *alpha, const double *a, const int *lda, double *b, const int *ldb,
+	               FC_LEN_T, FC_LEN_T, FC_LEN_T, FC_LEN_T );
+	void   dposv_( const char *uplo, const int *n, const int *nrhs, double *a, const int *lda, double *b,
+	               const int *ldb, int *info, FC_LEN_T );
+	void   dpotrf_( const char *uplo, const int *n, double *a, const int *lda, int *info, FC_LEN_T );
+}
+
+#endif
@@ -5,6 +5,10 @@
     #include <omp.h>
 #endif
 
+#ifdef BDGRAPH_STANDALONE
+    #include "standalone.h"   // the core samplers without R ( inst/cli )
+#else
+
 #ifndef USE_FC_LEN_T
 #define USE_FC_LEN_T  // For Fortran character strings
 #endif
@@ -22,9 +26,13 @@
 
 #include <R_ext/Visibility.h>
 
+#endif
+
 #include <sstream>
 #include <string>            // std::string, std::to_string
 #include <vector>            // for using vector
+#include <map>               // for the score caches of the hill-climbing search
+#include <queue>             // for priority_queue
 
 #include <math.h>            // isinf, sqrt
 #include <limits>            // for std::numeric_limits<double>::max()
@@ -38,4 +46,16 @@
 
 using namespace std;
 
+// progress of the MCMC loops, every 'print_c'% of 'iteration': 'i_done' iterations are done.
+// Runs shorter than 100 / print_c iterations have no progress output
+inline void print_progress( int i_done, int iteration, int print_c, int *print_conter )
+{
+	int print_step = ( print_c * iteration ) / 100;
+	if( ( print_step > 0 ) and ( i_done % print_step == 0 ) )
+	{
+		++( *print_conter );
+		( i_done != iteration ) ? Rprintf( "%i%%->", print_c * *print_conter ) : Rprintf( " done" );
+	}
+}
+
 #endif